@@ -31,12 +31,26 @@
 //     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 
+// per-frame globals shared by every program (see RenderEngine::FrameUniforms)
+// NOTE: must match the C++ struct and be identical in every shader that declares it
+layout(std140) uniform FrameUniforms {
+    mat4 viewMat;
+    mat4 projectionMat;
+    mat4 viewProjectionMat;
+    mat4 viewMatOnlyYaw;
+    vec4 fogColourFarAtCurrentTime;
+    vec3 cameraPosition;
+    float waveAnimationTimeInSeconds;
+    // the inverse light direction (in world-space)
+    vec3 sunPosition;
+    float zNear;
+    vec2 viewportWidthHeight;
+    float zFar;
+};
+
 uniform bool hasNormals;
 uniform bool isTextured;
-// in view-space
-uniform vec3 lightVec;
 uniform sampler2D textureData;
-uniform float zFar;
 
 in vec3 COLOUR;
 in vec3 normalVec;
@@ -47,7 +61,8 @@ in vec3 viewVec;
 out vec4 colour;
 
 void main() {
-    vec3 L = normalize(lightVec);
+    // in view-space
+    vec3 L = normalize((viewMat * vec4(sunPosition, 0.0f)).xyz);
     vec3 N = normalize(normalVec);
     vec3 V = normalize(viewVec);
     //NOTE: using the view-space position since we want the distance from the camera eye (which is the origin of view-space)
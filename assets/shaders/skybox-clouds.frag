@@ -31,11 +31,26 @@
 //     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 
+// per-frame globals shared by every program (see RenderEngine::FrameUniforms)
+// NOTE: must match the C++ struct and be identical in every shader that declares it
+layout(std140) uniform FrameUniforms {
+    mat4 viewMat;
+    mat4 projectionMat;
+    mat4 viewProjectionMat;
+    mat4 viewMatOnlyYaw;
+    vec4 fogColourFarAtCurrentTime;
+    vec3 cameraPosition;
+    float waveAnimationTimeInSeconds;
+    // the inverse light direction (in world-space)
+    vec3 sunPosition;
+    float zNear;
+    vec2 viewportWidthHeight;
+    float zFar;
+};
+
 // used as a grayscale intensity threshold acting as a way to control the proportion of clouds from the skybox textures get drawn
 uniform float oneMinusCloudProportion;
 uniform samplerCube skyboxClouds;
-// the inverse light direction
-uniform vec3 sunPosition;
 
 in vec3 STR;
 
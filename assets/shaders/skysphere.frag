@@ -31,12 +31,27 @@
 //     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 
+// per-frame globals shared by every program (see RenderEngine::FrameUniforms)
+// NOTE: must match the C++ struct and be identical in every shader that declares it
+layout(std140) uniform FrameUniforms {
+    mat4 viewMat;
+    mat4 projectionMat;
+    mat4 viewProjectionMat;
+    mat4 viewMatOnlyYaw;
+    vec4 fogColourFarAtCurrentTime;
+    vec3 cameraPosition;
+    float waveAnimationTimeInSeconds;
+    // the inverse light direction (in world-space)
+    vec3 sunPosition;
+    float zNear;
+    vec2 viewportWidthHeight;
+    float zFar;
+};
+
 // this is the sky-gradient texture that will be interpolated based on time of day
 uniform sampler1D skysphere;
 // this scales the sun horizon colour to be darker
 uniform float sunHorizonDarkness;
-// the inverse light direction
-uniform vec3 sunPosition;
 // higher shininess means smaller specular highlight (sun)
 uniform float sunShininess;
 // this scalar affects how much of the sun light is added on top of the diffuse sky colour
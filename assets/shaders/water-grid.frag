@@ -1,18 +1,31 @@
 #version 410 core
 
+// per-frame globals shared by every program (see RenderEngine::FrameUniforms)
+// NOTE: must match the C++ struct and be identical in every shader that declares it
+layout(std140) uniform FrameUniforms {
+    mat4 viewMat;
+    mat4 projectionMat;
+    mat4 viewProjectionMat;
+    mat4 viewMatOnlyYaw;
+    vec4 fogColourFarAtCurrentTime;
+    vec3 cameraPosition;
+    float waveAnimationTimeInSeconds;
+    // the inverse light direction (in world-space)
+    vec3 sunPosition;
+    float zNear;
+    vec2 viewportWidthHeight;
+    float zFar;
+};
+
 uniform sampler2D depthTexture2D;
 uniform sampler2D localReflectionsTexture2D;
 uniform sampler2D localRefractionsTexture2D;
 uniform samplerCube skybox;
 uniform float softEdgesDeltaDepthThreshold;
-uniform vec3 sunPosition;
 uniform float sunShininess;
 uniform float sunStrength;
 uniform float tintDeltaDepthThreshold;
-uniform vec2 viewportWidthHeight;
 uniform float waterClarity;
-uniform float zFar;
-uniform float zNear;
 
 in vec3 normal;
 in vec3 normalVecInViewSpaceOnlyYaw;
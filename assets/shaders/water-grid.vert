@@ -1,13 +1,16 @@
 #version 410 core
 
-
 out vec2 uv;
 
 uniform uint gridLength;
 
 void main() {
-    // Compute the (u, v) grid coordinates based on vertexID
-    float du = 1.0f / (gridLength - 1);
-    float dv = 1.0f / (gridLength - 1);
-    uv = vec2(mod(gl_VertexID, gridLength) * du, (gl_VertexID / gridLength) * dv);
+    // every instance is a row of cells, and every 4 vertices are the corners of a cell's quad patch (no vertex or index buffer)
+    // corners: 0 = bottom-left, 1 = bottom-right, 2 = top-left, 3 = top-right (see water-grid.tes)
+    uint cell = uint(gl_VertexID) / 4u;
+    uint corner = uint(gl_VertexID) % 4u;
+    uvec2 gridPoint = uvec2(cell + (corner & 1u), uint(gl_InstanceID) + (corner >> 1u));
+
+    // Compute the (u, v) grid coordinates of the corner
+    uv = vec2(gridPoint) / float(gridLength - 1u);
 }
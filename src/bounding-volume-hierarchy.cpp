@@ -0,0 +1,153 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "bounding-volume-hierarchy.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace wave_tool
+{
+    void BoundingVolumeHierarchy::build(std::vector<geometry::AABB> const &itemBounds)
+    {
+        m_nodes.clear();
+        m_itemBounds = itemBounds;
+        m_itemIndices.resize(itemBounds.size());
+        std::iota(m_itemIndices.begin(), m_itemIndices.end(), 0);
+        if (itemBounds.empty())
+            return;
+
+        // a binary tree with at least one item per leaf never has more than 2n - 1 nodes
+        m_nodes.reserve(2 * itemBounds.size() - 1);
+        buildRecursive(itemBounds, 0, (std::uint32_t)itemBounds.size());
+    }
+
+    void BoundingVolumeHierarchy::buildRecursive(std::vector<geometry::AABB> const &itemBounds, std::uint32_t const begin, std::uint32_t const end)
+    {
+        std::uint32_t const nodeIndex{(std::uint32_t)m_nodes.size()};
+        m_nodes.push_back(Node{});
+
+        geometry::AABB bounds;
+        geometry::AABB centroidBounds;
+        for (std::uint32_t i = begin; i < end; ++i)
+        {
+            geometry::AABB const &item{itemBounds.at(m_itemIndices.at(i))};
+            if (item.isEmpty())
+                continue;
+            bounds.expand(item);
+            centroidBounds.expand(item.getCenter());
+        }
+        m_nodes.at(nodeIndex).bounds = bounds;
+
+        std::uint32_t const count{end - begin};
+        if (count <= s_MAX_LEAF_SIZE || centroidBounds.isEmpty())
+        {
+            m_nodes.at(nodeIndex).firstItemOrRightChild = begin;
+            m_nodes.at(nodeIndex).itemCount = count;
+            return;
+        }
+
+        // median split along the widest axis of the centroids (always leaves both halves non-empty)
+        glm::vec3 const centroidExtent{centroidBounds.max - centroidBounds.min};
+        int const axis{centroidExtent.x >= centroidExtent.y && centroidExtent.x >= centroidExtent.z ? 0 : (centroidExtent.y >= centroidExtent.z ? 1 : 2)};
+        std::uint32_t const middle{begin + count / 2};
+        std::nth_element(m_itemIndices.begin() + begin, m_itemIndices.begin() + middle, m_itemIndices.begin() + end, [&itemBounds, axis](std::uint32_t const a, std::uint32_t const b) {
+            return itemBounds.at(a).getCenter()[axis] < itemBounds.at(b).getCenter()[axis];
+        });
+
+        buildRecursive(itemBounds, begin, middle);
+        m_nodes.at(nodeIndex).firstItemOrRightChild = (std::uint32_t)m_nodes.size();
+        m_nodes.at(nodeIndex).itemCount = 0;
+        buildRecursive(itemBounds, middle, end);
+    }
+
+    void BoundingVolumeHierarchy::refit(std::vector<geometry::AABB> const &itemBounds)
+    {
+        m_itemBounds = itemBounds;
+        // children always come after their parent, so a reverse sweep sees every child before its parent
+        for (std::size_t i = m_nodes.size(); i-- > 0;)
+        {
+            Node &node{m_nodes.at(i)};
+            node.bounds = geometry::AABB{};
+            if (0 != node.itemCount)
+            {
+                for (std::uint32_t j = node.firstItemOrRightChild; j < node.firstItemOrRightChild + node.itemCount; ++j)
+                {
+                    geometry::AABB const &item{itemBounds.at(m_itemIndices.at(j))};
+                    if (!item.isEmpty())
+                        node.bounds.expand(item);
+                }
+            }
+            else
+            {
+                node.bounds.expand(m_nodes.at(i + 1).bounds);
+                node.bounds.expand(m_nodes.at(node.firstItemOrRightChild).bounds);
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::query(geometry::Frustum const &frustum, std::vector<std::uint32_t> &out_itemIndices) const
+    {
+        if (m_nodes.empty())
+            return;
+
+        // (node index, planes still to test)
+        std::vector<std::pair<std::uint32_t, unsigned int>> stack;
+        stack.emplace_back(0, (1u << frustum.planeCount) - 1u);
+        while (!stack.empty())
+        {
+            std::pair<std::uint32_t, unsigned int> const entry{stack.back()};
+            stack.pop_back();
+
+            Node const &node{m_nodes.at(entry.first)};
+            unsigned int planeMask{entry.second};
+            if (0 != planeMask && !frustum.intersects(node.bounds, entry.second, planeMask))
+                continue;
+
+            if (0 != node.itemCount)
+            {
+                for (std::uint32_t i = node.firstItemOrRightChild; i < node.firstItemOrRightChild + node.itemCount; ++i)
+                {
+                    std::uint32_t const itemIndex{m_itemIndices.at(i)};
+                    unsigned int itemPlaneMask;
+                    // the leaf box straddles some planes, so each of its items still gets the remaining tests
+                    if (0 == planeMask || frustum.intersects(m_itemBounds.at(itemIndex), planeMask, itemPlaneMask))
+                        out_itemIndices.push_back(itemIndex);
+                }
+                continue;
+            }
+
+            stack.emplace_back(node.firstItemOrRightChild, planeMask);
+            stack.emplace_back(entry.first + 1, planeMask);
+        }
+    }
+}
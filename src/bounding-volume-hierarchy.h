@@ -0,0 +1,77 @@
+#ifndef WAVE_TOOL_BOUNDING_VOLUME_HIERARCHY_H_
+#define WAVE_TOOL_BOUNDING_VOLUME_HIERARCHY_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <cstdint>
+#include <vector>
+
+#include "bounding-volumes.h"
+
+namespace wave_tool
+{
+    // binary AABB tree over a set of items (item i is bounded by box i), used to cull whole groups of objects at once
+    // the topology is built once (median split along the widest axis of the centroids) and then only refit as the items move
+    // NOTE: refitting keeps the queries correct, but the tree gets looser if items move far from where they were when it was built
+    class BoundingVolumeHierarchy
+    {
+    public:
+        static unsigned int const s_MAX_LEAF_SIZE{4};
+
+        void build(std::vector<geometry::AABB> const &itemBounds);
+        // recomputes every node box from the new item boxes (same item count as the last build)
+        void refit(std::vector<geometry::AABB> const &itemBounds);
+
+        // appends the index of every item whose box intersects the frustum
+        // NOTE: once a node is fully inside a plane, nothing below it is tested against that plane again
+        void query(geometry::Frustum const &frustum, std::vector<std::uint32_t> &out_itemIndices) const;
+
+        inline std::size_t getItemCount() const { return m_itemIndices.size(); }
+
+    private:
+        // nodes are stored depth-first, so the left child of node i is i + 1 and every child comes after its parent
+        struct Node
+        {
+            geometry::AABB bounds;
+            std::uint32_t firstItemOrRightChild; // leaf: offset into m_itemIndices, internal: index of the right child
+            std::uint32_t itemCount;             // 0 for internal nodes
+        };
+
+        std::vector<Node> m_nodes;
+        std::vector<geometry::AABB> m_itemBounds;
+        std::vector<std::uint32_t> m_itemIndices;
+
+        void buildRecursive(std::vector<geometry::AABB> const &itemBounds, std::uint32_t const begin, std::uint32_t const end);
+    };
+}
+
+#endif // WAVE_TOOL_BOUNDING_VOLUME_HIERARCHY_H_
@@ -0,0 +1,202 @@
+#ifndef WAVE_TOOL_BOUNDING_VOLUMES_H_
+#define WAVE_TOOL_BOUNDING_VOLUMES_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <limits>
+#include <vector>
+
+namespace wave_tool
+{
+    namespace geometry
+    {
+        // axis-aligned bounding box (empty when min > max)
+        struct AABB
+        {
+            glm::vec3 min{std::numeric_limits<float>::max()};
+            glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+            inline bool isEmpty() const { return glm::any(glm::greaterThan(min, max)); }
+            inline glm::vec3 getCenter() const { return 0.5f * (min + max); }
+            inline glm::vec3 getExtent() const { return 0.5f * (max - min); }
+
+            inline void expand(glm::vec3 const &point)
+            {
+                min = glm::min(min, point);
+                max = glm::max(max, point);
+            }
+
+            inline void expand(AABB const &other)
+            {
+                min = glm::min(min, other.min);
+                max = glm::max(max, other.max);
+            }
+
+            // the (conservative) box around this box after an affine transform
+            // reference: Arvo, "Transforming Axis-Aligned Bounding Boxes", Graphics Gems (1990)
+            inline AABB transformed(glm::mat4 const &transform) const
+            {
+                if (isEmpty())
+                    return *this;
+
+                glm::vec3 const center{transform * glm::vec4{getCenter(), 1.0f}};
+                glm::mat3 const absLinear{glm::abs(glm::vec3{transform[0]}), glm::abs(glm::vec3{transform[1]}), glm::abs(glm::vec3{transform[2]})};
+                glm::vec3 const extent{absLinear * getExtent()};
+                return AABB{center - extent, center + extent};
+            }
+
+            static AABB fromPoints(std::vector<glm::vec3> const &points)
+            {
+                AABB bounds;
+                for (glm::vec3 const &point : points)
+                    bounds.expand(point);
+                return bounds;
+            }
+        };
+
+        // (negative radius when empty)
+        struct BoundingSphere
+        {
+            glm::vec3 center{0.0f};
+            float radius{-1.0f};
+
+            inline bool isEmpty() const { return radius < 0.0f; }
+
+            // NOTE: non-uniform scale is handled conservatively (by the largest axis scale)
+            inline BoundingSphere transformed(glm::mat4 const &transform) const
+            {
+                if (isEmpty())
+                    return *this;
+
+                float const maxScale{glm::sqrt(glm::max(glm::max(glm::dot(glm::vec3{transform[0]}, glm::vec3{transform[0]}), glm::dot(glm::vec3{transform[1]}, glm::vec3{transform[1]})), glm::dot(glm::vec3{transform[2]}, glm::vec3{transform[2]})))};
+                return BoundingSphere{glm::vec3{transform * glm::vec4{center, 1.0f}}, maxScale * radius};
+            }
+
+            // centered on the box of the points (not minimal, but cheap and never worse than the box's circumsphere)
+            static BoundingSphere fromPoints(std::vector<glm::vec3> const &points)
+            {
+                AABB const bounds{AABB::fromPoints(points)};
+                if (bounds.isEmpty())
+                    return BoundingSphere{};
+
+                BoundingSphere sphere{bounds.getCenter(), 0.0f};
+                for (glm::vec3 const &point : points)
+                    sphere.radius = glm::max(sphere.radius, glm::distance(sphere.center, point));
+                return sphere;
+            }
+        };
+
+        // convex volume bounded by inward-facing planes, where a point p is inside iff dot(plane.xyz, p) + plane.w >= 0 for every plane
+        struct Frustum
+        {
+            static unsigned int const MAX_PLANE_COUNT{7}; // the 6 frustum planes plus an optional user clip plane
+
+            std::array<glm::vec4, MAX_PLANE_COUNT> planes;
+            unsigned int planeCount{0};
+
+            // extracts the 6 planes of (projection * view * model), in the space that matrix is applied to
+            // reference: Gribb & Hartmann, "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix" (2001)
+            static Frustum fromMatrix(glm::mat4 const &matrix)
+            {
+                glm::mat4 const rows{glm::transpose(matrix)};
+                Frustum frustum;
+                frustum.planeCount = 6;
+                frustum.planes.at(0) = rows[3] + rows[0]; // left
+                frustum.planes.at(1) = rows[3] - rows[0]; // right
+                frustum.planes.at(2) = rows[3] + rows[1]; // bottom
+                frustum.planes.at(3) = rows[3] - rows[1]; // top
+                frustum.planes.at(4) = rows[3] + rows[2]; // near
+                frustum.planes.at(5) = rows[3] - rows[2]; // far
+                for (unsigned int i = 0; i < frustum.planeCount; ++i)
+                    frustum.planes.at(i) /= glm::length(glm::vec3{frustum.planes.at(i)});
+                return frustum;
+            }
+
+            // adds a plane in the same convention as above
+            inline void addPlane(glm::vec4 const &plane)
+            {
+                if (planeCount < MAX_PLANE_COUNT)
+                    planes.at(planeCount++) = plane;
+            }
+
+            // returns false if the box is fully outside any plane
+            // out_insideMask has bit i cleared if the box is fully inside plane i (those planes don't need testing for anything inside the box)
+            inline bool intersects(AABB const &bounds, unsigned int const planeMask, unsigned int &out_insideMask) const
+            {
+                out_insideMask = planeMask;
+                if (bounds.isEmpty())
+                    return false;
+
+                glm::vec3 const center{bounds.getCenter()};
+                glm::vec3 const extent{bounds.getExtent()};
+                for (unsigned int i = 0; i < planeCount; ++i)
+                {
+                    if (0 == (planeMask & (1u << i)))
+                        continue;
+
+                    glm::vec3 const normal{planes.at(i)};
+                    float const distance{glm::dot(normal, center) + planes.at(i).w};
+                    float const radius{glm::dot(glm::abs(normal), extent)};
+                    if (distance < -radius)
+                        return false;
+                    if (distance >= radius)
+                        out_insideMask &= ~(1u << i);
+                }
+                return true;
+            }
+
+            inline bool intersects(AABB const &bounds) const
+            {
+                unsigned int insideMask;
+                return intersects(bounds, (1u << planeCount) - 1u, insideMask);
+            }
+
+            inline bool intersects(BoundingSphere const &sphere) const
+            {
+                if (sphere.isEmpty())
+                    return false;
+
+                for (unsigned int i = 0; i < planeCount; ++i)
+                {
+                    if (glm::dot(glm::vec3{planes.at(i)}, sphere.center) + planes.at(i).w < -sphere.radius)
+                        return false;
+                }
+                return true;
+            }
+        };
+    }
+}
+
+#endif // WAVE_TOOL_BOUNDING_VOLUMES_H_
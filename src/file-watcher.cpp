@@ -0,0 +1,155 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "file-watcher.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef WAVE_TOOL_HAS_INOTIFY
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace wave_tool
+{
+#ifdef WAVE_TOOL_HAS_INOTIFY
+    FileWatcher::FileWatcher(std::string const &directory) : m_directory{directory}
+    {
+        m_inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (-1 == m_inotifyFD)
+        {
+            std::cout << "ERROR: failed to initialize inotify" << std::endl;
+            return;
+        }
+
+        // NOTE: editors often save by writing a temporary file and renaming it over the original, hence IN_MOVED_TO
+        if (-1 == inotify_add_watch(m_inotifyFD, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO))
+        {
+            std::cout << "ERROR: failed to watch directory: " << directory << std::endl;
+            close(m_inotifyFD);
+            m_inotifyFD = -1;
+            return;
+        }
+        m_isWatching = true;
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        if (-1 != m_inotifyFD)
+            close(m_inotifyFD);
+    }
+
+    std::vector<std::string> FileWatcher::pollChangedFiles()
+    {
+        std::vector<std::string> changedFiles;
+        if (!m_isWatching)
+            return changedFiles;
+
+        // reference: https://man7.org/linux/man-pages/man7/inotify.7.html
+        alignas(inotify_event) char buffer[4096];
+        for (;;)
+        {
+            ssize_t const length{read(m_inotifyFD, buffer, sizeof(buffer))};
+            if (length <= 0)
+                break; // EAGAIN, nothing (more) to read
+
+            for (char const *p = buffer; p < buffer + length;)
+            {
+                inotify_event const *const event{reinterpret_cast<inotify_event const *>(p)};
+                if (event->len > 0 && 0 == (event->mask & IN_ISDIR))
+                {
+                    std::string const name{event->name};
+                    if (changedFiles.end() == std::find(changedFiles.begin(), changedFiles.end(), name))
+                        changedFiles.push_back(name);
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+        return changedFiles;
+    }
+#else
+    FileWatcher::FileWatcher(std::string const &directory) : m_directory{directory}
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(directory, error))
+        {
+            std::cout << "ERROR: failed to watch directory: " << directory << std::endl;
+            return;
+        }
+        scan(nullptr); // only remember the current state
+        m_lastPollTime = std::chrono::steady_clock::now();
+        m_isWatching = true;
+    }
+
+    FileWatcher::~FileWatcher() {}
+
+    std::vector<std::string> FileWatcher::pollChangedFiles()
+    {
+        std::vector<std::string> changedFiles;
+        if (!m_isWatching)
+            return changedFiles;
+
+        std::chrono::steady_clock::time_point const now{std::chrono::steady_clock::now()};
+        if (now - m_lastPollTime < POLL_INTERVAL)
+            return changedFiles;
+        m_lastPollTime = now;
+
+        scan(&changedFiles);
+        return changedFiles;
+    }
+
+    void FileWatcher::scan(std::vector<std::string> *out_changedFiles)
+    {
+        std::error_code error;
+        for (std::filesystem::directory_iterator it{m_directory, error}, end; !error && it != end; it.increment(error))
+        {
+            if (!it->is_regular_file(error))
+                continue;
+
+            std::filesystem::file_time_type const lastWriteTime{it->last_write_time(error)};
+            if (error)
+                continue;
+
+            std::string const name{it->path().filename().string()};
+            auto const found{m_lastWriteTimes.find(name)};
+            if (m_lastWriteTimes.end() == found || found->second != lastWriteTime)
+            {
+                m_lastWriteTimes[name] = lastWriteTime;
+                if (nullptr != out_changedFiles)
+                    out_changedFiles->push_back(name);
+            }
+        }
+    }
+#endif
+}
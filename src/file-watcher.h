@@ -0,0 +1,81 @@
+#ifndef WAVE_TOOL_FILE_WATCHER_H_
+#define WAVE_TOOL_FILE_WATCHER_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#define WAVE_TOOL_HAS_INOTIFY
+#endif
+
+namespace wave_tool
+{
+    // reports files of a single directory (not recursive) that were written since the last poll
+    // NOTE: uses inotify where available, otherwise compares modification times (at most every POLL_INTERVAL)
+    class FileWatcher
+    {
+    public:
+        inline static std::chrono::milliseconds const POLL_INTERVAL{500};
+
+        explicit FileWatcher(std::string const &directory);
+        ~FileWatcher();
+
+        FileWatcher(FileWatcher const &) = delete;
+        FileWatcher &operator=(FileWatcher const &) = delete;
+
+        inline bool isWatching() const { return m_isWatching; }
+        inline std::string const &getDirectory() const { return m_directory; }
+
+        // the names (not paths) of the files changed since the last call, each reported once
+        // NOTE: never blocks
+        std::vector<std::string> pollChangedFiles();
+
+    private:
+        std::string m_directory;
+        bool m_isWatching{false};
+#ifdef WAVE_TOOL_HAS_INOTIFY
+        int m_inotifyFD{-1};
+#else
+        std::chrono::steady_clock::time_point m_lastPollTime;
+        std::unordered_map<std::string, std::filesystem::file_time_type> m_lastWriteTimes;
+
+        void scan(std::vector<std::string> *out_changedFiles);
+#endif
+    };
+}
+
+#endif // WAVE_TOOL_FILE_WATCHER_H_
@@ -0,0 +1,92 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "gerstner-wave.h"
+
+#include <cmath>
+#include <random>
+
+#include <glm/gtc/constants.hpp>
+
+namespace wave_tool
+{
+    void GerstnerSpectrum::generate(Parameters const &parameters, std::array<std::shared_ptr<geometry::GerstnerWave>, geometry::GerstnerWave::MAX_COUNT> &out_waves)
+    {
+        float const GRAVITY{9.81f};
+
+        // release the old set first, so the wave count never exceeds MAX_COUNT
+        for (std::shared_ptr<geometry::GerstnerWave> &wave : out_waves)
+            wave = nullptr;
+
+        unsigned int const waveCount{glm::clamp(parameters.waveCount, 1u, geometry::GerstnerWave::MAX_COUNT)};
+        float const minWavelength{glm::max(parameters.minWavelengthInMeters, 0.01f)};
+        float const maxWavelength{glm::max(parameters.maxWavelengthInMeters, minWavelength * 1.001f)};
+        float const windSpeed{glm::max(parameters.windSpeed, 0.1f)};
+        float const windAngle{glm::radians(parameters.windDirectionInDegrees)};
+        float const steepness{glm::clamp(parameters.steepness, 0.0f, 1.0f)};
+        // Pierson-Moskowitz peak frequency
+        float const peakOmega{0.855f * GRAVITY / windSpeed};
+
+        std::mt19937 generator{parameters.seed};
+        std::uniform_real_distribution<float> uniform{0.0f, 1.0f};
+
+        for (unsigned int i = 0; i < waveCount; ++i)
+        {
+            // band [lambda_i, lambda_i+1) with the wave at a jittered position inside it (log-spaced, so every octave gets the same number of waves)
+            float const wavelengthRatio{maxWavelength / minWavelength};
+            float const bandShortWavelength{minWavelength * std::pow(wavelengthRatio, (float)i / waveCount)};
+            float const bandLongWavelength{minWavelength * std::pow(wavelengthRatio, (float)(i + 1) / waveCount)};
+            float const wavelength{minWavelength * std::pow(wavelengthRatio, (i + uniform(generator)) / waveCount)};
+
+            // deep water dispersion relation
+            float const k{glm::two_pi<float>() / wavelength};
+            float const omega{std::sqrt(GRAVITY * k)};
+
+            // S(w) = alpha * g^2 / w^5 * e^(-5/4 * (wp / w)^4) -> S(k) = S(w) * dw/dk, with dw/dk = g / 2w
+            // the band variance is S(k) * dk and a sine wave of amplitude A has variance A^2 / 2
+            float const alpha{0.0081f};
+            float const S_omega{alpha * GRAVITY * GRAVITY / std::pow(omega, 5.0f) * std::exp(-1.25f * std::pow(peakOmega / omega, 4.0f))};
+            float const S_k{S_omega * GRAVITY / (2.0f * omega)};
+            float const deltaK{glm::two_pi<float>() / bandShortWavelength - glm::two_pi<float>() / bandLongWavelength};
+            float const amplitude{parameters.amplitudeScale * std::sqrt(2.0f * S_k * deltaK)};
+
+            // rejection sample the direction from the spreading function (its maximum is 1 at theta = 0)
+            float theta{0.0f};
+            do
+            {
+                theta = glm::pi<float>() * (2.0f * uniform(generator) - 1.0f);
+            } while (uniform(generator) > std::pow(std::cos(0.5f * theta), 2.0f * parameters.spreadingExponent));
+            float const directionAngle{windAngle + theta};
+
+            out_waves.at(i) = std::make_shared<geometry::GerstnerWave>(amplitude, k, omega, steepness, glm::vec2{std::cos(directionAngle), std::sin(directionAngle)}, glm::two_pi<float>() * uniform(generator));
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef WAVE_TOOL_GERSTNER_WAVE_H_
+#define WAVE_TOOL_GERSTNER_WAVE_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cassert>
+#include <memory>
+
+namespace wave_tool
+{
+    namespace geometry
+    {
+        // reference: https://developer.nvidia.com/gpugems/gpugems/part-i-natural-effects/chapter-1-effective-water-simulation-physical-models
+        // TODO: the statics are very unsafe at the moment
+        struct GerstnerWave
+        {
+        public:
+            // NOTE: must match MAX_COUNT_OF_GERSTNER_WAVES in water-grid.tes (the whole set lives in one uniform block)
+            static unsigned int const MAX_COUNT = 256;
+            static_assert(MAX_COUNT > 0);
+
+            inline static unsigned int Count() { return count; }
+            inline static float TotalAmplitude() { return totalAmplitude; }
+
+            float amplitude_A;       // height of crest above equilibrium plane
+            float frequency_w;       // w = 2/L (roughly), where L =:= wavelength (crest-to-crest distance)
+            float phaseConstant_phi; // phi = S x w, where S =:= speed (distance crest moves forward per second)
+            float steepness_Q;       // controls "sharpness" of crest
+            glm::vec2 xzDirection_D; // horizontal unit vector perpendicular to the wave front along which the crest travels
+            float phaseOffset{0.0f}; // in range [0.0, 2pi) - phase at the origin when time is 0 (keeps many waves from all peaking at the origin)
+
+            GerstnerWave(float const amplitude_A, float const frequency_w, float const phaseConstant_phi, float const steepness_Q, glm::vec2 const &xzDirection_D, float const phaseOffset = 0.0f)
+                : amplitude_A(amplitude_A), frequency_w(frequency_w), phaseConstant_phi(phaseConstant_phi), steepness_Q(steepness_Q), xzDirection_D(xzDirection_D), phaseOffset(phaseOffset)
+            {
+                assert(count < MAX_COUNT);
+                assert(amplitude_A >= 0.0f);
+                assert(frequency_w >= 0.0f);
+                assert(phaseConstant_phi >= 0.0f);
+                assert(0.0f <= steepness_Q && steepness_Q <= 1.0f);
+                float const EPSILON{0.001f};
+                float const xzDirection_D_length{glm::length(xzDirection_D)};
+                assert(1.0f - EPSILON <= xzDirection_D_length && xzDirection_D_length <= 1.0f + EPSILON);
+
+                ++count;
+                totalAmplitude += amplitude_A;
+            }
+
+            ~GerstnerWave()
+            {
+                --count;
+                totalAmplitude -= amplitude_A;
+            }
+
+        private:
+            inline static unsigned int count = 0;
+            inline static float totalAmplitude = 0.0f;
+        };
+    }
+
+    // samples a set of Gerstner waves from a directional wind-wave spectrum
+    // reference: Pierson & Moskowitz (1964) - fully developed sea spectrum
+    // reference: Longuet-Higgins et al. (1963) - cos^2s(theta / 2) directional spreading
+    // the wavelength range is split into one log-spaced band per wave, and each wave carries the energy of its band
+    class GerstnerSpectrum
+    {
+    public:
+        struct Parameters
+        {
+            unsigned int waveCount{64};          // in range [1, GerstnerWave::MAX_COUNT]
+            float windSpeed{6.0f};               // in range (0.0, inf) - m/s
+            float windDirectionInDegrees{0.0f};  // angle from +x towards +z
+            float spreadingExponent{8.0f};       // in range [0.0, inf) - the s in cos^2s(theta / 2), larger is more aligned with the wind
+            float minWavelengthInMeters{0.5f};   // in range (0.0, maxWavelengthInMeters)
+            float maxWavelengthInMeters{60.0f};  // in range (minWavelengthInMeters, inf)
+            float amplitudeScale{1.0f};          // in range [0.0, inf)
+            float steepness{0.5f};               // in range [0.0, 1.0] - the Q given to every wave
+            unsigned int seed{1};
+        };
+
+        // replaces every wave (unused slots become nullptr)
+        static void generate(Parameters const &parameters, std::array<std::shared_ptr<geometry::GerstnerWave>, geometry::GerstnerWave::MAX_COUNT> &out_waves);
+    };
+}
+
+#endif // WAVE_TOOL_GERSTNER_WAVE_H_
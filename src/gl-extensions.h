@@ -0,0 +1,62 @@
+#ifndef WAVE_TOOL_GL_EXTENSIONS_H_
+#define WAVE_TOOL_GL_EXTENSIONS_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glad/glad.h>
+
+// from GL 4.4 / ARB_buffer_storage (not part of the core profile our glad loader was generated for)
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace wave_tool
+{
+    // entry points beyond the GL 4.1 core profile our glad loader was generated for (each is nullptr if the context doesn't have it)
+    // NOTE: load must be called right after glad is loaded, with the same loader
+    class GLExtensions
+    {
+    public:
+        typedef void(APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, void const *data, GLbitfield flags);
+
+        static void load(GLADloadproc loadProc);
+        static bool isSupported(char const *extensionName);
+
+        // GL 4.4 core or ARB_buffer_storage
+        inline static BufferStorageProc bufferStorage{nullptr};
+    };
+}
+
+#endif // WAVE_TOOL_GL_EXTENSIONS_H_
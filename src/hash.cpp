@@ -0,0 +1,67 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "hash.h"
+
+#include <cstring>
+
+namespace wave_tool
+{
+    namespace
+    {
+        inline std::uint64_t mix(std::uint64_t value)
+        {
+            // reference: the 64-bit finalizer of MurmurHash3
+            value ^= value >> 33;
+            value *= 0xff51afd7ed558ccdULL;
+            value ^= value >> 33;
+            value *= 0xc4ceb9fe1a85ec53ULL;
+            value ^= value >> 33;
+            return value;
+        }
+    }
+
+    // hashes 8 bytes at a time, so checking a large source file costs far less than parsing it
+    std::uint64_t hashContents(char const *data, std::size_t const size)
+    {
+        std::uint64_t hash{0x9e3779b97f4a7c15ULL ^ size};
+        std::size_t i{0};
+        for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word)); // unaligned-safe
+            hash = (hash ^ mix(word)) * 0x100000001b3ULL;
+        }
+        std::uint64_t tail{0};
+        std::memcpy(&tail, data + i, size - i);
+        return mix(hash ^ mix(tail));
+    }
+}
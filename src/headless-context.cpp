@@ -0,0 +1,199 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "headless-context.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef WAVE_TOOL_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace wave_tool
+{
+    HeadlessContext::HeadlessContext() {}
+
+    HeadlessContext::~HeadlessContext()
+    {
+        destroy();
+    }
+
+#ifdef WAVE_TOOL_HAS_EGL
+    namespace
+    {
+        bool hasExtension(char const *extensions, char const *name)
+        {
+            if (nullptr == extensions)
+                return false;
+            std::size_t const nameLength{std::strlen(name)};
+            for (char const *start{extensions}; nullptr != (start = std::strstr(start, name)); start += nameLength)
+            {
+                // must match a whole space-separated token (not just a prefix of a longer extension name)
+                bool const isTokenStart{start == extensions || ' ' == start[-1]};
+                bool const isTokenEnd{'\0' == start[nameLength] || ' ' == start[nameLength]};
+                if (isTokenStart && isTokenEnd)
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    // reference: https://developer.nvidia.com/blog/egl-eye-opengl-visualization-without-x-server/
+    // reference: https://registry.khronos.org/EGL/extensions/MESA/EGL_MESA_platform_surfaceless.txt
+    bool HeadlessContext::create()
+    {
+        destroy();
+
+        EGLDisplay display{EGL_NO_DISPLAY};
+
+        // prefer the surfaceless platform (no X11/Wayland connection at all), otherwise use whatever the default display is
+        char const *clientExtensions{eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS)};
+        if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+        {
+            auto const eglGetPlatformDisplayEXT{(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT")};
+            if (nullptr != eglGetPlatformDisplayEXT)
+                display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+        if (EGL_NO_DISPLAY == display)
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+        EGLint major{0};
+        EGLint minor{0};
+        if (EGL_NO_DISPLAY == display || !eglInitialize(display, &major, &minor))
+        {
+            std::cout << "ERROR: failed to initialize an EGL display" << std::endl;
+            return false;
+        }
+        m_display = display;
+
+        // NOTE: desktop OpenGL (not GLES) is required for the 4.1 core shaders
+        if (!eglBindAPI(EGL_OPENGL_API))
+        {
+            std::cout << "ERROR: EGL display doesn't support desktop OpenGL" << std::endl;
+            destroy();
+            return false;
+        }
+
+        EGLint const configAttribs[]{EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                                     EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                     EGL_RED_SIZE, 8,
+                                     EGL_GREEN_SIZE, 8,
+                                     EGL_BLUE_SIZE, 8,
+                                     EGL_ALPHA_SIZE, 8,
+                                     EGL_NONE};
+        EGLConfig config{nullptr};
+        EGLint configCount{0};
+        if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount < 1)
+        {
+            std::cout << "ERROR: no suitable EGL config found" << std::endl;
+            destroy();
+            return false;
+        }
+
+        // same context as the windowed mode (see Program::setupWindow)
+        EGLint const contextAttribs[]{EGL_CONTEXT_MAJOR_VERSION, 4,
+                                      EGL_CONTEXT_MINOR_VERSION, 1,
+                                      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                      EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE, EGL_TRUE,
+                                      EGL_NONE};
+        EGLContext const context{eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs)};
+        if (EGL_NO_CONTEXT == context)
+        {
+            std::cout << "ERROR: failed to create an OpenGL 4.1 core EGL context" << std::endl;
+            destroy();
+            return false;
+        }
+        m_context = context;
+
+        // NOTE: the surface is never rendered to, it only exists for drivers that can't make a context current without one
+        EGLSurface surface{EGL_NO_SURFACE};
+        if (!hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+        {
+            EGLint const pbufferAttribs[]{EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+            surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+            if (EGL_NO_SURFACE == surface)
+            {
+                std::cout << "ERROR: failed to create an EGL pbuffer surface" << std::endl;
+                destroy();
+                return false;
+            }
+            m_surface = surface;
+        }
+
+        if (!eglMakeCurrent(display, surface, surface, context))
+        {
+            std::cout << "ERROR: failed to make the EGL context current" << std::endl;
+            destroy();
+            return false;
+        }
+
+        std::cout << "EGL [ " << major << "." << minor << " ] with vendor [ " << eglQueryString(display, EGL_VENDOR) << " ]" << std::endl;
+        return true;
+    }
+
+    void HeadlessContext::destroy()
+    {
+        if (nullptr == m_display)
+            return;
+
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (nullptr != m_surface)
+            eglDestroySurface(m_display, m_surface);
+        if (nullptr != m_context)
+            eglDestroyContext(m_display, m_context);
+        eglTerminate(m_display);
+
+        m_surface = nullptr;
+        m_context = nullptr;
+        m_display = nullptr;
+    }
+
+    void *HeadlessContext::getProcAddress(char const *name)
+    {
+        return (void *)eglGetProcAddress(name);
+    }
+#else
+    bool HeadlessContext::create()
+    {
+        std::cout << "ERROR: headless mode is unavailable (built without EGL support)" << std::endl;
+        return false;
+    }
+
+    void HeadlessContext::destroy() {}
+
+    void *HeadlessContext::getProcAddress(char const *)
+    {
+        return nullptr;
+    }
+#endif
+}
@@ -0,0 +1,61 @@
+#ifndef WAVE_TOOL_HEADLESS_CONTEXT_H_
+#define WAVE_TOOL_HEADLESS_CONTEXT_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+namespace wave_tool
+{
+    // an OpenGL 4.1 core context without any window (EGL surfaceless, or a tiny pbuffer as a fallback)
+    // NOTE: works without a display server and with software drivers (e.g. Mesa llvmpipe)
+    // NOTE: there is no usable default framebuffer, so everything must be rendered into an FBO
+    class HeadlessContext
+    {
+    public:
+        HeadlessContext();
+        ~HeadlessContext();
+
+        // creates the context and makes it current on the calling thread
+        bool create();
+        void destroy();
+
+        // suitable for gladLoadGLLoader
+        static void *getProcAddress(char const *name);
+
+    private:
+        // opaque EGL handles (avoids leaking EGL headers into every includer)
+        void *m_display = nullptr;
+        void *m_context = nullptr;
+        void *m_surface = nullptr;
+    };
+}
+
+#endif // WAVE_TOOL_HEADLESS_CONTEXT_H_
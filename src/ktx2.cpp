@@ -0,0 +1,294 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "ktx2.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace wave_tool
+{
+    namespace
+    {
+        std::array<unsigned char, 12> const IDENTIFIER{0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+        struct Header
+        {
+            std::array<unsigned char, 12> identifier;
+            std::uint32_t vkFormat;
+            std::uint32_t typeSize;
+            std::uint32_t pixelWidth;
+            std::uint32_t pixelHeight;
+            std::uint32_t pixelDepth;
+            std::uint32_t layerCount;
+            std::uint32_t faceCount;
+            std::uint32_t levelCount;
+            std::uint32_t supercompressionScheme;
+            std::uint32_t dfdByteOffset;
+            std::uint32_t dfdByteLength;
+            std::uint32_t kvdByteOffset;
+            std::uint32_t kvdByteLength;
+            std::uint64_t sgdByteOffset;
+            std::uint64_t sgdByteLength;
+        };
+        static_assert(sizeof(Header) == 80, "Header must match the KTX 2.0 file layout");
+
+        struct LevelIndexEntry
+        {
+            std::uint64_t byteOffset;
+            std::uint64_t byteLength;
+            std::uint64_t uncompressedByteLength;
+        };
+
+        // builds the basic data format descriptor (as required by KTX 2.0) of a BCn format
+        // floor(log2(max(width, height))) + 1, the length of a full mip chain down to 1x1
+        std::uint32_t getMaxLevelCount(std::uint32_t const width, std::uint32_t const height)
+        {
+            std::uint32_t levelCount{1};
+            for (std::uint32_t length{std::max(width, height)}; length > 1; length >>= 1)
+                ++levelCount;
+            return levelCount;
+        }
+
+        // reference: https://www.khronos.org/registry/DataFormat/specs/1.3/dataformat.1.3.html (sections 5 and 10.7)
+        std::vector<std::uint32_t> buildDataFormatDescriptor(KTX2::Format const format)
+        {
+            // colour models and channel ids of the khr_df.h enums
+            std::uint32_t colourModel{0};
+            std::vector<std::uint32_t> sampleChannels; // one per 64-bit half of the block
+            switch (format)
+            {
+            case KTX2::BC1_RGB:
+                colourModel = 128; // KHR_DF_MODEL_BC1A
+                sampleChannels = {0}; // KHR_DF_CHANNEL_BC1A_COLOR
+                break;
+            case KTX2::BC3_RGBA:
+                colourModel = 130;        // KHR_DF_MODEL_BC3
+                sampleChannels = {15, 0}; // KHR_DF_CHANNEL_BC3_ALPHA, KHR_DF_CHANNEL_BC3_COLOR
+                break;
+            case KTX2::BC4_R:
+                colourModel = 131; // KHR_DF_MODEL_BC4
+                sampleChannels = {0};
+                break;
+            case KTX2::BC5_RG:
+                colourModel = 132; // KHR_DF_MODEL_BC5
+                sampleChannels = {0, 1};
+                break;
+            default:
+                return {};
+            }
+
+            std::uint32_t const blockSize{24 + 16 * (std::uint32_t)sampleChannels.size()};
+            std::vector<std::uint32_t> words;
+            words.push_back(4 + blockSize); // dfdTotalSize
+            words.push_back(0); // vendorId (Khronos) | descriptorType (basic)
+            words.push_back(2 | (blockSize << 16)); // versionNumber | descriptorBlockSize
+            words.push_back(colourModel | (1 << 8) | (1 << 16)); // colorModel | colorPrimaries (BT709) | transferFunction (linear) | flags
+            words.push_back(3 | (3 << 8)); // texelBlockDimension0..3 (stored minus 1, so 4x4x1x1)
+            words.push_back((std::uint32_t)KTX2::getBlockSize(format)); // bytesPlane0..3
+            words.push_back(0); // bytesPlane4..7
+            for (std::size_t i = 0; i < sampleChannels.size(); ++i)
+            {
+                words.push_back((64 * (std::uint32_t)i) | (63 << 16) | (sampleChannels.at(i) << 24)); // bitOffset | bitLength (minus 1) | channelType
+                words.push_back(0); // samplePosition0..3
+                words.push_back(0); // sampleLower
+                words.push_back(0xFFFFFFFFu); // sampleUpper
+            }
+            return words;
+        }
+
+        char const ORIENTATION_KEY[] = "KTXorientation";
+
+        inline std::uint64_t alignUp(std::uint64_t const offset, std::uint64_t const alignment)
+        {
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    std::size_t KTX2::getBlockSize(Format const format)
+    {
+        switch (format)
+        {
+        case BC1_RGB:
+        case BC4_R:
+            return 8;
+        case BC3_RGBA:
+        case BC5_RG:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    std::size_t KTX2::getLevelSize(Format const format, std::uint32_t const width, std::uint32_t const height)
+    {
+        return getBlockSize(format) * ((width + 3) / 4) * ((height + 3) / 4);
+    }
+
+    std::string KTX2::getContainerPath(std::string const &imagePath)
+    {
+        std::size_t const dotIndex{imagePath.find_last_of('.')};
+        std::size_t const slashIndex{imagePath.find_last_of("/\\")};
+        // only strip a dot that belongs to the file name (not to a directory)
+        if (std::string::npos == dotIndex || (std::string::npos != slashIndex && dotIndex < slashIndex))
+            return imagePath + ".ktx2";
+        return imagePath.substr(0, dotIndex) + ".ktx2";
+    }
+
+    std::shared_ptr<KTX2::Mapping const> KTX2::open(std::string const &filePath)
+    {
+        std::shared_ptr<Mapping> mapping{new Mapping(filePath)};
+        MappedFile const &file{mapping->m_file};
+        if (!file.isOpen() || file.size() < sizeof(Header))
+            return nullptr;
+
+        Header header;
+        std::memcpy(&header, file.data(), sizeof(Header));
+        if (IDENTIFIER != header.identifier)
+            return nullptr;
+
+        Format const format{(Format)header.vkFormat};
+        if (0 == getBlockSize(format))
+            return nullptr; // not a format we can upload
+        if (0 == header.pixelWidth || 0 == header.pixelHeight || 0 != header.pixelDepth || 0 != header.layerCount || 1 != header.faceCount || 0 != header.supercompressionScheme)
+            return nullptr; // not a plain 2D image
+        if (0 == header.levelCount || file.size() < sizeof(Header) + sizeof(LevelIndexEntry) * header.levelCount)
+            return nullptr; // NOTE: a level count of 0 would ask for the mips to be generated at load time, which defeats the point of this format
+        if (header.levelCount > getMaxLevelCount(header.pixelWidth, header.pixelHeight))
+            return nullptr; // more levels than a full mip chain (and the level size shifts below would overflow)
+
+        mapping->m_format = format;
+        mapping->m_width = header.pixelWidth;
+        mapping->m_height = header.pixelHeight;
+        for (std::uint32_t level = 0; level < header.levelCount; ++level)
+        {
+            LevelIndexEntry entry;
+            std::memcpy(&entry, file.data() + sizeof(Header) + sizeof(LevelIndexEntry) * level, sizeof(LevelIndexEntry));
+            std::uint32_t const levelWidth{std::max(1u, header.pixelWidth >> level)};
+            std::uint32_t const levelHeight{std::max(1u, header.pixelHeight >> level)};
+            if (getLevelSize(format, levelWidth, levelHeight) != entry.byteLength || file.size() < entry.byteOffset || file.size() - entry.byteOffset < entry.byteLength)
+                return nullptr;
+            mapping->m_levels.push_back(Mapping::Level{(std::size_t)entry.byteOffset, (std::size_t)entry.byteLength});
+        }
+
+        // the only key read is the orientation, each entry is (length, "key\0value", padding to 4 bytes)
+        if (file.size() < header.kvdByteOffset || file.size() - header.kvdByteOffset < header.kvdByteLength)
+            return nullptr;
+        char const *entry{file.data() + header.kvdByteOffset};
+        char const *const kvdEnd{entry + header.kvdByteLength};
+        while (sizeof(std::uint32_t) <= (std::size_t)(kvdEnd - entry))
+        {
+            std::uint32_t length;
+            std::memcpy(&length, entry, sizeof(length));
+            char const *const keyAndValue{entry + sizeof(length)};
+            if ((std::size_t)(kvdEnd - keyAndValue) < length)
+                break;
+            if (sizeof(ORIENTATION_KEY) < length && 0 == std::memcmp(keyAndValue, ORIENTATION_KEY, sizeof(ORIENTATION_KEY)))
+                mapping->m_isBottomUp = sizeof(ORIENTATION_KEY) + 1 < length && 'u' == keyAndValue[sizeof(ORIENTATION_KEY) + 1]; // "ru" is (right, up)
+            entry = keyAndValue + alignUp(length, 4);
+        }
+
+        return mapping;
+    }
+
+    bool KTX2::write(std::string const &filePath, Format const format, std::uint32_t const width, std::uint32_t const height, std::vector<std::vector<unsigned char>> const &levels, bool const isBottomUp)
+    {
+        if (0 == getBlockSize(format) || 0 == width || 0 == height || levels.empty())
+            return false;
+        for (std::uint32_t level = 0; level < levels.size(); ++level)
+        {
+            if (getLevelSize(format, std::max(1u, width >> level), std::max(1u, height >> level)) != levels.at(level).size())
+                return false;
+        }
+
+        std::vector<std::uint32_t> const dataFormatDescriptor{buildDataFormatDescriptor(format)};
+        std::uint32_t const levelCount{(std::uint32_t)levels.size()};
+
+        // a single key/value entry: the orientation ("rd" for top-down rows, "ru" for bottom-up rows)
+        std::string const orientation{std::string(ORIENTATION_KEY, sizeof(ORIENTATION_KEY)) + (isBottomUp ? "ru" : "rd") + '\0'};
+        std::uint32_t const orientationLength{(std::uint32_t)orientation.size()};
+
+        Header header{};
+        header.identifier = IDENTIFIER;
+        header.vkFormat = format;
+        header.typeSize = 1; // required for block-compressed formats
+        header.pixelWidth = width;
+        header.pixelHeight = height;
+        header.faceCount = 1;
+        header.levelCount = levelCount;
+        header.dfdByteOffset = sizeof(Header) + sizeof(LevelIndexEntry) * levelCount;
+        header.dfdByteLength = sizeof(std::uint32_t) * dataFormatDescriptor.size();
+        header.kvdByteOffset = header.dfdByteOffset + header.dfdByteLength;
+        header.kvdByteLength = alignUp(sizeof(orientationLength) + orientationLength, 4);
+
+        // the levels are stored smallest first (so a streaming reader gets a usable image early), each aligned to its block size
+        std::vector<LevelIndexEntry> levelIndex(levelCount);
+        std::uint64_t offset{header.kvdByteOffset + header.kvdByteLength};
+        for (std::uint32_t i = 0; i < levelCount; ++i)
+        {
+            std::uint32_t const level{levelCount - 1 - i};
+            offset = alignUp(offset, getBlockSize(format));
+            levelIndex.at(level) = LevelIndexEntry{offset, levels.at(level).size(), levels.at(level).size()};
+            offset += levels.at(level).size();
+        }
+
+        std::ofstream fileStream(filePath, std::ios::binary | std::ios::trunc);
+        if (!fileStream)
+            return false;
+
+        fileStream.write(reinterpret_cast<char const *>(&header), sizeof(Header));
+        fileStream.write(reinterpret_cast<char const *>(levelIndex.data()), sizeof(LevelIndexEntry) * levelCount);
+        fileStream.write(reinterpret_cast<char const *>(dataFormatDescriptor.data()), header.dfdByteLength);
+        std::array<char, 16> const padding{};
+        fileStream.write(reinterpret_cast<char const *>(&orientationLength), sizeof(orientationLength));
+        fileStream.write(orientation.data(), orientationLength);
+        fileStream.write(padding.data(), header.kvdByteLength - sizeof(orientationLength) - orientationLength);
+        std::uint64_t written{header.kvdByteOffset + header.kvdByteLength};
+        for (std::uint32_t i = 0; i < levelCount; ++i)
+        {
+            std::uint32_t const level{levelCount - 1 - i};
+            fileStream.write(padding.data(), levelIndex.at(level).byteOffset - written);
+            fileStream.write(reinterpret_cast<char const *>(levels.at(level).data()), levels.at(level).size());
+            written = levelIndex.at(level).byteOffset + levels.at(level).size();
+        }
+
+        if (!fileStream)
+        {
+            fileStream.close();
+            std::remove(filePath.c_str());
+            return false;
+        }
+        return true;
+    }
+}
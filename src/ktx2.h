@@ -0,0 +1,107 @@
+#ifndef WAVE_TOOL_KTX2_H_
+#define WAVE_TOOL_KTX2_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mapped-file.h"
+
+namespace wave_tool
+{
+    // reads and writes the subset of KTX 2.0 used for pre-compressed textures: a single 2D image (no array layers, faces or supercompression) of BCn blocks with its full mip chain
+    // reference: https://github.khronos.org/KTX-Specification/
+    class KTX2
+    {
+    public:
+        // values are the matching VkFormat enumerants (what KTX 2.0 stores)
+        enum Format : std::uint32_t
+        {
+            UNDEFINED = 0,
+            BC1_RGB = 131,  // VK_FORMAT_BC1_RGB_UNORM_BLOCK, opaque colour (4 bpp)
+            BC3_RGBA = 137, // VK_FORMAT_BC3_UNORM_BLOCK, colour with smooth alpha (8 bpp)
+            BC4_R = 139,    // VK_FORMAT_BC4_UNORM_BLOCK, single channel (4 bpp)
+            BC5_RG = 141    // VK_FORMAT_BC5_UNORM_BLOCK, two channels (8 bpp)
+        };
+
+        // a validated file kept mapped in memory, whose levels can be handed straight to glCompressedTexImage2D
+        class Mapping
+        {
+        public:
+            inline Format getFormat() const { return m_format; }
+            inline std::uint32_t getWidth() const { return m_width; }
+            inline std::uint32_t getHeight() const { return m_height; }
+            inline std::uint32_t getLevelCount() const { return (std::uint32_t)m_levels.size(); }
+            // was the first row of each level written as the bottom of the image (KTXorientation "ru"), as OpenGL expects for 2D textures?
+            inline bool isBottomUp() const { return m_isBottomUp; }
+            // level 0 is the full resolution image
+            inline void const *getLevelData(std::uint32_t const level) const { return m_file.data() + m_levels.at(level).offset; }
+            inline std::size_t getLevelSize(std::uint32_t const level) const { return m_levels.at(level).size; }
+
+        private:
+            friend class KTX2;
+
+            struct Level
+            {
+                std::size_t offset;
+                std::size_t size;
+            };
+
+            explicit Mapping(std::string const &filePath) : m_file(filePath) {}
+
+            MappedFile m_file;
+            Format m_format{UNDEFINED};
+            std::uint32_t m_width{0};
+            std::uint32_t m_height{0};
+            bool m_isBottomUp{false};
+            std::vector<Level> m_levels;
+        };
+
+        // 8 or 16 bytes per 4x4 block, 0 for an unknown format
+        static std::size_t getBlockSize(Format const format);
+        static std::size_t getLevelSize(Format const format, std::uint32_t const width, std::uint32_t const height);
+        // "textures/sky.png" -> "textures/sky.ktx2"
+        static std::string getContainerPath(std::string const &imagePath);
+
+        // nullptr if the file is missing or isn't a KTX 2.0 file this reader supports
+        static std::shared_ptr<Mapping const> open(std::string const &filePath);
+        // levels.at(i) holds the blocks of mip level i (level 0 at width x height, each following level halved down to 1x1)
+        // isBottomUp is recorded as the KTXorientation of the file (see Mapping::isBottomUp)
+        static bool write(std::string const &filePath, Format const format, std::uint32_t const width, std::uint32_t const height, std::vector<std::vector<unsigned char>> const &levels, bool const isBottomUp);
+    };
+}
+
+#endif // WAVE_TOOL_KTX2_H_
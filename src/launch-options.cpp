@@ -0,0 +1,183 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "launch-options.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace wave_tool
+{
+    namespace
+    {
+        // reads the value following the option at argv[i] (advancing i), returns nullptr if it's missing
+        char const *nextValue(int argc, char *argv[], int &i)
+        {
+            if (i + 1 >= argc)
+            {
+                std::cout << "ERROR: missing value for option " << argv[i] << std::endl;
+                return nullptr;
+            }
+            return argv[++i];
+        }
+
+        bool parseFloat(char const *str, float &result)
+        {
+            if (nullptr == str)
+                return false;
+            char *end{nullptr};
+            result = std::strtof(str, &end);
+            return end != str && '\0' == *end;
+        }
+
+        bool parseUnsignedInt(char const *str, unsigned int &result)
+        {
+            if (nullptr == str || '-' == str[0])
+                return false;
+            char *end{nullptr};
+            unsigned long const value{std::strtoul(str, &end, 10)};
+            result = (unsigned int)value;
+            return end != str && '\0' == *end;
+        }
+
+        // expects "<width>x<height>" (e.g. 1920x1080)
+        bool parseResolution(char const *str, int &width, int &height)
+        {
+            if (nullptr == str)
+                return false;
+            char *end{nullptr};
+            long const w{std::strtol(str, &end, 10)};
+            if (end == str || ('x' != *end && 'X' != *end))
+                return false;
+            char const *heightStr{end + 1};
+            long const h{std::strtol(heightStr, &end, 10)};
+            if (end == heightStr || '\0' != *end || w <= 0 || h <= 0)
+                return false;
+            width = (int)w;
+            height = (int)h;
+            return true;
+        }
+    }
+
+    bool parseLaunchOptions(int argc, char *argv[], LaunchOptions &options)
+    {
+        // NOTE: argv[0] is skipped since it's the executable name
+        for (int i = 1; i < argc; ++i)
+        {
+            char const *arg{argv[i]};
+            bool isValid{true};
+
+            if (0 == std::strcmp(arg, "--help") || 0 == std::strcmp(arg, "-h"))
+            {
+                options.isHelpRequested = true;
+            }
+            else if (0 == std::strcmp(arg, "--headless"))
+            {
+                options.isHeadless = true;
+            }
+            else if (0 == std::strcmp(arg, "--frames"))
+            {
+                isValid = parseUnsignedInt(nextValue(argc, argv, i), options.frameCount) && options.frameCount > 0;
+            }
+            else if (0 == std::strcmp(arg, "--resolution"))
+            {
+                isValid = parseResolution(nextValue(argc, argv, i), options.width, options.height);
+            }
+            else if (0 == std::strcmp(arg, "--fps"))
+            {
+                isValid = parseFloat(nextValue(argc, argv, i), options.framesPerSecond) && options.framesPerSecond > 0.0f;
+            }
+            else if (0 == std::strcmp(arg, "--time"))
+            {
+                isValid = parseFloat(nextValue(argc, argv, i), options.waveAnimationTimeInSeconds) && options.waveAnimationTimeInSeconds >= 0.0f;
+            }
+            else if (0 == std::strcmp(arg, "--time-of-day"))
+            {
+                isValid = parseFloat(nextValue(argc, argv, i), options.timeOfDayInHours) && options.timeOfDayInHours >= 0.0f && options.timeOfDayInHours <= 24.0f;
+            }
+            else if (0 == std::strcmp(arg, "--water-geometry"))
+            {
+                char const *value{nextValue(argc, argv, i)};
+                isValid = nullptr != value && (0 == std::strcmp(value, "projected") || 0 == std::strcmp(value, "clipmap"));
+                if (isValid)
+                    options.waterGeometry = value;
+            }
+            else if (0 == std::strcmp(arg, "--out"))
+            {
+                char const *value{nextValue(argc, argv, i)};
+                isValid = nullptr != value && '\0' != value[0];
+                if (isValid)
+                    options.outputPrefix = value;
+            }
+            else if (0 == std::strcmp(arg, "--profile"))
+            {
+                char const *value{nextValue(argc, argv, i)};
+                isValid = nullptr != value && '\0' != value[0];
+                if (isValid)
+                    options.profileOutputPath = value;
+            }
+            else
+            {
+                std::cout << "ERROR: unknown option " << arg << std::endl;
+                printUsage(argv[0]);
+                return false;
+            }
+
+            if (!isValid)
+            {
+                std::cout << "ERROR: invalid value for option " << arg << std::endl;
+                printUsage(argv[0]);
+                return false;
+            }
+        }
+
+        if (options.isHelpRequested)
+            printUsage(argv[0]);
+
+        return true;
+    }
+
+    void printUsage(char const *executableName)
+    {
+        std::cout << "usage: " << (nullptr != executableName ? executableName : "wave-tool") << " [options]" << std::endl;
+        std::cout << "  --help, -h              print this message" << std::endl;
+        std::cout << "  --headless              render offscreen (EGL, no window/UI) and write the frames to disk" << std::endl;
+        std::cout << "  --frames <count>        number of frames to render in headless mode (default 1)" << std::endl;
+        std::cout << "  --resolution <W>x<H>    framebuffer resolution (default 1024x1024)" << std::endl;
+        std::cout << "  --fps <rate>            fixed animation rate of headless frames (default 60)" << std::endl;
+        std::cout << "  --time <seconds>        wave-animation time of the first frame (default 0)" << std::endl;
+        std::cout << "  --time-of-day <hours>   time of day in range [0, 24]" << std::endl;
+        std::cout << "  --water-geometry <mode> projected (default) or clipmap" << std::endl;
+        std::cout << "  --out <prefix>          frames are written as <prefix>-<index>.png (default \"frame\")" << std::endl;
+        std::cout << "  --profile <file.csv>    write the per-pass GPU/CPU timings of the headless run to a CSV file" << std::endl;
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef WAVE_TOOL_LAUNCH_OPTIONS_H_
+#define WAVE_TOOL_LAUNCH_OPTIONS_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <string>
+
+namespace wave_tool
+{
+    // options parsed from the command-line (everything defaults to the regular interactive windowed mode)
+    struct LaunchOptions
+    {
+        bool isHelpRequested{false};
+        bool isHeadless{false};                 // render offscreen (no window, no UI) and write frames to disk
+        unsigned int frameCount{1};             // in range [1, inf) - number of frames rendered in headless mode
+        int width{1024};                        // in range [1, inf)
+        int height{1024};                       // in range [1, inf)
+        float framesPerSecond{60.0f};           // in range (0.0, inf) - the fixed timestep between headless frames is 1 / framesPerSecond
+        float waveAnimationTimeInSeconds{0.0f}; // in range [0.0, inf) - wave-animation time of the first frame
+        float timeOfDayInHours{-1.0f};          // in range [0.0, 24.0] - symbolic negative value keeps the render engine default
+        std::string waterGeometry;              // "projected" or "clipmap" - empty keeps the render engine default
+        std::string outputPrefix{"frame"};      // frames are written as <outputPrefix>-<frameIndex>.png (the directory must already exist)
+        std::string profileOutputPath;          // if non-empty, the profiler samples of the headless run are written to this CSV file
+    };
+
+    // returns false if the args are invalid (the usage is printed if either the args are invalid or help was requested)
+    bool parseLaunchOptions(int argc, char *argv[], LaunchOptions &options);
+    void printUsage(char const *executableName);
+}
+
+#endif // WAVE_TOOL_LAUNCH_OPTIONS_H_
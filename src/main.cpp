@@ -37,6 +37,7 @@
 #include <string>
 #include <vector>
 
+#include "launch-options.h"
 #include "program.h"
 
 // NOTE: apparently this is the proper way to forward declare namespaced-functions (you can't do "int wave_tool::program(int argc, char *argv[]);")
@@ -59,9 +60,14 @@ namespace wave_tool
     int program(int argc, char *argv[])
     {
         // handle cmd-line args/options...
+        LaunchOptions launchOptions;
+        if (!parseLaunchOptions(argc, argv, launchOptions))
+            return EXIT_FAILURE;
+        if (launchOptions.isHelpRequested)
+            return EXIT_SUCCESS;
 
         // execute the rest of your program...
-        Program program;
+        Program program{launchOptions};
         bool const programResult = program.start();
 
         return programResult ? EXIT_SUCCESS : EXIT_FAILURE;
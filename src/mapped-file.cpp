@@ -0,0 +1,92 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "mapped-file.h"
+
+#ifdef WAVE_TOOL_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace wave_tool
+{
+    MappedFile::MappedFile(std::string const &filePath, bool const isSequential)
+    {
+#ifdef WAVE_TOOL_HAS_MMAP
+        int const fd{open(filePath.c_str(), O_RDONLY)};
+        if (-1 == fd)
+            return;
+
+        struct stat fileStat;
+        if (0 == fstat(fd, &fileStat))
+        {
+            if (0 == fileStat.st_size)
+            {
+                m_isOpen = true; // empty files can't be mapped, but they are still open
+            }
+            else
+            {
+                void *const mapping{mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+                if (MAP_FAILED != mapping)
+                {
+                    m_mapping = mapping;
+                    m_size = fileStat.st_size;
+                    m_isOpen = true;
+                    if (isSequential)
+                        madvise(mapping, m_size, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        close(fd); // the mapping keeps the file referenced
+#else
+        (void)isSequential;
+        std::ifstream fileStream(filePath, std::ios::binary);
+        if (!fileStream)
+            return;
+        m_buffer.assign(std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>());
+        m_size = m_buffer.size();
+        m_isOpen = true;
+#endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+#ifdef WAVE_TOOL_HAS_MMAP
+        if (nullptr != m_mapping)
+            munmap(m_mapping, m_size);
+#endif
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef WAVE_TOOL_MAPPED_FILE_H_
+#define WAVE_TOOL_MAPPED_FILE_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WAVE_TOOL_HAS_MMAP
+#endif
+
+namespace wave_tool
+{
+    // read-only view of a whole file (memory-mapped where available, otherwise read into memory)
+    class MappedFile
+    {
+    public:
+        // isSequential hints that the file will be read front to back once
+        explicit MappedFile(std::string const &filePath, bool const isSequential = false);
+        ~MappedFile();
+
+        MappedFile(MappedFile const &) = delete;
+        MappedFile &operator=(MappedFile const &) = delete;
+
+        inline bool isOpen() const { return m_isOpen; }
+        inline std::size_t size() const { return m_size; }
+#ifdef WAVE_TOOL_HAS_MMAP
+        inline char const *data() const { return static_cast<char const *>(m_mapping); }
+#else
+        inline char const *data() const { return m_buffer.data(); }
+#endif
+
+    private:
+#ifdef WAVE_TOOL_HAS_MMAP
+        void *m_mapping{nullptr};
+#else
+        std::vector<char> m_buffer;
+#endif
+        std::size_t m_size{0};
+        bool m_isOpen{false};
+    };
+}
+
+#endif // WAVE_TOOL_MAPPED_FILE_H_
@@ -0,0 +1,234 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "mesh-cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "mesh-object.h"
+#include "vertex-layout.h"
+
+namespace wave_tool
+{
+    namespace
+    {
+        std::array<char, 8> const MAGIC{'W', 'T', 'M', 'E', 'S', 'H', '\0', '\0'};
+        std::uint32_t const BYTE_ORDER_MARK{0x01020304};
+        std::size_t const STREAM_ALIGNMENT{16};
+
+        inline std::uint64_t alignUp(std::uint64_t const offset)
+        {
+            return (offset + STREAM_ALIGNMENT - 1) & ~std::uint64_t(STREAM_ALIGNMENT - 1);
+        }
+    }
+
+    void const *MeshCache::Mapping::getStreamData(Stream const stream) const
+    {
+        return hasStream(stream) ? m_file.data() + m_header->streamOffsets.at(stream) : nullptr;
+    }
+
+    std::size_t MeshCache::Mapping::getStreamSize(Stream const stream) const
+    {
+        if (!hasStream(stream))
+            return 0;
+        if (PACKED_VERTICES == stream)
+            return std::size_t(m_header->packedVertexSize) * m_header->vertexCount;
+        return getStreamElementSize(stream) * (INDICES == stream ? m_header->indexCount : m_header->vertexCount);
+    }
+
+    geometry::AABB MeshCache::Mapping::getLocalBounds() const
+    {
+        geometry::AABB bounds;
+        bounds.min = glm::vec3{m_header->boundsMin.at(0), m_header->boundsMin.at(1), m_header->boundsMin.at(2)};
+        bounds.max = glm::vec3{m_header->boundsMax.at(0), m_header->boundsMax.at(1), m_header->boundsMax.at(2)};
+        return bounds;
+    }
+
+    geometry::BoundingSphere MeshCache::Mapping::getLocalBoundingSphere() const
+    {
+        return geometry::BoundingSphere{glm::vec3{m_header->boundingSphere.at(0), m_header->boundingSphere.at(1), m_header->boundingSphere.at(2)}, m_header->boundingSphere.at(3)};
+    }
+
+    std::string MeshCache::getCachePath(std::string const &sourcePath)
+    {
+        std::size_t const dotIndex{sourcePath.find_last_of('.')};
+        std::size_t const slashIndex{sourcePath.find_last_of("/\\")};
+        // only strip a dot that belongs to the file name (not to a directory)
+        if (std::string::npos == dotIndex || (std::string::npos != slashIndex && dotIndex < slashIndex))
+            return sourcePath + ".wtmesh";
+        return sourcePath.substr(0, dotIndex) + ".wtmesh";
+    }
+
+    std::shared_ptr<MeshCache::Mapping const> MeshCache::open(std::string const &cachePath, std::uint64_t const sourceHash, std::uint32_t const loaderFlags)
+    {
+        std::shared_ptr<Mapping> mapping{new Mapping(cachePath)};
+        MappedFile const &file{mapping->m_file};
+        if (!file.isOpen() || file.size() < sizeof(Header))
+            return nullptr;
+
+        // NOTE: mappings are page-aligned, so the header (and every 16-byte aligned stream) is suitably aligned
+        Header const *const header{reinterpret_cast<Header const *>(file.data())};
+        if (MAGIC != header->magic || BYTE_ORDER_MARK != header->byteOrderMark || VERSION != header->version)
+            return nullptr;
+        if (sourceHash != header->sourceHash || loaderFlags != header->loaderFlags)
+            return nullptr; // stale
+        mapping->m_header = header;
+
+        // every stream must lie within the file (positions, indices and packed vertices are mandatory)
+        if (!mapping->hasStream(POSITIONS) || !mapping->hasStream(INDICES) || !mapping->hasStream(PACKED_VERTICES) || 0 == header->vertexCount || 0 == header->indexCount)
+            return nullptr;
+        if (VertexLayout::packed(mapping->hasStream(NORMALS), mapping->hasStream(UVS), mapping->hasStream(COLOURS)).getVertexSize() != (GLsizei)header->packedVertexSize)
+            return nullptr; // written with another packed layout
+        for (int stream = 0; stream < STREAM_COUNT; ++stream)
+        {
+            std::uint64_t const offset{header->streamOffsets.at(stream)};
+            if (0 == offset)
+                continue;
+            if (offset < sizeof(Header) || 0 != offset % STREAM_ALIGNMENT || file.size() < offset || file.size() - offset < mapping->getStreamSize(Stream(stream)))
+                return nullptr;
+        }
+
+        // every index must name a vertex (checked once here, so a corrupt file is re-parsed instead of making the GPU fetch out of bounds)
+        GLuint const *const indices{static_cast<GLuint const *>(mapping->getStreamData(INDICES))};
+        if (std::any_of(indices, indices + header->indexCount, [vertexCount = header->vertexCount](GLuint const index) { return index >= vertexCount; }))
+            return nullptr;
+
+        return mapping;
+    }
+
+    bool MeshCache::write(std::string const &cachePath, MeshObject const &object, std::uint64_t const sourceHash, std::uint32_t const loaderFlags)
+    {
+        std::array<std::size_t, STREAM_COUNT> const streamCounts{object.drawVerts.size(), object.normals.size(), object.uvs.size(), object.colours.size(), object.drawFaces.size(), object.drawVerts.size()};
+
+        // every vertex stream must match the positions (or be absent)
+        for (int stream = NORMALS; stream < INDICES; ++stream)
+        {
+            if (0 != streamCounts.at(stream) && streamCounts.at(POSITIONS) != streamCounts.at(stream))
+                return false;
+        }
+        if (0 == streamCounts.at(POSITIONS) || 0 == streamCounts.at(INDICES))
+            return false;
+
+        // NOTE: packed here once, so loading a PACKED_INTERLEAVED mesh never has to repack it
+        VertexLayout const packedLayout{VertexLayout::packed(0 != streamCounts.at(NORMALS), 0 != streamCounts.at(UVS), 0 != streamCounts.at(COLOURS))};
+        std::vector<std::uint8_t> packedVertices;
+        packedLayout.pack(streamCounts.at(POSITIONS), object.drawVerts.data(), object.normals.data(), object.uvs.data(), object.colours.data(), packedVertices);
+
+        std::array<void const *, STREAM_COUNT> const streamData{object.drawVerts.data(), object.normals.data(), object.uvs.data(), object.colours.data(), object.drawFaces.data(), packedVertices.data()};
+        std::array<std::size_t, STREAM_COUNT> streamSizes;
+        for (int stream = 0; stream < STREAM_COUNT; ++stream)
+            streamSizes.at(stream) = PACKED_VERTICES == stream ? packedVertices.size() : getStreamElementSize(Stream(stream)) * streamCounts.at(stream);
+
+        Header header{};
+        header.magic = MAGIC;
+        header.byteOrderMark = BYTE_ORDER_MARK;
+        header.version = VERSION;
+        header.sourceHash = sourceHash;
+        header.loaderFlags = loaderFlags;
+        header.vertexCount = streamCounts.at(POSITIONS);
+        header.indexCount = streamCounts.at(INDICES);
+        header.packedVertexSize = packedLayout.getVertexSize();
+        geometry::AABB const &bounds{object.getLocalBounds()};
+        geometry::BoundingSphere const &sphere{object.getLocalBoundingSphere()};
+        header.boundsMin = {bounds.min.x, bounds.min.y, bounds.min.z};
+        header.boundsMax = {bounds.max.x, bounds.max.y, bounds.max.z};
+        header.boundingSphere = {sphere.center.x, sphere.center.y, sphere.center.z, sphere.radius};
+
+        std::uint64_t offset{alignUp(sizeof(Header))};
+        for (int stream = 0; stream < STREAM_COUNT; ++stream)
+        {
+            if (0 == streamCounts.at(stream))
+                continue;
+            header.streamOffsets.at(stream) = offset;
+            offset = alignUp(offset + streamSizes.at(stream));
+        }
+
+        // NOTE: unique per thread, since the same mesh may be loaded (and cached) by several threads at once
+        std::string const temporaryPath{cachePath + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()))};
+        {
+            std::ofstream fileStream(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!fileStream)
+                return false;
+
+            std::array<char, STREAM_ALIGNMENT> const padding{};
+            fileStream.write(reinterpret_cast<char const *>(&header), sizeof(Header));
+            std::uint64_t written{sizeof(Header)};
+            for (int stream = 0; stream < STREAM_COUNT; ++stream)
+            {
+                if (0 == header.streamOffsets.at(stream))
+                    continue;
+                fileStream.write(padding.data(), header.streamOffsets.at(stream) - written);
+                fileStream.write(static_cast<char const *>(streamData.at(stream)), streamSizes.at(stream));
+                written = header.streamOffsets.at(stream) + streamSizes.at(stream);
+            }
+
+            if (!fileStream)
+            {
+                fileStream.close();
+                std::remove(temporaryPath.c_str());
+                return false;
+            }
+        }
+
+        // NOTE: rename won't replace an existing file on every platform
+        std::remove(cachePath.c_str());
+        if (0 != std::rename(temporaryPath.c_str(), cachePath.c_str()))
+        {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    std::size_t MeshCache::getStreamElementSize(Stream const stream)
+    {
+        switch (stream)
+        {
+        case POSITIONS:
+        case NORMALS:
+        case COLOURS:
+            return sizeof(glm::vec3);
+        case UVS:
+            return sizeof(glm::vec2);
+        case INDICES:
+            return sizeof(GLuint);
+        case PACKED_VERTICES:
+            return 0; // depends on which streams are present (see Header::packedVertexSize)
+        default:
+            return 0;
+        }
+    }
+}
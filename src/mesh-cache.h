@@ -0,0 +1,126 @@
+#ifndef WAVE_TOOL_MESH_CACHE_H_
+#define WAVE_TOOL_MESH_CACHE_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "bounding-volumes.h"
+#include "mapped-file.h"
+
+namespace wave_tool
+{
+    class MeshObject;
+
+    // versioned binary cache (.wtmesh) of a tri-mesh that has already been loaded and deduplicated, stored next to its source file
+    // layout: Header, then each present stream at a 16-byte aligned offset (positions, normals, uvs and colours as tightly packed floats, then GLuint indices, then the same vertices interleaved as VertexLayout::packed)
+    // NOTE: the file is written in native byte order (the header's byte order mark rejects a file written on a machine that differs)
+    class MeshCache
+    {
+    public:
+        // 2: the streams are stored after MeshOptimizer::optimize
+        // 3: adds the PACKED_VERTICES stream, so a PACKED_INTERLEAVED mesh uploads straight from the mapping too
+        static std::uint32_t const VERSION{3};
+
+        // the loader options that change the cached contents, so a cache written with different options is never reused
+        enum LoaderFlags : std::uint32_t
+        {
+            IGNORE_UVS = 1 << 0,
+            IGNORE_NORMALS = 1 << 1
+        };
+
+        enum Stream
+        {
+            POSITIONS = 0,
+            NORMALS,
+            UVS,
+            COLOURS,
+            INDICES,
+            PACKED_VERTICES, // every vertex stream interleaved by VertexLayout::packed (always present)
+            STREAM_COUNT
+        };
+
+        struct Header
+        {
+            std::array<char, 8> magic;
+            std::uint32_t byteOrderMark;
+            std::uint32_t version;
+            std::uint64_t sourceHash; // hashContents of the source file
+            std::uint32_t loaderFlags;
+            std::uint32_t vertexCount;
+            std::uint32_t indexCount;
+            std::uint32_t packedVertexSize; // stride of PACKED_VERTICES in bytes
+            std::array<float, 3> boundsMin;
+            std::array<float, 3> boundsMax;
+            std::array<float, 4> boundingSphere; // (center, radius)
+            std::array<std::uint64_t, STREAM_COUNT> streamOffsets; // in bytes from the start of the file, 0 if the stream is absent
+        };
+
+        // a validated cache file kept mapped in memory, whose streams can be handed straight to glBufferData
+        class Mapping
+        {
+        public:
+            inline std::uint32_t getVertexCount() const { return m_header->vertexCount; }
+            inline std::uint32_t getIndexCount() const { return m_header->indexCount; }
+            inline bool hasStream(Stream const stream) const { return 0 != m_header->streamOffsets.at(stream); }
+            // nullptr if the stream is absent
+            void const *getStreamData(Stream const stream) const;
+            std::size_t getStreamSize(Stream const stream) const;
+
+            geometry::AABB getLocalBounds() const;
+            geometry::BoundingSphere getLocalBoundingSphere() const;
+
+        private:
+            friend class MeshCache;
+
+            explicit Mapping(std::string const &cachePath) : m_file(cachePath) {}
+
+            MappedFile m_file;
+            Header const *m_header{nullptr};
+        };
+
+        // e.g. "models/cube.obj" -> "models/cube.wtmesh"
+        static std::string getCachePath(std::string const &sourcePath);
+        // nullptr if the cache is missing, corrupt (including any index >= the vertex count), from another version, or was made from a different source or with different loader flags
+        static std::shared_ptr<Mapping const> open(std::string const &cachePath, std::uint64_t const sourceHash, std::uint32_t const loaderFlags);
+        // writes the CPU-side data of object (verts, normals, uvs, colours and faces) - written to a temporary file first, so a reader never sees a partial cache
+        static bool write(std::string const &cachePath, MeshObject const &object, std::uint64_t const sourceHash, std::uint32_t const loaderFlags);
+
+        static std::size_t getStreamElementSize(Stream const stream);
+    };
+}
+
+#endif // WAVE_TOOL_MESH_CACHE_H_
@@ -33,7 +33,111 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include "thread-pool.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define WAVE_TOOL_MESH_OBJECT_SSE
+#endif
+
 namespace wave_tool {
+    namespace {
+        // below these, a chunk isn't worth a task
+        std::size_t const MIN_FACES_PER_TASK = 4096;
+        std::size_t const MIN_VERTICES_PER_TASK = 4096;
+
+        void forEachChunk(std::shared_ptr<ThreadPool> const& threadPool, std::size_t const count, std::size_t const minChunkSize, std::function<void(std::size_t, std::size_t)> const& func) {
+            if (nullptr != threadPool && count > minChunkSize) threadPool->parallelFor(count, func, minChunkSize);
+            else if (count > 0) func(0, count);
+        }
+
+        // the 3 corner positions of face f (all 0 vectors if one of its indices is out of range, which yields the 0 normal below)
+        inline void getFaceCorners(glm::vec3 const* verts, std::size_t const vertexCount, GLuint const* faces, std::size_t const f, glm::vec3 &out_p1, glm::vec3 &out_p2, glm::vec3 &out_p3) {
+            GLuint const p1_index = faces[3 * f];
+            GLuint const p2_index = faces[3 * f + 1];
+            GLuint const p3_index = faces[3 * f + 2];
+            if (p1_index >= vertexCount || p2_index >= vertexCount || p3_index >= vertexCount) {
+                out_p1 = out_p2 = out_p3 = glm::vec3(0.0f, 0.0f, 0.0f);
+                return;
+            }
+            out_p1 = verts[p1_index];
+            out_p2 = verts[p2_index];
+            out_p3 = verts[p3_index];
+        }
+
+        // outward face-normal (assuming CCW winding)
+        // SAFETY CHECK (e.g. if sideA or sideB were 0 vector OR if we tried to normalize the 0 vector)...
+        // on error, this face has no contribution (flagged symbolically as the 0 vector)
+        inline glm::vec3 computeFaceNormal(glm::vec3 const& p1, glm::vec3 const& p2, glm::vec3 const& p3) {
+            glm::vec3 const sideA = p2 - p1;
+            glm::vec3 const sideB = p3 - p2;
+            glm::vec3 const cross = glm::cross(sideA, sideB);
+            glm::vec3 const normal = cross / glm::length(cross);
+            return glm::any(glm::isnan(normal)) ? glm::vec3(0.0f, 0.0f, 0.0f) : normal;
+        }
+
+        // writes the normals of faces [begin, end) - or of faceList[begin, end) if given - into out_faceNormals
+        //NOTE: 4 faces per iteration with SSE (the faces are the SIMD lanes, gathered into SoA registers)
+        void computeFaceNormals(glm::vec3 const* verts, std::size_t const vertexCount, GLuint const* faces, GLuint const* faceList, std::size_t const begin, std::size_t const end, glm::vec3 *out_faceNormals) {
+            std::size_t i = begin;
+#ifdef WAVE_TOOL_MESH_OBJECT_SSE
+            for (; i + 4 <= end; i += 4) {
+                std::size_t f[4];
+                glm::vec3 p1[4], p2[4], p3[4];
+                for (unsigned int lane = 0; lane < 4; ++lane) {
+                    f[lane] = nullptr != faceList ? faceList[i + lane] : i + lane;
+                    getFaceCorners(verts, vertexCount, faces, f[lane], p1[lane], p2[lane], p3[lane]);
+                }
+
+                __m128 const p1x = _mm_setr_ps(p1[0].x, p1[1].x, p1[2].x, p1[3].x);
+                __m128 const p1y = _mm_setr_ps(p1[0].y, p1[1].y, p1[2].y, p1[3].y);
+                __m128 const p1z = _mm_setr_ps(p1[0].z, p1[1].z, p1[2].z, p1[3].z);
+                __m128 const p2x = _mm_setr_ps(p2[0].x, p2[1].x, p2[2].x, p2[3].x);
+                __m128 const p2y = _mm_setr_ps(p2[0].y, p2[1].y, p2[2].y, p2[3].y);
+                __m128 const p2z = _mm_setr_ps(p2[0].z, p2[1].z, p2[2].z, p2[3].z);
+                __m128 const p3x = _mm_setr_ps(p3[0].x, p3[1].x, p3[2].x, p3[3].x);
+                __m128 const p3y = _mm_setr_ps(p3[0].y, p3[1].y, p3[2].y, p3[3].y);
+                __m128 const p3z = _mm_setr_ps(p3[0].z, p3[1].z, p3[2].z, p3[3].z);
+
+                // sideA = p2 - p1, sideB = p3 - p2
+                __m128 const ax = _mm_sub_ps(p2x, p1x);
+                __m128 const ay = _mm_sub_ps(p2y, p1y);
+                __m128 const az = _mm_sub_ps(p2z, p1z);
+                __m128 const bx = _mm_sub_ps(p3x, p2x);
+                __m128 const by = _mm_sub_ps(p3y, p2y);
+                __m128 const bz = _mm_sub_ps(p3z, p2z);
+
+                // cross(sideA, sideB)
+                __m128 const cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+                __m128 const cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+                __m128 const cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+
+                // normalize (a real division rather than _mm_rsqrt_ps, so the result matches the scalar path)
+                __m128 const length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)), _mm_mul_ps(cz, cz)));
+                __m128 const nx = _mm_div_ps(cx, length);
+                __m128 const ny = _mm_div_ps(cy, length);
+                __m128 const nz = _mm_div_ps(cz, length);
+
+                // a lane with any NaN component (e.g. 0 / 0) becomes the 0 vector
+                __m128 const isValid = _mm_and_ps(_mm_cmpord_ps(nx, nx), _mm_and_ps(_mm_cmpord_ps(ny, ny), _mm_cmpord_ps(nz, nz)));
+                alignas(16) float x[4], y[4], z[4];
+                _mm_store_ps(x, _mm_and_ps(nx, isValid));
+                _mm_store_ps(y, _mm_and_ps(ny, isValid));
+                _mm_store_ps(z, _mm_and_ps(nz, isValid));
+
+                for (unsigned int lane = 0; lane < 4; ++lane) out_faceNormals[f[lane]] = glm::vec3(x[lane], y[lane], z[lane]);
+            }
+#endif
+            // the remainder (or everything, without SSE)
+            for (; i < end; ++i) {
+                std::size_t const f = nullptr != faceList ? faceList[i] : i;
+                glm::vec3 p1, p2, p3;
+                getFaceCorners(verts, vertexCount, faces, f, p1, p2, p3);
+                out_faceNormals[f] = computeFaceNormal(p1, p2, p3);
+            }
+        }
+    }
+
     MeshObject::MeshObject() :
         vao(0), vertexBuffer(0),
         normalBuffer(0), uvBuffer(0), colourBuffer(0),
@@ -68,54 +172,104 @@ namespace wave_tool {
         m_model = tMat * rMat * sMat; // S then R then T
     }
 
+    void MeshObject::computeBounds() {
+        m_localBounds = geometry::AABB::fromPoints(drawVerts);
+        m_localBoundingSphere = geometry::BoundingSphere::fromPoints(drawVerts);
+    }
+
     //NOTE: this assumes counter-clockwise winding of triangular faces
     //NOTE: this method does not overwrite the normal buffer, it just overwrites the normal vector data
-    void MeshObject::generateNormals() {
+    void MeshObject::generateNormals(std::shared_ptr<ThreadPool> const& threadPool) {
         if (PrimitiveMode::TRIANGLES != m_primitiveMode) return;
 
-        // clear any old normal data...
-        normals.clear();
-        faceNormals.clear();
+        buildVertexFaceAdjacency();
 
-        // init (per-vertex normals) / (per-face normals)...
-        normals.resize(drawVerts.size(), glm::vec3(0.0f, 0.0f, 0.0f));
-        faceNormals.resize(drawFaces.size() / 3, glm::vec3(0.0f, 0.0f, 0.0f));
+        // resized rather than cleared, so a mesh re-normalled every tick keeps its allocations
+        normals.resize(drawVerts.size());
+        faceNormals.resize(drawFaces.size() / 3);
 
         // foreach triangle face in mesh...
-        for (unsigned int f = 0; f < drawFaces.size(); f += 3) {
-            // save the 3 vert indices making up face f...
-            unsigned int const p1_index = drawFaces.at(f);
-            unsigned int const p2_index = drawFaces.at(f + 1);
-            unsigned int const p3_index = drawFaces.at(f + 2);
-
-            // get the 3 vert positions...
-            glm::vec3 const p1 = drawVerts.at(p1_index);
-            glm::vec3 const p2 = drawVerts.at(p2_index);
-            glm::vec3 const p3 = drawVerts.at(p3_index);
-
-            // compute the outward face-normal (assuming CCW winding)...
-            glm::vec3 const sideA = p2 - p1;
-            glm::vec3 const sideB = p3 - p2;
-            glm::vec3 const normal = glm::normalize(glm::cross(sideA, sideB));
-            // SAFETY CHECK (e.g. if sideA or sideB were 0 vector OR if we tried to normalize the 0 vector)...
-            // on error, this face has no contribution (could flag this face normal symbolically as the 0 vector)
-            if (glm::any(glm::isnan(normal))) continue;
+        forEachChunk(threadPool, faceNormals.size(), MIN_FACES_PER_TASK, [this](std::size_t const begin, std::size_t const end) {
+            computeFaceNormals(drawVerts.data(), drawVerts.size(), drawFaces.data(), nullptr, begin, end, faceNormals.data());
+        });
+
+        // foreach vertex in mesh...
+        forEachChunk(threadPool, normals.size(), MIN_VERTICES_PER_TASK, [this](std::size_t const begin, std::size_t const end) {
+            for (std::size_t v = begin; v < end; ++v) normals[v] = averageFaceNormals(v);
+        });
+    }
+
+    void MeshObject::updateNormals(std::size_t const firstVertex, std::size_t const vertexCount, std::shared_ptr<ThreadPool> const& threadPool) {
+        if (PrimitiveMode::TRIANGLES != m_primitiveMode) return;
+
+        if (!isVertexFaceAdjacencyValid()) {
+            generateNormals(threadPool);
+            return;
+        }
+
+        std::size_t const lastVertex = std::min(firstVertex + vertexCount, drawVerts.size());
+        if (firstVertex >= lastVertex) return;
 
-            faceNormals.at(f / 3) = normal;
+        // the faces touching the moved vertices...
+        std::vector<GLuint> dirtyFaces(m_vertexFaces.begin() + m_vertexFaceOffsets[firstVertex], m_vertexFaces.begin() + m_vertexFaceOffsets[lastVertex]);
+        std::sort(dirtyFaces.begin(), dirtyFaces.end());
+        dirtyFaces.erase(std::unique(dirtyFaces.begin(), dirtyFaces.end()), dirtyFaces.end());
 
-            //TODO: in the future, it would be better to weight this contribution by the face angle, but for now just doing the trivial average technique
-            normals.at(p1_index) += normal;
-            normals.at(p2_index) += normal;
-            normals.at(p3_index) += normal;
+        forEachChunk(threadPool, dirtyFaces.size(), MIN_FACES_PER_TASK, [this, &dirtyFaces](std::size_t const begin, std::size_t const end) {
+            computeFaceNormals(drawVerts.data(), drawVerts.size(), drawFaces.data(), dirtyFaces.data(), begin, end, faceNormals.data());
+        });
+
+        // ...and every vertex of those faces (a vertex outside the range can share a face with one inside it)
+        std::vector<GLuint> dirtyVertices;
+        dirtyVertices.reserve(dirtyFaces.size() * 3);
+        for (GLuint const f : dirtyFaces) {
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                //NOTE: a face with an out of range corner is still adjacent to its other corners, but the bad index has no normal to write
+                GLuint const v = drawFaces[3 * f + corner];
+                if (v < drawVerts.size()) dirtyVertices.push_back(v);
+            }
+        }
+        std::sort(dirtyVertices.begin(), dirtyVertices.end());
+        dirtyVertices.erase(std::unique(dirtyVertices.begin(), dirtyVertices.end()), dirtyVertices.end());
+
+        forEachChunk(threadPool, dirtyVertices.size(), MIN_VERTICES_PER_TASK, [this, &dirtyVertices](std::size_t const begin, std::size_t const end) {
+            for (std::size_t i = begin; i < end; ++i) normals[dirtyVertices[i]] = averageFaceNormals(dirtyVertices[i]);
+        });
+    }
+
+    //TODO: in the future, it would be better to weight each contribution by the face angle, but for now just doing the trivial average technique
+    glm::vec3 MeshObject::averageFaceNormals(std::size_t const v) const {
+        // summed in adjacency (i.e. face) order, so the result doesn't depend on how the work was split
+        glm::vec3 sum(0.0f, 0.0f, 0.0f);
+        for (GLuint i = m_vertexFaceOffsets[v]; i < m_vertexFaceOffsets[v + 1]; ++i) sum += faceNormals[m_vertexFaces[i]];
+
+        glm::vec3 const n = glm::normalize(sum);
+        // SAFETY CHECK (e.g. if n was somehow -nan or 0 vector...)
+        // set this normal symbolically as 0 vector
+        return glm::any(glm::isnan(n)) ? glm::vec3(0.0f, 0.0f, 0.0f) : n;
+    }
+
+    // counting sort of the face corners by vertex
+    //NOTE: a face using the same vertex twice is listed twice for it (same as the old per-corner accumulation)
+    void MeshObject::buildVertexFaceAdjacency() {
+        std::size_t const faceCount = drawFaces.size() / 3;
+
+        m_vertexFaceOffsets.assign(drawVerts.size() + 1, 0);
+        for (std::size_t i = 0; i < faceCount * 3; ++i) {
+            //NOTE: an out of range index has no vertex to contribute to
+            if (drawFaces[i] < drawVerts.size()) ++m_vertexFaceOffsets[drawFaces[i] + 1];
         }
+        for (std::size_t v = 0; v < drawVerts.size(); ++v) m_vertexFaceOffsets[v + 1] += m_vertexFaceOffsets[v];
 
-        // normalize the accumulated normals...
-        for (glm::vec3 &n : normals) {
-            n = glm::normalize(n);
-            // SAFETY CHECK (e.g. if n was somehow -nan or 0 vector...)
-            // set this normal symbolically as 0 vector
-            if (glm::any(glm::isnan(n))) n = glm::vec3(0.0f, 0.0f, 0.0f);
+        m_vertexFaces.resize(m_vertexFaceOffsets.back());
+        std::vector<GLuint> cursors(m_vertexFaceOffsets.begin(), m_vertexFaceOffsets.end() - 1);
+        for (std::size_t i = 0; i < faceCount * 3; ++i) {
+            if (drawFaces[i] < drawVerts.size()) m_vertexFaces[cursors[drawFaces[i]]++] = (GLuint)(i / 3);
         }
+    }
 
+    //NOTE: only catches changes in size - a reshuffle of drawFaces must go through generateNormals
+    bool MeshObject::isVertexFaceAdjacencyValid() const {
+        return m_vertexFaceOffsets.size() == drawVerts.size() + 1 && faceNormals.size() == drawFaces.size() / 3 && normals.size() == drawVerts.size();
     }
 }
@@ -36,11 +36,19 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <cstddef>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
 
+#include "bounding-volumes.h"
+#include "mesh-cache.h"
+#include "vertex-layout.h"
+
 namespace wave_tool {
+    class ThreadPool;
+
     // point association modes
     enum PrimitiveMode {
         POINTS = GL_POINTS,
@@ -84,11 +92,24 @@ namespace wave_tool {
             GLuint uvBuffer;
             GLuint colourBuffer;
             GLuint indexBuffer;
+            GLsizei indexCount = 0; // number of indices in indexBuffer (set by RenderEngine::assignBuffers / updateFaceBuffer)
+            GLenum indexType = GL_UNSIGNED_INT; // GL_UNSIGNED_SHORT whenever every index fits (set alongside indexCount)
+            //NOTE: must be chosen before RenderEngine::assignBuffers - when PACKED_INTERLEAVED, every stream lives in vertexBuffer (described by vertexLayout) and the other vertex buffers stay 0
+            VertexFormat vertexFormat = VertexFormat::SEPARATE_FLOAT;
+            VertexLayout vertexLayout;
+            //NOTE: byte sizes of the vertex buffers as last uploaded, so RenderEngine::updateBuffers never has to ask the driver
+            GLsizeiptr vertexBufferSize = 0;
+            GLsizeiptr normalBufferSize = 0;
+            GLsizeiptr uvBufferSize = 0;
+            GLsizeiptr colourBufferSize = 0;
             GLuint textureID;
             GLuint shaderProgramID;
 
             bool hasTexture;
 
+            //NOTE: if set, RenderEngine::assignBuffers uploads straight from this mapped cache file (and then releases it) - the vectors above are left empty
+            std::shared_ptr<MeshCache::Mapping const> cachedStreams = nullptr;
+
             //TODO: properly encapsulate this later...
             bool m_isVisible = true; // is the object to be rendered?
 
@@ -107,7 +128,26 @@ namespace wave_tool {
 
             glm::mat4 getModel() const { return m_model; }
 
-            void generateNormals();
+            // bounds of drawVerts in model space (see computeBounds)
+            inline geometry::AABB const& getLocalBounds() const { return m_localBounds; }
+            inline geometry::BoundingSphere const& getLocalBoundingSphere() const { return m_localBoundingSphere; }
+            // bounds in world space (local bounds transformed by the current model matrix)
+            geometry::AABB getWorldBounds() const { return m_localBounds.transformed(m_model); }
+            geometry::BoundingSphere getWorldBoundingSphere() const { return m_localBoundingSphere.transformed(m_model); }
+
+            // must be called again whenever drawVerts changes (RenderEngine::assignBuffers / updateBuffers do this)
+            void computeBounds();
+            // for meshes whose verts never reach the CPU-side vectors (see cachedStreams)
+            void setLocalBounds(geometry::AABB const& bounds, geometry::BoundingSphere const& boundingSphere) { m_localBounds = bounds; m_localBoundingSphere = boundingSphere; }
+            // recomputes faceNormals and (area-independent, averaged) normals from scratch, also rebuilds the vertex-to-face adjacency
+            //NOTE: must be called (instead of updateNormals) whenever drawFaces changes
+            //NOTE: with a thread pool, the faces and vertices are split across its workers (no write conflicts since every vertex gathers from its own adjacent faces)
+            void generateNormals(std::shared_ptr<ThreadPool> const& threadPool = nullptr);
+            // after only drawVerts[firstVertex, firstVertex + vertexCount) moved: recomputes just the faces touching them and the normals of those faces' vertices
+            //NOTE: falls back to generateNormals if the adjacency is missing or out of date
+            void updateNormals(std::size_t const firstVertex, std::size_t const vertexCount, std::shared_ptr<ThreadPool> const& threadPool = nullptr);
+
+            inline bool hasNormals() const { return 0 != normalBuffer || vertexLayout.hasAttribute(VertexLayout::NORMAL); }
         private:
             // these will represent exactly the values seen by the user in the UI (thus we use degrees since they're more user-friendly)...
             glm::vec3 m_position = glm::vec3(0.0f, 0.0f, 0.0f); // (x, y, z) position vector of object's origin point
@@ -116,8 +156,16 @@ namespace wave_tool {
             Tag m_tag{Tag::GENERIC};
 
             glm::mat4 m_model = glm::mat4(); // model matrix
+            geometry::AABB m_localBounds;
+            geometry::BoundingSphere m_localBoundingSphere;
+            // vertex-to-face adjacency (CSR): the faces using vertex v are m_vertexFaces[m_vertexFaceOffsets[v], m_vertexFaceOffsets[v + 1])
+            std::vector<GLuint> m_vertexFaceOffsets;
+            std::vector<GLuint> m_vertexFaces;
 
             void updateModel(); // updates model matrix to reflect new state of m_position, m_rotation and m_scale
+            void buildVertexFaceAdjacency();
+            glm::vec3 averageFaceNormals(std::size_t const v) const; // normalized sum of the normals of the faces using vertex v
+            bool isVertexFaceAdjacencyValid() const;
     };
 }
 
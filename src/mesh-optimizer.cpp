@@ -0,0 +1,393 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "mesh-optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+#include "mesh-object.h"
+
+namespace wave_tool
+{
+    namespace
+    {
+        // Forsyth's scoring, with his suggested constants
+        // reference: https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+        unsigned int const SCORING_CACHE_SIZE{32};
+        float const CACHE_DECAY_POWER{1.5f};
+        float const LAST_TRIANGLE_SCORE{0.75f};
+        float const VALENCE_BOOST_SCALE{2.0f};
+        float const VALENCE_BOOST_POWER{0.5f};
+        unsigned int const MAX_TABULATED_VALENCE{32};
+
+        struct ScoreTables
+        {
+            std::array<float, SCORING_CACHE_SIZE> cache;
+            std::array<float, MAX_TABULATED_VALENCE + 1> valence;
+
+            ScoreTables()
+            {
+                for (unsigned int position = 0; position < SCORING_CACHE_SIZE; ++position)
+                {
+                    // the vertices of the last triangle get a fixed score, so it isn't repeated in a strip-like order (which is worse for a FIFO)
+                    cache.at(position) = position < 3 ? LAST_TRIANGLE_SCORE : std::pow(1.0f - (position - 3) / (float)(SCORING_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+                }
+                valence.at(0) = 0.0f;
+                for (unsigned int remaining = 1; remaining <= MAX_TABULATED_VALENCE; ++remaining)
+                    valence.at(remaining) = VALENCE_BOOST_SCALE * std::pow((float)remaining, -VALENCE_BOOST_POWER);
+            }
+
+            // cachePosition < 0 if not in the cache
+            // NOTE: boosting vertices with few remaining triangles gets rid of lone triangles early, instead of leaving them for expensive cache misses later
+            float getVertexScore(int const cachePosition, GLuint const remainingValence) const
+            {
+                if (0 == remainingValence)
+                    return -1.0f;
+                float const cacheScore{cachePosition >= 0 ? cache[cachePosition] : 0.0f};
+                float const valenceScore{remainingValence <= MAX_TABULATED_VALENCE ? valence[remainingValence] : VALENCE_BOOST_SCALE * std::pow((float)remainingValence, -VALENCE_BOOST_POWER)};
+                return cacheScore + valenceScore;
+            }
+        };
+
+        bool areIndicesInRange(std::vector<GLuint> const &indices, std::size_t const vertexCount)
+        {
+            return std::all_of(indices.begin(), indices.end(), [vertexCount](GLuint const index) { return index < vertexCount; });
+        }
+
+        template <typename T>
+        void remapStream(std::vector<T> &stream, std::vector<GLuint> const &remap)
+        {
+            if (stream.size() != remap.size())
+                return;
+            std::vector<T> remapped(stream.size());
+            for (std::size_t v = 0; v < stream.size(); ++v)
+                remapped[remap[v]] = stream[v];
+            stream.swap(remapped);
+        }
+    }
+
+    float MeshOptimizer::computeACMR(GLuint const *indices, std::size_t const indexCount, std::size_t const vertexCount, unsigned int const cacheSize)
+    {
+        std::size_t const triangleCount{indexCount / 3};
+        if (0 == triangleCount)
+            return 0.0f;
+
+        // a vertex is in the FIFO while fewer than cacheSize misses happened since it was inserted
+        std::vector<std::size_t> insertedAt(vertexCount, 0);
+        std::size_t misses{0};
+        for (std::size_t i = 0; i < triangleCount * 3; ++i)
+        {
+            GLuint const v{indices[i]};
+            if (v >= vertexCount)
+                continue;
+            if (0 == insertedAt[v] || misses - insertedAt[v] >= cacheSize)
+            {
+                ++misses;
+                insertedAt[v] = misses;
+            }
+        }
+        return misses / (float)triangleCount;
+    }
+
+    void MeshOptimizer::optimizeVertexCache(std::vector<GLuint> &indices, std::size_t const vertexCount)
+    {
+        std::size_t const triangleCount{indices.size() / 3};
+        if (0 == triangleCount || !areIndicesInRange(indices, vertexCount))
+            return;
+
+        static ScoreTables const scores;
+
+        // vertex-to-triangle adjacency (CSR), the first remainingValence[v] entries of a vertex are its triangles not yet emitted
+        std::vector<GLuint> remainingValence(vertexCount, 0);
+        for (std::size_t i = 0; i < triangleCount * 3; ++i)
+            ++remainingValence[indices[i]];
+        std::vector<GLuint> adjacencyOffsets(vertexCount + 1, 0);
+        std::partial_sum(remainingValence.begin(), remainingValence.end(), adjacencyOffsets.begin() + 1);
+        std::vector<GLuint> adjacency(triangleCount * 3);
+        {
+            std::vector<GLuint> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (std::size_t i = 0; i < triangleCount * 3; ++i)
+                adjacency[cursors[indices[i]]++] = (GLuint)(i / 3);
+        }
+
+        std::vector<int> cachePositions(vertexCount, -1);
+        std::vector<float> vertexScores(vertexCount);
+        for (std::size_t v = 0; v < vertexCount; ++v)
+            vertexScores[v] = scores.getVertexScore(-1, remainingValence[v]);
+
+        std::vector<float> triangleScores(triangleCount);
+        std::vector<bool> isEmitted(triangleCount, false);
+        std::size_t bestTriangle{0};
+        for (std::size_t t = 0; t < triangleCount; ++t)
+        {
+            triangleScores[t] = vertexScores[indices[3 * t]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+            if (triangleScores[t] > triangleScores[bestTriangle])
+                bestTriangle = t;
+        }
+
+        std::vector<GLuint> optimized;
+        optimized.reserve(triangleCount * 3);
+        // the cache holds up to 3 extra vertices while a triangle is being added (they are the ones evicted)
+        std::vector<GLuint> cache;
+        std::vector<GLuint> nextCache;
+        cache.reserve(SCORING_CACHE_SIZE + 3);
+        nextCache.reserve(SCORING_CACHE_SIZE + 3);
+        std::size_t nextUnemitted{0};
+
+        for (std::size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+        {
+            // dead end (nothing in the cache has triangles left), so restart from the next triangle in input order
+            if (triangleCount == bestTriangle)
+            {
+                while (isEmitted[nextUnemitted])
+                    ++nextUnemitted;
+                bestTriangle = nextUnemitted;
+            }
+
+            GLuint const *corners{&indices[3 * bestTriangle]};
+            isEmitted[bestTriangle] = true;
+            nextCache.assign(corners, corners + 3);
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+                GLuint const v{corners[c]};
+                optimized.push_back(v);
+
+                // remove the triangle from the vertex's remaining triangles
+                GLuint *const begin{&adjacency[adjacencyOffsets[v]]};
+                GLuint *const end{begin + remainingValence[v]};
+                GLuint *const found{std::find(begin, end, (GLuint)bestTriangle)};
+                if (end != found)
+                {
+                    std::swap(*found, *(end - 1));
+                    --remainingValence[v];
+                }
+            }
+            for (GLuint const v : cache)
+            {
+                if (corners[0] != v && corners[1] != v && corners[2] != v)
+                    nextCache.push_back(v);
+            }
+            cache.swap(nextCache);
+
+            // rescore every vertex whose position (or valence) changed, and push the difference to its remaining triangles
+            for (std::size_t position = 0; position < cache.size(); ++position)
+            {
+                GLuint const v{cache[position]};
+                cachePositions[v] = position < SCORING_CACHE_SIZE ? (int)position : -1;
+                float const score{scores.getVertexScore(cachePositions[v], remainingValence[v])};
+                float const delta{score - vertexScores[v]};
+                vertexScores[v] = score;
+                for (GLuint i = 0; i < remainingValence[v]; ++i)
+                    triangleScores[adjacency[adjacencyOffsets[v] + i]] += delta;
+            }
+            if (cache.size() > SCORING_CACHE_SIZE)
+                cache.resize(SCORING_CACHE_SIZE);
+
+            // the next triangle is the best one touching the cache
+            bestTriangle = triangleCount;
+            float bestScore{-1.0f};
+            for (GLuint const v : cache)
+            {
+                for (GLuint i = 0; i < remainingValence[v]; ++i)
+                {
+                    GLuint const t{adjacency[adjacencyOffsets[v] + i]};
+                    if (triangleScores[t] > bestScore)
+                    {
+                        bestScore = triangleScores[t];
+                        bestTriangle = t;
+                    }
+                }
+            }
+        }
+
+        indices.swap(optimized);
+    }
+
+    // splits the (cache optimized) triangles into clusters and sorts them so those facing outwards from the mesh centre come first
+    // (they are the most likely to occlude the rest, so fewer fragments get shaded and then overwritten)
+    // NOTE: a cluster boundary is placed where the cache is flushed anyway (a triangle with 3 misses), or after minClusterSize triangles
+    //  every restart of the cache costs some misses, so minClusterSize doubles until the sorted order is within threshold of the ACMR before
+    void MeshOptimizer::optimizeOverdraw(std::vector<GLuint> &indices, std::vector<glm::vec3> const &positions, float const threshold)
+    {
+        std::size_t const triangleCount{indices.size() / 3};
+        std::size_t const vertexCount{positions.size()};
+        if (triangleCount < 2 || !areIndicesInRange(indices, vertexCount))
+            return;
+
+        float const acmrBefore{computeACMR(indices.data(), indices.size(), vertexCount)};
+
+        // the triangles whose 3 vertices all miss (same FIFO model as computeACMR)
+        std::vector<bool> isCacheRestart(triangleCount, false);
+        {
+            std::vector<std::size_t> insertedAt(vertexCount, 0);
+            std::size_t misses{0};
+            for (std::size_t t = 0; t < triangleCount; ++t)
+            {
+                unsigned int triangleMisses{0};
+                for (unsigned int c = 0; c < 3; ++c)
+                {
+                    GLuint const v{indices[3 * t + c]};
+                    if (0 == insertedAt[v] || misses - insertedAt[v] >= FIFO_CACHE_SIZE)
+                    {
+                        ++misses;
+                        ++triangleMisses;
+                        insertedAt[v] = misses;
+                    }
+                }
+                isCacheRestart[t] = 3 == triangleMisses;
+            }
+        }
+
+        // per triangle: area weighted centroid and normal (whose length is twice the area)
+        std::vector<glm::vec3> weightedCentroids(triangleCount);
+        std::vector<glm::vec3> weightedNormals(triangleCount);
+        std::vector<float> areas(triangleCount);
+        glm::vec3 meshCentroid{0.0f};
+        float meshArea{0.0f};
+        for (std::size_t t = 0; t < triangleCount; ++t)
+        {
+            glm::vec3 const &p1{positions[indices[3 * t]]};
+            glm::vec3 const &p2{positions[indices[3 * t + 1]]};
+            glm::vec3 const &p3{positions[indices[3 * t + 2]]};
+            weightedNormals[t] = glm::cross(p2 - p1, p3 - p1);
+            areas[t] = glm::length(weightedNormals[t]);
+            weightedCentroids[t] = (p1 + p2 + p3) * (areas[t] / 3.0f);
+            meshCentroid += weightedCentroids[t];
+            meshArea += areas[t];
+        }
+        if (meshArea <= 0.0f)
+            return;
+        meshCentroid /= meshArea;
+
+        for (std::size_t minClusterSize = FIFO_CACHE_SIZE; minClusterSize < triangleCount; minClusterSize *= 2)
+        {
+            std::vector<std::size_t> clusterStarts{0};
+            for (std::size_t t = 1; t < triangleCount; ++t)
+            {
+                if (isCacheRestart[t] || t - clusterStarts.back() >= minClusterSize)
+                    clusterStarts.push_back(t);
+            }
+            clusterStarts.push_back(triangleCount);
+            std::size_t const clusterCount{clusterStarts.size() - 1};
+            if (clusterCount < 2)
+                return;
+
+            // sort by how far each cluster faces away from the mesh centre
+            std::vector<float> sortKeys(clusterCount, 0.0f);
+            for (std::size_t c = 0; c < clusterCount; ++c)
+            {
+                glm::vec3 centroid{0.0f};
+                glm::vec3 normal{0.0f};
+                float area{0.0f};
+                for (std::size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t)
+                {
+                    centroid += weightedCentroids[t];
+                    normal += weightedNormals[t];
+                    area += areas[t];
+                }
+                float const normalLength{glm::length(normal)};
+                if (area > 0.0f && normalLength > 0.0f)
+                    sortKeys[c] = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+            }
+            std::vector<std::size_t> order(clusterCount);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&sortKeys](std::size_t const a, std::size_t const b) { return sortKeys[a] > sortKeys[b]; });
+
+            std::vector<GLuint> sorted;
+            sorted.reserve(indices.size());
+            for (std::size_t const c : order)
+                sorted.insert(sorted.end(), indices.begin() + 3 * clusterStarts[c], indices.begin() + 3 * clusterStarts[c + 1]);
+
+            // only keep it if the vertex cache didn't suffer too much
+            if (computeACMR(sorted.data(), sorted.size(), vertexCount) <= threshold * acmrBefore)
+            {
+                indices.swap(sorted);
+                return;
+            }
+        }
+    }
+
+    std::vector<GLuint> MeshOptimizer::optimizeVertexFetch(std::vector<GLuint> &indices, std::size_t const vertexCount)
+    {
+        GLuint const UNUSED{~0u};
+        std::vector<GLuint> remap(vertexCount, UNUSED);
+        if (!areIndicesInRange(indices, vertexCount))
+        {
+            std::iota(remap.begin(), remap.end(), 0);
+            return remap;
+        }
+
+        GLuint nextVertex{0};
+        for (GLuint &index : indices)
+        {
+            if (UNUSED == remap[index])
+                remap[index] = nextVertex++;
+            index = remap[index];
+        }
+        for (GLuint &newIndex : remap)
+        {
+            if (UNUSED == newIndex)
+                newIndex = nextVertex++;
+        }
+        return remap;
+    }
+
+    MeshOptimizer::Statistics MeshOptimizer::optimize(MeshObject &object)
+    {
+        std::vector<GLuint> &indices{object.drawFaces};
+        std::size_t const vertexCount{object.drawVerts.size()};
+        Statistics statistics{};
+        statistics.acmrBefore = computeACMR(indices.data(), indices.size(), vertexCount);
+        if (PrimitiveMode::TRIANGLES != object.m_primitiveMode)
+        {
+            statistics.acmrAfter = statistics.acmrBefore;
+            return statistics;
+        }
+
+        optimizeVertexCache(indices, vertexCount);
+        optimizeOverdraw(indices, object.drawVerts);
+
+        std::vector<GLuint> const remap{optimizeVertexFetch(indices, vertexCount)};
+        remapStream(object.drawVerts, remap);
+        remapStream(object.normals, remap);
+        remapStream(object.uvs, remap);
+        remapStream(object.colours, remap);
+        // face order changed
+        object.faceNormals.clear();
+
+        statistics.acmrAfter = computeACMR(indices.data(), indices.size(), vertexCount);
+        return statistics;
+    }
+}
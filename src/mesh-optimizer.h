@@ -0,0 +1,77 @@
+#ifndef WAVE_TOOL_MESH_OPTIMIZER_H_
+#define WAVE_TOOL_MESH_OPTIMIZER_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace wave_tool
+{
+    class MeshObject;
+
+    // load-time reordering of tri-mesh index (and vertex) data for the GPU:
+    //  1. triangles are reordered for the post-transform vertex cache (Forsyth's "linear-speed vertex cache optimisation")
+    //  2. clusters of those triangles are sorted outside-in to reduce overdraw (the cluster sort of Sander et al.'s "Tipsify"), as long as it costs little cache efficiency
+    //  3. vertices are renumbered in order of first use, so the vertex fetch walks through memory linearly
+    class MeshOptimizer
+    {
+    public:
+        // the FIFO cache modelled by computeACMR (a typical size for post-transform caches)
+        static unsigned int const FIFO_CACHE_SIZE{16};
+        // overdraw sorting may make the ACMR at most this much worse
+        static constexpr float OVERDRAW_ACMR_THRESHOLD{1.05f};
+
+        struct Statistics
+        {
+            float acmrBefore;
+            float acmrAfter;
+        };
+
+        // average cache miss ratio: transformed vertices per triangle (in range [~0.5, 3], lower is better) with a FIFO cache of the given size
+        static float computeACMR(GLuint const *indices, std::size_t const indexCount, std::size_t const vertexCount, unsigned int const cacheSize = FIFO_CACHE_SIZE);
+
+        static void optimizeVertexCache(std::vector<GLuint> &indices, std::size_t const vertexCount);
+        static void optimizeOverdraw(std::vector<GLuint> &indices, std::vector<glm::vec3> const &positions, float const threshold = OVERDRAW_ACMR_THRESHOLD);
+        // renumbers the vertices in order of first use (unused vertices go last) and returns the remap (old index -> new index)
+        static std::vector<GLuint> optimizeVertexFetch(std::vector<GLuint> &indices, std::size_t const vertexCount);
+
+        // every step above on a tri-mesh's CPU-side data (drawFaces and every per-vertex stream)
+        // NOTE: must run before RenderEngine::assignBuffers, and invalidates faceNormals
+        static Statistics optimize(MeshObject &object);
+    };
+}
+
+#endif // WAVE_TOOL_MESH_OPTIMIZER_H_
@@ -31,222 +31,282 @@
 
 #include "object-loader.h"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <fstream>
+#include <unordered_map>
 #include <boost/algorithm/string.hpp>
 
-namespace wave_tool {
-    //NOTE: this method simply returns the data as found in file (but with indices decremented by 1 for 0-indexing). Thus, for OpenGL, the data still needs to be converted into a single-index-buffer format.
-    // reference: https://www.cs.cmu.edu/~mbz/personal/graphics/obj.html
-    //NOTE: the referenced format above will be closely followed, although some of the information is innacurate (I think!) (e.g. f 1/1 is invalid, it would have to be f 1//1 or 1/1/)
-    //NOTE: this method does not support 3D texture coords (uvw) - will return false if found in file. Otherwise, 2D texture coords (uv) are allowed.
-    // reference: https://wiki.fileformat.com/3d/obj/
-    //NOTE: this loader is very incomplete according to above specification, but it is good enough for our application
-    //TODO: probably gonna have to keep track of stuff like "g" "usemtl", etc. and maybe comments so that they can be added to any exported files by our application (maybe we won't support that though...)
-    //TODO: could also return an error string with a specific error
-    // reference: http://paulbourke.net/dataformats/obj/
-    bool ObjectLoader::loadTriMeshOBJ(std::string const& filePath, std::vector<glm::vec3> &out_verts, std::vector<glm::vec2> &out_uvs, std::vector<glm::vec3> &out_normals, std::vector<std::vector<glm::vec3>> &out_faces) {
-
-        // ERROR CHECKING...
-
-        // verify extension is .obj (case-insensitive)
-        // reference: https://stackoverflow.com/questions/51949/how-to-get-file-extension-from-string-in-c
-
-        //NOTE: if find_last_of doesn't find any occurence, it returns std::string::npos
-        size_t const dotIndex = filePath.find_last_of(".");
-        if (dotIndex == std::string::npos) return false;
-
-        //NOTE: if dotIndex + 1 == filePath.length(), then substr will return ""
-        //NOTE: if pos in substr(pos) is > string length, it will throw as exception. Below, this will never happen though due to the check above
-        // performs case-insensitive comparison
-        // reference: https://stackoverflow.com/questions/11635/case-insensitive-string-comparison-in-c
-        if (!boost::iequals(filePath.substr(dotIndex + 1), "obj")) return false;
+#include "hash.h"
+#include "mapped-file.h"
+#include "mesh-cache.h"
+#include "mesh-optimizer.h"
+#include "thread-pool.h"
 
+namespace wave_tool {
+    namespace {
+        // the result of parsing one newline-aligned chunk of the file
+        struct ChunkData {
+            std::vector<glm::vec3> verts;
+            std::vector<glm::vec2> uvs;
+            std::vector<glm::vec3> normals;
+            std::vector<glm::ivec3> trianglePoints;
+            // (point * 3 + component) of every negative (relative) index - these were resolved against this chunk's own counts, so they still need the chunk's offset
+            std::vector<std::size_t> relativeIndexSlots;
+            bool isValid = true;
+        };
+
+        // files smaller than this are parsed on the calling thread
+        std::size_t const MIN_BYTES_PER_CHUNK = 1 << 20;
+
+        inline bool isHorizontalSpace(char const c) { return ' ' == c || '\t' == c || '\r' == c; }
+
+        inline char const* skipHorizontalSpace(char const *p, char const *const end) {
+            while (p < end && isHorizontalSpace(*p)) ++p;
+            return p;
+        }
 
-        // MAIN WORK...
+        inline bool isLineEnd(char const *const p, char const *const end) { return p >= end || '\n' == *p || '#' == *p; }
 
-        // 1. clear params (safety)...
+        // reads "[whitespace]real" and advances p past it
+        inline bool parseFloat(char const *&p, char const *const end, float &out_value) {
+            p = skipHorizontalSpace(p, end);
+            if (p < end && '+' == *p) ++p; // from_chars doesn't accept an explicit plus sign
+            std::from_chars_result const result = std::from_chars(p, end, out_value);
+            if (std::errc() != result.ec) return false;
+            p = result.ptr;
+            return true;
+        }
 
-        out_verts.clear();
-        out_uvs.clear();
-        out_normals.clear();
-        out_faces.clear();
+        // reads an obj index (1-based, or negative to count back from the latest element) into a 0-based index
+        //NOTE: a negative index is resolved against localCount, and isRelative is set so the caller can add the chunk's offset later
+        inline bool parseIndex(char const *&p, char const *const end, std::size_t const localCount, int &out_index, bool &out_isRelative) {
+            int value = 0;
+            std::from_chars_result const result = std::from_chars(p, end, value);
+            if (std::errc() != result.ec || 0 == value) return false;
+            p = result.ptr;
+            out_isRelative = value < 0;
+            out_index = out_isRelative ? (int)localCount + value : value - 1;
+            return true;
+        }
 
-        // 2. read obj file line by line (each line as a string). Only error checking here will be format checking on the lines (e.g. f 1/1/1 2/2/2 3/3/3 4/4/4 would return false since we are assuming pure tri mesh)
+        // parses every line that starts in [begin, end)
+        //NOTE: only v, vt, vn and f lines are read. Every line with a different prefix is simply ignored (this includes valid obj commands we don't support, as well as gibberish)
+        //NOTE: prefix tokens are checked in a case-insensitive manner
+        void parseChunk(char const *const begin, char const *const end, ChunkData &out_chunk) {
+            std::vector<glm::ivec3> facePoints; // reused by every face line (no allocation once it has grown to the largest polygon)
+            std::vector<std::size_t> faceRelativeSlots;
+
+            char const *p = begin;
+            while (p < end && out_chunk.isValid) {
+                p = skipHorizontalSpace(p, end);
+                char const *const tokenBegin = p;
+                while (p < end && !isHorizontalSpace(*p) && '\n' != *p) ++p;
+                std::size_t const tokenLength = p - tokenBegin;
+                char const first = 0 < tokenLength ? (char)std::tolower((unsigned char)tokenBegin[0]) : '\0';
+                char const second = 1 < tokenLength ? (char)std::tolower((unsigned char)tokenBegin[1]) : '\0';
+
+                bool const isVertex = 1 == tokenLength && 'v' == first;
+                bool const isUV = 2 == tokenLength && 'v' == first && 't' == second;
+                bool const isNormal = 2 == tokenLength && 'v' == first && 'n' == second;
+                bool const isFace = 1 == tokenLength && 'f' == first;
+
+                if ((isVertex || isUV || isNormal || isFace) && isLineEnd(skipHorizontalSpace(p, end), end)) {
+                    out_chunk.isValid = false; // valid and supported prefix, but missing data
+                    break;
+                }
 
-        // open file
-        std::ifstream fileStream;
-        fileStream.open(filePath); // opens file for reading (default mode)
-        // reference: https://stackoverflow.com/questions/4206816/ifstream-check-if-opened-successfully
-        if (!fileStream) return false; // if opening failed or stream is bad (e.g. invalid path), error
+                if (isVertex || isNormal) {
+                    //NOTE: expected format is "x y z" - anything after (e.g. w, or vertex colours) is ignored
+                    glm::vec3 value;
+                    if (!parseFloat(p, end, value.x) || !parseFloat(p, end, value.y) || !parseFloat(p, end, value.z)) {
+                        out_chunk.isValid = false;
+                        break;
+                    }
+                    (isVertex ? out_chunk.verts : out_chunk.normals).push_back(value);
+                } else if (isUV) {
+                    //NOTE: expected format is "u [v [w]]" - v defaults to 0 and 3D texture coords are accepted by dropping w
+                    glm::vec2 uv(0.0f, 0.0f);
+                    if (!parseFloat(p, end, uv.x)) {
+                        out_chunk.isValid = false;
+                        break;
+                    }
+                    if (!isLineEnd(skipHorizontalSpace(p, end), end) && !parseFloat(p, end, uv.y)) {
+                        out_chunk.isValid = false;
+                        break;
+                    }
+                    out_chunk.uvs.push_back(uv);
+                } else if (isFace) {
+                    //NOTE: each point is "v", "v/vt", "v//vn" or "v/vt/vn" - a missing index is stored as a symbolic -1
+                    facePoints.clear();
+                    faceRelativeSlots.clear();
+                    for (p = skipHorizontalSpace(p, end); !isLineEnd(p, end); p = skipHorizontalSpace(p, end)) {
+                        glm::ivec3 point(-1, -1, -1);
+                        bool isRelative = false;
+                        if (!parseIndex(p, end, out_chunk.verts.size(), point.x, isRelative)) {
+                            out_chunk.isValid = false; // we require all points to have a vIndex
+                            break;
+                        }
+                        if (isRelative) faceRelativeSlots.push_back(facePoints.size() * 3);
+
+                        if (p < end && '/' == *p) {
+                            ++p;
+                            if (p < end && '/' != *p) {
+                                if (!parseIndex(p, end, out_chunk.uvs.size(), point.y, isRelative)) {
+                                    out_chunk.isValid = false;
+                                    break;
+                                }
+                                if (isRelative) faceRelativeSlots.push_back(facePoints.size() * 3 + 1);
+                            }
+                            if (p < end && '/' == *p) {
+                                ++p;
+                                if (!parseIndex(p, end, out_chunk.normals.size(), point.z, isRelative)) {
+                                    out_chunk.isValid = false;
+                                    break;
+                                }
+                                if (isRelative) faceRelativeSlots.push_back(facePoints.size() * 3 + 2);
+                            }
+                        }
+                        // a point must be followed by whitespace or the end of the line
+                        if (!isLineEnd(p, end) && !isHorizontalSpace(*p)) {
+                            out_chunk.isValid = false;
+                            break;
+                        }
+                        facePoints.push_back(point);
+                    }
+                    if (!out_chunk.isValid) break;
+                    if (facePoints.size() < 3) {
+                        out_chunk.isValid = false; // not a polygon
+                        break;
+                    }
 
-        //NOTE: the file will be parsed in an order-agnostic manner
-        std::string line = "";
+                    // fan-triangulate (0, i, i + 1) - exact for triangles and convex polygons, which is what exporters write
+                    std::size_t const firstPoint = out_chunk.trianglePoints.size();
+                    for (std::size_t i = 1; i + 1 < facePoints.size(); ++i) {
+                        out_chunk.trianglePoints.push_back(facePoints.at(0));
+                        out_chunk.trianglePoints.push_back(facePoints.at(i));
+                        out_chunk.trianglePoints.push_back(facePoints.at(i + 1));
+                    }
+                    // remap the relative slots of the polygon onto the triangles that reference them
+                    for (std::size_t const slot : faceRelativeSlots) {
+                        std::size_t const polygonPoint = slot / 3;
+                        std::size_t const component = slot % 3;
+                        for (std::size_t i = 1; i + 1 < facePoints.size(); ++i) {
+                            std::size_t const triangle = firstPoint + (i - 1) * 3;
+                            if (0 == polygonPoint) out_chunk.relativeIndexSlots.push_back(triangle * 3 + component);
+                            else if (i == polygonPoint) out_chunk.relativeIndexSlots.push_back((triangle + 1) * 3 + component);
+                            else if (i + 1 == polygonPoint) out_chunk.relativeIndexSlots.push_back((triangle + 2) * 3 + component);
+                        }
+                    }
+                }
 
-        // reference: https://stackoverflow.com/questions/19123334/how-to-use-stdgetline-to-read-a-text-file-into-an-array-of-strings-in-c
-        // reference: https://stackoverflow.com/questions/5605125/why-is-iostreameof-inside-a-loop-condition-i-e-while-stream-eof-cons
-        while (std::getline(fileStream, line)) {
+                // move on to the next line
+                while (p < end && '\n' != *p) ++p;
+                if (p < end) ++p;
+            }
+        }
 
-            boost::trim(line);
-            if (line.empty()) continue; // ignore blank lines
+        // verify extension is .obj (case-insensitive)
+        // reference: https://stackoverflow.com/questions/51949/how-to-get-file-extension-from-string-in-c
+        bool hasOBJExtension(std::string const& filePath) {
+            //NOTE: if find_last_of doesn't find any occurence, it returns std::string::npos
+            size_t const dotIndex = filePath.find_last_of(".");
+            if (dotIndex == std::string::npos) return false;
+
+            //NOTE: if dotIndex + 1 == filePath.length(), then substr will return ""
+            // performs case-insensitive comparison
+            // reference: https://stackoverflow.com/questions/11635/case-insensitive-string-comparison-in-c
+            return boost::iequals(filePath.substr(dotIndex + 1), "obj");
+        }
 
-            // reference: https://wiki.fileformat.com/3d/obj/
-            //NOTE: this method will only be looking for v,vt,vn,f lines. Every line with a different prefix will simply be ignored (this includes all the valid prefix tokens listed in the above link, but it also unfortunately includes any gibberish as well)
-            //NOTE: this seems fine by me since this code should work even if the file format is updated in the future (by adding features, not subtracting the ones we support)
+        struct IndexTripleHash {
+            std::size_t operator()(glm::ivec3 const& key) const {
+                // reference: https://www.boost.org/doc/libs/1_71_0/doc/html/hash/reference.html#boost.hash_combine
+                std::size_t seed = std::hash<int>()(key.x);
+                seed ^= std::hash<int>()(key.y) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                seed ^= std::hash<int>()(key.z) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                return seed;
+            }
+        };
+    }
 
-            //NOTE: prefix tokens will be checked in a case-insensitive manner (idk if this is a violation of the spec, but its more flexible to the user)
+    //NOTE: this method simply returns the data as found in file (but with indices decremented by 1 for 0-indexing). Thus, for OpenGL, the data still needs to be converted into a single-index-buffer format.
+    // reference: https://www.cs.cmu.edu/~mbz/personal/graphics/obj.html
+    // reference: https://wiki.fileformat.com/3d/obj/
+    //NOTE: this loader is very incomplete according to above specification, but it is good enough for our application
+    //TODO: could also return an error string with a specific error
+    // reference: http://paulbourke.net/dataformats/obj/
+    //NOTE: the file is memory-mapped and tokenized in place (no per-line allocations), and large files are split at line boundaries and parsed in parallel
+    bool ObjectLoader::loadTriMeshOBJ(std::string const& filePath, OBJData &out_data, std::shared_ptr<ThreadPool> const& threadPool) {
 
-            // reference: https://stackoverflow.com/questions/10551125/boost-string-split-to-eliminate-spaces-in-words
+        // ERROR CHECKING...
 
+        if (!hasOBJExtension(filePath)) return false;
 
-            //NOTE: command prefixes must be followed by a space character (or tab)
-            // reference: https://stackoverflow.com/questions/2896600/how-to-replace-all-occurrences-of-a-character-in-string
-            std::replace(line.begin(), line.end(), '\t', ' '); // replace any and all tabs with simple space chars
 
+        // MAIN WORK...
 
-            if (boost::istarts_with(line, "v ")) {
-                std::string suffix = line.substr(2);
-                //NOTE: this suffix cannot be empty since it would mean our whole trimmed line is "v " which is impossible since we trimmed our raw line to get it
-                boost::trim_left(suffix); //NOTE: right trim is unneeded since line was already trimmed before
-                //NOTE: this suffix is also guaranteed to not be empty (otherwise, it would have been trimmed before)
+        MappedFile const file(filePath, true);
+        if (!file.isOpen()) return false; // if opening failed (e.g. invalid path), error
 
-                //NOTE: suffix is expected to be in the format "x[whitespace]y[whitespace]z" where x,y,z are real numbers (will get parsed into floats)
-                std::vector<std::string> words;
-                boost::split(words, suffix, boost::is_any_of(" "), boost::token_compress_on); //NOTE: no need to check for '\t', since we already replaced them with ' ' in whole line
+        return parseTriMeshOBJ(file, out_data, threadPool);
+    }
 
-                if (words.size() != 3) return false; // invalid format
+    bool ObjectLoader::parseTriMeshOBJ(MappedFile const& file, OBJData &out_data, std::shared_ptr<ThreadPool> const& threadPool) {
+        // 0. clear params (safety)...
 
-                //TODO: test -ve, none, +ve, ints, does 0.5f work (probably not, but no file will ever have this)
-                try {
-                    glm::vec3 vert;
-                    vert.x = std::stof(words.at(0));
-                    vert.y = std::stof(words.at(1));
-                    vert.z = std::stof(words.at(2));
-                    out_verts.push_back(vert);
-                } catch (...) { // catch-all (cannot convert or range violation)
-                    return false;
-                }
+        out_data = OBJData();
 
-            } else if (boost::istarts_with(line, "vt ")) {
-                std::string suffix = line.substr(3);
-                //NOTE: this suffix cannot be empty since it would mean our whole trimmed line is "vt " which is impossible since we trimmed our raw line to get it
-                boost::trim_left(suffix); //NOTE: right trim is unneeded since line was already trimmed before
-                //NOTE: this suffix is also guaranteed to not be empty (otherwise, it would have been trimmed before)
-
-                //NOTE: suffix is expected to be in the format "u[whitespace]v" where u,v are real numbers (will get parsed into floats)
-                //NOTE: if u,v,w is encountered, we treat it as a parsing error (this parser does not support 3D texture coords despite them being valid in specification)
-                std::vector<std::string> words;
-                boost::split(words, suffix, boost::is_any_of(" "), boost::token_compress_on); //NOTE: no need to check for '\t', since we already replaced them with ' ' in whole line
-
-                if (words.size() != 2) return false; // invalid format
-
-                //TODO: test -ve, none, +ve, ints, does 0.5f work (probably not, but no file will ever have this)
-                try {
-                    glm::vec2 uv;
-                    uv.x = std::stof(words.at(0));
-                    uv.y = std::stof(words.at(1));
-                    //TODO: could add error checking here to make sure both U and V are in range [0.0f, 1.0f]
-                    //uv.y *= -1; //NOTE: MUST FLIP THE V COORD HERE! - don't have to do this anymore since stb can flip texture
-                    //uv.y = 1.0f - uv.y; //NOTE: this seems to work as well, but i'll go with the above fix since it was present in old obj loader
-                    out_uvs.push_back(uv);
-                }
-                catch (...) { // catch-all (cannot convert or range violation)
-                    return false;
-                }
+        // 1. split the file into newline-aligned chunks...
 
-            } else if (boost::istarts_with(line, "vn ")) {
-                std::string suffix = line.substr(3);
-                //NOTE: this suffix cannot be empty since it would mean our whole trimmed line is "vn " which is impossible since we trimmed our raw line to get it
-                boost::trim_left(suffix); //NOTE: right trim is unneeded since line was already trimmed before
-                //NOTE: this suffix is also guaranteed to not be empty (otherwise, it would have been trimmed before)
-
-                //NOTE: suffix is expected to be in the format "x[whitespace]y[whitespace]z" where x,y,z are real numbers (will get parsed into floats)
-                std::vector<std::string> words;
-                boost::split(words, suffix, boost::is_any_of(" "), boost::token_compress_on); //NOTE: no need to check for '\t', since we already replaced them with ' ' in whole line
-
-                if (words.size() != 3) return false; // invalid format
-
-                //TODO: test -ve, none, +ve, ints, does 0.5f work (probably not, but no file will ever have this)
-                try {
-                    glm::vec3 normal;
-                    normal.x = std::stof(words.at(0));
-                    normal.y = std::stof(words.at(1));
-                    normal.z = std::stof(words.at(2));
-                    //TODO: do I need to add error checking for 1. zero vector? 2. non-normalized vector?
-                    out_normals.push_back(normal);
-                }
-                catch (...) { // catch-all (cannot convert or range violation)
-                    return false;
-                }
+        char const *const fileBegin = file.data();
+        char const *const fileEnd = fileBegin + file.size();
 
-            } else if (boost::istarts_with(line, "f ")) {
-                std::string suffix = line.substr(2);
-                //NOTE: this suffix cannot be empty since it would mean our whole trimmed line is "f " which is impossible since we trimmed our raw line to get it
-                boost::trim_left(suffix); //NOTE: right trim is unneeded since line was already trimmed before
-                //NOTE: this suffix is also guaranteed to not be empty (otherwise, it would have been trimmed before)
-
-                //NOTE: suffix is expected to be in the format "v0/vt0/vn0[whitespace]v1/vt1/vn1[whitespace]v2/vt2/vn2" where each token is an index (int >= 1) - NOTE: negative indices are not supported by this parser despite being valid in spec
-                //NOTE: vt/vn are optional, v is required, thus if both are missing the line could look like v0 v1 v2 or v0// v1// v2//
-                //NOTE: if an index is missing, a symbolic -1 will be put in its place
-                //NOTE: this parser only works for pure tri meshes
-                //NOTE: later on, I will error check that all explicit indices are in the proper format (e.g. can't have f 1/1/1 2//2 3/3/3 in the file)
-                std::vector<std::string> words;
-                boost::split(words, suffix, boost::is_any_of(" "), boost::token_compress_on); //NOTE: no need to check for '\t', since we already replaced them with ' ' in whole line
-
-                if (words.size() != 3) return false; // invalid format
-
-                std::vector<glm::vec3> points; // will be size 3 (triangle) - each of the 3 points has 3 indices (v/vt/vn)
-
-                for (std::string const& point : words) {
-                    std::vector<std::string> indices;
-                    boost::split(indices, point, boost::is_any_of("/"), boost::token_compress_off);
-
-                    int vIndex = -1;
-                    int vtIndex = -1;
-                    int vnIndex = -1;
-
-                    if (indices.size() == 1) { // point is just a vIndex (no slashes)
-                        try {
-                            vIndex = std::stoi(indices.at(0));
-                            if (1 > vIndex) return false; // we only support indices >= 1
-                            --vIndex; // must decrement obj indices to shift to 0-indexing
-                        } catch (...) { // catch-all (cannot convert or range violation)
-                            return false;
-                        }
-                    } else if (indices.size() == 3) {
-                        try {
-                            if (indices.at(0).empty()) return false; // missing vIndex (NOTE: we require all faces to have a vIndex)
-                            vIndex = std::stoi(indices.at(0));
-                            if (1 > vIndex) return false; // we only support indices >= 1
-                            --vIndex; // must decrement obj indices to shift to 0-indexing
-
-                            if (!indices.at(1).empty()) { // empty vt will stay at -1
-                                vtIndex = std::stoi(indices.at(1));
-                                if (1 > vtIndex) return false; // we only support indices >= 1
-                                --vtIndex; // must decrement obj indices to shift to 0-indexing
-                            }
+        std::size_t chunkCount = 1;
+        if (nullptr != threadPool) chunkCount = std::max<std::size_t>(1, std::min<std::size_t>(4 * (threadPool->getThreadCount() + 1), file.size() / MIN_BYTES_PER_CHUNK));
 
-                            if (!indices.at(2).empty()) { // empty vn will stay at -1
-                                vnIndex = std::stoi(indices.at(2));
-                                if (1 > vnIndex) return false; // we only support indices >= 1
-                                --vnIndex; // must decrement obj indices to shift to 0-indexing
-                            }
-                        } catch (...) { // catch-all (cannot convert or range violation)
-                            return false;
-                        }
-                    } else return false; // have slashes but don't have exactly 2
+        std::vector<char const*> chunkBounds(chunkCount + 1, fileEnd);
+        chunkBounds.at(0) = fileBegin;
+        for (std::size_t i = 1; i < chunkCount; ++i) {
+            char const *boundary = std::max(chunkBounds.at(i - 1), fileBegin + i * (file.size() / chunkCount));
+            while (boundary < fileEnd && '\n' != *(boundary - 1)) ++boundary;
+            chunkBounds.at(i) = boundary;
+        }
 
-                    // getting here means we have (so far) a valid triple of indices for this point
-                    points.push_back(glm::vec3(vIndex, vtIndex, vnIndex));
-                }
+        // 2. parse the chunks (each one on its own, since only relative indices depend on what came before)...
 
-                out_faces.push_back(points);
+        std::vector<ChunkData> chunks(chunkCount);
+        auto const parseChunks = [&](std::size_t const begin, std::size_t const end) {
+            for (std::size_t i = begin; i < end; ++i) parseChunk(chunkBounds.at(i), chunkBounds.at(i + 1), chunks.at(i));
+        };
+        if (1 < chunkCount) threadPool->parallelFor(chunkCount, parseChunks);
+        else parseChunks(0, chunkCount);
 
-            } else {
-                if ("v" == line || "vt" == line || "vn" == line || "f" == line) return false; // valid and supported prefix but, missing data
-                else continue; //NOTE: this case handles both gibberish lines (incl. something like v10.2 10.5 12.1 - missing space after 'v') and lines prefixed by valid obj commands that we do not support here
-            }
+        // 3. concatenate the chunks, offsetting each chunk's relative indices by the element counts of the chunks before it...
 
-            // otherwise, continue as normal
+        std::size_t vertCount = 0, uvCount = 0, normalCount = 0, pointCount = 0;
+        for (ChunkData const& chunk : chunks) {
+            if (!chunk.isValid) return false; // invalid format
+            vertCount += chunk.verts.size();
+            uvCount += chunk.uvs.size();
+            normalCount += chunk.normals.size();
+            pointCount += chunk.trianglePoints.size();
+        }
+        out_data.verts.reserve(vertCount);
+        out_data.uvs.reserve(uvCount);
+        out_data.normals.reserve(normalCount);
+        out_data.trianglePoints.reserve(pointCount);
+
+        for (ChunkData &chunk : chunks) {
+            glm::ivec3 const offset(out_data.verts.size(), out_data.uvs.size(), out_data.normals.size());
+            for (std::size_t const slot : chunk.relativeIndexSlots) chunk.trianglePoints.at(slot / 3)[slot % 3] += offset[slot % 3];
+
+            out_data.verts.insert(out_data.verts.end(), chunk.verts.begin(), chunk.verts.end());
+            out_data.uvs.insert(out_data.uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+            out_data.normals.insert(out_data.normals.end(), chunk.normals.begin(), chunk.normals.end());
+            out_data.trianglePoints.insert(out_data.trianglePoints.end(), chunk.trianglePoints.begin(), chunk.trianglePoints.end());
+            chunk = ChunkData(); // release it early, large files hold a lot in the chunks
         }
 
         // FILE HAS BEEN READ WITHOUT ERROR
@@ -254,57 +314,63 @@ namespace wave_tool {
 
         //NOTE: file must have contained verts and faces
         //NOTE: this error could also happen if file was empty or gibberish
-        if (out_verts.size() == 0 || out_faces.size() == 0) return false;
+        if (out_data.verts.empty() || out_data.trianglePoints.empty()) return false;
 
         //NOTE: all points (making up all faces) in the file must be in the same index format (e.g. v0 v1 v2 == v0// v1// v2//, but v0/vt1/ ... != v0//vn0 ...)
-        //NOTE: only need to check the state of vtIndex/vnIndex since error checking in the f-section already made sure every point had a valid vIndex.
         //NOTE: also must check if every index in in range of their respective vector
 
         // first, we can figure out the format to look for based on the first point
-        glm::vec3 const& firstPoint = out_faces.at(0).at(0);
+        glm::ivec3 const& firstPoint = out_data.trianglePoints.at(0);
         bool const vtIndexExpected = -1 != firstPoint.y;
         bool const vnIndexExpected = -1 != firstPoint.z;
 
-        // loop through all faces...
-        for (std::vector<glm::vec3> const& f : out_faces) {
-            for (glm::vec3 const& p : f) {
+        for (glm::ivec3 const& p : out_data.trianglePoints) {
+            // 1. check index format is consistent...
+            if (vtIndexExpected != (-1 != p.y)) return false; // mismatch of index format
+            if (vnIndexExpected != (-1 != p.z)) return false; // mismatch of index format
 
-                // 1. check index format is consistent...
+            // 2. check each index is in respective vector range (a relative index that reached before the first element ends up negative)...
+            if (p.x < 0 || out_data.verts.size() <= (std::size_t)p.x) return false;
+            if (vtIndexExpected && (p.y < 0 || out_data.uvs.size() <= (std::size_t)p.y)) return false;
+            if (vnIndexExpected && (p.z < 0 || out_data.normals.size() <= (std::size_t)p.z)) return false;
+        }
 
-                bool const vtFound = -1 != p.y;
-                if (vtIndexExpected != vtFound) return false; // mismatch of index format
+        return true;
+    }
 
-                bool const vnFound = -1 != p.z;
-                if (vnIndexExpected != vnFound) return false; // mismatch of index format
 
-                // 2. check each index is in respective vector range...
-                //NOTE: only need to check if index exists (!= -1)
 
-                if (out_verts.size() <= p.x) return false;
-                if (vtFound && out_uvs.size() <= p.y) return false;
-                if (vnFound && out_normals.size() <= p.z) return false;
-            }
-        }
+    std::shared_ptr<MeshObject> ObjectLoader::createTriMeshObject(std::string const& filePath, bool const ignoreUVS, bool const ignoreNormals, std::shared_ptr<ThreadPool> const& threadPool) {
+        if (!hasOBJExtension(filePath)) return nullptr;
 
-        return true;
-    }
+        MappedFile const file(filePath, true);
+        if (!file.isOpen()) return nullptr; // if opening failed (e.g. invalid path), error
 
+        // 0. reuse the binary cache next to the file, unless the file (or the options) changed since it was written...
+        //NOTE: the mesh keeps the cache mapped until its buffers are assigned, and its CPU-side vectors stay empty
 
+        std::uint64_t const sourceHash = hashContents(file.data(), file.size());
+        std::uint32_t const loaderFlags = (ignoreUVS ? (std::uint32_t)MeshCache::IGNORE_UVS : 0u) | (ignoreNormals ? (std::uint32_t)MeshCache::IGNORE_NORMALS : 0u);
+        std::string const cachePath = MeshCache::getCachePath(filePath);
 
-    std::shared_ptr<MeshObject> ObjectLoader::createTriMeshObject(std::string const& filePath, bool const ignoreUVS, bool const ignoreNormals) {
-        std::vector<glm::vec3> parsedVerts;
-        std::vector<glm::vec2> parsedUVs;
-        std::vector<glm::vec3> parsedNormals;
-        std::vector<std::vector<glm::vec3>> parsedFaces;
+        std::shared_ptr<MeshCache::Mapping const> const cached = MeshCache::open(cachePath, sourceHash, loaderFlags);
+        if (nullptr != cached) {
+            std::shared_ptr<MeshObject> triMesh = std::make_shared<MeshObject>();
+            triMesh->cachedStreams = cached;
+            triMesh->setLocalBounds(cached->getLocalBounds(), cached->getLocalBoundingSphere());
+            triMesh->hasTexture = cached->hasStream(MeshCache::UVS);
+            return triMesh;
+        }
 
-        if (!loadTriMeshOBJ(filePath, parsedVerts, parsedUVs, parsedNormals, parsedFaces)) return nullptr; // parsing error
+        OBJData parsed;
+        if (!parseTriMeshOBJ(file, parsed, threadPool)) return nullptr; // parsing error
 
         //NOTE: guaranteed to have verts and faces by parser (if obj file is valid). UVs and Normals may not be found in file.
         //NOTE: the parser guarantees that we have a pure tri mesh
         //NOTE: an obj file with faces that don't specify uvs or normals or both, but the file still contains vt or vn lines is valid (we just have to ignore this extra data provided to us)
 
         // 1. can look at format of a point (they are all the same format) to figure out what data each face is made up of...
-        glm::vec3 const& firstPoint = parsedFaces.at(0).at(0);
+        glm::ivec3 const& firstPoint = parsed.trianglePoints.at(0);
         bool const vtFound = -1 != firstPoint.y;
         bool const vnFound = -1 != firstPoint.z;
 
@@ -315,122 +381,45 @@ namespace wave_tool {
         bool const includeNormals = vnFound && !ignoreNormals;
 
         // 3. process the parsed data into an OpenGL single-index-buffer compatible format...
-
-        //std::shared_ptr<MeshObject> triMesh = std::make_shared<MeshObject>();
-
-        std::vector<glm::vec3> drawVerts;
-        std::vector<glm::vec3> normals;
-        std::vector<glm::vec2> uvs;
-        std::vector<GLuint> drawFaces;
-
-
-        // 4 CASES...
-
         //NOTE: remember that the parser won't return false if the file has unreferenced data (e.g. a v line whose index is never mentioned in any face) - thus, below we must only add referenced data to meshobject
-        //NOTE: the parser also doesn't check each section for unique data (e.g. are all v lines unique?), but this is assumed in every obj file. - anyway, we we extract unique data anyway
-
-        if (!includeUVs && !includeNormals) { // TRIVIAL CASE (just verts and faces)
-
-            std::vector<int> vIndices; // stores unique singles
-
-            for (std::vector<glm::vec3> const& f : parsedFaces) {
-                for (glm::vec3 const& p : f) {
-
-                    int const vIndex = p.x;
-
-                    auto it = std::find(vIndices.begin(), vIndices.end(), vIndex);
-                    if (vIndices.end() != it) { // duplicate single
-                        unsigned int const index = it - vIndices.begin();
-                        drawFaces.push_back(index);
-                    } else { // new single
-                        vIndices.push_back(vIndex);
-                        drawVerts.push_back(parsedVerts.at(vIndex));
-                        drawFaces.push_back(vIndices.size() - 1);
-                    }
-                }
-            }
-
-        } else if (includeUVs && !includeNormals) { // verts, uvs and faces
+        //NOTE: every unique (v, vt, vn) triple becomes one vertex (excluded attributes are keyed as -1, so they don't split vertices)
 
-            std::vector<glm::vec2> v_vtIndexPairs; // stores unique pairs
-
-            for (std::vector<glm::vec3> const& f : parsedFaces) {
-                for (glm::vec3 const& p : f) {
-
-                    glm::vec2 const pair = glm::vec2(p.x, p.y);
-
-                    auto it = std::find(v_vtIndexPairs.begin(), v_vtIndexPairs.end(), pair);
-                    if (v_vtIndexPairs.end() != it) { // duplicate pair
-                        unsigned int const index = it - v_vtIndexPairs.begin();
-                        drawFaces.push_back(index);
-                    } else { // new pair
-                        v_vtIndexPairs.push_back(pair);
-                        drawVerts.push_back(parsedVerts.at(pair.x));
-                        uvs.push_back(parsedUVs.at(pair.y));
-                        drawFaces.push_back(v_vtIndexPairs.size() - 1);
-                    }
-                }
-            }
-
-        } else if (!includeUVs && includeNormals) { // verts, normals and faces
-
-            std::vector<glm::vec2> v_vnIndexPairs; // stores unique pairs
-
-            for (std::vector<glm::vec3> const& f : parsedFaces) {
-                for (glm::vec3 const& p : f) {
-
-                    glm::vec2 const pair = glm::vec2(p.x, p.z);
-
-                    auto it = std::find(v_vnIndexPairs.begin(), v_vnIndexPairs.end(), pair);
-                    if (v_vnIndexPairs.end() != it) { // duplicate pair
-                        unsigned int const index = it - v_vnIndexPairs.begin();
-                        drawFaces.push_back(index);
-                    } else { // new pair
-                        v_vnIndexPairs.push_back(pair);
-                        drawVerts.push_back(parsedVerts.at(pair.x));
-                        normals.push_back(parsedNormals.at(pair.y));
-                        drawFaces.push_back(v_vnIndexPairs.size() - 1);
-                    }
-                }
+        std::shared_ptr<MeshObject> triMesh = std::make_shared<MeshObject>();
+        std::vector<glm::vec3> &drawVerts = triMesh->drawVerts;
+        std::vector<glm::vec3> &normals = triMesh->normals;
+        std::vector<glm::vec2> &uvs = triMesh->uvs;
+        std::vector<GLuint> &drawFaces = triMesh->drawFaces;
+
+        std::unordered_map<glm::ivec3, GLuint, IndexTripleHash> uniqueIndexTriples;
+        uniqueIndexTriples.reserve(parsed.verts.size());
+        drawFaces.reserve(parsed.trianglePoints.size());
+
+        for (glm::ivec3 const& p : parsed.trianglePoints) {
+            glm::ivec3 const triple(p.x, includeUVs ? p.y : -1, includeNormals ? p.z : -1);
+
+            auto const inserted = uniqueIndexTriples.emplace(triple, (GLuint)drawVerts.size());
+            if (inserted.second) { // new triple
+                drawVerts.push_back(parsed.verts.at(triple.x));
+                if (includeUVs) uvs.push_back(parsed.uvs.at(triple.y));
+                if (includeNormals) normals.push_back(parsed.normals.at(triple.z));
             }
+            drawFaces.push_back(inserted.first->second);
+        }
 
-        } else { // verts, uvs, normals and faces
-
-            std::vector<glm::vec3> v_vt_vnIndexTriples; // stores unique triples
-
-            for (std::vector<glm::vec3> const& f : parsedFaces) {
-                for (glm::vec3 const& p : f) {
-
-                    glm::vec3 const triple = p;
+        // init vert colours (uniform light grey for now)
+        triMesh->colours.assign(drawVerts.size(), glm::vec3(0.8f, 0.8f, 0.8f));
 
-                    auto it = std::find(v_vt_vnIndexTriples.begin(), v_vt_vnIndexTriples.end(), triple);
-                    if (v_vt_vnIndexTriples.end() != it) { // duplicate triple
-                        unsigned int const index = it - v_vt_vnIndexTriples.begin();
-                        drawFaces.push_back(index);
-                    } else { // new triple
-                        v_vt_vnIndexTriples.push_back(triple);
-                        drawVerts.push_back(parsedVerts.at(triple.x));
-                        uvs.push_back(parsedUVs.at(triple.y));
-                        normals.push_back(parsedNormals.at(triple.z));
-                        drawFaces.push_back(v_vt_vnIndexTriples.size() - 1);
-                    }
-                }
-            }
+        if (triMesh->uvs.size() > 0) triMesh->hasTexture = true; //TODO: probably gonna remove this hasTexture field later on
 
-        }
+        // 4. reorder for the GPU's vertex cache (and overdraw / vertex fetch) - this runs once per source file, since the cache stores the result...
 
-        std::shared_ptr<MeshObject> triMesh = std::make_shared<MeshObject>();
-        triMesh->drawVerts = drawVerts;
-        triMesh->uvs = uvs;
-        triMesh->normals = normals;
-        triMesh->drawFaces = drawFaces;
+        MeshOptimizer::Statistics const statistics = MeshOptimizer::optimize(*triMesh);
+        std::cout << "mesh [ " << filePath << " ] ACMR [ " << statistics.acmrBefore << " -> " << statistics.acmrAfter << " ]" << std::endl;
 
-        // init vert colours (uniform light grey for now)
-        for (unsigned int i = 0; i < triMesh->drawVerts.size(); ++i) {
-            triMesh->colours.push_back(glm::vec3(0.8f, 0.8f, 0.8f));
-        }
+        // 5. write the cache for next time (a failure, e.g. a read-only directory, only costs the next load a re-parse)...
 
-        if (triMesh->uvs.size() > 0) triMesh->hasTexture = true; //TODO: probably gonna remove this hasTexture field later on
+        triMesh->computeBounds();
+        if (!MeshCache::write(cachePath, *triMesh, sourceHash, loaderFlags)) std::cout << "ERROR: failed to write mesh cache " << cachePath << std::endl;
 
         return triMesh;
     }
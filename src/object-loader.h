@@ -44,15 +44,29 @@
 #include "mesh-object.h"
 
 namespace wave_tool {
+    class MappedFile;
+    class ThreadPool;
+
     class ObjectLoader {
         public:
+            // the parsed contents of an .obj file (every polygon is fan-triangulated)
+            struct OBJData {
+                std::vector<glm::vec3> verts;
+                std::vector<glm::vec2> uvs;
+                std::vector<glm::vec3> normals;
+                std::vector<glm::ivec3> trianglePoints; // 3 per triangle, each a 0-based (v, vt, vn) index triple (-1 if missing)
+            };
+
             // newer better loader that should be used
-            //NOTE: will return indices starting from 0 (not 1 like obj format)
-            //NOTE: assumes that all faces are triangles, otherwise returns false
-            static bool loadTriMeshOBJ(std::string const& filePath, std::vector<glm::vec3> &out_verts, std::vector<glm::vec2> &out_uvs, std::vector<glm::vec3> &out_normals, std::vector<std::vector<glm::vec3>> &out_faces);
+            //NOTE: will return indices starting from 0 (not 1 like obj format), negative (relative) indices are resolved
+            //NOTE: quads and other polygons are fan-triangulated
+            //NOTE: if a thread pool is given, large files are parsed in parallel
+            static bool loadTriMeshOBJ(std::string const& filePath, OBJData &out_data, std::shared_ptr<ThreadPool> const& threadPool = nullptr);
 
-            static std::shared_ptr<MeshObject> createTriMeshObject(std::string const& filePath, bool const ignoreUVS = false, bool const ignoreNormals = false);
+            //NOTE: the processed mesh is cached as a .wtmesh file next to the .obj (see MeshCache), which is used instead of parsing while the .obj's contents are unchanged
+            static std::shared_ptr<MeshObject> createTriMeshObject(std::string const& filePath, bool const ignoreUVS = false, bool const ignoreNormals = false, std::shared_ptr<ThreadPool> const& threadPool = nullptr);
         private:
+            static bool parseTriMeshOBJ(MappedFile const& file, OBJData &out_data, std::shared_ptr<ThreadPool> const& threadPool);
 
     };
 }
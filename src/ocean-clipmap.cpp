@@ -0,0 +1,134 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "ocean-clipmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace wave_tool
+{
+    void OceanClipmap::setParameters(Parameters const &parameters)
+    {
+        m_parameters = parameters;
+        if (m_parameters.cellsPerTile < 2 || 0 != m_parameters.cellsPerTile % 2)
+        {
+            std::cout << "ERROR: clipmap cells per tile must be even and at least 2, using 16" << std::endl;
+            m_parameters.cellsPerTile = 16;
+        }
+        m_parameters.finestTileSize = std::max(m_parameters.finestTileSize, 0.001f);
+        m_parameters.levelCount = std::clamp(m_parameters.levelCount, 1u, MAX_LEVEL_COUNT);
+        // a level reaches at most a tile diagonal past its range, which must stay out of the next level's morph range (2 * ratio * range), or the levels crack apart
+        m_parameters.rangeInTiles = std::max(m_parameters.rangeInTiles, 3.0f);
+        float const minMorphStartRatio{(m_parameters.rangeInTiles + std::sqrt(2.0f)) / (2.0f * m_parameters.rangeInTiles)};
+        m_parameters.morphStartRatio = std::clamp(m_parameters.morphStartRatio, minMorphStartRatio, 0.95f);
+    }
+
+    void OceanClipmap::select(glm::vec3 const &cameraPosition, geometry::Frustum const &frustum, float const displaceableAmplitude)
+    {
+        m_tiles.clear();
+
+        // the coarsest tiles within range of the camera (on the world-space grid of that level, so the tiles only move in whole tiles)
+        unsigned int const coarsestLevel{m_parameters.levelCount - 1};
+        float const coarsestSize{getTileSize(coarsestLevel)};
+        float const range{getRange(coarsestLevel)};
+        glm::ivec2 const first{glm::floor((glm::vec2{cameraPosition.x, cameraPosition.z} - range) / coarsestSize)};
+        glm::ivec2 const last{glm::floor((glm::vec2{cameraPosition.x, cameraPosition.z} + range) / coarsestSize)};
+        unsigned int const allPlanes{(1u << frustum.planeCount) - 1u};
+        for (int z = first.y; z <= last.y; ++z)
+        {
+            for (int x = first.x; x <= last.x; ++x)
+                selectNode(coarsestSize * glm::vec2{x, z}, coarsestLevel, cameraPosition, frustum, displaceableAmplitude, allPlanes);
+        }
+    }
+
+    float OceanClipmap::getRange(unsigned int const level) const
+    {
+        return m_parameters.rangeInTiles * getTileSize(level);
+    }
+
+    float OceanClipmap::getTileSize(unsigned int const level) const
+    {
+        return std::ldexp(m_parameters.finestTileSize, static_cast<int>(level));
+    }
+
+    unsigned int OceanClipmap::getCellCount() const
+    {
+        unsigned int count{0};
+        for (Tile const &tile : m_tiles)
+            count += tile.cellCount * tile.cellCount;
+        return count;
+    }
+
+    bool OceanClipmap::selectNode(glm::vec2 const &origin, unsigned int const level, glm::vec3 const &cameraPosition, geometry::Frustum const &frustum, float const displaceableAmplitude, unsigned int const planeMask)
+    {
+        float const size{getTileSize(level)};
+        // distance from the camera to the closest point of the (undisplaced) tile, the same distance water-grid.tes morphs by
+        glm::vec2 const cameraXZ{cameraPosition.x, cameraPosition.z};
+        glm::vec2 const closestXZ{glm::clamp(cameraXZ, origin, origin + size)};
+        float const distanceToTile{glm::distance(cameraPosition, glm::vec3{closestXZ.x, 0.0f, closestXZ.y})};
+        if (distanceToTile > getRange(level))
+            return false;
+
+        // culled tiles count as selected (their parent doesn't need to draw them either)
+        unsigned int insideMask;
+        if (!frustum.intersects(getBounds(origin, size, displaceableAmplitude), planeMask, insideMask))
+            return true;
+
+        // NOTE: a coarser tile is only drawn where none of it is within the finer range, so the finer vertices along a shared edge are always fully morphed
+        if (0 == level || distanceToTile > getRange(level - 1))
+        {
+            m_tiles.push_back(Tile{origin, size, m_parameters.cellsPerTile, level});
+            return true;
+        }
+
+        // the quadrants out of range of the finer level are drawn at this level (half the cells over half the size keeps the vertex spacing)
+        float const childSize{0.5f * size};
+        for (unsigned int quadrant = 0; quadrant < 4; ++quadrant)
+        {
+            glm::vec2 const childOrigin{origin + childSize * glm::vec2{quadrant & 1u, quadrant >> 1}};
+            unsigned int childInsideMask;
+            if (!selectNode(childOrigin, level - 1, cameraPosition, frustum, displaceableAmplitude, insideMask) &&
+                frustum.intersects(getBounds(childOrigin, childSize, displaceableAmplitude), insideMask, childInsideMask))
+                m_tiles.push_back(Tile{childOrigin, childSize, m_parameters.cellsPerTile / 2, level});
+        }
+        return true;
+    }
+
+    geometry::AABB OceanClipmap::getBounds(glm::vec2 const &origin, float const size, float const displaceableAmplitude) const
+    {
+        // the waves can move the surface up to displaceableAmplitude in any direction
+        return geometry::AABB{glm::vec3{origin.x - displaceableAmplitude, -displaceableAmplitude, origin.y - displaceableAmplitude},
+                              glm::vec3{origin.x + size + displaceableAmplitude, displaceableAmplitude, origin.y + size + displaceableAmplitude}};
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef WAVE_TOOL_OCEAN_CLIPMAP_H_
+#define WAVE_TOOL_OCEAN_CLIPMAP_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "bounding-volumes.h"
+
+namespace wave_tool
+{
+    // camera-centred level of detail for the water surface, as an alternative to the projected grid (no GL dependency)
+    // the base plane is covered by a world-aligned quadtree of square tiles (level 0 is the finest, every level doubles the tile size)
+    // a tile is split while the camera is within its children's range, which gives nested rings of tiles around the camera - every tile is drawn with the same fixed grid topology
+    // near the end of its range, every odd vertex of a tile's lattice morphs onto the lattice of the next coarser level, so neighbouring levels meet without cracks (see water-grid.tes)
+    // reference: Strugar - Continuous Distance-Dependent Level of Detail for Rendering Heightmaps (2009)
+    // reference: Losasso & Hoppe - Geometry Clipmaps: Terrain Rendering Using Nested Regular Grids (2004)
+    class OceanClipmap
+    {
+    public:
+        struct Parameters
+        {
+            float finestTileSize{2.0f};      // in range (0.0, inf) - width of a level 0 tile
+            unsigned int cellsPerTile{16};   // even, in range [2, inf) - grid cells per tile side (every level has the same topology)
+            unsigned int levelCount{6};      // in range [1, MAX_LEVEL_COUNT]
+            float rangeInTiles{4.0f};        // in range [3.0, inf) - level l is used up to rangeInTiles * (tile size of level l) from the camera
+            float morphStartRatio{0.75f};    // in range [(rangeInTiles + sqrt(2)) / (2 * rangeInTiles), 0.95] - the vertices of a level start to morph at this fraction of its range
+        };
+
+        struct Tile
+        {
+            glm::vec2 origin;         // world-space xz of the corner with the smallest coordinates
+            float size;               // world-space width (a tile drawn by its parent for one of its quadrants is half a tile of that level)
+            unsigned int cellCount;   // grid cells per side
+            unsigned int level;
+        };
+
+        inline static unsigned int const MAX_LEVEL_COUNT{16};
+
+        void setParameters(Parameters const &parameters);
+        inline Parameters const &getParameters() const { return m_parameters; }
+
+        // selects the tiles around the camera that intersect the frustum
+        // NOTE: displaceableAmplitude bounds the displacement of the surface in every axis, so tiles are culled conservatively
+        void select(glm::vec3 const &cameraPosition, geometry::Frustum const &frustum, float const displaceableAmplitude);
+
+        inline std::vector<Tile> const &getTiles() const { return m_tiles; }
+        // distance from the camera up to which a level is used
+        float getRange(unsigned int const level) const;
+        // the morph of a level's vertices happens over [getMorphStart(level), getRange(level)]
+        inline float getMorphStart(unsigned int const level) const { return m_parameters.morphStartRatio * getRange(level); }
+        float getTileSize(unsigned int const level) const;
+        // grid cells over all selected tiles
+        unsigned int getCellCount() const;
+
+    private:
+        Parameters m_parameters;
+        std::vector<Tile> m_tiles;
+
+        // returns false if the node is out of its level's range (so its parent has to draw the area)
+        bool selectNode(glm::vec2 const &origin, unsigned int const level, glm::vec3 const &cameraPosition, geometry::Frustum const &frustum, float const displaceableAmplitude, unsigned int const planeMask);
+        geometry::AABB getBounds(glm::vec2 const &origin, float const size, float const displaceableAmplitude) const;
+    };
+}
+
+#endif // WAVE_TOOL_OCEAN_CLIPMAP_H_
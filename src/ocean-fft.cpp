@@ -0,0 +1,475 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "ocean-fft.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <glm/gtc/constants.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define WAVE_TOOL_OCEAN_FFT_SSE
+#endif
+
+namespace wave_tool
+{
+    namespace
+    {
+        float const GRAVITY{9.81f};
+
+        bool isPowerOfTwo(unsigned int const n)
+        {
+            return 0 != n && 0 == (n & (n - 1));
+        }
+
+        // maps an FFT-order index to its signed wavenumber index
+        int toWavenumberIndex(unsigned int const n, unsigned int const N)
+        {
+            return n < N / 2 ? (int)n : (int)n - (int)N;
+        }
+    }
+
+    bool OceanFFT::Parameters::operator==(Parameters const &other) const
+    {
+        return resolution == other.resolution && patchLengthInMeters == other.patchLengthInMeters && spectrum == other.spectrum && windSpeed == other.windSpeed && windDirectionInDegrees == other.windDirectionInDegrees && fetchInMeters == other.fetchInMeters && amplitudeScale == other.amplitudeScale && choppiness == other.choppiness && smallWaveCutoffInMeters == other.smallWaveCutoffInMeters && seed == other.seed;
+    }
+
+    OceanFFT::OceanFFT(std::shared_ptr<ThreadPool> const &threadPool)
+        : m_threadPool{threadPool}
+    {
+        assert(nullptr != m_threadPool);
+        generateInitialSpectrum();
+    }
+
+    void OceanFFT::setParameters(Parameters const &parameters)
+    {
+        if (parameters == m_parameters)
+            return;
+
+        m_parameters = parameters;
+        if (!isPowerOfTwo(m_parameters.resolution) || m_parameters.resolution < 16 || m_parameters.resolution > 1024)
+        {
+            std::cout << "ERROR: ocean FFT resolution must be a power of 2 in range [16, 1024], using 256" << std::endl;
+            m_parameters.resolution = 256;
+        }
+        generateInitialSpectrum();
+    }
+
+    void OceanFFT::update(float const timeInSeconds)
+    {
+        evolveSpectrum(timeInSeconds);
+
+        for (unsigned int field = 0; field < s_FIELD_COUNT; ++field)
+            inverseFFT2D(m_fieldsRe.at(field).data(), m_fieldsIm.at(field).data());
+
+        assembleMaps();
+    }
+
+    void OceanFFT::generateInitialSpectrum()
+    {
+        unsigned int const N{m_parameters.resolution};
+        std::size_t const texelCount{(std::size_t)N * N};
+
+        m_h0Re.assign(texelCount, 0.0f);
+        m_h0Im.assign(texelCount, 0.0f);
+        m_omega.assign(texelCount, 0.0f);
+        for (unsigned int field = 0; field < s_FIELD_COUNT; ++field)
+        {
+            m_fieldsRe.at(field).assign(texelCount, 0.0f);
+            m_fieldsIm.at(field).assign(texelCount, 0.0f);
+        }
+        m_displacementMap.assign(4 * texelCount, 0.0f);
+        m_normalFoldingMap.assign(4 * texelCount, 0.0f);
+        m_rowMaxima.assign(N, glm::vec2{0.0f});
+        m_maxHeight = 0.0f;
+        m_maxHorizontalDisplacement = 0.0f;
+
+        // FFT tables...
+        unsigned int bitCount{0};
+        while ((1u << bitCount) < N)
+            ++bitCount;
+        m_bitReversal.resize(N);
+        for (unsigned int i = 0; i < N; ++i)
+        {
+            unsigned int reversed{0};
+            for (unsigned int bit = 0; bit < bitCount; ++bit)
+                reversed |= ((i >> bit) & 1u) << (bitCount - 1 - bit);
+            m_bitReversal.at(i) = reversed;
+        }
+        m_twiddleRe.resize(N / 2);
+        m_twiddleIm.resize(N / 2);
+        for (unsigned int j = 0; j < N / 2; ++j)
+        {
+            double const angle{glm::two_pi<double>() * j / N};
+            m_twiddleRe.at(j) = (float)std::cos(angle);
+            m_twiddleIm.at(j) = (float)std::sin(angle);
+        }
+
+        // h0(k) = (xi_r + i * xi_i) / sqrt(2) * sqrt(Psi(k) * dk^2 / 2) with xi ~ N(0, 1)
+        // NOTE: with h(k, t) = h0(k) * e^(iwt) + conj(h0(-k)) * e^(-iwt), the height variance sums to the integral of Psi over the k-plane
+        // NOTE: generated serially (in a fixed order) so a seed always produces the same ocean regardless of the thread count
+        std::mt19937 generator{m_parameters.seed};
+        std::normal_distribution<float> gaussian{0.0f, 1.0f};
+        float const deltaK{glm::two_pi<float>() / m_parameters.patchLengthInMeters};
+        for (unsigned int row = 0; row < N; ++row)
+        {
+            for (unsigned int col = 0; col < N; ++col)
+            {
+                glm::vec2 const k{deltaK * toWavenumberIndex(col, N), deltaK * toWavenumberIndex(row, N)};
+                std::size_t const index{(std::size_t)row * N + col};
+                float const amplitude{std::sqrt(0.25f * evaluateSpectrum(k) * deltaK * deltaK)};
+                float const xi_r{gaussian(generator)};
+                float const xi_i{gaussian(generator)};
+                m_h0Re.at(index) = xi_r * amplitude;
+                m_h0Im.at(index) = xi_i * amplitude;
+                // deep water dispersion relation
+                m_omega.at(index) = std::sqrt(GRAVITY * glm::length(k));
+            }
+        }
+    }
+
+    float OceanFFT::evaluateSpectrum(glm::vec2 const &k) const
+    {
+        float const kLength{glm::length(k)};
+        if (kLength < 1.0e-6f)
+            return 0.0f;
+
+        float const windAngle{glm::radians(m_parameters.windDirectionInDegrees)};
+        glm::vec2 const windDirection{std::cos(windAngle), std::sin(windAngle)};
+        float const cosTheta{glm::dot(k / kLength, windDirection)};
+        float const smallWaveDamping{std::exp(-kLength * kLength * m_parameters.smallWaveCutoffInMeters * m_parameters.smallWaveCutoffInMeters)};
+
+        float psi{0.0f};
+        switch (m_parameters.spectrum)
+        {
+        case Spectrum::JONSWAP:
+        {
+            // reference: Hasselmann et al. (1973), fetch-limited parameterization
+            float const U{m_parameters.windSpeed};
+            float const F{m_parameters.fetchInMeters};
+            float const alpha{0.076f * std::pow(U * U / (F * GRAVITY), 0.22f)};
+            float const omegaPeak{22.0f * std::cbrt(GRAVITY * GRAVITY / (U * F))};
+            float const gamma{3.3f};
+
+            float const omega{std::sqrt(GRAVITY * kLength)};
+            float const sigma{omega <= omegaPeak ? 0.07f : 0.09f};
+            float const r{std::exp(-(omega - omegaPeak) * (omega - omegaPeak) / (2.0f * sigma * sigma * omegaPeak * omegaPeak))};
+            float const S{alpha * GRAVITY * GRAVITY / std::pow(omega, 5.0f) * std::exp(-1.25f * std::pow(omegaPeak / omega, 4.0f)) * std::pow(gamma, r)};
+
+            // S(w) -> Psi(k) with dw/dk = g / 2w, the polar Jacobian 1/k and a cos^2 spreading over the downwind half-plane (integrates to 1)
+            float const spreading{cosTheta > 0.0f ? (2.0f / glm::pi<float>()) * cosTheta * cosTheta : 0.0f};
+            psi = S * (GRAVITY / (2.0f * omega)) / kLength * spreading;
+            break;
+        }
+        case Spectrum::PHILLIPS:
+        default:
+        {
+            // Psi(k) = (alpha / pi) * e^(-1 / (kL)^2) / k^4 * cos^2(theta), which integrates to a height variance of alpha * L^2 / 2 with L = U^2 / g
+            float const alpha{0.0081f};
+            float const L{m_parameters.windSpeed * m_parameters.windSpeed / GRAVITY};
+            float const kL{kLength * L};
+            psi = (alpha / glm::pi<float>()) * std::exp(-1.0f / (kL * kL)) / (kLength * kLength * kLength * kLength) * cosTheta * cosTheta;
+            break;
+        }
+        }
+
+        return m_parameters.amplitudeScale * psi * smallWaveDamping;
+    }
+
+    void OceanFFT::evolveSpectrum(float const timeInSeconds)
+    {
+        unsigned int const N{m_parameters.resolution};
+        float const deltaK{glm::two_pi<float>() / m_parameters.patchLengthInMeters};
+
+        m_threadPool->parallelFor(N, [this, N, deltaK, timeInSeconds](std::size_t rowBegin, std::size_t rowEnd) {
+            for (std::size_t row = rowBegin; row < rowEnd; ++row)
+            {
+                float const kz{deltaK * toWavenumberIndex((unsigned int)row, N)};
+                std::size_t const rowNegK{(N - row) % N};
+                for (unsigned int col = 0; col < N; ++col)
+                {
+                    float const kx{deltaK * toWavenumberIndex(col, N)};
+                    float const kLength{std::sqrt(kx * kx + kz * kz)};
+                    float const invK{kLength > 0.0f ? 1.0f / kLength : 0.0f};
+
+                    std::size_t const index{row * N + col};
+                    std::size_t const indexNegK{rowNegK * N + (N - col) % N};
+
+                    // h(k, t) = h0(k) * e^(iwt) + conj(h0(-k)) * e^(-iwt)
+                    float const phase{m_omega[index] * timeInSeconds};
+                    float const c{std::cos(phase)};
+                    float const s{std::sin(phase)};
+                    float const ar{m_h0Re[index]};
+                    float const ai{m_h0Im[index]};
+                    float const br{m_h0Re[indexNegK]};
+                    float const bi{m_h0Im[indexNegK]};
+                    float const hr{(ar + br) * c - (ai + bi) * s};
+                    float const hi{(ar - br) * s + (ai - bi) * c};
+
+                    // i * k / |k| * h (choppy displacement, pointing towards the crests), i * k * h (slopes), -k_a * k_b / |k| * h (displacement derivatives)
+                    float const dxRe{-kx * invK * hi};
+                    float const dxIm{kx * invK * hr};
+                    float const dzRe{-kz * invK * hi};
+                    float const dzIm{kz * invK * hr};
+                    float const sxRe{-kx * hi};
+                    float const sxIm{kx * hr};
+                    float const szRe{-kz * hi};
+                    float const szIm{kz * hr};
+                    float const dxxRe{-kx * kx * invK * hr};
+                    float const dxxIm{-kx * kx * invK * hi};
+                    float const dzzRe{-kz * kz * invK * hr};
+                    float const dzzIm{-kz * kz * invK * hi};
+                    float const dxzRe{-kx * kz * invK * hr};
+                    float const dxzIm{-kx * kz * invK * hi};
+
+                    // pack A + i * B
+                    m_fieldsRe[0][index] = hr - dxIm;
+                    m_fieldsIm[0][index] = hi + dxRe;
+                    m_fieldsRe[1][index] = dzRe - sxIm;
+                    m_fieldsIm[1][index] = dzIm + sxRe;
+                    m_fieldsRe[2][index] = szRe - dxxIm;
+                    m_fieldsIm[2][index] = szIm + dxxRe;
+                    m_fieldsRe[3][index] = dzzRe - dxzIm;
+                    m_fieldsIm[3][index] = dzzIm + dxzRe;
+                }
+            }
+        });
+    }
+
+    void OceanFFT::assembleMaps()
+    {
+        unsigned int const N{m_parameters.resolution};
+        float const lambda{m_parameters.choppiness};
+
+        // NOTE: the choppy displacement is subtracted (x' = x - lambda * D) since D points towards the crests, which makes them sharper
+        m_threadPool->parallelFor(N, [this, N, lambda](std::size_t rowBegin, std::size_t rowEnd) {
+            for (std::size_t row = rowBegin; row < rowEnd; ++row)
+            {
+                glm::vec2 rowMaximum{0.0f};
+                for (std::size_t col = 0; col < N; ++col)
+                {
+                    std::size_t const index{row * N + col};
+                    float const height{m_fieldsRe[0][index]};
+                    float const displacementX{-lambda * m_fieldsIm[0][index]};
+                    float const displacementZ{-lambda * m_fieldsRe[1][index]};
+                    float const slopeX{m_fieldsIm[1][index]};
+                    float const slopeZ{m_fieldsRe[2][index]};
+                    float const jacobianXX{1.0f - lambda * m_fieldsIm[2][index]};
+                    float const jacobianZZ{1.0f - lambda * m_fieldsRe[3][index]};
+                    float const jacobianXZ{-lambda * m_fieldsIm[3][index]};
+
+                    float *displacement{&m_displacementMap[4 * index]};
+                    displacement[0] = displacementX;
+                    displacement[1] = height;
+                    displacement[2] = displacementZ;
+                    displacement[3] = 0.0f;
+
+                    glm::vec3 const normal{glm::normalize(glm::vec3{-slopeX, 1.0f, -slopeZ})};
+                    float *normalFolding{&m_normalFoldingMap[4 * index]};
+                    normalFolding[0] = normal.x;
+                    normalFolding[1] = normal.y;
+                    normalFolding[2] = normal.z;
+                    normalFolding[3] = jacobianXX * jacobianZZ - jacobianXZ * jacobianXZ;
+
+                    rowMaximum = glm::max(rowMaximum, glm::vec2{std::abs(height), std::max(std::abs(displacementX), std::abs(displacementZ))});
+                }
+                m_rowMaxima[row] = rowMaximum;
+            }
+        });
+
+        for (glm::vec2 const &rowMaximum : m_rowMaxima)
+        {
+            m_maxHeight = std::max(m_maxHeight, rowMaximum.x);
+            m_maxHorizontalDisplacement = std::max(m_maxHorizontalDisplacement, rowMaximum.y);
+        }
+    }
+
+    // 2D FFT = 1D FFTs down every column, then down every row
+    // NOTE: the row pass is done as another column pass on the transposed grid, so every butterfly stays contiguous in memory (SIMD-friendly)
+    void OceanFFT::inverseFFT2D(float *re, float *im) const
+    {
+        std::size_t const N{m_parameters.resolution};
+        std::size_t const blockCount{(N + s_TRANSPOSE_BLOCK_LENGTH - 1) / s_TRANSPOSE_BLOCK_LENGTH};
+        // every chunk boundary falls on a multiple of 16 floats (64 bytes) within a row, so threads share at most the one cache line straddling each boundary
+        // NOTE: not none, since std::vector only guarantees 16-byte alignment (N is a power of 2 of at least 16, so the groups divide the rows exactly)
+        std::size_t const columnGroupCount{N / s_COLUMN_GROUP_LENGTH};
+#ifndef NDEBUG
+        std::vector<float> const inputRe{re, re + N * N};
+        std::vector<float> const inputIm{im, im + N * N};
+#endif
+
+        for (unsigned int pass = 0; pass < 2; ++pass)
+        {
+            m_threadPool->parallelFor(columnGroupCount, [this, re, im](std::size_t groupBegin, std::size_t groupEnd) { inverseFFTColumns(re, im, groupBegin * s_COLUMN_GROUP_LENGTH, groupEnd * s_COLUMN_GROUP_LENGTH); });
+            m_threadPool->parallelFor(blockCount, [this, re, im](std::size_t blockRowBegin, std::size_t blockRowEnd) {
+                transposeRows(re, blockRowBegin, blockRowEnd);
+                transposeRows(im, blockRowBegin, blockRowEnd);
+            });
+        }
+
+        assert(isInverseFFTConsistent(inputRe.data(), inputIm.data(), re, im));
+    }
+
+    bool OceanFFT::isInverseFFTConsistent(float const *inputRe, float const *inputIm, float const *re, float const *im) const
+    {
+        std::size_t const N{m_parameters.resolution};
+        double energy{0.0};
+        for (std::size_t i = 0; i < N * N; ++i)
+            energy += (double)inputRe[i] * inputRe[i] + (double)inputIm[i] * inputIm[i];
+        // NOTE: the rounding error grows with the input's magnitude and (roughly) with the number of butterfly stages
+        double const tolerance{1.0e-5 * std::sqrt(energy) * std::log2((double)N) + 1.0e-6};
+
+        // every angle is a multiple of 2 * pi / N
+        std::vector<double> rootsRe(N);
+        std::vector<double> rootsIm(N);
+        for (std::size_t k = 0; k < N; ++k)
+        {
+            rootsRe.at(k) = std::cos(glm::two_pi<double>() * k / N);
+            rootsIm.at(k) = std::sin(glm::two_pi<double>() * k / N);
+        }
+
+        for (unsigned int point = 0; point < s_CONSISTENCY_CHECK_POINTS; ++point)
+        {
+            // spread over the grid (including the edges)
+            std::size_t const x{(point * (N - 1)) / glm::max(s_CONSISTENCY_CHECK_POINTS - 1, 1u)};
+            std::size_t const z{((point * 7 + 3) * N / 11) % N};
+
+            // out(x, z) = sum over (u, v) of in(u, v) * exp(+2 * pi * i * (u * x + v * z) / N)
+            double sumRe{0.0};
+            double sumIm{0.0};
+            for (std::size_t v = 0; v < N; ++v)
+            {
+                for (std::size_t u = 0; u < N; ++u)
+                {
+                    std::size_t const k{(u * x + v * z) & (N - 1)}; // N is a power of 2
+                    double const c{rootsRe[k]};
+                    double const s{rootsIm[k]};
+                    sumRe += inputRe[v * N + u] * c - inputIm[v * N + u] * s;
+                    sumIm += inputRe[v * N + u] * s + inputIm[v * N + u] * c;
+                }
+            }
+            if (std::abs(sumRe - re[z * N + x]) > tolerance || std::abs(sumIm - im[z * N + x]) > tolerance)
+                return false;
+        }
+        return true;
+    }
+
+    // iterative radix-2 Cooley-Tukey (decimation in time)
+    void OceanFFT::inverseFFTColumns(float *re, float *im, std::size_t const columnBegin, std::size_t const columnEnd) const
+    {
+        std::size_t const N{m_parameters.resolution};
+        std::size_t const width{columnEnd - columnBegin};
+
+        // bit-reversal permutation of the rows...
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            std::size_t const j{m_bitReversal[i]};
+            if (j <= i)
+                continue;
+            std::swap_ranges(re + i * N + columnBegin, re + i * N + columnEnd, re + j * N + columnBegin);
+            std::swap_ranges(im + i * N + columnBegin, im + i * N + columnEnd, im + j * N + columnBegin);
+        }
+
+        // butterflies...
+        for (std::size_t length = 2; length <= N; length *= 2)
+        {
+            std::size_t const halfLength{length / 2};
+            std::size_t const twiddleStride{N / length};
+            for (std::size_t start = 0; start < N; start += length)
+            {
+                for (std::size_t j = 0; j < halfLength; ++j)
+                {
+                    float const wr{m_twiddleRe[j * twiddleStride]};
+                    float const wi{m_twiddleIm[j * twiddleStride]};
+                    float *aRe{re + (start + j) * N + columnBegin};
+                    float *aIm{im + (start + j) * N + columnBegin};
+                    float *bRe{re + (start + j + halfLength) * N + columnBegin};
+                    float *bIm{im + (start + j + halfLength) * N + columnBegin};
+
+                    std::size_t c{0};
+#ifdef WAVE_TOOL_OCEAN_FFT_SSE
+                    __m128 const wr4{_mm_set1_ps(wr)};
+                    __m128 const wi4{_mm_set1_ps(wi)};
+                    for (; c + 4 <= width; c += 4)
+                    {
+                        __m128 const br4{_mm_loadu_ps(bRe + c)};
+                        __m128 const bi4{_mm_loadu_ps(bIm + c)};
+                        __m128 const tr4{_mm_sub_ps(_mm_mul_ps(wr4, br4), _mm_mul_ps(wi4, bi4))};
+                        __m128 const ti4{_mm_add_ps(_mm_mul_ps(wr4, bi4), _mm_mul_ps(wi4, br4))};
+                        __m128 const ar4{_mm_loadu_ps(aRe + c)};
+                        __m128 const ai4{_mm_loadu_ps(aIm + c)};
+                        _mm_storeu_ps(bRe + c, _mm_sub_ps(ar4, tr4));
+                        _mm_storeu_ps(bIm + c, _mm_sub_ps(ai4, ti4));
+                        _mm_storeu_ps(aRe + c, _mm_add_ps(ar4, tr4));
+                        _mm_storeu_ps(aIm + c, _mm_add_ps(ai4, ti4));
+                    }
+#endif
+                    for (; c < width; ++c)
+                    {
+                        float const tr{wr * bRe[c] - wi * bIm[c]};
+                        float const ti{wr * bIm[c] + wi * bRe[c]};
+                        bRe[c] = aRe[c] - tr;
+                        bIm[c] = aIm[c] - ti;
+                        aRe[c] += tr;
+                        aIm[c] += ti;
+                    }
+                }
+            }
+        }
+    }
+
+    // in-place blocked transpose, handling the block rows in [blockRowBegin, blockRowEnd) (each swaps with its mirrored block column)
+    void OceanFFT::transposeRows(float *data, std::size_t const blockRowBegin, std::size_t const blockRowEnd) const
+    {
+        std::size_t const N{m_parameters.resolution};
+        std::size_t const B{s_TRANSPOSE_BLOCK_LENGTH};
+        for (std::size_t blockRow = blockRowBegin; blockRow < blockRowEnd; ++blockRow)
+        {
+            std::size_t const rowBegin{blockRow * B};
+            std::size_t const rowEnd{std::min(N, rowBegin + B)};
+            for (std::size_t colBegin = rowBegin; colBegin < N; colBegin += B)
+            {
+                std::size_t const colEnd{std::min(N, colBegin + B)};
+                for (std::size_t row = rowBegin; row < rowEnd; ++row)
+                {
+                    // diagonal blocks only swap their upper triangle
+                    for (std::size_t col = (colBegin == rowBegin ? row + 1 : colBegin); col < colEnd; ++col)
+                        std::swap(data[row * N + col], data[col * N + row]);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef WAVE_TOOL_OCEAN_FFT_H_
+#define WAVE_TOOL_OCEAN_FFT_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "thread-pool.h"
+
+namespace wave_tool
+{
+    // statistical ocean surface synthesized with inverse FFTs on the CPU (no GL dependency)
+    // reference: Tessendorf - Simulating Ocean Water (2001)
+    // reference: Horvath - Empirical directional wave spectra for computer graphics (2015)
+    // each update produces one tileable patch (patchLengthInMeters wide) of...
+    //  - displacement map: (choppy x, height y, choppy z, 0) in meters
+    //  - normal + folding map: (unit normal xyz, Jacobian determinant of the horizontal displacement) where a determinant <= 0 means the surface folds over itself (foam)
+    // NOTE: both maps are resolution * resolution RGBA floats, row-major with rows along +z and columns along +x
+    class OceanFFT
+    {
+    public:
+        enum Spectrum
+        {
+            PHILLIPS = 0,
+            JONSWAP = 1
+        };
+
+        struct Parameters
+        {
+            unsigned int resolution{256};        // power of 2 in range [16, 1024]
+            float patchLengthInMeters{50.0f};    // in range (0.0, inf)
+            Spectrum spectrum{Spectrum::PHILLIPS};
+            float windSpeed{6.0f};               // in range (0.0, inf) - m/s
+            float windDirectionInDegrees{0.0f};  // angle from +x towards +z
+            float fetchInMeters{100000.0f};      // in range (0.0, inf) - JONSWAP only, distance over which the wind has blown
+            float amplitudeScale{1.0f};          // in range [0.0, inf) - scales the whole spectrum energy
+            float choppiness{1.0f};              // in range [0.0, inf) - horizontal displacement scale (lambda)
+            float smallWaveCutoffInMeters{0.0f}; // in range [0.0, inf) - suppresses waves shorter than about this length
+            unsigned int seed{1};
+
+            bool operator==(Parameters const &other) const;
+            inline bool operator!=(Parameters const &other) const { return !(*this == other); }
+        };
+
+        explicit OceanFFT(std::shared_ptr<ThreadPool> const &threadPool);
+
+        // regenerates the initial spectrum only if anything changed
+        void setParameters(Parameters const &parameters);
+        inline Parameters const &getParameters() const { return m_parameters; }
+
+        // evolves the spectrum to the given time and regenerates both maps
+        void update(float const timeInSeconds);
+
+        inline unsigned int getResolution() const { return m_parameters.resolution; }
+        inline std::vector<float> const &getDisplacementMap() const { return m_displacementMap; }
+        inline std::vector<float> const &getNormalFoldingMap() const { return m_normalFoldingMap; }
+        // the largest |height| seen since the parameters last changed (useful as a conservative displacement bound)
+        inline float getMaxHeight() const { return m_maxHeight; }
+        inline float getMaxHorizontalDisplacement() const { return m_maxHorizontalDisplacement; }
+
+        // in-place 2D inverse DFT (without 1/N^2 scaling) of a resolution * resolution complex grid in SoA form
+        // NOTE: debug builds spot-check every transform against a naive DFT (see isInverseFFTConsistent)
+        void inverseFFT2D(float *re, float *im) const;
+
+    private:
+        static unsigned int const s_FIELD_COUNT{4};
+        static unsigned int const s_TRANSPOSE_BLOCK_LENGTH{32};
+        // columns are handed to threads in whole groups of 16 floats (64 bytes, one cache line on common CPUs)
+        static unsigned int const s_COLUMN_GROUP_LENGTH{16};
+        // output points of every transform that debug builds re-evaluate with a naive DFT (each costs resolution^2 complex multiplies)
+        static unsigned int const s_CONSISTENCY_CHECK_POINTS{4};
+
+        Parameters m_parameters;
+        std::shared_ptr<ThreadPool> m_threadPool = nullptr;
+
+        // initial spectrum h0(k) and dispersion w(k), stored in FFT order (index n is wavenumber n for n < N/2, otherwise n - N)
+        std::vector<float> m_h0Re;
+        std::vector<float> m_h0Im;
+        std::vector<float> m_omega;
+
+        // FFT tables
+        std::vector<unsigned int> m_bitReversal;
+        std::vector<float> m_twiddleRe; // exp(+2 * pi * i * j / N) for j in [0, N / 2)
+        std::vector<float> m_twiddleIm;
+
+        // 8 real fields packed pairwise into 4 complex fields (the inverse FFT of a Hermitian spectrum is real, so the imaginary part is free)
+        // [0] = height + i * displacement x
+        // [1] = displacement z + i * slope x
+        // [2] = slope z + i * d(displacement x)/dx
+        // [3] = d(displacement z)/dz + i * d(displacement x)/dz
+        std::array<std::vector<float>, s_FIELD_COUNT> m_fieldsRe;
+        std::array<std::vector<float>, s_FIELD_COUNT> m_fieldsIm;
+
+        std::vector<float> m_displacementMap;
+        std::vector<float> m_normalFoldingMap;
+        std::vector<glm::vec2> m_rowMaxima; // (|height|, |horizontal displacement|) per row
+        float m_maxHeight{0.0f};
+        float m_maxHorizontalDisplacement{0.0f};
+
+        void generateInitialSpectrum();
+        // directional wavenumber spectrum Psi(k) in m^4 (integrates to the height variance over the k-plane)
+        float evaluateSpectrum(glm::vec2 const &k) const;
+        void evolveSpectrum(float const timeInSeconds);
+        void assembleMaps();
+
+        // inverse FFT along the columns in [columnBegin, columnEnd) (every butterfly combines two whole row segments, which vectorizes across columns)
+        void inverseFFTColumns(float *re, float *im, std::size_t const columnBegin, std::size_t const columnEnd) const;
+        void transposeRows(float *data, std::size_t const blockRowBegin, std::size_t const blockRowEnd) const;
+        // debug check that re/im (the transform of inputRe/inputIm) match a naive DFT at a few points, to within the float error of the butterflies
+        bool isInverseFFTConsistent(float const *inputRe, float const *inputIm, float const *re, float const *im) const;
+    };
+}
+
+#endif // WAVE_TOOL_OCEAN_FFT_H_
@@ -0,0 +1,414 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "ocean-surface.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+#include <glm/gtc/constants.hpp>
+
+#include "render-engine.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#include <immintrin.h>
+#define WAVE_TOOL_OCEAN_SURFACE_SSE
+// the AVX2 kernel is compiled in regardless of the global flags and only selected at runtime if the CPU supports it
+#if defined(__GNUC__) || defined(__clang__)
+#define WAVE_TOOL_OCEAN_SURFACE_AVX2
+#define WAVE_TOOL_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace wave_tool
+{
+    namespace
+    {
+        // raw output pointers of a Samples batch
+        struct SampleStreams
+        {
+            float *positionX;
+            float *positionY;
+            float *positionZ;
+            float *normalX;
+            float *normalY;
+            float *normalZ;
+            float *jacobianDeterminant;
+        };
+
+        // the Gerstner sum and its partial derivatives, matching computeGerstnerSurfacePosition() in water-grid.tes
+        // P(x, z, t) = (x + sum(Q_i * A * D.x * cos(theta)), sum(A * sin(theta)), z + sum(Q_i * A * D.y * cos(theta))), theta = w * dot(D, (x, z)) + phi * t + phaseOffset
+        void evaluateScalar(OceanSurface::WaveConstants const *waves, std::size_t const waveCount, float const verticalBounceWaveDisplacement,
+                            float const *x, float const *z, float const *t, std::size_t const begin, std::size_t const end, SampleStreams const &out)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                glm::vec3 position{x[i], verticalBounceWaveDisplacement, z[i]};
+                glm::vec3 tangentX{1.0f, 0.0f, 0.0f}; // dP/dx
+                glm::vec3 tangentZ{0.0f, 0.0f, 1.0f}; // dP/dz
+                for (std::size_t w = 0; w < waveCount; ++w)
+                {
+                    OceanSurface::WaveConstants const &wave{waves[w]};
+                    float const theta{wave.frequencyDirectionX * x[i] + wave.frequencyDirectionZ * z[i] + wave.phaseConstant * t[i] + wave.phaseOffset};
+                    float const s{std::sin(theta)};
+                    float const c{std::cos(theta)};
+
+                    position += glm::vec3{wave.steepAmplitudeX * c, wave.amplitude * s, wave.steepAmplitudeZ * c};
+                    tangentX += glm::vec3{-wave.curvatureXX * s, wave.slopeX * c, -wave.curvatureXZ * s};
+                    tangentZ += glm::vec3{-wave.curvatureXZ * s, wave.slopeZ * c, -wave.curvatureZZ * s};
+                }
+
+                glm::vec3 const normal{glm::normalize(glm::cross(tangentZ, tangentX))};
+                out.positionX[i] = position.x;
+                out.positionY[i] = position.y;
+                out.positionZ[i] = position.z;
+                out.normalX[i] = normal.x;
+                out.normalY[i] = normal.y;
+                out.normalZ[i] = normal.z;
+                out.jacobianDeterminant[i] = tangentX.x * tangentZ.y - tangentZ.x * tangentX.y;
+            }
+        }
+
+        // polynomial sin/cos (Cephes single precision), accurate to a few ulp for |theta| < 8192
+        // reduction: theta = j * pi/4 + r with j even and |r| <= pi/4, then the quadrant (j / 2) picks the polynomial and signs
+        float const FOUR_OVER_PI{1.27323954473516f};
+        float const PI_OVER_FOUR_PART_1{0.78515625f};
+        float const PI_OVER_FOUR_PART_2{2.4187564849853515625e-4f};
+        float const PI_OVER_FOUR_PART_3{3.77489497744594108e-8f};
+        float const SIN_COEFFICIENT_1{-1.9515295891e-4f};
+        float const SIN_COEFFICIENT_2{8.3321608736e-3f};
+        float const SIN_COEFFICIENT_3{-1.6666654611e-1f};
+        float const COS_COEFFICIENT_1{2.443315711809948e-5f};
+        float const COS_COEFFICIENT_2{-1.388731625493765e-3f};
+        float const COS_COEFFICIENT_3{4.166664568298827e-2f};
+
+#ifdef WAVE_TOOL_OCEAN_SURFACE_SSE
+        inline void sinCosSSE(__m128 const theta, __m128 &out_sin, __m128 &out_cos)
+        {
+            __m128 const signMask{_mm_castsi128_ps(_mm_set1_epi32((int)0x80000000))};
+            __m128 const sinSignOfInput{_mm_and_ps(theta, signMask)};
+            __m128 x{_mm_andnot_ps(signMask, theta)};
+
+            __m128i j{_mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOUR_OVER_PI)))};
+            j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+            __m128 const y{_mm_cvtepi32_ps(j)};
+            x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(PI_OVER_FOUR_PART_1)));
+            x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(PI_OVER_FOUR_PART_2)));
+            x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(PI_OVER_FOUR_PART_3)));
+
+            __m128 const isSwapped{_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_set1_epi32(2)))};
+            __m128 const sinSign{_mm_xor_ps(sinSignOfInput, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29)))};
+            __m128 const cosSign{_mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29))};
+
+            __m128 const z{_mm_mul_ps(x, x)};
+            __m128 polyCos{_mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_COEFFICIENT_1), z), _mm_set1_ps(COS_COEFFICIENT_2))};
+            polyCos = _mm_add_ps(_mm_mul_ps(polyCos, z), _mm_set1_ps(COS_COEFFICIENT_3));
+            polyCos = _mm_mul_ps(_mm_mul_ps(polyCos, z), z);
+            polyCos = _mm_add_ps(_mm_sub_ps(polyCos, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+            __m128 polySin{_mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_COEFFICIENT_1), z), _mm_set1_ps(SIN_COEFFICIENT_2))};
+            polySin = _mm_add_ps(_mm_mul_ps(polySin, z), _mm_set1_ps(SIN_COEFFICIENT_3));
+            polySin = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(polySin, z), x), x);
+
+            out_sin = _mm_xor_ps(_mm_or_ps(_mm_and_ps(isSwapped, polyCos), _mm_andnot_ps(isSwapped, polySin)), sinSign);
+            out_cos = _mm_xor_ps(_mm_or_ps(_mm_and_ps(isSwapped, polySin), _mm_andnot_ps(isSwapped, polyCos)), cosSign);
+        }
+
+        // 4 query points per iteration (the waves are broadcast, the points are the SIMD lanes)
+        void evaluateSSE(OceanSurface::WaveConstants const *waves, std::size_t const waveCount, float const verticalBounceWaveDisplacement,
+                         float const *x, float const *z, float const *t, std::size_t const begin, std::size_t const end, SampleStreams const &out)
+        {
+            std::size_t i{begin};
+            for (; i + 4 <= end; i += 4)
+            {
+                __m128 const px{_mm_loadu_ps(x + i)};
+                __m128 const pz{_mm_loadu_ps(z + i)};
+                __m128 const pt{_mm_loadu_ps(t + i)};
+
+                __m128 positionX{px};
+                __m128 positionY{_mm_set1_ps(verticalBounceWaveDisplacement)};
+                __m128 positionZ{pz};
+                __m128 tangentXX{_mm_set1_ps(1.0f)};
+                __m128 tangentXY{_mm_setzero_ps()};
+                __m128 tangentXZ{_mm_setzero_ps()};
+                __m128 tangentZY{_mm_setzero_ps()};
+                __m128 tangentZZ{_mm_set1_ps(1.0f)};
+                for (std::size_t w = 0; w < waveCount; ++w)
+                {
+                    OceanSurface::WaveConstants const &wave{waves[w]};
+                    __m128 const theta{_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(wave.frequencyDirectionX), px), _mm_mul_ps(_mm_set1_ps(wave.frequencyDirectionZ), pz)), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(wave.phaseConstant), pt), _mm_set1_ps(wave.phaseOffset)))};
+                    __m128 s;
+                    __m128 c;
+                    sinCosSSE(theta, s, c);
+
+                    positionX = _mm_add_ps(positionX, _mm_mul_ps(_mm_set1_ps(wave.steepAmplitudeX), c));
+                    positionY = _mm_add_ps(positionY, _mm_mul_ps(_mm_set1_ps(wave.amplitude), s));
+                    positionZ = _mm_add_ps(positionZ, _mm_mul_ps(_mm_set1_ps(wave.steepAmplitudeZ), c));
+                    // NOTE: d(P.z)/dx == d(P.x)/dz, so the cross terms share one accumulator
+                    tangentXX = _mm_sub_ps(tangentXX, _mm_mul_ps(_mm_set1_ps(wave.curvatureXX), s));
+                    tangentXY = _mm_add_ps(tangentXY, _mm_mul_ps(_mm_set1_ps(wave.slopeX), c));
+                    tangentXZ = _mm_sub_ps(tangentXZ, _mm_mul_ps(_mm_set1_ps(wave.curvatureXZ), s));
+                    tangentZY = _mm_add_ps(tangentZY, _mm_mul_ps(_mm_set1_ps(wave.slopeZ), c));
+                    tangentZZ = _mm_sub_ps(tangentZZ, _mm_mul_ps(_mm_set1_ps(wave.curvatureZZ), s));
+                }
+
+                // normal = cross(dP/dz, dP/dx) with dP/dx = (XX, XY, XZ) and dP/dz = (XZ, ZY, ZZ)
+                __m128 const normalX{_mm_sub_ps(_mm_mul_ps(tangentZY, tangentXZ), _mm_mul_ps(tangentZZ, tangentXY))};
+                __m128 const normalY{_mm_sub_ps(_mm_mul_ps(tangentZZ, tangentXX), _mm_mul_ps(tangentXZ, tangentXZ))};
+                __m128 const normalZ{_mm_sub_ps(_mm_mul_ps(tangentXZ, tangentXY), _mm_mul_ps(tangentZY, tangentXX))};
+                __m128 const inverseLength{_mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, normalX), _mm_mul_ps(normalY, normalY)), _mm_mul_ps(normalZ, normalZ))))};
+
+                _mm_storeu_ps(out.positionX + i, positionX);
+                _mm_storeu_ps(out.positionY + i, positionY);
+                _mm_storeu_ps(out.positionZ + i, positionZ);
+                _mm_storeu_ps(out.normalX + i, _mm_mul_ps(normalX, inverseLength));
+                _mm_storeu_ps(out.normalY + i, _mm_mul_ps(normalY, inverseLength));
+                _mm_storeu_ps(out.normalZ + i, _mm_mul_ps(normalZ, inverseLength));
+                _mm_storeu_ps(out.jacobianDeterminant + i, _mm_sub_ps(_mm_mul_ps(tangentXX, tangentZY), _mm_mul_ps(tangentXZ, tangentXY)));
+            }
+            evaluateScalar(waves, waveCount, verticalBounceWaveDisplacement, x, z, t, i, end, out);
+        }
+#endif
+
+#ifdef WAVE_TOOL_OCEAN_SURFACE_AVX2
+        // same as sinCosSSE(), 8 lanes wide
+        WAVE_TOOL_AVX2_TARGET inline void sinCosAVX2(__m256 const theta, __m256 &out_sin, __m256 &out_cos)
+        {
+            __m256 const signMask{_mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000))};
+            __m256 const sinSignOfInput{_mm256_and_ps(theta, signMask)};
+            __m256 x{_mm256_andnot_ps(signMask, theta)};
+
+            __m256i j{_mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOUR_OVER_PI)))};
+            j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+            __m256 const y{_mm256_cvtepi32_ps(j)};
+            x = _mm256_fnmadd_ps(y, _mm256_set1_ps(PI_OVER_FOUR_PART_1), x);
+            x = _mm256_fnmadd_ps(y, _mm256_set1_ps(PI_OVER_FOUR_PART_2), x);
+            x = _mm256_fnmadd_ps(y, _mm256_set1_ps(PI_OVER_FOUR_PART_3), x);
+
+            __m256 const isSwapped{_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(2)))};
+            __m256 const sinSign{_mm256_xor_ps(sinSignOfInput, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29)))};
+            __m256 const cosSign{_mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29))};
+
+            __m256 const z{_mm256_mul_ps(x, x)};
+            __m256 polyCos{_mm256_fmadd_ps(_mm256_set1_ps(COS_COEFFICIENT_1), z, _mm256_set1_ps(COS_COEFFICIENT_2))};
+            polyCos = _mm256_fmadd_ps(polyCos, z, _mm256_set1_ps(COS_COEFFICIENT_3));
+            polyCos = _mm256_mul_ps(_mm256_mul_ps(polyCos, z), z);
+            polyCos = _mm256_add_ps(_mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), polyCos), _mm256_set1_ps(1.0f));
+            __m256 polySin{_mm256_fmadd_ps(_mm256_set1_ps(SIN_COEFFICIENT_1), z, _mm256_set1_ps(SIN_COEFFICIENT_2))};
+            polySin = _mm256_fmadd_ps(polySin, z, _mm256_set1_ps(SIN_COEFFICIENT_3));
+            polySin = _mm256_fmadd_ps(_mm256_mul_ps(polySin, z), x, x);
+
+            out_sin = _mm256_xor_ps(_mm256_blendv_ps(polySin, polyCos, isSwapped), sinSign);
+            out_cos = _mm256_xor_ps(_mm256_blendv_ps(polyCos, polySin, isSwapped), cosSign);
+        }
+
+        // same as evaluateSSE(), 8 query points per iteration
+        WAVE_TOOL_AVX2_TARGET void evaluateAVX2(OceanSurface::WaveConstants const *waves, std::size_t const waveCount, float const verticalBounceWaveDisplacement,
+                                                float const *x, float const *z, float const *t, std::size_t const begin, std::size_t const end, SampleStreams const &out)
+        {
+            std::size_t i{begin};
+            for (; i + 8 <= end; i += 8)
+            {
+                __m256 const px{_mm256_loadu_ps(x + i)};
+                __m256 const pz{_mm256_loadu_ps(z + i)};
+                __m256 const pt{_mm256_loadu_ps(t + i)};
+
+                __m256 positionX{px};
+                __m256 positionY{_mm256_set1_ps(verticalBounceWaveDisplacement)};
+                __m256 positionZ{pz};
+                __m256 tangentXX{_mm256_set1_ps(1.0f)};
+                __m256 tangentXY{_mm256_setzero_ps()};
+                __m256 tangentXZ{_mm256_setzero_ps()};
+                __m256 tangentZY{_mm256_setzero_ps()};
+                __m256 tangentZZ{_mm256_set1_ps(1.0f)};
+                for (std::size_t w = 0; w < waveCount; ++w)
+                {
+                    OceanSurface::WaveConstants const &wave{waves[w]};
+                    __m256 const theta{_mm256_fmadd_ps(_mm256_set1_ps(wave.frequencyDirectionX), px, _mm256_fmadd_ps(_mm256_set1_ps(wave.frequencyDirectionZ), pz, _mm256_fmadd_ps(_mm256_set1_ps(wave.phaseConstant), pt, _mm256_set1_ps(wave.phaseOffset))))};
+                    __m256 s;
+                    __m256 c;
+                    sinCosAVX2(theta, s, c);
+
+                    positionX = _mm256_fmadd_ps(_mm256_set1_ps(wave.steepAmplitudeX), c, positionX);
+                    positionY = _mm256_fmadd_ps(_mm256_set1_ps(wave.amplitude), s, positionY);
+                    positionZ = _mm256_fmadd_ps(_mm256_set1_ps(wave.steepAmplitudeZ), c, positionZ);
+                    tangentXX = _mm256_fnmadd_ps(_mm256_set1_ps(wave.curvatureXX), s, tangentXX);
+                    tangentXY = _mm256_fmadd_ps(_mm256_set1_ps(wave.slopeX), c, tangentXY);
+                    tangentXZ = _mm256_fnmadd_ps(_mm256_set1_ps(wave.curvatureXZ), s, tangentXZ);
+                    tangentZY = _mm256_fmadd_ps(_mm256_set1_ps(wave.slopeZ), c, tangentZY);
+                    tangentZZ = _mm256_fnmadd_ps(_mm256_set1_ps(wave.curvatureZZ), s, tangentZZ);
+                }
+
+                __m256 const normalX{_mm256_fmsub_ps(tangentZY, tangentXZ, _mm256_mul_ps(tangentZZ, tangentXY))};
+                __m256 const normalY{_mm256_fmsub_ps(tangentZZ, tangentXX, _mm256_mul_ps(tangentXZ, tangentXZ))};
+                __m256 const normalZ{_mm256_fmsub_ps(tangentXZ, tangentXY, _mm256_mul_ps(tangentZY, tangentXX))};
+                __m256 const inverseLength{_mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_fmadd_ps(normalX, normalX, _mm256_fmadd_ps(normalY, normalY, _mm256_mul_ps(normalZ, normalZ)))))};
+
+                _mm256_storeu_ps(out.positionX + i, positionX);
+                _mm256_storeu_ps(out.positionY + i, positionY);
+                _mm256_storeu_ps(out.positionZ + i, positionZ);
+                _mm256_storeu_ps(out.normalX + i, _mm256_mul_ps(normalX, inverseLength));
+                _mm256_storeu_ps(out.normalY + i, _mm256_mul_ps(normalY, inverseLength));
+                _mm256_storeu_ps(out.normalZ + i, _mm256_mul_ps(normalZ, inverseLength));
+                _mm256_storeu_ps(out.jacobianDeterminant + i, _mm256_fmsub_ps(tangentXX, tangentZY, _mm256_mul_ps(tangentXZ, tangentXY)));
+            }
+            evaluateScalar(waves, waveCount, verticalBounceWaveDisplacement, x, z, t, i, end, out);
+        }
+#endif
+    }
+
+    void OceanSurface::Samples::resize(std::size_t const count)
+    {
+        for (std::vector<float> *stream : {&positionX, &positionY, &positionZ, &normalX, &normalY, &normalZ, &jacobianDeterminant})
+            stream->resize(count);
+    }
+
+    OceanSurface::Sample OceanSurface::Samples::at(std::size_t const i) const
+    {
+        return Sample{glm::vec3{positionX.at(i), positionY.at(i), positionZ.at(i)}, glm::vec3{normalX.at(i), normalY.at(i), normalZ.at(i)}, jacobianDeterminant.at(i)};
+    }
+
+    OceanSurface::OceanSurface(std::shared_ptr<ThreadPool> const &threadPool)
+        : m_threadPool{threadPool}
+    {
+        assert(nullptr != m_threadPool);
+#ifdef WAVE_TOOL_OCEAN_SURFACE_AVX2
+        m_isAVX2Supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }
+
+    void OceanSurface::setWaves(RenderEngine const &renderEngine)
+    {
+        m_waves.clear();
+        for (std::shared_ptr<geometry::GerstnerWave> const &gerstnerWave : renderEngine.gerstnerWaves)
+        {
+            if (nullptr == gerstnerWave)
+                continue;
+
+            // NOTE: must match the steepness normalization done in RenderEngine::render()
+            float const frequencyAmplitude{gerstnerWave->frequency_w * gerstnerWave->amplitude_A};
+            float const steepness_Q_i{0.0f != frequencyAmplitude ? gerstnerWave->steepness_Q / (frequencyAmplitude * geometry::GerstnerWave::Count()) : 0.0f};
+            glm::vec2 const &D{gerstnerWave->xzDirection_D};
+
+            WaveConstants wave;
+            wave.frequencyDirectionX = gerstnerWave->frequency_w * D.x;
+            wave.frequencyDirectionZ = gerstnerWave->frequency_w * D.y;
+            wave.phaseConstant = gerstnerWave->phaseConstant_phi;
+            wave.phaseOffset = gerstnerWave->phaseOffset;
+            wave.amplitude = gerstnerWave->amplitude_A;
+            wave.steepAmplitudeX = steepness_Q_i * gerstnerWave->amplitude_A * D.x;
+            wave.steepAmplitudeZ = steepness_Q_i * gerstnerWave->amplitude_A * D.y;
+            wave.slopeX = frequencyAmplitude * D.x;
+            wave.slopeZ = frequencyAmplitude * D.y;
+            wave.curvatureXX = steepness_Q_i * frequencyAmplitude * D.x * D.x;
+            wave.curvatureXZ = steepness_Q_i * frequencyAmplitude * D.x * D.y;
+            wave.curvatureZZ = steepness_Q_i * frequencyAmplitude * D.y * D.y;
+            m_waves.push_back(wave);
+        }
+
+        m_verticalBounceWaveDisplacement = renderEngine.verticalBounceWaveAmplitude * glm::sin(renderEngine.verticalBounceWavePhase * glm::two_pi<float>());
+    }
+
+    OceanSurface::Sample OceanSurface::query(float const x, float const z, float const t) const
+    {
+        Sample sample;
+        SampleStreams const out{&sample.position.x, &sample.position.y, &sample.position.z, &sample.normal.x, &sample.normal.y, &sample.normal.z, &sample.jacobianDeterminant};
+        evaluateScalar(m_waves.data(), m_waves.size(), m_verticalBounceWaveDisplacement, &x, &z, &t, 0, 1, out);
+        return sample;
+    }
+
+    OceanSurface::Sample OceanSurface::queryDisplaced(float const x, float const z, float const t, unsigned int const iterationCount) const
+    {
+        glm::vec2 const target{x, z};
+        glm::vec2 gridPosition{target};
+        Sample sample{query(gridPosition.x, gridPosition.y, t)};
+        for (unsigned int i = 0; i < iterationCount; ++i)
+        {
+            gridPosition += target - glm::vec2{sample.position.x, sample.position.z};
+            sample = query(gridPosition.x, gridPosition.y, t);
+        }
+        return sample;
+    }
+
+    void OceanSurface::query(float const *x, float const *z, float const *t, std::size_t const count, Samples &out) const
+    {
+        out.resize(count);
+        SampleStreams const streams{out.positionX.data(), out.positionY.data(), out.positionZ.data(), out.normalX.data(), out.normalY.data(), out.normalZ.data(), out.jacobianDeterminant.data()};
+
+        m_threadPool->parallelFor(count, [this, x, z, t, &streams](std::size_t begin, std::size_t end) {
+#ifdef WAVE_TOOL_OCEAN_SURFACE_AVX2
+            if (m_isAVX2Supported)
+            {
+                evaluateAVX2(m_waves.data(), m_waves.size(), m_verticalBounceWaveDisplacement, x, z, t, begin, end, streams);
+                return;
+            }
+#endif
+#ifdef WAVE_TOOL_OCEAN_SURFACE_SSE
+            evaluateSSE(m_waves.data(), m_waves.size(), m_verticalBounceWaveDisplacement, x, z, t, begin, end, streams);
+#else
+            evaluateScalar(m_waves.data(), m_waves.size(), m_verticalBounceWaveDisplacement, x, z, t, begin, end, streams);
+#endif
+        }, s_MIN_CHUNK_SIZE);
+
+        assert(isBatchConsistent(x, z, t, out));
+    }
+
+    bool OceanSurface::isBatchConsistent(float const *x, float const *z, float const *t, Samples const &out) const
+    {
+        std::size_t const count{out.size()};
+        std::size_t const stride{std::max<std::size_t>(count / s_CONSISTENCY_CHECK_POINTS, 1)};
+        for (std::size_t i = 0; i < count; i += stride)
+        {
+            Sample const reference{query(x[i], z[i], t[i])};
+            Sample const batched{out.at(i)};
+
+            // NOTE: the kernels form each theta with a different rounding (e.g. FMA), so the tolerance grows with |theta| (the sin/cos themselves are good to a few ulp)
+            float tolerance{1e-5f};
+            for (WaveConstants const &wave : m_waves)
+            {
+                float const theta{wave.frequencyDirectionX * x[i] + wave.frequencyDirectionZ * z[i] + wave.phaseConstant * t[i] + wave.phaseOffset};
+                float const coefficient{std::max({std::abs(wave.amplitude), std::abs(wave.slopeX), std::abs(wave.slopeZ), std::abs(wave.curvatureXX), std::abs(wave.curvatureXZ), std::abs(wave.curvatureZZ)})};
+                tolerance += coefficient * 16.0f * FLT_EPSILON * (1.0f + std::abs(theta));
+            }
+            // the horizontal displacement is added to x and z, whose own rounding the kernels share
+            float const positionTolerance{tolerance + 4.0f * FLT_EPSILON * std::max(std::abs(x[i]), std::abs(z[i]))};
+
+            if (glm::any(glm::greaterThan(glm::abs(batched.position - reference.position), glm::vec3{positionTolerance})) ||
+                glm::any(glm::greaterThan(glm::abs(batched.normal - reference.normal), glm::vec3{4.0f * tolerance})) ||
+                std::abs(batched.jacobianDeterminant - reference.jacobianDeterminant) > 4.0f * tolerance)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
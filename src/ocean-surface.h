@@ -0,0 +1,128 @@
+#ifndef WAVE_TOOL_OCEAN_SURFACE_H_
+#define WAVE_TOOL_OCEAN_SURFACE_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "thread-pool.h"
+
+namespace wave_tool
+{
+    class RenderEngine;
+
+    // CPU mirror of the Gerstner surface evaluated in water-grid.tes, so the application can ask where the water is without the GPU
+    // each query takes an undisplaced grid position (x, z) and a wave time t, exactly like the TES does, and returns...
+    //  - the displaced surface position (Gerstner sum + vertical bounce)
+    //  - the unit surface normal (analytic, pointing up)
+    //  - the same Jacobian determinant the TES outputs for foam (dX/dx * dY/dz - dX/dz * dY/dx)
+    // NOTE: the heightmap / FFT ocean detail is sampled from textures on the GPU and isn't included
+    // NOTE: every wave is summed at full amplitude (the TES fades out waves too short for the local tessellation density, which only affects distant vertices)
+    class OceanSurface
+    {
+    public:
+        struct Sample
+        {
+            glm::vec3 position;
+            glm::vec3 normal;
+            float jacobianDeterminant;
+        };
+
+        // results of a batch query in structure-of-arrays form (element i is the result of query point i)
+        struct Samples
+        {
+            std::vector<float> positionX;
+            std::vector<float> positionY;
+            std::vector<float> positionZ;
+            std::vector<float> normalX;
+            std::vector<float> normalY;
+            std::vector<float> normalZ;
+            std::vector<float> jacobianDeterminant;
+
+            void resize(std::size_t const count);
+            inline std::size_t size() const { return positionX.size(); }
+            Sample at(std::size_t const i) const;
+        };
+
+        // per-wave terms of the sum and its partial derivatives (precomputed once per setWaves, shared with the SIMD kernels)
+        struct WaveConstants
+        {
+            float frequencyDirectionX; // w * D.x
+            float frequencyDirectionZ; // w * D.y
+            float phaseConstant;       // phi
+            float phaseOffset;         // phase at the origin when t is 0
+            float amplitude;           // A
+            float steepAmplitudeX;     // Q_i * A * D.x
+            float steepAmplitudeZ;     // Q_i * A * D.y
+            float slopeX;              // w * A * D.x
+            float slopeZ;              // w * A * D.y
+            float curvatureXX;         // Q_i * w * A * D.x * D.x
+            float curvatureXZ;         // Q_i * w * A * D.x * D.y
+            float curvatureZZ;         // Q_i * w * A * D.y * D.y
+        };
+
+        explicit OceanSurface(std::shared_ptr<ThreadPool> const &threadPool);
+
+        // snapshots the current wave parameters of the render engine (must be called again after they change)
+        void setWaves(RenderEngine const &renderEngine);
+        inline unsigned int getWaveCount() const { return (unsigned int)m_waves.size(); }
+
+        Sample query(float const x, float const z, float const t) const;
+        // NOTE: out is resized to count
+        void query(float const *x, float const *z, float const *t, std::size_t const count, Samples &out) const;
+        // the sample whose displaced position lies directly above or below the world point (x, z), e.g. the water under the camera
+        // NOTE: the waves also move points sideways, so the grid position is solved for by fixed-point iteration (p += target - P(p).xz), which converges since the steepness is normalized to at most 1 overall
+        Sample queryDisplaced(float const x, float const z, float const t, unsigned int const iterationCount = s_DEFAULT_DISPLACEMENT_ITERATIONS) const;
+
+    private:
+        // query points per thread chunk (keeps chunks large enough to amortize the dispatch)
+        static std::size_t const s_MIN_CHUNK_SIZE{4096};
+        // the horizontal error shrinks by roughly the steepness every iteration, so two are plenty for the UI
+        static unsigned int const s_DEFAULT_DISPLACEMENT_ITERATIONS{2};
+        // points of every batch that debug builds re-evaluate with the scalar path (see isBatchConsistent)
+        static std::size_t const s_CONSISTENCY_CHECK_POINTS{16};
+
+        // debug check that the SIMD kernels agree with the scalar reference on a few points of out (spread over the batch), to within the float error of the sin/cos arguments
+        bool isBatchConsistent(float const *x, float const *z, float const *t, Samples const &out) const;
+
+        std::shared_ptr<ThreadPool> m_threadPool = nullptr;
+        std::vector<WaveConstants> m_waves;
+        float m_verticalBounceWaveDisplacement{0.0f};
+        bool m_isAVX2Supported{false}; // detected once at construction
+    };
+}
+
+#endif // WAVE_TOOL_OCEAN_SURFACE_H_
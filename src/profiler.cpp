@@ -0,0 +1,300 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace wave_tool
+{
+    Profiler::Profiler()
+    {
+        for (auto &queries : m_queries)
+            glGenQueries(GPU_PASS_COUNT, queries.data());
+        for (auto &isQueryIssued : m_isQueryIssued)
+            isQueryIssued.fill(false);
+        m_queryFrameIndices.fill(0);
+        m_cpuSectionAccumulatedMs.fill(-1.0);
+
+        setHistoryLength(s_HISTORY_LENGTH);
+
+        // time one throwaway clear of a 1x1 target, since Mesa's llvmpipe returns garbage (the system uptime) for the first timer query after the context first rasterizes anything
+        GLint previousFramebuffer{0};
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        GLuint framebuffer{0};
+        GLuint renderbuffer{0};
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+        glGenRenderbuffers(1, &renderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1);
+        glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+        glBeginQuery(GL_TIME_ELAPSED, m_queries.at(0).at(0));
+        glClear(GL_COLOR_BUFFER_BIT);
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 elapsedNs{0};
+        glGetQueryObjectui64v(m_queries.at(0).at(0), GL_QUERY_RESULT, &elapsedNs);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFramebuffer);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &renderbuffer);
+    }
+
+    Profiler::~Profiler()
+    {
+        for (auto &queries : m_queries)
+            glDeleteQueries(GPU_PASS_COUNT, queries.data());
+    }
+
+    void Profiler::beginFrame()
+    {
+        m_isInFrame = true;
+        m_cpuSectionAccumulatedMs.fill(-1.0);
+        if (isEnabled)
+        {
+            FrameSamples frame;
+            frame.frameIndex = m_frameIndex;
+            frame.gpuMs.fill(-1.0f);
+            frame.cpuMs.fill(-1.0f);
+            m_frames.push_back(frame);
+        }
+
+        // advance to the oldest set of queries and harvest its results (issued s_QUERY_BUFFER_COUNT - 1 frames ago), since this frame reuses them...
+        m_queryBufferIndex = (m_queryBufferIndex + 1) % s_QUERY_BUFFER_COUNT;
+        readQueries(m_queryBufferIndex);
+        m_queryFrameIndices.at(m_queryBufferIndex) = m_frameIndex;
+        m_queryFrameStarts.at(m_queryBufferIndex) = Clock::now();
+    }
+
+    void Profiler::endFrame()
+    {
+        if (!m_isInFrame)
+            return;
+        m_isInFrame = false;
+        std::uint64_t const frameIndex{m_frameIndex++};
+
+        // NOTE: like GPU passes, sections that didn't run this frame don't record a sample (e.g. a hidden water grid)
+        FrameSamples *const frame{findFrame(frameIndex)};
+        if (!isEnabled || nullptr == frame)
+            return;
+        for (unsigned int section = 0; section < CPU_SECTION_COUNT; ++section)
+            frame->cpuMs.at(section) = (float)m_cpuSectionAccumulatedMs.at(section);
+    }
+
+    void Profiler::flush()
+    {
+        // NOTE: the queries of the frame in progress may not even be ended yet
+        for (unsigned int bufferIndex = 0; bufferIndex < s_QUERY_BUFFER_COUNT; ++bufferIndex)
+        {
+            if (!m_isInFrame || bufferIndex != m_queryBufferIndex)
+                readQueries(bufferIndex);
+        }
+    }
+
+    void Profiler::readQueries(unsigned int const bufferIndex)
+    {
+        auto &queries{m_queries.at(bufferIndex)};
+        auto &isQueryIssued{m_isQueryIssued.at(bufferIndex)};
+        FrameSamples *const frame{findFrame(m_queryFrameIndices.at(bufferIndex))};
+        // no pass of that frame can have taken longer than the frame has existed
+        std::chrono::duration<double, std::milli> const maxElapsed{Clock::now() - m_queryFrameStarts.at(bufferIndex)};
+        for (unsigned int pass = 0; pass < GPU_PASS_COUNT; ++pass)
+        {
+            if (!isQueryIssued.at(pass))
+                continue;
+            isQueryIssued.at(pass) = false;
+
+            // NOTE: waits if the GPU is still behind (the query is about to be reused, and dropping it would leave a hole in its frame)
+            GLuint64 elapsedNs{0};
+            glGetQueryObjectui64v(queries.at(pass), GL_QUERY_RESULT, &elapsedNs);
+            double const elapsedMs{elapsedNs / 1.0e6};
+            // NOTE: a result longer than the frame has existed is a driver bug (see the constructor), so it is dropped rather than reported
+            if (nullptr != frame && elapsedMs <= maxElapsed.count())
+                frame->gpuMs.at(pass) = (float)elapsedMs;
+        }
+    }
+
+    Profiler::FrameSamples *Profiler::findFrame(std::uint64_t const frameIndex)
+    {
+        // NOTE: searched from the newest, since the frames still being written are at most s_QUERY_BUFFER_COUNT from the back
+        auto const frame{std::find_if(m_frames.rbegin(), m_frames.rend(), [frameIndex](FrameSamples const &samples) { return frameIndex == samples.frameIndex; })};
+        return m_frames.rend() != frame ? &*frame : nullptr;
+    }
+
+    void Profiler::beginGpuPass(GpuPass const pass)
+    {
+        assert(-1 == m_activeGpuPass);
+        if (!isEnabled)
+            return;
+
+        glBeginQuery(GL_TIME_ELAPSED, m_queries.at(m_queryBufferIndex).at(pass));
+        m_isQueryIssued.at(m_queryBufferIndex).at(pass) = true;
+        m_activeGpuPass = pass;
+    }
+
+    void Profiler::endGpuPass()
+    {
+        if (-1 == m_activeGpuPass)
+            return;
+
+        glEndQuery(GL_TIME_ELAPSED);
+        m_activeGpuPass = -1;
+    }
+
+    void Profiler::beginCpuSection(CpuSection const section)
+    {
+        m_cpuSectionStarts.at(section) = Clock::now();
+    }
+
+    void Profiler::endCpuSection(CpuSection const section)
+    {
+        std::chrono::duration<double, std::milli> const elapsed{Clock::now() - m_cpuSectionStarts.at(section)};
+        // NOTE: accumulates, so a section can be entered multiple times in one frame
+        double &accumulatedMs{m_cpuSectionAccumulatedMs.at(section)};
+        accumulatedMs = std::max(accumulatedMs, 0.0) + elapsed.count();
+    }
+
+    void Profiler::setHistoryLength(std::size_t const frameCount)
+    {
+        m_frames.set_capacity(frameCount);
+    }
+
+    Profiler::Statistics Profiler::getGpuStatistics(GpuPass const pass) const
+    {
+        std::vector<float> samples;
+        for (FrameSamples const &frame : m_frames)
+        {
+            if (frame.gpuMs.at(pass) >= 0.0f)
+                samples.push_back(frame.gpuMs.at(pass));
+        }
+        return computeStatistics(samples);
+    }
+
+    Profiler::Statistics Profiler::getCpuStatistics(CpuSection const section) const
+    {
+        std::vector<float> samples;
+        for (FrameSamples const &frame : m_frames)
+        {
+            if (frame.cpuMs.at(section) >= 0.0f)
+                samples.push_back(frame.cpuMs.at(section));
+        }
+        return computeStatistics(samples);
+    }
+
+    char const *Profiler::getName(GpuPass const pass)
+    {
+        static std::array<char const *, GPU_PASS_COUNT> const NAMES{"SKY CUBEMAP", "LOCAL REFLECTIONS", "LOCAL REFRACTIONS", "DEPTH", "SKYBOX", "WATER GRID"};
+        return NAMES.at(pass);
+    }
+
+    char const *Profiler::getName(CpuSection const section)
+    {
+        static std::array<char const *, CPU_SECTION_COUNT> const NAMES{"BUILD UI", "OCEAN FFT", "OBJECT SUBMISSION", "PROJECTED GRID", "CLIPMAP", "BUFFER SWAP"};
+        return NAMES.at(section);
+    }
+
+    bool Profiler::writeCSV(std::string const &filePath) const
+    {
+        std::ofstream file{filePath};
+        if (!file)
+        {
+            std::cout << "ERROR: failed to open " << filePath << " for writing" << std::endl;
+            return false;
+        }
+
+        // summary...
+        file << "section,type,latest_ms,min_ms,avg_ms,p99_ms\n";
+        for (unsigned int pass = 0; pass < GPU_PASS_COUNT; ++pass)
+        {
+            Statistics const stats{getGpuStatistics((GpuPass)pass)};
+            file << getName((GpuPass)pass) << ",gpu," << stats.latestMs << "," << stats.minMs << "," << stats.avgMs << "," << stats.p99Ms << "\n";
+        }
+        for (unsigned int section = 0; section < CPU_SECTION_COUNT; ++section)
+        {
+            Statistics const stats{getCpuStatistics((CpuSection)section)};
+            file << getName((CpuSection)section) << ",cpu," << stats.latestMs << "," << stats.minMs << "," << stats.avgMs << "," << stats.p99Ms << "\n";
+        }
+
+        // raw samples...
+        file << "\nframe";
+        for (unsigned int pass = 0; pass < GPU_PASS_COUNT; ++pass)
+            file << ",gpu " << getName((GpuPass)pass);
+        for (unsigned int section = 0; section < CPU_SECTION_COUNT; ++section)
+            file << ",cpu " << getName((CpuSection)section);
+        file << "\n";
+
+        auto const writeSample{[&file](float const sampleMs) {
+            file << ",";
+            if (sampleMs >= 0.0f)
+                file << sampleMs;
+        }};
+        for (FrameSamples const &frame : m_frames)
+        {
+            file << frame.frameIndex;
+            for (float const sampleMs : frame.gpuMs)
+                writeSample(sampleMs);
+            for (float const sampleMs : frame.cpuMs)
+                writeSample(sampleMs);
+            file << "\n";
+        }
+
+        std::cout << "profiler samples written to " << filePath << std::endl;
+        return true;
+    }
+
+    Profiler::Statistics Profiler::computeStatistics(std::vector<float> const &samples)
+    {
+        Statistics stats;
+        if (samples.empty())
+            return stats;
+
+        stats.latestMs = samples.back();
+        stats.minMs = samples.front();
+        double sum{0.0};
+        for (float const sample : samples)
+        {
+            stats.minMs = std::min(stats.minMs, sample);
+            sum += sample;
+        }
+        stats.avgMs = (float)(sum / samples.size());
+
+        // nearest-rank percentile
+        std::vector<float> sorted{samples};
+        std::size_t const p99Index{std::min(sorted.size() - 1, (std::size_t)(0.99 * sorted.size()))};
+        std::nth_element(sorted.begin(), sorted.begin() + p99Index, sorted.end());
+        stats.p99Ms = sorted.at(p99Index);
+
+        return stats;
+    }
+}
@@ -0,0 +1,163 @@
+#ifndef WAVE_TOOL_PROFILER_H_
+#define WAVE_TOOL_PROFILER_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glad/glad.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/circular_buffer.hpp>
+
+namespace wave_tool
+{
+    // collects per-pass GPU times (GL_TIME_ELAPSED queries) and per-section CPU times (steady clock) over a rolling window of frames
+    // every sample is kept with the frame it was measured in, so a frame's GPU and CPU times always stay together
+    // NOTE: GPU results are read back s_QUERY_BUFFER_COUNT - 1 frames late, by which time the GPU has (almost always) finished them, so reading them rarely stalls
+    // NOTE: GL_TIME_ELAPSED queries can't be nested, so only one GPU pass can be timed at once
+    class Profiler
+    {
+    public:
+        enum GpuPass
+        {
+            SKY_CUBEMAP = 0,
+            LOCAL_REFLECTIONS,
+            LOCAL_REFRACTIONS,
+            DEPTH,
+            SKYBOX,
+            WATER_GRID,
+            GPU_PASS_COUNT
+        };
+
+        enum CpuSection
+        {
+            BUILD_UI = 0,
+            OCEAN_FFT,
+            OBJECT_SUBMISSION,
+            PROJECTED_GRID,
+            CLIPMAP,
+            BUFFER_SWAP,
+            CPU_SECTION_COUNT
+        };
+
+        struct Statistics
+        {
+            float latestMs{0.0f};
+            float minMs{0.0f};
+            float avgMs{0.0f};
+            float p99Ms{0.0f};
+        };
+
+        static unsigned int const s_HISTORY_LENGTH{300}; // frames kept in the rolling window by default
+        static unsigned int const s_QUERY_BUFFER_COUNT{3};
+
+        bool isEnabled{true};
+
+        Profiler();
+        ~Profiler();
+
+        // must wrap everything that is timed in a frame
+        void beginFrame();
+        void endFrame();
+
+        void beginGpuPass(GpuPass const pass);
+        void endGpuPass();
+        void beginCpuSection(CpuSection const section);
+        void endCpuSection(CpuSection const section);
+
+        // waits for every GPU result still pending (except those of the frame in progress), so the latest frames are complete too (e.g. before writeCSV)
+        void flush();
+
+        // frames kept in the rolling window (e.g. a whole headless run, so writeCSV loses none of it)
+        // NOTE: shrinking it keeps the newest samples
+        void setHistoryLength(std::size_t const frameCount);
+        inline std::size_t getHistoryLength() const { return m_frames.capacity(); }
+
+        Statistics getGpuStatistics(GpuPass const pass) const;
+        Statistics getCpuStatistics(CpuSection const section) const;
+        static char const *getName(GpuPass const pass);
+        static char const *getName(CpuSection const section);
+
+        // writes the summary and every frame in the rolling window (one row per frame, oldest first, with a blank cell wherever a pass or section didn't run)
+        bool writeCSV(std::string const &filePath) const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct FrameSamples
+        {
+            std::uint64_t frameIndex;
+            std::array<float, GPU_PASS_COUNT> gpuMs;     // symbolic -1 if the pass didn't run (or its result isn't read back yet)
+            std::array<float, CPU_SECTION_COUNT> cpuMs;  // symbolic -1 if the section didn't run
+        };
+
+        std::array<std::array<GLuint, GPU_PASS_COUNT>, s_QUERY_BUFFER_COUNT> m_queries;
+        std::array<std::array<bool, GPU_PASS_COUNT>, s_QUERY_BUFFER_COUNT> m_isQueryIssued;
+        std::array<std::uint64_t, s_QUERY_BUFFER_COUNT> m_queryFrameIndices;       // the frame each set of queries was issued in
+        std::array<Clock::time_point, s_QUERY_BUFFER_COUNT> m_queryFrameStarts;  // when that frame began
+        unsigned int m_queryBufferIndex{0};
+        int m_activeGpuPass{-1}; // symbolic -1 if no pass is being timed
+
+        std::array<Clock::time_point, CPU_SECTION_COUNT> m_cpuSectionStarts;
+        std::array<double, CPU_SECTION_COUNT> m_cpuSectionAccumulatedMs; // symbolic -1 if the section didn't run this frame
+        bool m_isInFrame{false};
+        std::uint64_t m_frameIndex{0}; // of the frame in progress (or the next one)
+
+        boost::circular_buffer<FrameSamples> m_frames; // oldest first, frames in which the profiler was disabled are skipped
+
+        // blocks until every issued query of the set is done, then stores the results with the frame that issued them
+        void readQueries(unsigned int const bufferIndex);
+        FrameSamples *findFrame(std::uint64_t const frameIndex);
+        static Statistics computeStatistics(std::vector<float> const &samples);
+    };
+
+    // times the enclosing scope as a CPU section
+    class ScopedCpuTimer
+    {
+    public:
+        ScopedCpuTimer(Profiler &profiler, Profiler::CpuSection const section) : m_profiler{profiler}, m_section{section} { m_profiler.beginCpuSection(m_section); }
+        ~ScopedCpuTimer() { m_profiler.endCpuSection(m_section); }
+
+        ScopedCpuTimer(ScopedCpuTimer const &) = delete;
+        ScopedCpuTimer &operator=(ScopedCpuTimer const &) = delete;
+
+    private:
+        Profiler &m_profiler;
+        Profiler::CpuSection const m_section;
+    };
+}
+
+#endif // WAVE_TOOL_PROFILER_H_
@@ -39,6 +39,8 @@
 
 #include "program.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -52,14 +54,20 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+#include "gl-extensions.h"
+#include "headless-context.h"
 #include "input-handler.h"
 #include "mesh-object.h"
 #include "object-loader.h"
 #include "render-engine.h"
+#include "simulation-clock.h"
 
 namespace wave_tool
 {
-    Program::Program() {}
+    Program::Program(LaunchOptions const &launchOptions) : m_launchOptions{launchOptions} {}
 
     Program::~Program() {}
 
@@ -70,27 +78,61 @@ namespace wave_tool
 
     bool Program::start()
     {
+        if (m_launchOptions.isHeadless)
+            return startHeadless();
+
         if (!setupWindow())
             return false;
 
-        m_renderEngine = std::make_shared<RenderEngine>(m_window);
+        int windowWidth{0};
+        int windowHeight{0};
+        glfwGetWindowSize(m_window, &windowWidth, &windowHeight);
+        m_renderEngine = std::make_shared<RenderEngine>(windowWidth, windowHeight);
+        m_renderEngine->waveAnimationTimeInSeconds = m_launchOptions.waveAnimationTimeInSeconds;
+        if (m_launchOptions.timeOfDayInHours >= 0.0f)
+            m_renderEngine->timeOfDayInHours = m_launchOptions.timeOfDayInHours;
+        if ("clipmap" == m_launchOptions.waterGeometry)
+            m_renderEngine->waterGeometryMode = WaterGeometryMode::CLIPMAP;
+
+        // shaders are recompiled when they are saved, on a hidden window's context unless the driver can compile in the background
+        if (!ShaderTools::isParallelCompileSupported())
+        {
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            m_shaderWorkerWindow = glfwCreateWindow(1, 1, "WaveTool Shader Worker", nullptr, m_window);
+            glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+            glfwMakeContextCurrent(m_window); // NOTE: creating a window can change the current context on some platforms
+        }
+        m_renderEngine->enableShaderHotReload(m_shaderWorkerWindow);
 
         initScene();
 
+        // from here on, time advances on the simulation thread (independent of the framerate)
+        m_simulationClock = std::make_unique<SimulationClock>(SimulationClock::State{m_renderEngine->waveAnimationTimeInSeconds, m_renderEngine->verticalBounceWavePhase, m_renderEngine->timeOfDayInHours});
+        m_simulationClock->start();
+
         // image.Initialize();
         // do a bunch of raytracing into texture
         // image.SaveToFile("image.png"); // no need to put in loop since we dont update image
 
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         // render loop
+        Profiler &profiler{*m_renderEngine->getProfiler()};
         while (!glfwWindowShouldClose(m_window))
         {
+            profiler.beginFrame();
+
             // handle inputs
             glfwPollEvents();
 
+            updateShaderHotReload();
+            syncSimulation();
+
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            buildUI();
+            {
+                ScopedCpuTimer const timer{profiler, Profiler::BUILD_UI};
+                buildUI();
+            }
 
             // rendering...
             ImGui::Render();
@@ -99,12 +141,147 @@ namespace wave_tool
 
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-            glfwSwapBuffers(m_window);
+            {
+                ScopedCpuTimer const timer{profiler, Profiler::BUFFER_SWAP};
+                glfwSwapBuffers(m_window);
+            }
+
+            profiler.endFrame();
         }
 
         return cleanup();
     }
 
+    bool Program::startHeadless()
+    {
+        HeadlessContext context;
+        if (!context.create())
+            return false;
+
+        if (!gladLoadGLLoader((GLADloadproc)HeadlessContext::getProcAddress))
+        {
+            std::cout << "ERROR: Failed to initialize OpenGL context, TERMINATING..." << std::endl;
+            return false;
+        }
+        GLExtensions::load((GLADloadproc)HeadlessContext::getProcAddress);
+
+        // query and print out information about our OpenGL environment
+        queryGLVersion();
+
+        int const width{m_launchOptions.width};
+        int const height{m_launchOptions.height};
+
+        // there is no default framebuffer, so create an offscreen one of the requested size to stand in for the window...
+        GLuint outputFBO{0};
+        GLuint outputColourRBO{0};
+        GLuint outputDepth24Stencil8RBO{0};
+        glGenFramebuffers(1, &outputFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+        glGenRenderbuffers(1, &outputColourRBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, outputColourRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, outputColourRBO);
+        glGenRenderbuffers(1, &outputDepth24Stencil8RBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, outputDepth24Stencil8RBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, outputDepth24Stencil8RBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        bool isSuccessful{GL_FRAMEBUFFER_COMPLETE == glCheckFramebufferStatus(GL_FRAMEBUFFER)};
+        if (!isSuccessful)
+            std::cout << "ERROR: headless output framebuffer is not complete!" << std::endl;
+        glViewport(0, 0, width, height);
+
+        if (isSuccessful)
+        {
+            m_renderEngine = std::make_shared<RenderEngine>(width, height);
+            m_renderEngine->setOutputFramebuffer(outputFBO);
+            m_renderEngine->waveAnimationTimeInSeconds = m_launchOptions.waveAnimationTimeInSeconds;
+            if (m_launchOptions.timeOfDayInHours >= 0.0f)
+                m_renderEngine->timeOfDayInHours = m_launchOptions.timeOfDayInHours;
+            if ("clipmap" == m_launchOptions.waterGeometry)
+                m_renderEngine->waterGeometryMode = WaterGeometryMode::CLIPMAP;
+
+            initScene();
+
+            // NOTE: a fixed timestep (rather than the measured framerate) keeps the output deterministic, so the simulation clock is stepped manually rather than started
+            m_simulationClock = std::make_unique<SimulationClock>(SimulationClock::State{m_renderEngine->waveAnimationTimeInSeconds, m_renderEngine->verticalBounceWavePhase, m_renderEngine->timeOfDayInHours});
+            float const deltaTimeInSeconds{1.0f / m_launchOptions.framesPerSecond};
+            std::vector<unsigned char> pixels((std::size_t)width * height * 4);
+            // OpenGL's origin is the bottom-left, but images are stored top-row first
+            stbi_flip_vertically_on_write(1);
+
+            Profiler &profiler{*m_renderEngine->getProfiler()};
+            // keep every frame of the run for the CSV (the rolling window would drop the earliest ones)
+            if (!m_launchOptions.profileOutputPath.empty())
+                profiler.setHistoryLength(std::max<std::size_t>(m_launchOptions.frameCount, Profiler::s_HISTORY_LENGTH));
+            for (unsigned int frameIndex = 0; frameIndex < m_launchOptions.frameCount && isSuccessful; ++frameIndex)
+            {
+                profiler.beginFrame();
+
+                syncSimulation();
+                glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+                m_renderEngine->render(m_skyboxStars, m_skysphere, m_skyboxClouds, m_waterGrid, m_meshObjects);
+
+                // read back the final image (this waits for the frame to finish)...
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, outputFBO);
+                glReadBuffer(GL_COLOR_ATTACHMENT0);
+                glPixelStorei(GL_PACK_ALIGNMENT, 1);
+                glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+                char frameIndexStr[16];
+                std::snprintf(frameIndexStr, sizeof(frameIndexStr), "%05u", frameIndex);
+                std::string const filePath{m_launchOptions.outputPrefix + "-" + frameIndexStr + ".png"};
+                if (!stbi_write_png(filePath.c_str(), width, height, 4, pixels.data(), width * 4))
+                {
+                    std::cout << "ERROR: failed to write frame " << filePath << std::endl;
+                    isSuccessful = false;
+                }
+
+                m_simulationClock->step(deltaTimeInSeconds);
+                profiler.endFrame();
+            }
+
+            if (!m_launchOptions.profileOutputPath.empty())
+            {
+                // the GPU times of the last frames are still pending
+                profiler.flush();
+                profiler.writeCSV(m_launchOptions.profileOutputPath);
+            }
+
+            if (isSuccessful)
+                std::cout << "rendered " << m_launchOptions.frameCount << " frame(s) at " << width << "x" << height << " to " << m_launchOptions.outputPrefix << "-*.png" << std::endl;
+        }
+
+        m_simulationClock = nullptr;
+
+        // release all GL objects while the context is still current...
+        m_meshObjects.clear();
+        m_skyboxClouds = nullptr;
+        m_skyboxStars = nullptr;
+        m_skysphere = nullptr;
+        m_waterGrid = nullptr;
+        m_renderEngine = nullptr;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteRenderbuffers(1, &outputDepth24Stencil8RBO);
+        glDeleteRenderbuffers(1, &outputColourRBO);
+        glDeleteFramebuffers(1, &outputFBO);
+
+        context.destroy();
+        return isSuccessful;
+    }
+
+    void Program::syncSimulation()
+    {
+        m_simulationClock->setRates(SimulationClock::Rates{m_renderEngine->isAnimatingWaves, m_renderEngine->isAnimatingTimeOfDay,
+                                                           m_renderEngine->animationSpeedVerticalBounceWavePhasePeriodInSeconds, m_renderEngine->animationSpeedTimeOfDayInSecondsPerHour});
+        SimulationClock::State const state{m_simulationClock->sample()};
+        m_renderEngine->waveAnimationTimeInSeconds = (float)state.waveAnimationTimeInSeconds;
+        m_renderEngine->verticalBounceWavePhase = state.verticalBounceWavePhase;
+        m_renderEngine->timeOfDayInHours = state.timeOfDayInHours;
+        // the bounce phase moves every tick
+        m_renderEngine->updateOceanSurface();
+    }
+
     // TODO: look at Dear ImGui demo code and expand this to be better organized
     void Program::buildUI()
     {
@@ -125,6 +302,15 @@ namespace wave_tool
 
         ImGui::Separator();
 
+        // NOTE: the last good program of every failed shader keeps rendering
+        std::string const shaderErrorLog{m_renderEngine->getShaderHotReloadErrorLog()};
+        if (!shaderErrorLog.empty())
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "SHADER RELOAD FAILED (USING THE LAST GOOD PROGRAM):");
+            ImGui::TextWrapped("%s", shaderErrorLog.c_str());
+            ImGui::Separator();
+        }
+
         // reference: https://www.glfw.org/docs/latest/group__keys.html
         // reference: https://github.com/ocornut/imgui/blob/7b3d379819c487f0d5323ed7bd7c9109a2bc1d76/imgui_demo.cpp#L154-L167
         if (ImGui::TreeNode("CONTROLS"))
@@ -162,12 +348,14 @@ namespace wave_tool
 
         ImGui::Separator();
 
-        const float MIN_TIME = 7.0f;
-        const float MAX_TIME = 17.0f;
+        // NOTE: the simulated values below are overwritten by the simulation every frame, so edits are handed to it (see syncSimulation())
+        const float MIN_TIME = SimulationClock::MIN_TIME_OF_DAY_IN_HOURS;
+        const float MAX_TIME = SimulationClock::MAX_TIME_OF_DAY_IN_HOURS;
         if (ImGui::SliderFloat("TIME OF DAY (HOURS)", &m_renderEngine->timeOfDayInHours, MIN_TIME, MAX_TIME))
         {
             // force-clamp (handle CTRL + LEFT_CLICK)
             m_renderEngine->timeOfDayInHours = glm::clamp(m_renderEngine->timeOfDayInHours, MIN_TIME, MAX_TIME);
+            m_simulationClock->setTimeOfDayInHours(m_renderEngine->timeOfDayInHours);
         }
 
         ImGui::SameLine();
@@ -176,45 +364,79 @@ namespace wave_tool
         {
             m_renderEngine->isAnimatingTimeOfDay = !m_renderEngine->isAnimatingTimeOfDay;
         }
-        if (m_renderEngine->isAnimatingTimeOfDay && m_renderEngine->animationSpeedTimeOfDayInSecondsPerHour > 0.0f)
+
+        if (ImGui::SliderInt("SKY FACES PER FRAME (WHILE ANIMATING)", &m_renderEngine->skyboxCubemapFacesPerFrame, 1, 6))
         {
-            float const deltaTimeInSeconds = 1.0f / ImGui::GetIO().Framerate;
-            float const deltaTimeOfDayInHours = (1.0f / m_renderEngine->animationSpeedTimeOfDayInSecondsPerHour) * deltaTimeInSeconds;
-            m_renderEngine->timeOfDayInHours += deltaTimeOfDayInHours;
-            m_renderEngine->timeOfDayInHours = MIN_TIME + glm::mod(m_renderEngine->timeOfDayInHours - MIN_TIME, MAX_TIME - MIN_TIME);
+            // force-clamp (handle CTRL + LEFT_CLICK)
+            m_renderEngine->skyboxCubemapFacesPerFrame = glm::clamp(m_renderEngine->skyboxCubemapFacesPerFrame, 1, 6);
         }
 
+        // NOTE: items must be in order of downsample level (0 == full resolution)
+        ImGui::Combo("LOCAL REFLECTIONS RESOLUTION", &m_renderEngine->localReflectionsDownsampleLevel, "FULL\0HALF\0QUARTER\0");
+        ImGui::Combo("LOCAL REFRACTIONS RESOLUTION", &m_renderEngine->localRefractionsDownsampleLevel, "FULL\0HALF\0QUARTER\0");
+
         if (ImGui::SliderFloat("CLOUD PROPORTION", &m_renderEngine->cloudProportion, 0.0f, 0.3f))
         {
             // force-clamp (handle CTRL + LEFT_CLICK)
             m_renderEngine->cloudProportion = glm::clamp(m_renderEngine->cloudProportion, 0.0f, 0.3f);
         }
 
-        static int GerstnerWaveCount = 4;
-        if (ImGui::InputInt("Gerstner Wave Count", &GerstnerWaveCount, 1, 1))
-        {
-            GerstnerWaveCount = glm::clamp(GerstnerWaveCount, 1, 4);
-        }
-        ImGui::SameLine();
-        if (ImGui::Button("Generate"))
+        // set by every edit of the waves below, so the CPU surface queries are re-snapshotted before the UI reads them
+        bool areWavesEdited{false};
+
+        if (ImGui::TreeNode("GERSTNER SPECTRUM"))
         {
-            for (int i = 0; i < geometry::GerstnerWave::MAX_COUNT; ++i)
+            GerstnerSpectrum::Parameters &parameters{m_renderEngine->gerstnerSpectrumParameters};
+            ImGui::Separator();
+            int waveCount{(int)parameters.waveCount};
+            if (ImGui::SliderInt("WAVE COUNT", &waveCount, 1, geometry::GerstnerWave::MAX_COUNT))
             {
-                if (i < GerstnerWaveCount)
-                {
-                    float A, w, phi, steep;
-                    glm::vec2 dir;
-                    A = getRandomFloat(0.05f, 0.15f);   // amplitude: 0.05 ~ 0.15
-                    w = getRandomFloat(0.5f, 2.0f);     // frequency: 0.5 ~ 2.0
-                    phi = getRandomFloat(0.3f, 1.0f);   // phase: 0.3 ~ 1.0
-                    steep = getRandomFloat(0.0f, 1.0f); // steepness: 0.0 ~ 1.0
-                    dir = getRandomDirection();
-                    m_renderEngine->gerstnerWaves.at(i) = nullptr;
-                    m_renderEngine->gerstnerWaves.at(i) = std::make_shared<geometry::GerstnerWave>(A, w, phi, steep, dir);
-                }
-                else
-                    m_renderEngine->gerstnerWaves.at(i) = nullptr;
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.waveCount = (unsigned int)glm::clamp(waveCount, 1, (int)geometry::GerstnerWave::MAX_COUNT);
+            }
+            if (ImGui::SliderFloat("WIND SPEED (M/S)", &parameters.windSpeed, 0.5f, 30.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.windSpeed = glm::max(parameters.windSpeed, 0.5f);
+            }
+            ImGui::SliderFloat("WIND DIRECTION (DEGREES)", &parameters.windDirectionInDegrees, -180.0f, 180.0f);
+            if (ImGui::SliderFloat("DIRECTIONAL SPREADING", &parameters.spreadingExponent, 0.0f, 64.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.spreadingExponent = glm::max(parameters.spreadingExponent, 0.0f);
+            }
+            if (ImGui::SliderFloat("MIN WAVELENGTH (M)", &parameters.minWavelengthInMeters, 0.05f, 10.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.minWavelengthInMeters = glm::clamp(parameters.minWavelengthInMeters, 0.05f, parameters.maxWavelengthInMeters);
+            }
+            if (ImGui::SliderFloat("MAX WAVELENGTH (M)", &parameters.maxWavelengthInMeters, 1.0f, 500.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.maxWavelengthInMeters = glm::max(parameters.maxWavelengthInMeters, parameters.minWavelengthInMeters);
+            }
+            if (ImGui::SliderFloat("AMPLITUDE SCALE", &parameters.amplitudeScale, 0.0f, 4.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.amplitudeScale = glm::max(parameters.amplitudeScale, 0.0f);
+            }
+            if (ImGui::SliderFloat("STEEPNESS", &parameters.steepness, 0.0f, 1.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.steepness = glm::clamp(parameters.steepness, 0.0f, 1.0f);
             }
+            int seed{(int)parameters.seed};
+            if (ImGui::InputInt("SEED", &seed))
+                parameters.seed = (unsigned int)seed;
+            if (ImGui::Button("GENERATE"))
+            {
+                GerstnerSpectrum::generate(parameters, m_renderEngine->gerstnerWaves);
+                areWavesEdited = true;
+            }
+            ImGui::SameLine();
+            ImGui::Text("(%u WAVES, TOTAL AMPLITUDE %.2f M)", geometry::GerstnerWave::Count(), geometry::GerstnerWave::TotalAmplitude());
+            ImGui::Separator();
+            ImGui::TreePop();
         }
 
         ImGui::Separator();
@@ -246,23 +468,27 @@ namespace wave_tool
                             // force-clamp (handle CTRL + LEFT_CLICK)
                             if (m_renderEngine->gerstnerWaves.at(i)->amplitude_A < 0.0f)
                                 m_renderEngine->gerstnerWaves.at(i)->amplitude_A = 0.0f;
+                            areWavesEdited = true;
                         }
-                        if (ImGui::SliderFloat(std::string{"Frequency##" + std::to_string(i)}.c_str(), &m_renderEngine->gerstnerWaves.at(i)->frequency_w, 0.0f, 1.0f))
+                        if (ImGui::SliderFloat(std::string{"Frequency##" + std::to_string(i)}.c_str(), &m_renderEngine->gerstnerWaves.at(i)->frequency_w, 0.0f, 16.0f))
                         {
                             // force-clamp (handle CTRL + LEFT_CLICK)
                             if (m_renderEngine->gerstnerWaves.at(i)->frequency_w < 0.0f)
                                 m_renderEngine->gerstnerWaves.at(i)->frequency_w = 0.0f;
+                            areWavesEdited = true;
                         }
                         if (ImGui::SliderFloat(std::string{"Phase Constant (~Speed)##" + std::to_string(i)}.c_str(), &m_renderEngine->gerstnerWaves.at(i)->phaseConstant_phi, 0.0f, 10.0f))
                         {
                             // force-clamp (handle CTRL + LEFT_CLICK)
                             if (m_renderEngine->gerstnerWaves.at(i)->phaseConstant_phi < 0.0f)
                                 m_renderEngine->gerstnerWaves.at(i)->phaseConstant_phi = 0.0f;
+                            areWavesEdited = true;
                         }
                         if (ImGui::SliderFloat(std::string{"Steepness##" + std::to_string(i)}.c_str(), &m_renderEngine->gerstnerWaves.at(i)->steepness_Q, 0.0f, 1.0f))
                         {
                             // force-clamp (handle CTRL + LEFT_CLICK)
                             m_renderEngine->gerstnerWaves.at(i)->steepness_Q = glm::clamp(m_renderEngine->gerstnerWaves.at(i)->steepness_Q, 0.0f, 1.0f);
+                            areWavesEdited = true;
                         }
                         if (ImGui::SliderFloat2(std::string{"XZ-Direction##" + std::to_string(i)}.c_str(), (float *)&m_renderEngine->gerstnerWaves.at(i)->xzDirection_D, -1.0f, 1.0f))
                         {
@@ -274,6 +500,7 @@ namespace wave_tool
                                 m_renderEngine->gerstnerWaves.at(i)->xzDirection_D = glm::vec2{0.0f, 1.0f};
                             else
                                 m_renderEngine->gerstnerWaves.at(i)->xzDirection_D = glm::normalize(m_renderEngine->gerstnerWaves.at(i)->xzDirection_D);
+                            areWavesEdited = true;
                         }
                         ImGui::Separator();
                         ImGui::TreePop();
@@ -285,6 +512,52 @@ namespace wave_tool
             ImGui::Separator();
         }
 
+        if (ImGui::SliderFloat("TESSELLATION TARGET EDGE (PIXELS)", &m_renderEngine->tessellationTargetEdgeLengthInPixels, 2.0f, 64.0f))
+        {
+            // force-clamp (handle CTRL + LEFT_CLICK)
+            if (m_renderEngine->tessellationTargetEdgeLengthInPixels < 1.0f)
+                m_renderEngine->tessellationTargetEdgeLengthInPixels = 1.0f;
+        }
+
+        // NOTE: items must be in order of WaterGeometryMode
+        ImGui::Combo("WATER GEOMETRY", &m_renderEngine->waterGeometryMode, "PROJECTED GRID\0CLIPMAP\0");
+        if (WaterGeometryMode::CLIPMAP == m_renderEngine->waterGeometryMode)
+        {
+            OceanClipmap::Parameters &parameters{m_renderEngine->oceanClipmapParameters};
+            if (ImGui::SliderFloat("CLIPMAP FINEST TILE SIZE (m)", &parameters.finestTileSize, 0.5f, 16.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.finestTileSize = glm::max(parameters.finestTileSize, 0.5f);
+            }
+            // even only
+            int cellsIndex{0};
+            unsigned int const CELLS[]{8, 16, 32, 64};
+            char const *const CELLS_NAMES[]{"8", "16", "32", "64"};
+            while (cellsIndex < IM_ARRAYSIZE(CELLS) - 1 && CELLS[cellsIndex] < parameters.cellsPerTile)
+                ++cellsIndex;
+            if (ImGui::Combo("CLIPMAP CELLS PER TILE", &cellsIndex, CELLS_NAMES, IM_ARRAYSIZE(CELLS_NAMES)))
+                parameters.cellsPerTile = CELLS[cellsIndex];
+            int levelCount{(int)parameters.levelCount};
+            if (ImGui::SliderInt("CLIPMAP LEVELS", &levelCount, 1, 10))
+                parameters.levelCount = (unsigned int)glm::clamp(levelCount, 1, (int)OceanClipmap::MAX_LEVEL_COUNT);
+            if (ImGui::SliderFloat("CLIPMAP RANGE (TILES)", &parameters.rangeInTiles, 3.0f, 8.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.rangeInTiles = glm::max(parameters.rangeInTiles, 3.0f);
+            }
+            std::shared_ptr<OceanClipmap const> const clipmap{m_renderEngine->getOceanClipmap()};
+            // NOTE: the lower bound depends on the range (see OceanClipmap::setParameters), so the effective value is shown as well
+            ImGui::SliderFloat("CLIPMAP MORPH START", &parameters.morphStartRatio, 0.5f, 0.95f);
+            ImGui::Text("(EFFECTIVE MORPH START %.2f)", clipmap->getParameters().morphStartRatio);
+            ImGui::Text("WATER TILES: %u, PATCHES: %u", (unsigned int)clipmap->getTiles().size(), clipmap->getCellCount());
+        }
+        else
+        {
+            GLuint const gridLength{m_renderEngine->computeWaterGridLength()};
+            ImGui::Text("WATER-GRID BASE LENGTH: %u, PATCHES: %u", gridLength, (gridLength - 1) * (gridLength - 1));
+        }
+        ImGui::Text("WATER PRIMITIVES (TESSELLATED): %u", m_renderEngine->getWaterPrimitiveCount());
+
         if (ImGui::SliderFloat("WATER BUMP ROUGHNESS", &m_renderEngine->heightmapSampleScale, 0.0f, 1.0f))
         {
             // force-clamp (handle CTRL + LEFT_CLICK)
@@ -299,17 +572,77 @@ namespace wave_tool
                 m_renderEngine->heightmapDisplacementScale = 0.0f;
         }
 
+        // statistical ocean (replaces the water bump heightmap while enabled)...
+        if (ImGui::TreeNode("OCEAN FFT"))
+        {
+            OceanFFT::Parameters &parameters{m_renderEngine->oceanFFTParameters};
+            ImGui::Checkbox("ENABLED##2", &m_renderEngine->isUsingOceanFFT);
+
+            int spectrum{(int)parameters.spectrum};
+            char const *const SPECTRUM_NAMES[]{"PHILLIPS", "JONSWAP"};
+            if (ImGui::Combo("SPECTRUM", &spectrum, SPECTRUM_NAMES, IM_ARRAYSIZE(SPECTRUM_NAMES)))
+                parameters.spectrum = (OceanFFT::Spectrum)spectrum;
+
+            // power of 2 only
+            int resolutionIndex{0};
+            unsigned int const RESOLUTIONS[]{64, 128, 256, 512};
+            char const *const RESOLUTION_NAMES[]{"64", "128", "256", "512"};
+            while (resolutionIndex < IM_ARRAYSIZE(RESOLUTIONS) - 1 && RESOLUTIONS[resolutionIndex] < parameters.resolution)
+                ++resolutionIndex;
+            if (ImGui::Combo("RESOLUTION", &resolutionIndex, RESOLUTION_NAMES, IM_ARRAYSIZE(RESOLUTION_NAMES)))
+                parameters.resolution = RESOLUTIONS[resolutionIndex];
+
+            if (ImGui::SliderFloat("PATCH LENGTH (m)", &parameters.patchLengthInMeters, 10.0f, 1000.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.patchLengthInMeters = glm::max(parameters.patchLengthInMeters, 1.0f);
+            }
+            if (ImGui::SliderFloat("WIND SPEED (m/s)", &parameters.windSpeed, 0.5f, 30.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.windSpeed = glm::max(parameters.windSpeed, 0.5f);
+            }
+            ImGui::SliderFloat("WIND DIRECTION (DEGREES)", &parameters.windDirectionInDegrees, -180.0f, 180.0f);
+            if (OceanFFT::Spectrum::JONSWAP == parameters.spectrum && ImGui::SliderFloat("FETCH (m)", &parameters.fetchInMeters, 1000.0f, 1000000.0f, "%.0f", 4.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.fetchInMeters = glm::max(parameters.fetchInMeters, 1.0f);
+            }
+            if (ImGui::SliderFloat("AMPLITUDE SCALE", &parameters.amplitudeScale, 0.0f, 4.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.amplitudeScale = glm::max(parameters.amplitudeScale, 0.0f);
+            }
+            if (ImGui::SliderFloat("CHOPPINESS", &parameters.choppiness, 0.0f, 2.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.choppiness = glm::max(parameters.choppiness, 0.0f);
+            }
+            if (ImGui::SliderFloat("SMALL-WAVE CUTOFF (m)", &parameters.smallWaveCutoffInMeters, 0.0f, 1.0f))
+            {
+                // force-clamp (handle CTRL + LEFT_CLICK)
+                parameters.smallWaveCutoffInMeters = glm::max(parameters.smallWaveCutoffInMeters, 0.0f);
+            }
+            int seed{(int)parameters.seed};
+            if (ImGui::InputInt("SEED", &seed))
+                parameters.seed = (unsigned int)glm::max(seed, 0);
+            ImGui::TreePop();
+        }
+
         if (ImGui::SliderFloat("VERTICAL-BOUNCE-WAVE AMPLITUDE", &m_renderEngine->verticalBounceWaveAmplitude, 0.0f, 1.0f))
         {
             // force-clamp (handle CTRL + LEFT_CLICK)
             if (m_renderEngine->verticalBounceWaveAmplitude < 0.0f)
                 m_renderEngine->verticalBounceWaveAmplitude = 0.0f;
+            areWavesEdited = true;
         }
 
         if (ImGui::SliderFloat("VERTICAL-BOUNCE-WAVE PHASE", &m_renderEngine->verticalBounceWavePhase, 0.0f, 1.0f))
         {
             // force-clamp (handle CTRL + LEFT_CLICK)
             m_renderEngine->verticalBounceWavePhase = glm::clamp(m_renderEngine->verticalBounceWavePhase, 0.0f, 1.0f);
+            m_simulationClock->setVerticalBounceWavePhase(m_renderEngine->verticalBounceWavePhase);
+            areWavesEdited = true;
         }
 
         // TODO: once i figure out why the Gerstner waves decay over time, change the max here to an appropriate value (and maybe clamp or mod???)
@@ -320,8 +653,16 @@ namespace wave_tool
             // force-clamp (handle CTRL + LEFT_CLICK)
             if (m_renderEngine->waveAnimationTimeInSeconds < 0.0f)
                 m_renderEngine->waveAnimationTimeInSeconds = 0.0f;
+            m_simulationClock->setWaveAnimationTimeInSeconds(m_renderEngine->waveAnimationTimeInSeconds);
         }
 
+        // water surface directly below the camera (CPU query, Gerstner waves only)
+        if (areWavesEdited)
+            m_renderEngine->updateOceanSurface();
+        glm::vec3 const cameraPosition{m_renderEngine->getCamera()->getPosition()};
+        OceanSurface::Sample const waterBelowCamera{m_renderEngine->getOceanSurface()->queryDisplaced(cameraPosition.x, cameraPosition.z, m_renderEngine->waveAnimationTimeInSeconds)};
+        ImGui::Text("WATER HEIGHT BELOW CAMERA: %.3f m (CAMERA %.3f m ABOVE IT)", waterBelowCamera.position.y, cameraPosition.y - waterBelowCamera.position.y);
+
         if (ImGui::Button("TOGGLE ANIMATION##1"))
         {
             m_renderEngine->isAnimatingWaves = !m_renderEngine->isAnimatingWaves;
@@ -336,25 +677,7 @@ namespace wave_tool
                 m_renderEngine->animationSpeedVerticalBounceWavePhasePeriodInSeconds = 0.0f;
         }
         ImGui::PopItemWidth();
-
-        // TODO: refactor this into its own function somewhere else...
-        // TODO: check if this ImGui framerate is applicable here (or is it an average of several frames???)
-        if (m_renderEngine->isAnimatingWaves)
-        {
-            float const deltaTimeInSeconds = 1.0f / ImGui::GetIO().Framerate;
-
-            m_renderEngine->waveAnimationTimeInSeconds += deltaTimeInSeconds;
-            // handle overflow...
-            if (m_renderEngine->waveAnimationTimeInSeconds < 0.0f)
-                m_renderEngine->waveAnimationTimeInSeconds = 0.0f;
-
-            if (m_renderEngine->animationSpeedVerticalBounceWavePhasePeriodInSeconds > 0.0f)
-            {
-                float const deltaVerticalBounceWavePhase = (1.0f / m_renderEngine->animationSpeedVerticalBounceWavePhasePeriodInSeconds) * deltaTimeInSeconds;
-                m_renderEngine->verticalBounceWavePhase += deltaVerticalBounceWavePhase;
-                m_renderEngine->verticalBounceWavePhase = glm::mod(m_renderEngine->verticalBounceWavePhase, 1.0f);
-            }
-        }
+        ImGui::Text("SIMULATION: %.0f TICKS/S (%llu TICKS, %llu DROPPED)", m_simulationClock->getTicksPerSecond(), m_simulationClock->getTickCount(), m_simulationClock->getDroppedTickCount());
 
         // if (ImGui::SliderFloat("TINT DEPTH THRESHOLD", &m_renderEngine->tintDeltaDepthThreshold, 0.0f, 1.0f))
         // {
@@ -375,6 +698,52 @@ namespace wave_tool
         // }
         ImGui::Separator();
 
+        // per-pass timings over the last Profiler::getHistoryLength() frames...
+        if (ImGui::TreeNode("PROFILER"))
+        {
+            Profiler &profiler{*m_renderEngine->getProfiler()};
+            ImGui::Checkbox("ENABLED", &profiler.isEnabled);
+            ImGui::SameLine();
+            if (ImGui::Button("DUMP TO CSV"))
+            {
+                profiler.flush();
+                profiler.writeCSV("profile.csv");
+            }
+
+            auto const statisticsRow{[](char const *type, char const *name, Profiler::Statistics const &stats) {
+                ImGui::Text("%s %s", type, name);
+                ImGui::NextColumn();
+                ImGui::Text("%.3f", stats.latestMs);
+                ImGui::NextColumn();
+                ImGui::Text("%.3f", stats.minMs);
+                ImGui::NextColumn();
+                ImGui::Text("%.3f", stats.avgMs);
+                ImGui::NextColumn();
+                ImGui::Text("%.3f", stats.p99Ms);
+                ImGui::NextColumn();
+            }};
+
+            ImGui::Columns(5, "PROFILER TABLE");
+            ImGui::Separator();
+            for (char const *header : {"SECTION", "LATEST (ms)", "MIN (ms)", "AVG (ms)", "P99 (ms)"})
+            {
+                ImGui::Text("%s", header);
+                ImGui::NextColumn();
+            }
+            ImGui::Separator();
+            for (unsigned int pass = 0; pass < Profiler::GPU_PASS_COUNT; ++pass)
+                statisticsRow("GPU", Profiler::getName((Profiler::GpuPass)pass), profiler.getGpuStatistics((Profiler::GpuPass)pass));
+            for (unsigned int section = 0; section < Profiler::CPU_SECTION_COUNT; ++section)
+                statisticsRow("CPU", Profiler::getName((Profiler::CpuSection)section), profiler.getCpuStatistics((Profiler::CpuSection)section));
+            ImGui::Columns(1);
+            ImGui::Separator();
+
+            std::array<unsigned int, RenderQueue::PASS_COUNT> const visibleObjectCounts{m_renderEngine->getVisibleObjectCounts()};
+            ImGui::Text("OBJECTS AFTER CULLING (REFLECTIONS / REFRACTIONS / DEPTH): %u / %u / %u OF %zu", visibleObjectCounts.at(RenderQueue::LOCAL_REFLECTIONS), visibleObjectCounts.at(RenderQueue::LOCAL_REFRACTIONS), visibleObjectCounts.at(RenderQueue::DEPTH), m_renderEngine->getCullableObjectCount());
+
+            ImGui::TreePop();
+        }
+
         ImGui::End();
 
         ImGui::EndFrame();
@@ -387,6 +756,22 @@ namespace wave_tool
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
 
+        // stops the simulation thread
+        m_simulationClock = nullptr;
+
+        // release all GL objects while the context is still current (this also stops the shader worker before its window goes away)...
+        m_meshObjects.clear();
+        m_skyboxClouds = nullptr;
+        m_skyboxStars = nullptr;
+        m_skysphere = nullptr;
+        m_waterGrid = nullptr;
+        m_renderEngine = nullptr;
+        if (nullptr != m_shaderWorkerWindow)
+        {
+            glfwDestroyWindow(m_shaderWorkerWindow);
+            m_shaderWorkerWindow = nullptr;
+        }
+
         // glfw cleanup...
         if (nullptr != m_window)
         {
@@ -397,6 +782,23 @@ namespace wave_tool
         return true;
     }
 
+    void Program::updateShaderHotReload()
+    {
+        for (auto const &[previousProgram, program] : m_renderEngine->updateShaderHotReload())
+        {
+            for (std::shared_ptr<MeshObject> const &o : m_meshObjects)
+            {
+                if (previousProgram == o->shaderProgramID)
+                    o->shaderProgramID = program;
+            }
+            for (std::shared_ptr<MeshObject> const &o : {m_skyboxClouds, m_skyboxStars, m_skysphere, m_waterGrid})
+            {
+                if (nullptr != o && previousProgram == o->shaderProgramID)
+                    o->shaderProgramID = program;
+            }
+        }
+    }
+
     // NOTE: this method should only be called ONCE at start
     void Program::initScene()
     {
@@ -418,97 +820,93 @@ namespace wave_tool
         // TODO: is it possible to mirror the skybox textures on loading them in (since we are inside the cube), but keeping the proper orientation???
         //  hard-coded skyboxes...
 
+        // every mesh and image below is parsed / decoded concurrently on the thread pool, and each texture is uploaded on this (the context) thread as soon as its pixels are ready
+        // NOTE: nothing here is used until the wait below, so the loads can't run in the wrong order
+        std::shared_ptr<ThreadPool> const threadPool = m_renderEngine->getThreadPool();
+        std::vector<ThreadPool::TaskHandle> loads;
+
         // this will hold the skybox geometry (cube) and star skybox cubemap
-        m_skyboxStars = ObjectLoader::createTriMeshObject("../../assets/models/imports/cube.obj", true, true);
+        GLuint skyboxStarsCubemap = 0;
+        loads.push_back(threadPool->submit([this, threadPool]() { m_skyboxStars = ObjectLoader::createTriMeshObject("../../assets/models/imports/cube.obj", true, true, threadPool); }));
+        loads.push_back(m_renderEngine->loadCubemapAsync({"../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/right.png",
+                                                          "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/left.png",
+                                                          "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/top.png",
+                                                          "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/bottom.png",
+                                                          "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/front.png",
+                                                          "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/back.png"},
+                                                         skyboxStarsCubemap));
+
+        // skysphere...
+        GLuint skyGradientTexture = 0;
+        loads.push_back(threadPool->submit([this, threadPool]() { m_skysphere = ObjectLoader::createTriMeshObject("../../assets/models/imports/icosphere.obj", true, true, threadPool); }));
+        loads.push_back(m_renderEngine->load1DTextureAsync("../../assets/textures/sky-gradient.png", skyGradientTexture));
+
+        // this will hold the skybox geometry (cube) and cloud skybox cubemap
+        GLuint skyboxCloudsCubemap = 0;
+        loads.push_back(threadPool->submit([this, threadPool]() { m_skyboxClouds = ObjectLoader::createTriMeshObject("../../assets/models/imports/cube.obj", true, true, threadPool); }));
+        loads.push_back(m_renderEngine->loadCubemapAsync({"../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Right.bmp",
+                                                          "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Left.bmp",
+                                                          "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Top.bmp",
+                                                          "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Bottom.bmp",
+                                                          "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Front.bmp",
+                                                          "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Back.bmp"},
+                                                         skyboxCloudsCubemap));
+
+        GLuint waterGridHeightmap = 0;
+        loads.push_back(m_renderEngine->loadHeightmapTextureAsync("../../assets/textures/noise/waves/waves3/00.png", waterGridHeightmap));
+
+        m_waterGrid = std::make_shared<MeshObject>();
+        // m_waterGrid->m_polygonMode = PolygonMode::POINT; //NOTE: doing this atm makes a cool pixel art world
+        // NOTE: the water grid has no vertices or faces - it is generated in its shaders (see RenderEngine::render), so assignBuffers only gives it an empty vao
+
+        threadPool->wait(loads);
+
+        // a texture whose object failed to load (or vice versa) is dropped
+        auto const releaseUnused = [](GLuint const textureID) {
+            if (0 != textureID)
+                glDeleteTextures(1, &textureID);
+        };
+
         if (nullptr != m_skyboxStars)
         {
-            m_skyboxStars->textureID = m_renderEngine->loadCubemap({"../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/right.png",
-                                                                    "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/left.png",
-                                                                    "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/top.png",
-                                                                    "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/bottom.png",
-                                                                    "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/front.png",
-                                                                    "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-stars-2048/back.png"});
-
-            if (nullptr != m_skyboxStars)
-            {
-                m_skyboxStars->shaderProgramID = m_renderEngine->getSkyboxStarsProgram();
-                m_renderEngine->assignBuffers(*m_skyboxStars);
-            }
+            m_skyboxStars->textureID = skyboxStarsCubemap;
+            m_skyboxStars->vertexFormat = VertexFormat::PACKED_INTERLEAVED;
+            m_skyboxStars->shaderProgramID = m_renderEngine->getSkyboxStarsProgram();
+            m_renderEngine->assignBuffers(*m_skyboxStars);
+        }
+        else
+        {
+            releaseUnused(skyboxStarsCubemap);
         }
 
-        // skysphere...
-        m_skysphere = ObjectLoader::createTriMeshObject("../../assets/models/imports/icosphere.obj", true, true);
+        // fallback #1 (no skysphere)
+        if (0 == skyGradientTexture)
+            m_skysphere = nullptr;
         if (nullptr != m_skysphere)
         {
-            m_skysphere->textureID = m_renderEngine->load1DTexture("../../assets/textures/sky-gradient.png");
-            // fallback #1 (no skysphere)
-            if (0 == m_skysphere->textureID)
-                m_skysphere = nullptr;
-            if (nullptr != m_skysphere)
-            {
-                m_skysphere->shaderProgramID = m_renderEngine->getSkysphereProgram();
-                m_renderEngine->assignBuffers(*m_skysphere);
-            }
+            m_skysphere->textureID = skyGradientTexture;
+            m_skysphere->vertexFormat = VertexFormat::PACKED_INTERLEAVED;
+            m_skysphere->shaderProgramID = m_renderEngine->getSkysphereProgram();
+            m_renderEngine->assignBuffers(*m_skysphere);
+        }
+        else
+        {
+            releaseUnused(skyGradientTexture);
         }
 
-        // this will hold the skybox geometry (cube) and cloud skybox cubemap
-        m_skyboxClouds = ObjectLoader::createTriMeshObject("../../assets/models/imports/cube.obj", true, true);
         if (nullptr != m_skyboxClouds)
         {
-            m_skyboxClouds->textureID = m_renderEngine->loadCubemap({"../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Right.bmp",
-                                                                     "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Left.bmp",
-                                                                     "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Top.bmp",
-                                                                     "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Bottom.bmp",
-                                                                     "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Front.bmp",
-                                                                     "../../assets/textures/skyboxes/wwwtyro-space-3d/2drp4i9sx0lc-nebulae-2048/DaylightBox_Back.bmp"});
-
+            m_skyboxClouds->textureID = skyboxCloudsCubemap;
+            m_skyboxClouds->vertexFormat = VertexFormat::PACKED_INTERLEAVED;
             m_skyboxClouds->shaderProgramID = m_renderEngine->getSkyboxCloudsProgram();
             m_renderEngine->assignBuffers(*m_skyboxClouds);
         }
-
-        m_waterGrid = std::make_shared<MeshObject>();
-        // m_waterGrid->m_polygonMode = PolygonMode::POINT; //NOTE: doing this atm makes a cool pixel art world
-        // TEMP: hacking some indices together to draw grid as tri-mesh (should move this to MeshObject in the future)...
-        // TODO: explain this better in the future (with diagrams)
-
-        // first, store indices into a length * length square grid
-        // NOTE: atm, this must match the constant of the same name in render-engine.cpp, but will be changed in the future
-        GLuint const GRID_LENGTH = 513;
-        // NOTE: must use vector instead of array to handle larger grid lengths
-        //  zero-fill
-        std::vector<std::vector<GLuint>> gridIndices(GRID_LENGTH, std::vector<GLuint>(GRID_LENGTH, 0));
-        // now fill with the proper indices in the same layout that shader expects
-        // not that it really matters, but visualize it as [row][col] = [0][0] as the bottom-left element of 2D array
-        GLuint counterIndex = 0;
-        for (GLuint row = 0; row < GRID_LENGTH; ++row)
-        {
-            for (GLuint col = 0; col < GRID_LENGTH; ++col)
-            {
-                gridIndices.at(row).at(col) = counterIndex;
-                ++counterIndex;
-            }
-        }
-
-        // now using the vertex indices in this format, we can easily tesselate this grid into triangles as so...
-        // TODO: draw a diagram comment here to better explain this
-        for (GLuint row = 0; row < GRID_LENGTH - 1; ++row)
+        else
         {
-            for (GLuint col = 0; col < GRID_LENGTH - 1; ++col)
-            {
-                // make 2 triangles (thus a square) from each of these indices acting as the bottom-left corner
-                // ensures that the winding of all triangles is counter-clockwise
-
-                m_waterGrid->drawFaces.push_back(gridIndices.at(row).at(col));
-                m_waterGrid->drawFaces.push_back(gridIndices.at(row + 1).at(col + 1));
-                m_waterGrid->drawFaces.push_back(gridIndices.at(row + 1).at(col));
-
-                m_waterGrid->drawFaces.push_back(gridIndices.at(row).at(col));
-                m_waterGrid->drawFaces.push_back(gridIndices.at(row).at(col + 1));
-                m_waterGrid->drawFaces.push_back(gridIndices.at(row + 1).at(col + 1));
-            }
+            releaseUnused(skyboxCloudsCubemap);
         }
 
-        m_waterGrid->textureID = m_renderEngine->load2DTexture("../../assets/textures/noise/waves/waves3/00.png"); // WARNING: THIS MAY HAVE TO BE CHANGED TO LOAD IN SPECIFICALLY WITH 8-bits (or may work, but should be optimized)
+        m_waterGrid->textureID = waterGridHeightmap;
         // fallback #1 (no water grid)
         if (0 == m_waterGrid->textureID)
             m_waterGrid = nullptr;
@@ -550,9 +948,7 @@ namespace wave_tool
         // reference: https://stackoverflow.com/questions/42848322/what-does-my-choice-of-glfw-samples-actually-do
         // glfwWindowHint(GLFW_SAMPLES, 4);
         // glEnable(GL_MULTISAMPLE);
-        int const WIDTH = 1024;
-        int const HEIGHT = 1024;
-        m_window = glfwCreateWindow(WIDTH, HEIGHT, "WaveTool", nullptr, nullptr);
+        m_window = glfwCreateWindow(m_launchOptions.width, m_launchOptions.height, "WaveTool", nullptr, nullptr);
         if (!m_window)
         {
             std::cout << "ERROR: Program failed to create GLFW window, TERMINATING..." << std::endl;
@@ -585,6 +981,7 @@ namespace wave_tool
             glfwTerminate();
             return false;
         }
+        GLExtensions::load((GLADloadproc)glfwGetProcAddress);
 
         // reference: https://blog.conan.io/2019/06/26/An-introduction-to-the-Dear-ImGui-library.html
         // setup Dear ImGui context...
@@ -606,25 +1003,6 @@ namespace wave_tool
         return true;
     }
 
-    // 랜덤 생성을 위한 함수
-    glm::vec2 Program::getRandomDirection()
-    {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
-
-        glm::vec2 dir(dis(gen), dis(gen));
-        return glm::normalize(dir);
-    }
-
-    float Program::getRandomFloat(float min, float max)
-    {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        std::uniform_real_distribution<float> dis(min, max);
-        return dis(gen);
-    }
-
     void errorCallback(int error, char const *description)
     {
         std::cout << "GLFW ERROR: " << error << ":" << std::endl;
@@ -43,9 +43,10 @@
 #include <memory>
 #include <string>
 #include <vector>
-#include <random>
 #include <glm/glm.hpp>
 
+#include "launch-options.h"
+
 struct GLFWwindow;
 
 namespace wave_tool
@@ -53,13 +54,14 @@ namespace wave_tool
     class Camera;
     class MeshObject;
     class RenderEngine;
+    class SimulationClock;
 
     class Program
     {
     public:
         static unsigned int const s_IMAGE_SAVE_AS_NAME_CHAR_LIMIT{128};
 
-        Program();
+        Program(LaunchOptions const &launchOptions = LaunchOptions{});
         ~Program();
 
         std::shared_ptr<RenderEngine> getRenderEngine() const;
@@ -69,13 +71,16 @@ namespace wave_tool
 
     private:
         char m_imageSaveAsName[s_IMAGE_SAVE_AS_NAME_CHAR_LIMIT]{"image"};
+        LaunchOptions m_launchOptions;
         std::vector<std::shared_ptr<MeshObject>> m_meshObjects;
         std::shared_ptr<RenderEngine> m_renderEngine = nullptr;
         std::shared_ptr<MeshObject> m_skyboxClouds = nullptr;
         std::shared_ptr<MeshObject> m_skyboxStars = nullptr;
         std::shared_ptr<MeshObject> m_skysphere = nullptr;
         std::shared_ptr<MeshObject> m_waterGrid = nullptr;
+        std::unique_ptr<SimulationClock> m_simulationClock; // NOTE: no initializer, so SimulationClock can stay incomplete here
         GLFWwindow *m_window = nullptr;
+        GLFWwindow *m_shaderWorkerWindow = nullptr; // hidden, shares objects with m_window (see RenderEngine::enableShaderHotReload)
 
         // constructs Dear ImGui UI components
         void buildUI();
@@ -85,9 +90,12 @@ namespace wave_tool
         void queryGLVersion();
         // initializes GLFW and creates the window
         bool setupWindow();
-
-        glm::vec2 getRandomDirection();
-        float getRandomFloat(float min, float max);
+        // renders a fixed number of frames offscreen (no window/UI) and writes them to disk
+        bool startHeadless();
+        // hands the UI's animation rates to the simulation and copies its current (interpolated) state into the render engine
+        void syncSimulation();
+        // swaps in recompiled shader programs and points the objects that used the old ones to them
+        void updateShaderHotReload();
     };
 
     // functions passed to GLFW to handle errors and keyboard input
@@ -31,7 +31,12 @@
 
 #include "render-engine.h"
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -40,9 +45,60 @@
 
 namespace wave_tool
 {
-    RenderEngine::RenderEngine(GLFWwindow *window)
+    namespace
+    {
+        // pixels decoded by stb_image (and freed by it), or the pre-compressed blocks of the image instead
+        struct DecodedImage
+        {
+            int width{0};
+            int height{0};
+            std::unique_ptr<unsigned char, void (*)(void *)> pixels{nullptr, stbi_image_free};
+            std::shared_ptr<KTX2::Mapping const> compressed{nullptr};
+        };
+
+        // safe to call from any thread (stb_image keeps the flip flag per thread)
+        DecodedImage decodeImage(std::string const &filePath, bool const isFlipped, int const channels)
+        {
+            DecodedImage image;
+            int nrChannels; // the original number of 8-bit channels (the output always has the requested number)
+            stbi_set_flip_vertically_on_load_thread(isFlipped);
+            image.pixels.reset(stbi_load(filePath.c_str(), &image.width, &image.height, &nrChannels, channels));
+            return image;
+        }
+
+        // prefers the .ktx2 file next to the image (see tools/texconv.cpp) if its rows are in the same order stb_image would produce, since that skips decoding entirely
+        // NOTE: whether the GPU supports the compressed format can only be checked on the context thread (see ensureUploadable)
+        DecodedImage decodeImageOrContainer(std::string const &filePath, bool const isFlipped)
+        {
+            std::shared_ptr<KTX2::Mapping const> const container{KTX2::open(KTX2::getContainerPath(filePath))};
+            if (nullptr == container || isFlipped != container->isBottomUp())
+                return decodeImage(filePath, isFlipped, STBI_rgb_alpha);
+
+            DecodedImage image;
+            image.width = container->getWidth();
+            image.height = container->getHeight();
+            image.compressed = container;
+            return image;
+        }
+
+        // must be called on the context thread, falls back to decoding the image if its compressed format can't be uploaded
+        void ensureUploadable(DecodedImage &image, std::string const &filePath, bool const isFlipped)
+        {
+            if (nullptr != image.compressed && !Texture::isCompressedFormatSupported(image.compressed->getFormat()))
+                image = decodeImage(filePath, isFlipped, STBI_rgb_alpha);
+        }
+
+        // the CPU side of loadHeightmapTexture (see there)
+        struct HeightmapTexels
+        {
+            int width{0};
+            int height{0};
+            std::vector<float> texels; // empty if decoding failed
+        };
+    }
+
+    RenderEngine::RenderEngine(int windowWidth, int windowHeight) : m_windowHeight{windowHeight}, m_windowWidth{windowWidth}
     {
-        glfwGetWindowSize(window, &m_windowWidth, &m_windowHeight);
 
         // hard-coded defaults
         gerstnerWaves.at(0) = std::make_shared<geometry::GerstnerWave>(0.1f, 1.0f, 0.7f, 1.0f, glm::vec2{-1.0f, 0.0f});
@@ -50,19 +106,26 @@ namespace wave_tool
         gerstnerWaves.at(2) = std::make_shared<geometry::GerstnerWave>(0.03f, 2.0f, 0.5f, 0.0f, glm::vec2{0.0f, 1.0f});
         gerstnerWaves.at(3) = std::make_shared<geometry::GerstnerWave>(0.05f, 2.0f, 1.0f, 0.0f, glm::normalize(glm::vec2{1.0f, -1.0f}));
 
+        m_profiler = std::make_shared<Profiler>();
+        m_threadPool = std::make_shared<ThreadPool>();
+        m_oceanFFT = std::make_shared<OceanFFT>(m_threadPool);
+        m_oceanClipmap = std::make_shared<OceanClipmap>();
+        m_oceanClipmap->setParameters(oceanClipmapParameters);
+        m_oceanSurface = std::make_shared<OceanSurface>(m_threadPool);
+        updateOceanSurface();
+
         // NOTE: near distance must be small enough to not conflict with skybox size
         m_camera = std::make_shared<Camera>(72.0f, (float)m_windowWidth / m_windowHeight, Z_NEAR, Z_FAR, glm::vec3(0.0f, 4.0f, 70.0f));
 
         // TODO: assert these are not 0, or wrap them and assert non-null
-        depthProgram = ShaderTools::compileShaders("../../assets/shaders/depth.vert", "../../assets/shaders/depth.frag");
-        screenSpaceQuadProgram = ShaderTools::compileShaders("../../assets/shaders/screen-space-quad.vert", "../../assets/shaders/screen-space-quad.frag");
-        skyboxCloudsProgram = ShaderTools::compileShaders("../../assets/shaders/skybox-clouds.vert", "../../assets/shaders/skybox-clouds.frag");
-        skyboxStarsProgram = ShaderTools::compileShaders("../../assets/shaders/skybox-stars.vert", "../../assets/shaders/skybox-stars.frag");
-        skyboxTrivialProgram = ShaderTools::compileShaders("../../assets/shaders/skybox-trivial.vert", "../../assets/shaders/skybox-trivial.frag");
-        skysphereProgram = ShaderTools::compileShaders("../../assets/shaders/skysphere.vert", "../../assets/shaders/skysphere.frag");
-        mainProgram = ShaderTools::compileShaders("../../assets/shaders/main.vert", "../../assets/shaders/main.frag");
-        waterGridProgram = ShaderTools::compileShaders("../../assets/shaders/water-grid.vert", "../../assets/shaders/water-grid.frag",
-                                                       "../../assets/shaders/water-grid.tcs", "../../assets/shaders/water-grid.tes");
+        for (auto const &[program, sources] : getProgramSources())
+        {
+            auto const getFilename{[&sources = sources](int const stage) { return sources.at(stage).empty() ? nullptr : sources.at(stage).c_str(); }};
+            *program = ShaderTools::compileShaders(getFilename(ProgramCompilation::VERTEX), getFilename(ProgramCompilation::FRAGMENT),
+                                                   getFilename(ProgramCompilation::TESS_CONTROL), getFilename(ProgramCompilation::TESS_EVALUATION));
+            bindUniformBlocks(*program);
+        }
+        resolveUniformLocations();
 
         // Set OpenGL state
         glEnable(GL_DEPTH_TEST);
@@ -76,6 +139,15 @@ namespace wave_tool
         glGenVertexArrays(1, &m_emptyVAO);
         ///////////////////////////////////////////////////
 
+        glGenQueries((GLsizei)m_waterPrimitiveQueries.size(), m_waterPrimitiveQueries.data());
+
+        ///////////////////////////////////////////////////
+        // STREAMING BUFFER (per-frame uniform blocks, dynamic vertex data and the ocean maps are all written through it)...
+        // NOTE: uniform block ranges must start at a multiple of this
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_uniformBufferOffsetAlignment);
+        m_streamingBuffer = std::make_unique<StreamingBuffer>(STREAMING_BUFFER_REGION_SIZE);
+        ///////////////////////////////////////////////////
+
         ///////////////////////////////////////////////////
         // init stuff for dynamic skybox texture updating...
         // reference: https://www.youtube.com/watch?v=21UsMuFTN0k
@@ -116,12 +188,9 @@ namespace wave_tool
 
         ///////////////////////////////////////////////////
         // reference: https://learnopengl.com/Advanced-OpenGL/Framebuffers
-        // REUSABLE DEPTH/STENCIL RBO...
-        glGenRenderbuffers(1, &m_depth24Stencil8RBO);
-        glBindRenderbuffer(GL_RENDERBUFFER, m_depth24Stencil8RBO);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_windowWidth, m_windowHeight);
-        // unbind
-        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        // DEPTH/STENCIL RBOS (one per local target, since each target can have its own resolution)...
+        glGenRenderbuffers(1, &m_localReflectionsDepth24Stencil8RBO);
+        glGenRenderbuffers(1, &m_localRefractionsDepth24Stencil8RBO);
         ///////////////////////////////////////////////////
 
         ///////////////////////////////////////////////////
@@ -149,10 +218,10 @@ namespace wave_tool
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // generate empty texture (2D)...
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_windowWidth, m_windowHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
         // unbind
         glBindTexture(GL_TEXTURE_2D, 0);
+        // allocate the colour texture and its depth/stencil RBO at the (scaled) target resolution
+        resizeLocalReflectionsTarget();
 
         // LOCAL REFLECTIONS FBO...
         glGenFramebuffers(1, &m_localReflectionsFBO);
@@ -160,7 +229,7 @@ namespace wave_tool
         // attach colour buffer to FBO
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_localReflectionsTexture2D, 0);
         // attach depth/stencil buffer to FBO
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depth24Stencil8RBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_localReflectionsDepth24Stencil8RBO);
         // set fragment shader (location = 0) output
         glDrawBuffer(GL_COLOR_ATTACHMENT0);
         // check FBO setup status...
@@ -179,10 +248,10 @@ namespace wave_tool
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // generate empty texture (2D)...
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_windowWidth, m_windowHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
         // unbind
         glBindTexture(GL_TEXTURE_2D, 0);
+        // allocate the colour texture and its depth/stencil RBO at the (scaled) target resolution
+        resizeLocalRefractionsTarget();
 
         // LOCAL REFRACTIONS FBO...
         glGenFramebuffers(1, &m_localRefractionsFBO);
@@ -190,7 +259,7 @@ namespace wave_tool
         // attach colour buffer to FBO
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_localRefractionsTexture2D, 0);
         // attach depth/stencil buffer to FBO
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depth24Stencil8RBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_localRefractionsDepth24Stencil8RBO);
         // set fragment shader (location = 0) output
         glDrawBuffer(GL_COLOR_ATTACHMENT0);
         // check FBO setup status...
@@ -219,7 +288,8 @@ namespace wave_tool
 
     RenderEngine::~RenderEngine()
     {
-        glDeleteRenderbuffers(1, &m_depth24Stencil8RBO);
+        glDeleteRenderbuffers(1, &m_localReflectionsDepth24Stencil8RBO);
+        glDeleteRenderbuffers(1, &m_localRefractionsDepth24Stencil8RBO);
         glDeleteTextures(1, &m_depthTexture2D);
 
         glDeleteTextures(1, &m_localReflectionsTexture2D);
@@ -231,7 +301,11 @@ namespace wave_tool
         glDeleteTextures(1, &m_skyboxCubemap);
         glDeleteFramebuffers(1, &m_skyboxFBO);
 
+        glDeleteTextures(1, &m_oceanDisplacementTexture2D);
+        glDeleteTextures(1, &m_oceanNormalFoldingTexture2D);
+
         glDeleteVertexArrays(1, &m_emptyVAO);
+        glDeleteQueries((GLsizei)m_waterPrimitiveQueries.size(), m_waterPrimitiveQueries.data());
 
         glDeleteProgram(mainProgram);
         glDeleteProgram(screenSpaceQuadProgram);
@@ -264,7 +338,6 @@ namespace wave_tool
         float const timeOfDayInDays{timeOfDayInHours / 24.0f};
         float const timeThetaInRadians{timeOfDayInDays * glm::two_pi<float>() - glm::half_pi<float>()};
         glm::vec3 const sunPosition{glm::cos(timeThetaInRadians), glm::sin(timeThetaInRadians), 0.0f};
-        glm::vec3 const lightVec{glm::normalize(glm::vec3{view * glm::vec4{sunPosition, 0.0f}})};
 
         // tint fades to black when sun is lower in sky
         glm::vec4 const fogColourFarAtCurrentTime{glm::clamp(sunPosition.y, 0.0f, 1.0f) * glm::vec3{1.0f}, 0.1f};
@@ -274,155 +347,184 @@ namespace wave_tool
         float const verticalBounceWavePhaseShift{verticalBounceWavePhase * glm::two_pi<float>()};
         float const verticalBounceWaveDisplacement{verticalBounceWaveAmplitude * glm::sin(verticalBounceWavePhaseShift)};
 
+        // this frame's uniform blocks and uploads go to the next region of the streaming buffer (the previous frames may still be reading theirs)
+        m_streamingBuffer->nextFrame();
+
+        // upload the per-frame globals once (every program reads them through the shared uniform block)
+        FrameUniforms const frameUniforms{view,
+                                          projection,
+                                          viewProjection,
+                                          viewMatOnlyYaw,
+                                          fogColourFarAtCurrentTime,
+                                          m_camera->getPosition(),
+                                          waveAnimationTimeInSeconds,
+                                          sunPosition,
+                                          Z_NEAR,
+                                          glm::vec2{(float)m_windowWidth, (float)m_windowHeight},
+                                          Z_FAR,
+                                          0.0f};
+        streamUniformBlock(FRAME_UNIFORMS_BINDING, &frameUniforms, sizeof(FrameUniforms), sizeof(FrameUniforms));
+
+        // upload the wave set, longest first (the TES stops at the first wave too short for the local tessellation density)
+        // reference: https://developer.nvidia.com/gpugems/gpugems/part-i-natural-effects/chapter-1-effective-water-simulation-physical-models
+        // reference: https://github.com/CaffeineViking/osgw/blob/master/share/shaders/gerstner.glsl
+        {
+            GerstnerWaves gerstnerWavesBlock;
+            gerstnerWavesBlock.count = 0;
+            for (std::shared_ptr<geometry::GerstnerWave> const &gerstnerWave : gerstnerWaves)
+            {
+                if (nullptr == gerstnerWave)
+                    continue;
+
+                // NOTE: div by zero is just handled by setting to a symbolic 0.0
+                float const steepness_Q_i{(gerstnerWave->frequency_w * gerstnerWave->amplitude_A) != 0.0f ? gerstnerWave->steepness_Q / (gerstnerWave->frequency_w * gerstnerWave->amplitude_A * geometry::GerstnerWave::Count()) : 0.0f};
+                // NOTE: a wave with zero frequency never fades out (infinite wavelength)
+                float const wavelength{gerstnerWave->frequency_w != 0.0f ? glm::two_pi<float>() / gerstnerWave->frequency_w : std::numeric_limits<float>::max()};
+                gerstnerWavesBlock.waves.at(gerstnerWavesBlock.count++) = {gerstnerWave->amplitude_A, gerstnerWave->frequency_w, gerstnerWave->phaseConstant_phi, steepness_Q_i, gerstnerWave->xzDirection_D, wavelength, gerstnerWave->phaseOffset};
+            }
+            std::sort(gerstnerWavesBlock.waves.begin(), gerstnerWavesBlock.waves.begin() + gerstnerWavesBlock.count, [](GerstnerWaves::Wave const &a, GerstnerWaves::Wave const &b) { return a.wavelength > b.wavelength; });
+
+            // only the used prefix is filled, but the whole block is bound
+            streamUniformBlock(GERSTNER_WAVES_BINDING, &gerstnerWavesBlock, offsetof(GerstnerWaves, waves) + gerstnerWavesBlock.count * sizeof(GerstnerWaves::Wave), sizeof(GerstnerWaves));
+        }
+
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         ///////////////////////////////////////////////////
-        // dynamic skybox rendering (render 6 faces of cubemap to textures)...
-        // bind FBO (switch to render to textures)
-        glBindFramebuffer(GL_FRAMEBUFFER, m_skyboxFBO);
-
-        // TODO: see if this is even needed
-        //  disable depth writing to draw everything in layers (NOTE: the FBO doesn't have a depth buffer)
-        glDepthMask(GL_FALSE);
-        // set a square viewport
-        glViewport(0, 0, CUBEMAP_LENGTH, CUBEMAP_LENGTH);
+        // dynamic skybox rendering (render the stale faces of cubemap to textures)...
+        // the cubemap only depends on these inputs, so it is cached until one of them changes
+        SkyboxCubemapInputs const skyboxCubemapInputs{timeOfDayInHours,
+                                                      cloudProportion,
+                                                      sunHorizonDarkness,
+                                                      sunShininess,
+                                                      sunStrength,
+                                                      nullptr != skyboxStars && skyboxStars->m_isVisible,
+                                                      nullptr != skysphere && skysphere->m_isVisible,
+                                                      nullptr != skyboxClouds && skyboxClouds->m_isVisible};
+        if (skyboxCubemapInputs != m_skyboxCubemapInputs)
+        {
+            m_skyboxCubemapInputs = skyboxCubemapInputs;
+            m_skyboxCubemapStaleFaceCount = 6;
+        }
 
-        // TODO: if I ever get around to allowing exporting of the skybox, I might have to flip the image data since we are on the inside
+        // while time-of-day is animating, the inputs change every frame, so only a few faces get refreshed per frame (round-robin)
+        // NOTE: the first complete build and any static change (e.g. a UI slider) still refresh every stale face immediately
+        unsigned int skyboxCubemapFaceRenderCount{m_skyboxCubemapStaleFaceCount};
+        if (isAnimatingTimeOfDay && m_isSkyboxCubemapComplete)
+            skyboxCubemapFaceRenderCount = glm::min(skyboxCubemapFaceRenderCount, (unsigned int)glm::clamp(skyboxCubemapFacesPerFrame, 1, 6));
 
-        // render each side of skybox to texture
-        // TODO: should probably only set the uniforms once
-        for (unsigned int i = 0; i < 6; ++i)
+        if (skyboxCubemapFaceRenderCount > 0)
         {
-            // attach the next cube map face texture as the color attachment to render colours to
-            // TODO: I think I can move this call into the FBO setup
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, m_skyboxCubemap, 0);
+            m_profiler->beginGpuPass(Profiler::SKY_CUBEMAP);
+            // bind FBO (switch to render to textures)
+            glBindFramebuffer(GL_FRAMEBUFFER, m_skyboxFBO);
 
-            glClear(GL_COLOR_BUFFER_BIT);
+            // TODO: see if this is even needed
+            //  disable depth writing to draw everything in layers (NOTE: the FBO doesn't have a depth buffer)
+            glDepthMask(GL_FALSE);
+            // set a square viewport
+            glViewport(0, 0, CUBEMAP_LENGTH, CUBEMAP_LENGTH);
 
-            // now render star skybox then skysphere then cloud skybox then fog...
-            // NOTE: in the future, I could also render more objects (like far mountains/land) on top of everything
-            // TODO: refactor this into own function
+            // TODO: if I ever get around to allowing exporting of the skybox, I might have to flip the image data since we are on the inside
 
-            // render skybox (star layer) on top of clear colour...
-            // reference: https://learnopengl.com/Advanced-OpenGL/Cubemaps
-            // reference: http://antongerdelan.net/opengl/cubemaps.html
-            if (nullptr != skyboxStars && skyboxStars->m_isVisible)
+            // render the stale sides of skybox to texture
+            for (unsigned int i = 0; i < skyboxCubemapFaceRenderCount; ++i)
             {
-                // enable star shader program
-                glUseProgram(skyboxStarsProgram);
-                // bind geometry data...
-                glBindVertexArray(skyboxStars->vao);
-
-                // set uniforms...
-                // TODO: refactor into own function
-                // bind texture...
-                glActiveTexture(GL_TEXTURE0 + skyboxStars->textureID);
-                glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxStars->textureID);
-                glUniform1i(glGetUniformLocation(skyboxStarsProgram, "skyboxStars"), skyboxStars->textureID);
-                glUniformMatrix4fv(glGetUniformLocation(skyboxStarsProgram, "VPNoTranslation"), 1, GL_FALSE, glm::value_ptr(CUBEMAP_VP_NO_TRANSLATION_MATS.at(i)));
-
-                // POINT, LINE or FILL...
-                glPolygonMode(GL_FRONT_AND_BACK, skyboxStars->m_polygonMode);
-                glDrawElements(skyboxStars->m_primitiveMode, skyboxStars->drawFaces.size(), GL_UNSIGNED_INT, (void *)0);
-
-                // TODO: refactor into own function
-                //  unbind texture...
-                glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-                // unbind
-                glBindVertexArray(0);
+                renderSkyboxCubemapFace(m_skyboxCubemapNextFace, skyboxStars, skysphere, skyboxClouds, fogColourFarAtCurrentTime, oneMinusCloudProportion);
+                m_skyboxCubemapNextFace = (m_skyboxCubemapNextFace + 1) % 6;
             }
+            m_skyboxCubemapStaleFaceCount -= skyboxCubemapFaceRenderCount;
+            if (0 == m_skyboxCubemapStaleFaceCount)
+                m_isSkyboxCubemapComplete = true;
 
-            // render skysphere on top of stars...
-            if (nullptr != skysphere && skysphere->m_isVisible)
-            {
-                // enable skysphere shader program
-                glUseProgram(skysphereProgram);
-                // bind geometry data...
-                glBindVertexArray(skysphere->vao);
-
-                // set uniforms...
-                Texture::bind1DTexture(skysphereProgram, skysphere->textureID, "skysphere");
-                glUniform1f(glGetUniformLocation(skysphereProgram, "sunHorizonDarkness"), sunHorizonDarkness);
-                glUniform3fv(glGetUniformLocation(skysphereProgram, "sunPosition"), 1, glm::value_ptr(sunPosition));
-                glUniform1f(glGetUniformLocation(skysphereProgram, "sunShininess"), sunShininess);
-                glUniform1f(glGetUniformLocation(skysphereProgram, "sunStrength"), sunStrength);
-                glUniformMatrix4fv(glGetUniformLocation(skysphereProgram, "VPNoTranslation"), 1, GL_FALSE, glm::value_ptr(CUBEMAP_VP_NO_TRANSLATION_MATS.at(i)));
-
-                // POINT, LINE or FILL...
-                glPolygonMode(GL_FRONT_AND_BACK, skysphere->m_polygonMode);
-                glDrawElements(skysphere->m_primitiveMode, skysphere->drawFaces.size(), GL_UNSIGNED_INT, (void *)0);
+            // re-enable depth writing for the rest of the scene
+            glDepthMask(GL_TRUE);
+            // unbind / reset to the output framebuffer
+            glBindFramebuffer(GL_FRAMEBUFFER, m_outputFBO);
+            m_profiler->endGpuPass();
+        }
 
-                Texture::unbind1DTexture();
-                // unbind
-                glBindVertexArray(0);
-            }
+        // reset viewport back to match GLFW window
+        glViewport(0, 0, m_windowWidth, m_windowHeight);
+        ///////////////////////////////////////////////////
 
-            // render skybox (cloud layer) on top of skysphere...
-            // reference: https://learnopengl.com/Advanced-OpenGL/Cubemaps
-            // reference: http://antongerdelan.net/opengl/cubemaps.html
-            if (nullptr != skyboxClouds && skyboxClouds->m_isVisible)
-            {
-                // enable cloud shader program
-                glUseProgram(skyboxCloudsProgram);
-                // bind geometry data...
-                glBindVertexArray(skyboxClouds->vao);
+        ///////////////////////////////////////////////////
+        // CULL AND QUEUE THE OBJECT DRAWS OF EVERY OFF-SCREEN PASS...
+        // in column-major order
+        // mirrors world-space position about the XZ-plane
+        glm::mat4 const LOCAL_REFLECTIONS_MATRIX{1.0f, 0.0f, 0.0f, 0.0f,
+                                                 0.0f, -1.0f, 0.0f, 0.0f,
+                                                 0.0f, 0.0f, 1.0f, 0.0f,
+                                                 0.0f, 0.0f, 0.0f, 1.0f};
 
-                // set uniforms...
-                glUniform1f(glGetUniformLocation(skyboxCloudsProgram, "oneMinusCloudProportion"), oneMinusCloudProportion);
-                // TODO: refactor into own function
-                //  bind texture...
-                glActiveTexture(GL_TEXTURE0 + skyboxClouds->textureID);
-                glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxClouds->textureID);
-                glUniform1i(glGetUniformLocation(skyboxCloudsProgram, "skyboxClouds"), skyboxClouds->textureID);
-                glUniform3fv(glGetUniformLocation(skyboxCloudsProgram, "sunPosition"), 1, glm::value_ptr(sunPosition));
-                glUniformMatrix4fv(glGetUniformLocation(skyboxCloudsProgram, "VPNoTranslation"), 1, GL_FALSE, glm::value_ptr(CUBEMAP_VP_NO_TRANSLATION_MATS.at(i)));
+        // <A, B, C, D> where Ax + By + Cz = D
+        // clipping test will succeed if underneath XZ-plane
+        // TODO: see if any padding is needed to hide artifacts when grazing the surface
+        glm::vec4 const LOCAL_REFLECTIONS_CLIP_PLANE{0.0f, -1.0f, 0.0f, 0.0f};
 
-                // POINT, LINE or FILL...
-                glPolygonMode(GL_FRONT_AND_BACK, skyboxClouds->m_polygonMode);
-                glDrawElements(skyboxClouds->m_primitiveMode, skyboxClouds->drawFaces.size(), GL_UNSIGNED_INT, (void *)0);
+        // in column-major order
+        // shrinks/shallows world-space position in the Y-axis by the refractive index ratio of air (n_1 = 1.0003) / water (n_2 = 1.33) ~= 0.75
+        glm::mat4 const LOCAL_REFRACTIONS_MATRIX{1.0f, 0.0f, 0.0f, 0.0f,
+                                                 0.0f, 0.75f, 0.0f, 0.0f,
+                                                 0.0f, 0.0f, 1.0f, 0.0f,
+                                                 0.0f, 0.0f, 0.0f, 1.0f};
 
-                // TODO: refactor into own function
-                //  unbind texture...
-                glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-                // unbind
-                glBindVertexArray(0);
-            }
+        // <A, B, C, D> where Ax + By + Cz = D
+        // TODO: this might be improved by accounting for amplitude
+        // clipping test will succeed if underneath XZ-plane
+        // TODO: see if any padding is needed to hide artifacts when grazing the surface
+        glm::vec4 const LOCAL_REFRACTIONS_CLIP_PLANE{0.0f, -1.0f, 0.0f, 0.0f};
 
-            // render fog layer on top of clouds...
-            if (0 != m_emptyVAO)
+        m_profiler->beginCpuSection(Profiler::OBJECT_SUBMISSION);
+        updateObjectBVH(objects);
+
+        // each pass sees the objects through its own transform, so its frustum is extracted in the objects' (untransformed) world-space
+        // NOTE: the clip plane applies after the pass transform, so it is pulled back through the transform as well (planes transform by the transpose)
+        geometry::Frustum localReflectionsFrustum{geometry::Frustum::fromMatrix(viewProjection * LOCAL_REFLECTIONS_MATRIX)};
+        localReflectionsFrustum.addPlane(glm::transpose(LOCAL_REFLECTIONS_MATRIX) * LOCAL_REFLECTIONS_CLIP_PLANE);
+        geometry::Frustum localRefractionsFrustum{geometry::Frustum::fromMatrix(viewProjection * LOCAL_REFRACTIONS_MATRIX)};
+        localRefractionsFrustum.addPlane(glm::transpose(LOCAL_REFRACTIONS_MATRIX) * LOCAL_REFRACTIONS_CLIP_PLANE);
+        geometry::Frustum const depthFrustum{geometry::Frustum::fromMatrix(viewProjection)};
+
+        m_renderQueue.clear();
+        std::array<unsigned int, RenderQueue::PASS_COUNT> visibleObjectCounts{0, 0, 0};
+        auto const queueVisibleObjects = [&](RenderQueue::Pass const pass, geometry::Frustum const &frustum) {
+            m_visibleObjectIndices.clear();
+            m_objectBVH.query(frustum, m_visibleObjectIndices);
+            for (std::uint32_t const index : m_visibleObjectIndices)
             {
-                // enable screen-space-quad shader program
-                glUseProgram(screenSpaceQuadProgram);
-                // bind geometry data...
-                glBindVertexArray(m_emptyVAO);
-
-                // set uniforms...
-                glUniform1i(glGetUniformLocation(screenSpaceQuadProgram, "isTextured"), GL_FALSE);
-                Texture::bind2DTexture(screenSpaceQuadProgram, 0, "textureData"); // no texture
-                glUniform4fv(glGetUniformLocation(screenSpaceQuadProgram, "solidColour"), 1, glm::value_ptr(fogColourFarAtCurrentTime));
-
-                // POINT, LINE or FILL...
-                glPolygonMode(GL_FRONT_AND_BACK, PolygonMode::FILL);
-                glDrawArrays(PrimitiveMode::TRIANGLE_STRIP, 0, 4);
-
-                Texture::unbind2DTexture();
-                // unbind
-                glBindVertexArray(0);
+                MeshObject const &o{*m_objectBVHItems.at(index)};
+                // front-to-back within each run of equal state
+                float const depth{glm::max(glm::distance(m_camera->getPosition(), o.getWorldBoundingSphere().center) - o.getWorldBoundingSphere().radius, 0.0f) / Z_FAR};
+
+                // TODO: currently not rendering any objects using trivial shader program in the local passes (see below)
+                if (RenderQueue::DEPTH != pass && o.shaderProgramID == mainProgram)
+                    m_renderQueue.push(pass, o, mainProgram, o.textureID, depth);
+                // the depth texture only holds generic objects (other than water-grid)
+                else if (RenderQueue::DEPTH == pass && Tag::GENERIC == o.getTag())
+                    m_renderQueue.push(pass, o, depthProgram, 0, depth);
+                else
+                    continue;
+                ++visibleObjectCounts.at(pass);
             }
-        }
-
-        // reset viewport back to match GLFW window
-        glViewport(0, 0, m_windowWidth, m_windowHeight);
-        // re-enable depth writing for the rest of the scene
-        glDepthMask(GL_TRUE);
-        // unbind / reset to default screen framebuffer
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        };
+        queueVisibleObjects(RenderQueue::LOCAL_REFLECTIONS, localReflectionsFrustum);
+        queueVisibleObjects(RenderQueue::LOCAL_REFRACTIONS, localRefractionsFrustum);
+        queueVisibleObjects(RenderQueue::DEPTH, depthFrustum);
+        m_renderQueue.sort();
+        m_visibleObjectCounts = visibleObjectCounts;
+        m_profiler->endCpuSection(Profiler::OBJECT_SUBMISSION);
         ///////////////////////////////////////////////////
 
         ///////////////////////////////////////////////////
         // RENDER LOCAL REFLECTIONS TO TEXTURE...
+        m_profiler->beginGpuPass(Profiler::LOCAL_REFLECTIONS);
+        if (computeLocalTargetSize(localReflectionsDownsampleLevel) != m_localReflectionsSize)
+            resizeLocalReflectionsTarget();
         glBindFramebuffer(GL_FRAMEBUFFER, m_localReflectionsFBO);
+        // the target is only sampled (distorted) by the water surface, so it can be rendered at a fraction of the window resolution
+        glViewport(0, 0, m_localReflectionsSize.x, m_localReflectionsSize.y);
 
         glEnable(GL_CLIP_DISTANCE0);
 
@@ -438,63 +540,9 @@ namespace wave_tool
         // render other objects...
         // TODO: currently not rendering any objects using trivial shader program (cause I don't want to change those shaders), but this is fine since only the debug planes currently are shaded this way
         //      I could create a modified trivial shader program, or switch everything to the main shader program and then just skip rendering objects flagged as DEBUG
-        // TODO: optimize by batch-drawing objects that use the same shader program, as well as removing redundant uniform setting
         // TODO: design some sort of wrapper around shader programs that can dynamically set all uniforms properly
 
-        // in column-major order
-        // mirrors world-space position about the XZ-plane
-        glm::mat4 const LOCAL_REFLECTIONS_MATRIX{1.0f, 0.0f, 0.0f, 0.0f,
-                                                 0.0f, -1.0f, 0.0f, 0.0f,
-                                                 0.0f, 0.0f, 1.0f, 0.0f,
-                                                 0.0f, 0.0f, 0.0f, 1.0f};
-
-        // <A, B, C, D> where Ax + By + Cz = D
-        // clipping test will succeed if underneath XZ-plane
-        // TODO: see if any padding is needed to hide artifacts when grazing the surface
-        glm::vec4 const LOCAL_REFLECTIONS_CLIP_PLANE{0.0f, -1.0f, 0.0f, 0.0f};
-
-        for (std::shared_ptr<MeshObject const> o : objects)
-        {
-            assert(0 != o->shaderProgramID);
-
-            // don't render invisible objects...
-            if (!o->m_isVisible)
-                continue;
-
-            if (o->shaderProgramID == mainProgram)
-            {
-                glm::mat4 const modelMat{LOCAL_REFLECTIONS_MATRIX * o->getModel()};
-                glm::mat4 const modelViewMat{view * modelMat};
-                glm::mat4 const mvpMat{projection * modelViewMat};
-
-                // enable shader program...
-                glUseProgram(mainProgram);
-                // bind geometry data...
-                glBindVertexArray(o->vao);
-
-                // set uniforms...
-                glUniform4fv(glGetUniformLocation(mainProgram, "clipPlane0"), 1, glm::value_ptr(LOCAL_REFLECTIONS_CLIP_PLANE));
-                glUniform4fv(glGetUniformLocation(mainProgram, "fogColourFarAtCurrentTime"), 1, glm::value_ptr(fogColourFarAtCurrentTime));
-                glUniform1i(glGetUniformLocation(mainProgram, "forceFlipNormals"), GL_TRUE);
-                glUniform1i(glGetUniformLocation(mainProgram, "hasNormals"), !o->normals.empty());
-                // TODO: handle this better
-                glUniform1i(glGetUniformLocation(mainProgram, "isTextured"), o->hasTexture);
-                glUniform3fv(glGetUniformLocation(mainProgram, "lightVec"), 1, glm::value_ptr(lightVec));
-                Texture::bind2DTexture(mainProgram, o->textureID, "textureData");
-                glUniformMatrix4fv(glGetUniformLocation(mainProgram, "modelMat"), 1, GL_FALSE, glm::value_ptr(modelMat));
-                glUniformMatrix4fv(glGetUniformLocation(mainProgram, "modelViewMat"), 1, GL_FALSE, glm::value_ptr(modelViewMat));
-                glUniformMatrix4fv(glGetUniformLocation(mainProgram, "mvpMat"), 1, GL_FALSE, glm::value_ptr(mvpMat));
-                glUniform1f(glGetUniformLocation(mainProgram, "zFar"), Z_FAR);
-
-                // POINT, LINE or FILL...
-                glPolygonMode(GL_FRONT_AND_BACK, o->m_polygonMode);
-                glDrawElements(o->m_primitiveMode, o->drawFaces.size(), GL_UNSIGNED_INT, (void *)0);
-
-                Texture::unbind2DTexture();
-                // unbind
-                glBindVertexArray(0);
-            }
-        }
+        submitMainProgramPass(RenderQueue::LOCAL_REFLECTIONS, LOCAL_REFLECTIONS_MATRIX, LOCAL_REFLECTIONS_CLIP_PLANE, true, view, projection);
 
         // reset
         glFrontFace(GL_CCW);
@@ -502,12 +550,19 @@ namespace wave_tool
 
         glDisable(GL_CLIP_DISTANCE0);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_outputFBO);
+        // reset viewport back to match GLFW window
+        glViewport(0, 0, m_windowWidth, m_windowHeight);
+        m_profiler->endGpuPass();
         ///////////////////////////////////////////////////
 
         ///////////////////////////////////////////////////
         // RENDER LOCAL REFRACTIONS TO TEXTURE...
+        m_profiler->beginGpuPass(Profiler::LOCAL_REFRACTIONS);
+        if (computeLocalTargetSize(localRefractionsDownsampleLevel) != m_localRefractionsSize)
+            resizeLocalRefractionsTarget();
         glBindFramebuffer(GL_FRAMEBUFFER, m_localRefractionsFBO);
+        glViewport(0, 0, m_localRefractionsSize.x, m_localRefractionsSize.y);
 
         glEnable(GL_CLIP_DISTANCE0);
 
@@ -523,112 +578,40 @@ namespace wave_tool
         // render other objects...
         // TODO: currently not rendering any objects using trivial shader program (cause I don't want to change those shaders), but this is fine since only the debug planes currently are shaded this way
         //      I could create a modified trivial shader program, or switch everything to the main shader program and then just skip rendering objects flagged as DEBUG
-        // TODO: optimize by batch-drawing objects that use the same shader program, as well as removing redundant uniform setting
         // TODO: design some sort of wrapper around shader programs that can dynamically set all uniforms properly
 
-        // in column-major order
-        // shrinks/shallows world-space position in the Y-axis by the refractive index ratio of air (n_1 = 1.0003) / water (n_2 = 1.33) ~= 0.75
-        glm::mat4 const LOCAL_REFRACTIONS_MATRIX{1.0f, 0.0f, 0.0f, 0.0f,
-                                                 0.0f, 0.75f, 0.0f, 0.0f,
-                                                 0.0f, 0.0f, 1.0f, 0.0f,
-                                                 0.0f, 0.0f, 0.0f, 1.0f};
-
-        // <A, B, C, D> where Ax + By + Cz = D
-        // TODO: this might be improved by accounting for amplitude
-        // clipping test will succeed if underneath XZ-plane
-        // TODO: see if any padding is needed to hide artifacts when grazing the surface
-        glm::vec4 const LOCAL_REFRACTIONS_CLIP_PLANE{0.0f, -1.0f, 0.0f, 0.0f};
-
-        for (std::shared_ptr<MeshObject const> o : objects)
-        {
-            assert(0 != o->shaderProgramID);
-
-            // don't render invisible objects...
-            if (!o->m_isVisible)
-                continue;
-
-            if (o->shaderProgramID == mainProgram)
-            {
-                glm::mat4 const modelMat{LOCAL_REFRACTIONS_MATRIX * o->getModel()};
-                glm::mat4 const modelViewMat{view * modelMat};
-                glm::mat4 const mvpMat{projection * modelViewMat};
-
-                // enable shader program...
-                glUseProgram(mainProgram);
-                // bind geometry data...
-                glBindVertexArray(o->vao);
-
-                // set uniforms...
-                glUniform4fv(glGetUniformLocation(mainProgram, "clipPlane0"), 1, glm::value_ptr(LOCAL_REFRACTIONS_CLIP_PLANE));
-                glUniform4fv(glGetUniformLocation(mainProgram, "fogColourFarAtCurrentTime"), 1, glm::value_ptr(fogColourFarAtCurrentTime));
-                glUniform1i(glGetUniformLocation(mainProgram, "forceFlipNormals"), GL_FALSE);
-                glUniform1i(glGetUniformLocation(mainProgram, "hasNormals"), !o->normals.empty());
-                // TODO: handle this better
-                glUniform1i(glGetUniformLocation(mainProgram, "isTextured"), o->hasTexture);
-                glUniform3fv(glGetUniformLocation(mainProgram, "lightVec"), 1, glm::value_ptr(lightVec));
-                Texture::bind2DTexture(mainProgram, o->textureID, "textureData");
-                glUniformMatrix4fv(glGetUniformLocation(mainProgram, "modelMat"), 1, GL_FALSE, glm::value_ptr(modelMat));
-                glUniformMatrix4fv(glGetUniformLocation(mainProgram, "modelViewMat"), 1, GL_FALSE, glm::value_ptr(modelViewMat));
-                glUniformMatrix4fv(glGetUniformLocation(mainProgram, "mvpMat"), 1, GL_FALSE, glm::value_ptr(mvpMat));
-                glUniform1f(glGetUniformLocation(mainProgram, "zFar"), Z_FAR);
-
-                // POINT, LINE or FILL...
-                glPolygonMode(GL_FRONT_AND_BACK, o->m_polygonMode);
-                glDrawElements(o->m_primitiveMode, o->drawFaces.size(), GL_UNSIGNED_INT, (void *)0);
-
-                Texture::unbind2DTexture();
-                // unbind
-                glBindVertexArray(0);
-            }
-        }
+        submitMainProgramPass(RenderQueue::LOCAL_REFRACTIONS, LOCAL_REFRACTIONS_MATRIX, LOCAL_REFRACTIONS_CLIP_PLANE, false, view, projection);
 
         // reset
         glDisable(GL_CULL_FACE);
 
         glDisable(GL_CLIP_DISTANCE0);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_outputFBO);
+        // reset viewport back to match GLFW window
+        glViewport(0, 0, m_windowWidth, m_windowHeight);
+        m_profiler->endGpuPass();
 
         ///////////////////////////////////////////////////
         // RENDER DEPTH TEXTURE (of all generic objects, other than water-grid)
+        m_profiler->beginGpuPass(Profiler::DEPTH);
         glBindFramebuffer(GL_FRAMEBUFFER, m_depthFBO);
 
         // since the skybox is at infinity, its depth is handled by clearing the depth buffer
         glClear(GL_DEPTH_BUFFER_BIT);
 
-        // enable shader program...
-        glUseProgram(depthProgram);
-
-        for (std::shared_ptr<MeshObject const> o : objects)
-        {
-            // don't render invisible objects or non-generics...
-            if (!o->m_isVisible || Tag::GENERIC != o->getTag())
-                continue;
-
-            glm::mat4 const mvpMat{viewProjection * o->getModel()};
-
-            // bind geometry data...
-            glBindVertexArray(o->vao);
-
-            // set uniforms...
-            glUniformMatrix4fv(glGetUniformLocation(depthProgram, "mvpMat"), 1, GL_FALSE, glm::value_ptr(mvpMat));
-
-            // POINT, LINE or FILL...
-            glPolygonMode(GL_FRONT_AND_BACK, o->m_polygonMode);
-            glDrawElements(o->m_primitiveMode, o->drawFaces.size(), GL_UNSIGNED_INT, (void *)0);
-
-            // unbind
-            glBindVertexArray(0);
-        }
+        submitDepthPass(viewProjection);
 
         // disable
         glUseProgram(0);
         // reset
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_outputFBO);
+        m_profiler->endGpuPass();
         ///////////////////////////////////////////////////
 
         ///////////////////////////////////////////////////
-        // now render everything else to main screen framebuffer...
+        // now render everything else to the output framebuffer (the main screen framebuffer, unless rendering headless)...
+        m_profiler->beginGpuPass(Profiler::SKYBOX);
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -652,12 +635,12 @@ namespace wave_tool
             // bind texture...
             glActiveTexture(GL_TEXTURE0 + m_skyboxCubemap);
             glBindTexture(GL_TEXTURE_CUBE_MAP, m_skyboxCubemap);
-            glUniform1i(glGetUniformLocation(skyboxTrivialProgram, "skybox"), m_skyboxCubemap);
-            glUniformMatrix4fv(glGetUniformLocation(skyboxTrivialProgram, "VPNoTranslation"), 1, GL_FALSE, glm::value_ptr(VPNoTranslation));
+            glUniform1i(m_skyboxTrivialProgramUniforms.skybox, m_skyboxCubemap);
+            glUniformMatrix4fv(m_skyboxTrivialProgramUniforms.VPNoTranslation, 1, GL_FALSE, glm::value_ptr(VPNoTranslation));
 
             // POINT, LINE or FILL...
             glPolygonMode(GL_FRONT_AND_BACK, PolygonMode::FILL);
-            glDrawElements(skyboxStars->m_primitiveMode, skyboxStars->drawFaces.size(), GL_UNSIGNED_INT, (void *)0);
+            glDrawElements(skyboxStars->m_primitiveMode, skyboxStars->indexCount, skyboxStars->indexType, (void *)0);
 
             //  unbind texture...
             glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
@@ -666,321 +649,119 @@ namespace wave_tool
             // re-enable depth writing for the rest of the scene
             glDepthMask(GL_TRUE);
         }
+        m_profiler->endGpuPass();
 
         // NOTE: the order of drawing matters for alpha-blending
         //  render water...
         if (nullptr != waterGrid && waterGrid->m_isVisible && 0 != m_skyboxCubemap)
         {
-            static geometry::Plane upperPlane{0.0f, 1.0f, 0.0f, 0.0f};
-            static geometry::Plane basePlane{0.0f, 1.0f, 0.0f, 0.0f};
-            static geometry::Plane lowerPlane{0.0f, 1.0f, 0.0f, 0.0f};
-            static float cachedAmplitude = -1.0f;
-
-            // the displaceable volume is defined by the maximum possible amplitude of all the wave summations
-            float const DISPLACEABLE_AMPLITUDE = geometry::GerstnerWave::TotalAmplitude() + heightmapDisplacementScale + verticalBounceWaveAmplitude;
-
-            if (cachedAmplitude != DISPLACEABLE_AMPLITUDE)
+            if (isUsingOceanFFT)
             {
-                cachedAmplitude = DISPLACEABLE_AMPLITUDE;
-                upperPlane = {0.0f, 1.0f, 0.0f, DISPLACEABLE_AMPLITUDE};
-                lowerPlane = {0.0f, 1.0f, 0.0f, -DISPLACEABLE_AMPLITUDE};
+                m_profiler->beginCpuSection(Profiler::OCEAN_FFT);
+                updateOceanFFT();
+                m_profiler->endCpuSection(Profiler::OCEAN_FFT);
             }
 
-            auto frustumCornerPoints = transformFrustumCorners(inverseViewProjection, 1.2f);
-
-            // stores indices into frustumCornerPoints
-            // 12 edges between pairs of points
-            std::array<unsigned int, 24> const FRUSTUM_EDGES{0, 1,  // [0]  - lbn ---> lbf (across-edge)
-                                                             0, 2,  // [1]  - lbn ---> ltn (near-edge)
-                                                             0, 4,  // [2]  - lbn ---> rbn (near-edge)
-                                                             1, 3,  // [3]  - lbf ---> ltf (far-edge)
-                                                             1, 5,  // [4]  - lbf ---> rbf (far-edge)
-                                                             2, 3,  // [5]  - ltn ---> ltf (across-edge)
-                                                             2, 6,  // [6]  - ltn ---> rtn (near-edge)
-                                                             3, 7,  // [7]  - ltf ---> rtf (far-edge)
-                                                             4, 5,  // [8]  - rbn ---> rbf (across-edge)
-                                                             4, 6,  // [9]  - rbn ---> rtn (near-edge)
-                                                             5, 7,  // [10] - rbf ---> rtf (far-edge)
-                                                             6, 7}; // [11] - rtn ---> rtf (across-edge)
-
-            // stores intersection points of camera frustum with the displaceable volume (between upper and lower bounding planes)
-            std::vector<glm::vec4> intersectionPoints;
-
-            // intersection testing with upper/lower bound planes...
-            // for each frustum edge...
-            for (unsigned int i = 0; i < 12; ++i)
+            // the displaceable volume is defined by the maximum possible amplitude of all the wave summations
+            // NOTE: the FFT ocean has no closed-form bound, so the largest height it has produced so far is used instead
+            float const heightmapAmplitude{isUsingOceanFFT ? m_oceanFFT->getMaxHeight() : heightmapDisplacementScale};
+            float const DISPLACEABLE_AMPLITUDE = geometry::GerstnerWave::TotalAmplitude() + heightmapAmplitude + verticalBounceWaveAmplitude;
+
+            // either a single projected grid (corners: bottom-left, bottom-right, top-left, top-right) or the clipmap tiles
+            bool const isClipmap{WaterGeometryMode::CLIPMAP == waterGeometryMode};
+            std::array<glm::vec4, 4> projectedGridCornerPoints;
+            bool isWaterGridVisible;
+            if (isClipmap)
             {
-                unsigned int const src{FRUSTUM_EDGES.at(i * 2)};
-                unsigned int const dest{FRUSTUM_EDGES.at(i * 2 + 1)};
-
-                geometry::Line const line{frustumCornerPoints.at(src), frustumCornerPoints.at(dest)};
-
-                if (glm::max(line.p0.y, line.p1.y) < -DISPLACEABLE_AMPLITUDE || glm::min(line.p0.y, line.p1.y) > DISPLACEABLE_AMPLITUDE)
-                    continue; // Edge is completely outside the displaceable volume
-
-                // upper-bound plane
-                // first, we do a quick intersection check (plane in this case can be described by all points with y = d, since the normal is <0,1,0>)
-                if (glm::min(line.p0.y, line.p1.y) <= upperPlane.d && upperPlane.d <= glm::max(line.p0.y, line.p1.y))
-                {
-                    glm::vec3 intersectionPoint;
-                    bool const isIntersection{utils::linePlaneIntersection(intersectionPoint, line, upperPlane)};
-                    // NOTE: we can't currently assert this is true, since there is the rare chance that the line lies in the plane (which is currently treated as no intersection for simplicity)
-                    if (isIntersection)
-                        intersectionPoints.push_back(glm::vec4{intersectionPoint, 1.0f});
-                }
-
-                // lower-bound plane
-                // first, we do a quick intersection check (plane in this case can be described by all points with y = d, since the normal is <0,1,0>)
-                if (glm::min(line.p0.y, line.p1.y) <= lowerPlane.d && lowerPlane.d <= glm::max(line.p0.y, line.p1.y))
-                {
-                    glm::vec3 intersectionPoint;
-                    bool const isIntersection{utils::linePlaneIntersection(intersectionPoint, line, lowerPlane)};
-                    // NOTE: we can't currently assert this is true, since there is the rare chance that the line lies in the plane (which is currently treated as no intersection for simplicity)
-                    if (isIntersection)
-                        intersectionPoints.push_back(glm::vec4{intersectionPoint, 1.0f});
-                }
+                m_profiler->beginCpuSection(Profiler::CLIPMAP);
+                m_oceanClipmap->setParameters(oceanClipmapParameters);
+                m_oceanClipmap->select(m_camera->getPosition(), depthFrustum, DISPLACEABLE_AMPLITUDE);
+                isWaterGridVisible = !m_oceanClipmap->getTiles().empty();
+                m_profiler->endCpuSection(Profiler::CLIPMAP);
             }
-
-            // include any frustum vertices that lie within (intersect) the displaceable volume (between upper and lower bounding planes)
-            // for each frustum vertex...
-            auto isWithinVolume = [&](const glm::vec4 &point)
-            {
-                return point.y >= -DISPLACEABLE_AMPLITUDE && point.y <= DISPLACEABLE_AMPLITUDE;
-            };
-            for (const auto &corner : frustumCornerPoints)
+            else
             {
-                if (isWithinVolume(corner))
-                {
-                    intersectionPoints.push_back(corner);
-                }
+                m_profiler->beginCpuSection(Profiler::PROJECTED_GRID);
+                isWaterGridVisible = computeProjectedGridCorners(DISPLACEABLE_AMPLITUDE, projection, inverseViewProjection, projectedGridCornerPoints);
+                m_profiler->endCpuSection(Profiler::PROJECTED_GRID);
             }
 
-            // only continue to render the water grid, if there were intersection points
-            if (!intersectionPoints.empty())
+            if (isWaterGridVisible)
             {
-                Camera projector{*m_camera};
-
-                float const cameraDistanceFromBasePlane{m_camera->getPosition().y};
-                bool const isUnderwater{cameraDistanceFromBasePlane < 0.0f};
-                // TODO: make this a UI property
-                float const PROJECTOR_ELEVATION_FROM_CAMERA{1.0f};
-                float const MINIMUM_PROJECTOR_DISTANCE_FROM_BASE_PLANE{DISPLACEABLE_AMPLITUDE + PROJECTOR_ELEVATION_FROM_CAMERA};
-
-                // translate the y-position of the projector, so that it lies outside the displaceable volume (with some extra elevation padding)
-                if (cameraDistanceFromBasePlane < MINIMUM_PROJECTOR_DISTANCE_FROM_BASE_PLANE)
-                {
-                    if (isUnderwater)
-                        projector.translate(glm::vec3{0.0f, MINIMUM_PROJECTOR_DISTANCE_FROM_BASE_PLANE - 2.0f * cameraDistanceFromBasePlane, 0.0f});
-                    else
-                        projector.translate(glm::vec3{0.0f, MINIMUM_PROJECTOR_DISTANCE_FROM_BASE_PLANE - cameraDistanceFromBasePlane, 0.0f});
-                }
-
-                // safely handle when the camera is looking too close to the horizon (shift the forward vector a bit to ensure the intersection test succeeds for aimpoint_1)
-                glm::vec3 cameraForwardIntersectionSafe{m_camera->getForward()};
-                float const SAFE_EPSILON{0.001f};
-                if (glm::abs(cameraForwardIntersectionSafe.y) < SAFE_EPSILON)
-                {
-                    float const sign{cameraForwardIntersectionSafe.y >= 0.0f ? 1.0f : -1.0f};
-                    cameraForwardIntersectionSafe.y = sign * SAFE_EPSILON;
-                    // NOTE: there is no need to normalize this (and I don't want to cause the ypos will decrease)
-                }
-
-                // compute aimpoint for method 1 (bird's eye)...
-                glm::vec3 aimpoint_1;
-                bool const isLookingDown{cameraForwardIntersectionSafe.y < 0.0f};
-                bool const isLookingDown_XOR_isUnderwater{isLookingDown != isUnderwater};
-                if (isLookingDown_XOR_isUnderwater)
-                {
-                    bool const isIntersection{utils::linePlaneIntersection(aimpoint_1, geometry::Line{m_camera->getPosition(), m_camera->getPosition() + cameraForwardIntersectionSafe}, basePlane)};
-                    assert(isIntersection);
-                }
-                else
-                {
-                    glm::vec3 const cameraForwardIntersectionSafeMirrored{glm::reflect(cameraForwardIntersectionSafe, basePlane.getNormalVec())};
-                    bool const isIntersection{utils::linePlaneIntersection(aimpoint_1, geometry::Line{m_camera->getPosition(), m_camera->getPosition() + cameraForwardIntersectionSafeMirrored}, basePlane)};
-                    assert(isIntersection);
-                }
-
-                // compute aimpoint for method 2 (horizon)...
-                // TODO: make this a UI property? auto-generate it?
-                float const FORWARD_FIXED_LENGTH{1.0f};
-                glm::vec3 aimpoint_2{m_camera->getPosition() + FORWARD_FIXED_LENGTH * m_camera->getForward()};
-                // project this point onto the base plane
-                aimpoint_2.y = 0.0f;
-
-                // NOTE: the grid changes abruptly when aimpoint_final == aimpoint2 (a == 0), but this will never occur since...
-                //       I made the camera's forward vector (for the math only) intersection safe (aimpoint_1 will be defined and a != 0.0)
-                //  compute the interpolation coefficient in range [SAFE_EPSILON, 1.0]...
-                float const a{glm::abs(cameraForwardIntersectionSafe.y)};
-
-                // compute the final aimpoint as an interpolation between the two aimpoints...
-                glm::vec3 const aimpoint_final{glm::mix(aimpoint_2, aimpoint_1, a)};
-
-                // compute the projector's pitch in order to aim at this aimpoint...
-                glm::vec3 const projectorNewForwardVec{glm::normalize(aimpoint_final - projector.getPosition())};
-                glm::vec3 const projectorNewForwardVecXZProjection{glm::normalize(glm::vec3{projectorNewForwardVec.x, 0.0f, projectorNewForwardVec.z})};
-                // NOTE: the projector's position will always be above water, thus the pitch will always be negative
-                float projectorNewPitchDegrees{-glm::degrees(glm::acos(glm::dot(projectorNewForwardVec, projectorNewForwardVecXZProjection)))};
-
-                // now, aim the projector...
-                projector.setRotation(projector.getYaw(), projectorNewPitchDegrees);
-                ///////////////////////////////////////////////////////////////////////////////////
-
-                // project all intersection points onto base plane...
-                for (auto &point : intersectionPoints)
-                {
-                    point.y = 0.0f;
-                }
-
-                // transform all intersection points into NDC-space (for projector)
-                // reference: https://community.khronos.org/t/homogenous-normalized-device-coords-and-clipping/61965
-                // reference: https://stackoverflow.com/questions/21841598/when-does-the-transition-from-clip-space-to-screen-coordinates-happen
-                // NOTE: I was having a lot of issues before I divided by w, so hopefully everything works now
-                glm::mat4 const projector_viewProjectionMat{projector.getProjectionMat() * projector.getViewMat()};
-                for (unsigned int i = 0; i < intersectionPoints.size(); ++i)
-                {
-                    glm::vec4 const temp{projector_viewProjectionMat * intersectionPoints.at(i)}; // now in clip-space
-                    intersectionPoints.at(i) = temp / temp.w;                                     // now in NDC-space
-                }
-
-                // determine the xy-NDC bounds of the intersection points
-                // clang-format off
-                float x_min = std::min_element(intersectionPoints.begin(), intersectionPoints.end(),
-                    [](const glm::vec4& a, const glm::vec4& b) { return a.x < b.x; })->x;
-
-                float x_max = std::max_element(intersectionPoints.begin(), intersectionPoints.end(),
-                    [](const glm::vec4& a, const glm::vec4& b) { return a.x < b.x; })->x;
-
-                float y_min = std::min_element(intersectionPoints.begin(), intersectionPoints.end(),
-                    [](const glm::vec4& a, const glm::vec4& b) { return a.y < b.y; })->y;
-
-                float y_max = std::max_element(intersectionPoints.begin(), intersectionPoints.end(),
-                    [](const glm::vec4& a, const glm::vec4& b) { return a.y < b.y; })->y;
-                // clang-format on
-
-                glm::mat4 const rangeMat{x_max - x_min, 0.0f, 0.0f, 0.0f,
-                                         0.0f, y_max - y_min, 0.0f, 0.0f,
-                                         0.0f, 0.0f, 1.0f, 0.0f,
-                                         x_min, y_min, 0.0f, 1.0f};
-
-                // compute M_projector...
-                glm::mat4 const projectorMat{glm::inverse(projection * projector.getViewMat()) * rangeMat};
-
-                // compute the world-space coordinates of the four grid corners...
-                // init the corner positions in a special uv-space ("range-space") - (with z = -1 (near) for convenience for intersection test below)
-                std::array<glm::vec4, 4> waterGridCornerPoints{glm::vec4{0.0f, 0.0f, -1.0f, 1.0f},  // [0] - bottom-left
-                                                               glm::vec4{0.0f, 1.0f, -1.0f, 1.0f},  // [1] - top-left
-                                                               glm::vec4{1.0f, 0.0f, -1.0f, 1.0f},  // [2] - bottom-right
-                                                               glm::vec4{1.0f, 1.0f, -1.0f, 1.0f}}; // [3] - top-right
-
-                // transform the coordinates to world-space...
-                // intersect projected rays with XZ-plane (base plane) to get world-space bounds of grid...
-                for (unsigned int i = 0; i < waterGridCornerPoints.size(); ++i)
-                {
-                    glm::vec4 p0{waterGridCornerPoints.at(i)};
-                    glm::vec4 p1{p0};
-                    p1.z = 1.0f; // far
-
-                    // transform both points to world-space...
-                    p0 = projectorMat * p0;
-                    p0 /= p0.w;
-                    p1 = projectorMat * p1;
-                    p1 /= p1.w;
-
-                    // intersection test...
-                    geometry::Line const line{p0, p1};
-                    glm::vec3 intersectionPoint;
-                    bool const isIntersection{utils::linePlaneIntersection(intersectionPoint, line, basePlane)};
-                    assert(isIntersection);
-                    waterGridCornerPoints.at(i) = glm::vec4{intersectionPoint, 1.0f};
-                }
-
-                // set useful aliases for the grid corners
-                glm::vec4 const &bottomLeftGridPointInWorld{waterGridCornerPoints.at(0)};
-                glm::vec4 const &topLeftGridPointInWorld{waterGridCornerPoints.at(1)};
-                glm::vec4 const &bottomRightGridPointInWorld{waterGridCornerPoints.at(2)};
-                glm::vec4 const &topRightGridPointInWorld{waterGridCornerPoints.at(3)};
-
                 // now render...
+                m_profiler->beginGpuPass(Profiler::WATER_GRID);
                 glUseProgram(waterGridProgram);
                 glBindVertexArray(waterGrid->vao);
 
                 // set uniforms...
-                // NOTE: this should be >= 2
-                GLuint const GRID_LENGTH = 513;
-
-                glUniform4fv(glGetUniformLocation(waterGridProgram, "bottomLeftGridPointInWorld"), 1, glm::value_ptr(bottomLeftGridPointInWorld));
-                glUniform4fv(glGetUniformLocation(waterGridProgram, "bottomRightGridPointInWorld"), 1, glm::value_ptr(bottomRightGridPointInWorld));
-                glUniform3fv(glGetUniformLocation(waterGridProgram, "cameraPosition"), 1, glm::value_ptr(m_camera->getPosition()));
-                Texture::bind2DTexture(waterGridProgram, m_depthTexture2D, "depthTexture2D");
-                glUniform4fv(glGetUniformLocation(waterGridProgram, "fogColourFarAtCurrentTime"), 1, glm::value_ptr(fogColourFarAtCurrentTime));
+                Texture::bind2DTexture(m_waterGridProgramUniforms.depthTexture2D, m_depthTexture2D);
 
                 // reference: https://developer.nvidia.com/gpugems/gpugems/part-i-natural-effects/chapter-1-effective-water-simulation-physical-models
                 // reference: https://github.com/CaffeineViking/osgw/blob/master/share/shaders/gerstner.glsl
-                glUniform1ui(glGetUniformLocation(waterGridProgram, "gerstnerWaveCount"), geometry::GerstnerWave::Count());
-                for (unsigned int i = 0; i < gerstnerWaves.size(); ++i)
+                Texture::bind2DTexture(m_waterGridProgramUniforms.heightmap, waterGrid->textureID);
+                glUniform1f(m_waterGridProgramUniforms.heightmapDisplacementScale, heightmapDisplacementScale);
+                glUniform1f(m_waterGridProgramUniforms.heightmapSampleScale, heightmapSampleScale);
+                glUniform1ui(m_waterGridProgramUniforms.isUsingOceanFFT, isUsingOceanFFT ? 1 : 0);
+                Texture::bind2DTexture(m_waterGridProgramUniforms.localReflectionsTexture2D, m_localReflectionsTexture2D);
+                Texture::bind2DTexture(m_waterGridProgramUniforms.localRefractionsTexture2D, m_localRefractionsTexture2D);
+                if (isUsingOceanFFT)
                 {
-                    std::shared_ptr<geometry::GerstnerWave const> gerstnerWave{gerstnerWaves.at(i)};
-                    if (nullptr == gerstnerWave)
-                        continue;
-
-                    // NOTE: div by zero is just handled by setting to a symbolic 0.0
-                    float const steepness_Q_i{(gerstnerWave->frequency_w * gerstnerWave->amplitude_A) != 0.0f ? gerstnerWave->steepness_Q / (gerstnerWave->frequency_w * gerstnerWave->amplitude_A * geometry::GerstnerWave::Count()) : 0.0f};
-                    std::string const prefixStr{"gerstnerWaves[" + std::to_string(i) + "]."};
-
-                    glUniform1f(glGetUniformLocation(waterGridProgram, std::string{prefixStr + "amplitude_A"}.c_str()), gerstnerWave->amplitude_A);
-                    glUniform1f(glGetUniformLocation(waterGridProgram, std::string{prefixStr + "frequency_w"}.c_str()), gerstnerWave->frequency_w);
-                    glUniform1f(glGetUniformLocation(waterGridProgram, std::string{prefixStr + "phaseConstant_phi"}.c_str()), gerstnerWave->phaseConstant_phi);
-                    glUniform1f(glGetUniformLocation(waterGridProgram, std::string{prefixStr + "steepness_Q_i"}.c_str()), steepness_Q_i);
-                    glUniform2fv(glGetUniformLocation(waterGridProgram, std::string{prefixStr + "xzDirection_D"}.c_str()), 1, glm::value_ptr(gerstnerWave->xzDirection_D));
+                    Texture::bind2DTexture(m_waterGridProgramUniforms.oceanDisplacementMap, m_oceanDisplacementTexture2D);
+                    Texture::bind2DTexture(m_waterGridProgramUniforms.oceanNormalFoldingMap, m_oceanNormalFoldingTexture2D);
+                    glUniform1f(m_waterGridProgramUniforms.oceanSampleScale, 1.0f / m_oceanFFT->getParameters().patchLengthInMeters);
                 }
 
-                GLint width_hm, height_hm;
-                glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width_hm);
-                glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height_hm);
-
-                glUniform1ui(glGetUniformLocation(waterGridProgram, "gridLength"), GRID_LENGTH);
-                Texture::bind2DTexture(waterGridProgram, waterGrid->textureID, "heightmap");
-                glUniform1f(glGetUniformLocation(waterGridProgram, "heightmapDisplacementScale"), heightmapDisplacementScale);
-                glUniform1f(glGetUniformLocation(waterGridProgram, "heightmapSampleScale"), heightmapSampleScale);
-                glUniform2f(glGetUniformLocation(waterGridProgram, "heightmapResolution"), (float)width_hm, (float)height_hm);
-                Texture::bind2DTexture(waterGridProgram, m_localReflectionsTexture2D, "localReflectionsTexture2D");
-                Texture::bind2DTexture(waterGridProgram, m_localRefractionsTexture2D, "localRefractionsTexture2D");
-
                 //  bind texture...
                 glActiveTexture(GL_TEXTURE0 + m_skyboxCubemap);
                 glBindTexture(GL_TEXTURE_CUBE_MAP, m_skyboxCubemap);
-                glUniform1i(glGetUniformLocation(waterGridProgram, "skybox"), m_skyboxCubemap);
-
-                glUniform1f(glGetUniformLocation(waterGridProgram, "softEdgesDeltaDepthThreshold"), softEdgesDeltaDepthThreshold);
-                glUniform3fv(glGetUniformLocation(waterGridProgram, "sunPosition"), 1, glm::value_ptr(sunPosition));
-                glUniform1f(glGetUniformLocation(waterGridProgram, "sunShininess"), sunShininess);
-                glUniform1f(glGetUniformLocation(waterGridProgram, "sunStrength"), sunStrength);
-                glUniform1f(glGetUniformLocation(waterGridProgram, "tintDeltaDepthThreshold"), tintDeltaDepthThreshold);
-                glUniform4fv(glGetUniformLocation(waterGridProgram, "topLeftGridPointInWorld"), 1, glm::value_ptr(topLeftGridPointInWorld));
-                glUniform4fv(glGetUniformLocation(waterGridProgram, "topRightGridPointInWorld"), 1, glm::value_ptr(topRightGridPointInWorld));
-                glUniform1f(glGetUniformLocation(waterGridProgram, "verticalBounceWaveDisplacement"), verticalBounceWaveDisplacement);
-                glUniformMatrix4fv(glGetUniformLocation(waterGridProgram, "viewMatOnlyYaw"), 1, GL_FALSE, glm::value_ptr(viewMatOnlyYaw));
-                glUniform2fv(glGetUniformLocation(waterGridProgram, "viewportWidthHeight"), 1, glm::value_ptr(glm::vec2{(float)m_windowWidth, (float)m_windowHeight}));
-                glUniformMatrix4fv(glGetUniformLocation(waterGridProgram, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
-                glUniform1f(glGetUniformLocation(waterGridProgram, "waterClarity"), waterClarity);
-                glUniform1f(glGetUniformLocation(waterGridProgram, "waveAnimationTimeInSeconds"), waveAnimationTimeInSeconds);
-                glUniform1f(glGetUniformLocation(waterGridProgram, "zFar"), Z_FAR);
-                glUniform1f(glGetUniformLocation(waterGridProgram, "zNear"), Z_NEAR);
-
-                if (projectorNewPitchDegrees < -65.0f)
-                    glUniform1f(glGetUniformLocation(waterGridProgram, "tessLevel"), 1.0f);
-                else if (projectorNewPitchDegrees < -45.0f)
-                    glUniform1f(glGetUniformLocation(waterGridProgram, "tessLevel"), 2.0f);
-                else
-                    glUniform1f(glGetUniformLocation(waterGridProgram, "tessLevel"), 3.0f);
+                glUniform1i(m_waterGridProgramUniforms.skybox, m_skyboxCubemap);
+
+                glUniform1f(m_waterGridProgramUniforms.softEdgesDeltaDepthThreshold, softEdgesDeltaDepthThreshold);
+                glUniform1f(m_waterGridProgramUniforms.sunShininess, sunShininess);
+                glUniform1f(m_waterGridProgramUniforms.sunStrength, sunStrength);
+                glUniform1f(m_waterGridProgramUniforms.tintDeltaDepthThreshold, tintDeltaDepthThreshold);
+                glUniform1f(m_waterGridProgramUniforms.verticalBounceWaveDisplacement, verticalBounceWaveDisplacement);
+                glUniform1f(m_waterGridProgramUniforms.waterClarity, waterClarity);
+
+                // per-edge tessellation from the projected edge lengths (see water-grid.tcs)
+                glUniform1f(m_waterGridProgramUniforms.maxTessellationLevel, MAX_TESSELLATION_LEVEL);
+                glUniform1f(m_waterGridProgramUniforms.tessellationTargetEdgeLengthInPixels, glm::max(tessellationTargetEdgeLengthInPixels, 1.0f));
+                // ...unless the clipmap fixes it (see OceanClipmap)
+                glUniform1f(m_waterGridProgramUniforms.fixedTessellationLevel, isClipmap ? CLIPMAP_TESSELLATION_LEVEL : 0.0f);
 
                 // draw...
                 // POINT, LINE or FILL...
                 glPolygonMode(GL_FRONT_AND_BACK, waterGrid->m_polygonMode);
-                // glDrawElements(waterGrid->m_primitiveMode, waterGrid->drawFaces.size(), GL_UNSIGNED_INT, (void *)0);
-                glPatchParameteri(GL_PATCH_VERTICES, 3); // Set the number of vertices per patch (3 for triangles)
-                glDrawElements(GL_PATCHES, waterGrid->drawFaces.size(), GL_UNSIGNED_INT, (void *)0);
+                // one quad patch (4 vertices) per grid cell and one instance per row of cells
+                // NOTE: the shaders derive the patch corners from gl_VertexID and gl_InstanceID, so there's no vertex or index buffer (the vao is empty)
+                glPatchParameteri(GL_PATCH_VERTICES, 4);
+                auto const drawGrid{[&](std::array<glm::vec4, 4> const &cornerPoints, GLuint const gridLength, glm::vec4 const &clipmapMorph) {
+                    glUniform4fv(m_waterGridProgramUniforms.bottomLeftGridPointInWorld, 1, glm::value_ptr(cornerPoints.at(0)));
+                    glUniform4fv(m_waterGridProgramUniforms.bottomRightGridPointInWorld, 1, glm::value_ptr(cornerPoints.at(1)));
+                    glUniform4fv(m_waterGridProgramUniforms.topLeftGridPointInWorld, 1, glm::value_ptr(cornerPoints.at(2)));
+                    glUniform4fv(m_waterGridProgramUniforms.topRightGridPointInWorld, 1, glm::value_ptr(cornerPoints.at(3)));
+                    glUniform1ui(m_waterGridProgramUniforms.gridLength, gridLength);
+                    glUniform4fv(m_waterGridProgramUniforms.clipmapMorph, 1, glm::value_ptr(clipmapMorph));
+                    glDrawArraysInstanced(GL_PATCHES, 0, 4 * (gridLength - 1), gridLength - 1);
+                }};
+                beginWaterPrimitiveQuery();
+                if (isClipmap)
+                {
+                    for (OceanClipmap::Tile const &tile : m_oceanClipmap->getTiles())
+                    {
+                        glm::vec4 const origin{tile.origin.x, 0.0f, tile.origin.y, 1.0f};
+                        std::array<glm::vec4, 4> const cornerPoints{origin, origin + glm::vec4{tile.size, 0.0f, 0.0f, 0.0f}, origin + glm::vec4{0.0f, 0.0f, tile.size, 0.0f}, origin + glm::vec4{tile.size, 0.0f, tile.size, 0.0f}};
+                        // (tessellated vertex spacing, morph start, morph end, 0) - see morphClipmapVertex() in water-grid.tes
+                        float const vertexSpacing{tile.size / (tile.cellCount * CLIPMAP_TESSELLATION_LEVEL)};
+                        glm::vec4 const clipmapMorph{vertexSpacing, m_oceanClipmap->getMorphStart(tile.level), m_oceanClipmap->getRange(tile.level), 0.0f};
+                        drawGrid(cornerPoints, tile.cellCount + 1, clipmapMorph);
+                    }
+                }
+                else
+                {
+                    drawGrid(projectedGridCornerPoints, computeWaterGridLength(), glm::vec4{0.0f});
+                }
+                endWaterPrimitiveQuery();
 
                 // unbind texture...
                 glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
@@ -988,170 +769,641 @@ namespace wave_tool
                 Texture::unbind2DTexture();
                 glBindVertexArray(0); // unbind VAO
                 glUseProgram(0);      // unbind shader program
+                m_profiler->endGpuPass();
             }
         }
         ///////////////////////////////////////////////////
     }
 
-    void RenderEngine::assignBuffers(MeshObject &object)
+    void RenderEngine::updateObjectBVH(std::vector<std::shared_ptr<MeshObject>> const &objects)
     {
-        std::vector<glm::vec3> const &vertices = object.drawVerts;
-        std::vector<glm::vec3> const &normals = object.normals;
-        std::vector<glm::vec2> const &uvs = object.uvs;
-        std::vector<glm::vec3> const &colours = object.colours;
-        std::vector<GLuint> const &faces = object.drawFaces;
+        // only visible objects take part (an object toggling visibility changes the item set, which forces a rebuild)
+        m_objectBVHBounds.clear();
+        bool isItemSetChanged{false};
+        std::size_t itemCount{0};
+        for (std::shared_ptr<MeshObject> const &o : objects)
+        {
+            assert(0 != o->shaderProgramID);
 
-        glGenVertexArrays(1, &object.vao);
-        glBindVertexArray(object.vao);
+            if (!o->m_isVisible)
+                continue;
 
-        // Vertex buffer
-        // location 0 in vao
-        if (vertices.size() > 0)
+            if (itemCount >= m_objectBVHItems.size() || m_objectBVHItems.at(itemCount) != o.get())
+            {
+                isItemSetChanged = true;
+                m_objectBVHItems.resize(itemCount);
+                m_objectBVHItems.push_back(o.get());
+            }
+            m_objectBVHBounds.push_back(o->getWorldBounds());
+            ++itemCount;
+        }
+        if (itemCount != m_objectBVHItems.size())
         {
-            glGenBuffers(1, &object.vertexBuffer);
-            glBindBuffer(GL_ARRAY_BUFFER, object.vertexBuffer);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
-            glEnableVertexAttribArray(0);
+            isItemSetChanged = true;
+            m_objectBVHItems.resize(itemCount);
         }
 
-        // Normal buffer
-        // location 1 in vao
-        if (normals.size() > 0)
+        // otherwise, the objects may have moved, so the tree is refit
+        if (isItemSetChanged)
+            m_objectBVH.build(m_objectBVHBounds);
+        else
+            m_objectBVH.refit(m_objectBVHBounds);
+    }
+
+    void RenderEngine::submitMainProgramPass(RenderQueue::Pass const pass, glm::mat4 const &passMat, glm::vec4 const &clipPlane, bool const forceFlipNormals, glm::mat4 const &view, glm::mat4 const &projection)
+    {
+        ScopedCpuTimer const timer{*m_profiler, Profiler::OBJECT_SUBMISSION};
+
+        // state can have been changed outside of the cache since the last pass
+        m_renderStateCache.reset();
+        for (RenderQueue::DrawItem const *item = m_renderQueue.begin(pass); item != m_renderQueue.end(pass); ++item)
         {
-            glGenBuffers(1, &object.normalBuffer);
-            glBindBuffer(GL_ARRAY_BUFFER, object.normalBuffer);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * normals.size(), normals.data(), GL_STATIC_DRAW);
-            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
-            glEnableVertexAttribArray(1);
+            MeshObject const &o{*item->object};
+
+            glm::mat4 const modelMat{passMat * o.getModel()};
+            glm::mat4 const modelViewMat{view * modelMat};
+            glm::mat4 const mvpMat{projection * modelViewMat};
+
+            // enable shader program (the per-pass uniforms only need setting when the program was switched)...
+            GLuint const previousProgram{m_renderStateCache.getProgram()};
+            m_renderStateCache.useProgram(mainProgram);
+            if (previousProgram != mainProgram)
+            {
+                glUniform4fv(m_mainProgramUniforms.clipPlane0, 1, glm::value_ptr(clipPlane));
+                m_renderStateCache.uniform1i(m_mainProgramUniforms.forceFlipNormals, forceFlipNormals ? GL_TRUE : GL_FALSE);
+            }
+            // bind geometry data...
+            m_renderStateCache.bindVertexArray(o.vao);
+
+            // set uniforms...
+            m_renderStateCache.uniform1i(m_mainProgramUniforms.hasNormals, o.hasNormals());
+            // TODO: handle this better
+            m_renderStateCache.uniform1i(m_mainProgramUniforms.isTextured, o.hasTexture);
+            m_renderStateCache.bind2DTexture(m_mainProgramUniforms.textureData, o.textureID);
+            glUniformMatrix4fv(m_mainProgramUniforms.modelMat, 1, GL_FALSE, glm::value_ptr(modelMat));
+            glUniformMatrix4fv(m_mainProgramUniforms.modelViewMat, 1, GL_FALSE, glm::value_ptr(modelViewMat));
+            glUniformMatrix4fv(m_mainProgramUniforms.mvpMat, 1, GL_FALSE, glm::value_ptr(mvpMat));
+
+            // POINT, LINE or FILL...
+            m_renderStateCache.polygonMode(o.m_polygonMode);
+            glDrawElements(o.m_primitiveMode, o.indexCount, o.indexType, (void *)0);
         }
 
-        if (uvs.size() > 0)
+        Texture::unbind2DTexture();
+        // unbind
+        glBindVertexArray(0);
+        m_renderStateCache.reset();
+    }
+
+    void RenderEngine::submitDepthPass(glm::mat4 const &viewProjection)
+    {
+        ScopedCpuTimer const timer{*m_profiler, Profiler::OBJECT_SUBMISSION};
+
+        m_renderStateCache.reset();
+        // enable shader program...
+        m_renderStateCache.useProgram(depthProgram);
+        for (RenderQueue::DrawItem const *item = m_renderQueue.begin(RenderQueue::DEPTH); item != m_renderQueue.end(RenderQueue::DEPTH); ++item)
         {
-            // UV buffer
-            // location 2 in vao
-            glGenBuffers(1, &object.uvBuffer);
-            glBindBuffer(GL_ARRAY_BUFFER, object.uvBuffer);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * uvs.size(), uvs.data(), GL_STATIC_DRAW);
-            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, (void *)0);
-            glEnableVertexAttribArray(2);
+            MeshObject const &o{*item->object};
+
+            glm::mat4 const mvpMat{viewProjection * o.getModel()};
+
+            // bind geometry data...
+            m_renderStateCache.bindVertexArray(o.vao);
+
+            // set uniforms...
+            glUniformMatrix4fv(m_depthProgramUniforms.mvpMat, 1, GL_FALSE, glm::value_ptr(mvpMat));
+
+            // POINT, LINE or FILL...
+            m_renderStateCache.polygonMode(o.m_polygonMode);
+            glDrawElements(o.m_primitiveMode, o.indexCount, o.indexType, (void *)0);
         }
 
-        // Colour buffer
-        // location 3 in vao
-        if (colours.size() > 0)
+        // unbind
+        glBindVertexArray(0);
+        m_renderStateCache.reset();
+    }
+
+    void RenderEngine::enableShaderHotReload(GLFWwindow *workerContext)
+    {
+        std::vector<ShaderHotReloader::ProgramSources> programSources;
+        for (auto const &[program, sources] : getProgramSources())
+            programSources.push_back(sources);
+        m_shaderHotReloader = std::make_unique<ShaderHotReloader>(SHADER_DIRECTORY, programSources, workerContext);
+    }
+
+    std::vector<std::pair<GLuint, GLuint>> RenderEngine::updateShaderHotReload()
+    {
+        std::vector<std::pair<GLuint, GLuint>> replacedPrograms;
+        if (nullptr == m_shaderHotReloader)
+            return replacedPrograms;
+
+        std::vector<ShaderHotReloader::Reload> const reloads{m_shaderHotReloader->update()};
+        if (reloads.empty())
+            return replacedPrograms;
+
+        auto const programSources{getProgramSources()};
+        for (ShaderHotReloader::Reload const &reload : reloads)
         {
-            glGenBuffers(1, &object.colourBuffer);
-            glBindBuffer(GL_ARRAY_BUFFER, object.colourBuffer);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * colours.size(), colours.data(), GL_STATIC_DRAW);
-            glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
-            glEnableVertexAttribArray(3);
+            GLuint &program{*programSources.at(reload.index).first};
+            bindUniformBlocks(reload.program);
+            replacedPrograms.emplace_back(program, reload.program);
+            glDeleteProgram(program);
+            program = reload.program;
         }
 
-        // Face buffer
-        if (faces.size() > 0)
+        // the uniform locations (and any state cached per program name) belong to the old programs
+        resolveUniformLocations();
+        m_renderStateCache.reset();
+        return replacedPrograms;
+    }
+
+    std::string RenderEngine::getShaderHotReloadErrorLog() const
+    {
+        return nullptr != m_shaderHotReloader ? m_shaderHotReloader->getErrorLog() : std::string{};
+    }
+
+    // NOTE: size is how much of data is filled, blockSize is the full size of the block (the bound range always covers the whole block)
+    void RenderEngine::streamUniformBlock(GLuint const bindingPoint, void const *data, GLsizeiptr const size, GLsizeiptr const blockSize)
+    {
+        StreamingBuffer::Allocation const allocation{m_streamingBuffer->allocate(blockSize, m_uniformBufferOffsetAlignment)};
+        // NOTE: can't fail, the blocks are the first allocations of a frame and are much smaller than a region
+        assert(allocation.isValid());
+        std::memcpy(allocation.data, data, size);
+        m_streamingBuffer->commit(allocation);
+        glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_streamingBuffer->getBuffer(), allocation.offset, allocation.size);
+    }
+
+    std::vector<std::pair<GLuint *, ShaderHotReloader::ProgramSources>> RenderEngine::getProgramSources()
+    {
+        return {{&depthProgram, {SHADER_DIRECTORY + "depth.vert", SHADER_DIRECTORY + "depth.frag", "", ""}},
+                {&screenSpaceQuadProgram, {SHADER_DIRECTORY + "screen-space-quad.vert", SHADER_DIRECTORY + "screen-space-quad.frag", "", ""}},
+                {&skyboxCloudsProgram, {SHADER_DIRECTORY + "skybox-clouds.vert", SHADER_DIRECTORY + "skybox-clouds.frag", "", ""}},
+                {&skyboxStarsProgram, {SHADER_DIRECTORY + "skybox-stars.vert", SHADER_DIRECTORY + "skybox-stars.frag", "", ""}},
+                {&skyboxTrivialProgram, {SHADER_DIRECTORY + "skybox-trivial.vert", SHADER_DIRECTORY + "skybox-trivial.frag", "", ""}},
+                {&skysphereProgram, {SHADER_DIRECTORY + "skysphere.vert", SHADER_DIRECTORY + "skysphere.frag", "", ""}},
+                {&mainProgram, {SHADER_DIRECTORY + "main.vert", SHADER_DIRECTORY + "main.frag", "", ""}},
+                {&waterGridProgram, {SHADER_DIRECTORY + "water-grid.vert", SHADER_DIRECTORY + "water-grid.frag", SHADER_DIRECTORY + "water-grid.tcs", SHADER_DIRECTORY + "water-grid.tes"}}};
+    }
+
+    // connects the program to the shared per-frame uniform block and the wave set (bindUniformBlock skips blocks a program doesn't use)
+    void RenderEngine::bindUniformBlocks(GLuint const program)
+    {
+        ShaderTools::bindUniformBlock(program, "FrameUniforms", FRAME_UNIFORMS_BINDING);
+        ShaderTools::bindUniformBlock(program, "GerstnerWaves", GERSTNER_WAVES_BINDING);
+    }
+
+    // NOTE: must be called again whenever a program is re-linked (locations are only valid for the program they came from)
+    void RenderEngine::resolveUniformLocations()
+    {
+        ProgramReflection const depth{ShaderTools::reflectProgram(depthProgram)};
+        m_depthProgramUniforms.mvpMat = depth.getUniformLocation("mvpMat");
+
+        ProgramReflection const main{ShaderTools::reflectProgram(mainProgram)};
+        m_mainProgramUniforms.clipPlane0 = main.getUniformLocation("clipPlane0");
+        m_mainProgramUniforms.forceFlipNormals = main.getUniformLocation("forceFlipNormals");
+        m_mainProgramUniforms.hasNormals = main.getUniformLocation("hasNormals");
+        m_mainProgramUniforms.isTextured = main.getUniformLocation("isTextured");
+        m_mainProgramUniforms.modelMat = main.getUniformLocation("modelMat");
+        m_mainProgramUniforms.modelViewMat = main.getUniformLocation("modelViewMat");
+        m_mainProgramUniforms.mvpMat = main.getUniformLocation("mvpMat");
+        m_mainProgramUniforms.textureData = main.getUniformLocation("textureData");
+
+        ProgramReflection const screenSpaceQuad{ShaderTools::reflectProgram(screenSpaceQuadProgram)};
+        m_screenSpaceQuadProgramUniforms.isTextured = screenSpaceQuad.getUniformLocation("isTextured");
+        m_screenSpaceQuadProgramUniforms.solidColour = screenSpaceQuad.getUniformLocation("solidColour");
+        m_screenSpaceQuadProgramUniforms.textureData = screenSpaceQuad.getUniformLocation("textureData");
+
+        ProgramReflection const skyboxClouds{ShaderTools::reflectProgram(skyboxCloudsProgram)};
+        m_skyboxCloudsProgramUniforms.oneMinusCloudProportion = skyboxClouds.getUniformLocation("oneMinusCloudProportion");
+        m_skyboxCloudsProgramUniforms.skyboxClouds = skyboxClouds.getUniformLocation("skyboxClouds");
+        m_skyboxCloudsProgramUniforms.VPNoTranslation = skyboxClouds.getUniformLocation("VPNoTranslation");
+
+        ProgramReflection const skyboxStars{ShaderTools::reflectProgram(skyboxStarsProgram)};
+        m_skyboxStarsProgramUniforms.skyboxStars = skyboxStars.getUniformLocation("skyboxStars");
+        m_skyboxStarsProgramUniforms.VPNoTranslation = skyboxStars.getUniformLocation("VPNoTranslation");
+
+        ProgramReflection const skyboxTrivial{ShaderTools::reflectProgram(skyboxTrivialProgram)};
+        m_skyboxTrivialProgramUniforms.skybox = skyboxTrivial.getUniformLocation("skybox");
+        m_skyboxTrivialProgramUniforms.VPNoTranslation = skyboxTrivial.getUniformLocation("VPNoTranslation");
+
+        ProgramReflection const skysphere{ShaderTools::reflectProgram(skysphereProgram)};
+        m_skysphereProgramUniforms.skysphere = skysphere.getUniformLocation("skysphere");
+        m_skysphereProgramUniforms.sunHorizonDarkness = skysphere.getUniformLocation("sunHorizonDarkness");
+        m_skysphereProgramUniforms.sunShininess = skysphere.getUniformLocation("sunShininess");
+        m_skysphereProgramUniforms.sunStrength = skysphere.getUniformLocation("sunStrength");
+        m_skysphereProgramUniforms.VPNoTranslation = skysphere.getUniformLocation("VPNoTranslation");
+
+        ProgramReflection const waterGrid{ShaderTools::reflectProgram(waterGridProgram)};
+        m_waterGridProgramUniforms.bottomLeftGridPointInWorld = waterGrid.getUniformLocation("bottomLeftGridPointInWorld");
+        m_waterGridProgramUniforms.bottomRightGridPointInWorld = waterGrid.getUniformLocation("bottomRightGridPointInWorld");
+        m_waterGridProgramUniforms.clipmapMorph = waterGrid.getUniformLocation("clipmapMorph");
+        m_waterGridProgramUniforms.depthTexture2D = waterGrid.getUniformLocation("depthTexture2D");
+        m_waterGridProgramUniforms.fixedTessellationLevel = waterGrid.getUniformLocation("fixedTessellationLevel");
+        m_waterGridProgramUniforms.gridLength = waterGrid.getUniformLocation("gridLength");
+        m_waterGridProgramUniforms.heightmap = waterGrid.getUniformLocation("heightmap");
+        m_waterGridProgramUniforms.heightmapDisplacementScale = waterGrid.getUniformLocation("heightmapDisplacementScale");
+        m_waterGridProgramUniforms.heightmapSampleScale = waterGrid.getUniformLocation("heightmapSampleScale");
+        m_waterGridProgramUniforms.isUsingOceanFFT = waterGrid.getUniformLocation("isUsingOceanFFT");
+        m_waterGridProgramUniforms.localReflectionsTexture2D = waterGrid.getUniformLocation("localReflectionsTexture2D");
+        m_waterGridProgramUniforms.localRefractionsTexture2D = waterGrid.getUniformLocation("localRefractionsTexture2D");
+        m_waterGridProgramUniforms.oceanDisplacementMap = waterGrid.getUniformLocation("oceanDisplacementMap");
+        m_waterGridProgramUniforms.oceanNormalFoldingMap = waterGrid.getUniformLocation("oceanNormalFoldingMap");
+        m_waterGridProgramUniforms.oceanSampleScale = waterGrid.getUniformLocation("oceanSampleScale");
+        m_waterGridProgramUniforms.skybox = waterGrid.getUniformLocation("skybox");
+        m_waterGridProgramUniforms.softEdgesDeltaDepthThreshold = waterGrid.getUniformLocation("softEdgesDeltaDepthThreshold");
+        m_waterGridProgramUniforms.sunShininess = waterGrid.getUniformLocation("sunShininess");
+        m_waterGridProgramUniforms.sunStrength = waterGrid.getUniformLocation("sunStrength");
+        m_waterGridProgramUniforms.maxTessellationLevel = waterGrid.getUniformLocation("maxTessellationLevel");
+        m_waterGridProgramUniforms.tessellationTargetEdgeLengthInPixels = waterGrid.getUniformLocation("tessellationTargetEdgeLengthInPixels");
+        m_waterGridProgramUniforms.tintDeltaDepthThreshold = waterGrid.getUniformLocation("tintDeltaDepthThreshold");
+        m_waterGridProgramUniforms.topLeftGridPointInWorld = waterGrid.getUniformLocation("topLeftGridPointInWorld");
+        m_waterGridProgramUniforms.topRightGridPointInWorld = waterGrid.getUniformLocation("topRightGridPointInWorld");
+        m_waterGridProgramUniforms.verticalBounceWaveDisplacement = waterGrid.getUniformLocation("verticalBounceWaveDisplacement");
+        m_waterGridProgramUniforms.waterClarity = waterGrid.getUniformLocation("waterClarity");
+    }
+
+    void RenderEngine::updateOceanFFT()
+    {
+        m_oceanFFT->setParameters(oceanFFTParameters);
+        m_oceanFFT->update(waveAnimationTimeInSeconds);
+
+        unsigned int const resolution{m_oceanFFT->getResolution()};
+        GLvoid const *displacementData{m_oceanFFT->getDisplacementMap().data()};
+        GLvoid const *normalFoldingData{m_oceanFFT->getNormalFoldingMap().data()};
+
+        // (re)allocate only when the resolution changes, otherwise just overwrite the texels
+        if (resolution != m_oceanTextureResolution)
         {
-            // NOTE: assuming every object with faces is using an index buffer (thus glDrawElements is always used)
-            //  this is fully compatible since if an object has only verts and wanted to use glDrawArrays, then it could just initialize a trivial index buffer (0,1,2,...,verts.size()-1)
-            glGenBuffers(1, &object.indexBuffer);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object.indexBuffer);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * faces.size(), faces.data(), GL_STATIC_DRAW);
+            m_oceanTextureResolution = resolution;
+            for (GLuint *texture : {&m_oceanDisplacementTexture2D, &m_oceanNormalFoldingTexture2D})
+            {
+                if (0 == *texture)
+                    glGenTextures(1, texture);
+                glBindTexture(GL_TEXTURE_2D, *texture);
+                // the patch tiles seamlessly
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, resolution, resolution, 0, GL_RGBA, GL_FLOAT, &m_oceanDisplacementTexture2D == texture ? displacementData : normalFoldingData);
+            }
         }
+        else
+        {
+            // the texels are staged in the streaming buffer, so the transfer happens on the GPU timeline instead of blocking glTexSubImage2D
+            GLsizeiptr const mapSize{GLsizeiptr(sizeof(float) * 4) * resolution * resolution};
+            for (GLuint const texture : {m_oceanDisplacementTexture2D, m_oceanNormalFoldingTexture2D})
+            {
+                GLvoid const *const data{m_oceanDisplacementTexture2D == texture ? displacementData : normalFoldingData};
+                StreamingBuffer::Allocation const allocation{m_streamingBuffer->upload(data, mapSize, sizeof(float) * 4)};
 
-        // unbind vao
-        glBindVertexArray(0);
+                glBindTexture(GL_TEXTURE_2D, texture);
+                if (allocation.isValid())
+                {
+                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_streamingBuffer->getBuffer());
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, resolution, resolution, GL_RGBA, GL_FLOAT, reinterpret_cast<GLvoid const *>(allocation.offset));
+                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                }
+                else
+                {
+                    // the streaming buffer grows for the next frame (e.g. after the resolution went up)
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, resolution, resolution, GL_RGBA, GL_FLOAT, data);
+                }
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
     }
 
-    // NOTE: this method assumes that the vector sizes have remained the same, the data in them has just changed
-    // NOTE: it also assumes that the buffers have already been created and bound to the vao (by assignBuffers)
-    void RenderEngine::updateBuffers(MeshObject &object, bool const updateVerts, bool const updateUVs, bool const updateNormals, bool const updateColours)
+    // NOTE: assumes the skybox FBO is bound with a square cubemap-sized viewport and depth writing disabled
+    void RenderEngine::renderSkyboxCubemapFace(unsigned int const face, std::shared_ptr<const MeshObject> const &skyboxStars, std::shared_ptr<const MeshObject> const &skysphere, std::shared_ptr<const MeshObject> const &skyboxClouds, glm::vec4 const &fogColourFarAtCurrentTime, float const oneMinusCloudProportion)
     {
-        // nothing bound
-        if (0 == object.vao)
-            return;
+        assert(face < 6);
 
-        if (updateVerts && 0 != object.vertexBuffer)
+        // attach the cube map face texture as the color attachment to render colours to
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, m_skyboxCubemap, 0);
+
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // now render star skybox then skysphere then cloud skybox then fog...
+        // NOTE: in the future, I could also render more objects (like far mountains/land) on top of everything
+
+        // render skybox (star layer) on top of clear colour...
+        // reference: https://learnopengl.com/Advanced-OpenGL/Cubemaps
+        // reference: http://antongerdelan.net/opengl/cubemaps.html
+        if (nullptr != skyboxStars && skyboxStars->m_isVisible)
         {
-            std::vector<glm::vec3> const &newVerts = object.drawVerts;
-            unsigned int const newSize = sizeof(glm::vec3) * newVerts.size();
+            // enable star shader program
+            glUseProgram(skyboxStarsProgram);
+            // bind geometry data...
+            glBindVertexArray(skyboxStars->vao);
 
-            GLint oldSize = 0;
-            glBindBuffer(GL_ARRAY_BUFFER, object.vertexBuffer);
-            glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &oldSize); // get size of data in buffer
+            // set uniforms...
+            // TODO: refactor into own function
+            // bind texture...
+            glActiveTexture(GL_TEXTURE0 + skyboxStars->textureID);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxStars->textureID);
+            glUniform1i(m_skyboxStarsProgramUniforms.skyboxStars, skyboxStars->textureID);
+            glUniformMatrix4fv(m_skyboxStarsProgramUniforms.VPNoTranslation, 1, GL_FALSE, glm::value_ptr(CUBEMAP_VP_NO_TRANSLATION_MATS.at(face)));
 
-            // only update buffer data if new data is same size, otherwise buffer will be unchanged
-            if (newSize == oldSize)
-            {
-                glBufferSubData(GL_ARRAY_BUFFER, 0, newSize, newVerts.data());
-            }
+            // POINT, LINE or FILL...
+            glPolygonMode(GL_FRONT_AND_BACK, skyboxStars->m_polygonMode);
+            glDrawElements(skyboxStars->m_primitiveMode, skyboxStars->indexCount, skyboxStars->indexType, (void *)0);
+
+            // TODO: refactor into own function
+            //  unbind texture...
+            glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+            // unbind
+            glBindVertexArray(0);
         }
 
-        if (updateUVs && 0 != object.uvBuffer)
+        // render skysphere on top of stars...
+        if (nullptr != skysphere && skysphere->m_isVisible)
         {
-            std::vector<glm::vec2> const &newUVs = object.uvs;
-            unsigned int const newSize = sizeof(glm::vec2) * newUVs.size();
+            // enable skysphere shader program
+            glUseProgram(skysphereProgram);
+            // bind geometry data...
+            glBindVertexArray(skysphere->vao);
 
-            GLint oldSize = 0;
-            glBindBuffer(GL_ARRAY_BUFFER, object.uvBuffer);
-            glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &oldSize); // get size of data in buffer
+            // set uniforms...
+            Texture::bind1DTexture(m_skysphereProgramUniforms.skysphere, skysphere->textureID);
+            glUniform1f(m_skysphereProgramUniforms.sunHorizonDarkness, sunHorizonDarkness);
+            glUniform1f(m_skysphereProgramUniforms.sunShininess, sunShininess);
+            glUniform1f(m_skysphereProgramUniforms.sunStrength, sunStrength);
+            glUniformMatrix4fv(m_skysphereProgramUniforms.VPNoTranslation, 1, GL_FALSE, glm::value_ptr(CUBEMAP_VP_NO_TRANSLATION_MATS.at(face)));
 
-            // only update buffer data if new data is same size, otherwise buffer will be unchanged
-            if (newSize == oldSize)
-            {
-                glBufferSubData(GL_ARRAY_BUFFER, 0, newSize, newUVs.data());
-            }
+            // POINT, LINE or FILL...
+            glPolygonMode(GL_FRONT_AND_BACK, skysphere->m_polygonMode);
+            glDrawElements(skysphere->m_primitiveMode, skysphere->indexCount, skysphere->indexType, (void *)0);
+
+            Texture::unbind1DTexture();
+            // unbind
+            glBindVertexArray(0);
         }
 
-        if (updateNormals && 0 != object.normalBuffer)
+        // render skybox (cloud layer) on top of skysphere...
+        // reference: https://learnopengl.com/Advanced-OpenGL/Cubemaps
+        // reference: http://antongerdelan.net/opengl/cubemaps.html
+        if (nullptr != skyboxClouds && skyboxClouds->m_isVisible)
         {
-            std::vector<glm::vec3> const &newNormals = object.normals;
-            unsigned int const newSize = sizeof(glm::vec3) * newNormals.size();
+            // enable cloud shader program
+            glUseProgram(skyboxCloudsProgram);
+            // bind geometry data...
+            glBindVertexArray(skyboxClouds->vao);
 
-            GLint oldSize = 0;
-            glBindBuffer(GL_ARRAY_BUFFER, object.normalBuffer);
-            glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &oldSize); // get size of data in buffer
+            // set uniforms...
+            glUniform1f(m_skyboxCloudsProgramUniforms.oneMinusCloudProportion, oneMinusCloudProportion);
+            // TODO: refactor into own function
+            //  bind texture...
+            glActiveTexture(GL_TEXTURE0 + skyboxClouds->textureID);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxClouds->textureID);
+            glUniform1i(m_skyboxCloudsProgramUniforms.skyboxClouds, skyboxClouds->textureID);
+            glUniformMatrix4fv(m_skyboxCloudsProgramUniforms.VPNoTranslation, 1, GL_FALSE, glm::value_ptr(CUBEMAP_VP_NO_TRANSLATION_MATS.at(face)));
 
-            // only update buffer data if new data is same size, otherwise buffer will be unchanged
-            if (newSize == oldSize)
-            {
-                glBufferSubData(GL_ARRAY_BUFFER, 0, newSize, newNormals.data());
-            }
+            // POINT, LINE or FILL...
+            glPolygonMode(GL_FRONT_AND_BACK, skyboxClouds->m_polygonMode);
+            glDrawElements(skyboxClouds->m_primitiveMode, skyboxClouds->indexCount, skyboxClouds->indexType, (void *)0);
+
+            // TODO: refactor into own function
+            //  unbind texture...
+            glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+            // unbind
+            glBindVertexArray(0);
         }
 
-        if (updateColours && 0 != object.colourBuffer)
+        // render fog layer on top of clouds...
+        if (0 != m_emptyVAO)
+        {
+            // enable screen-space-quad shader program
+            glUseProgram(screenSpaceQuadProgram);
+            // bind geometry data...
+            glBindVertexArray(m_emptyVAO);
+
+            // set uniforms...
+            glUniform1i(m_screenSpaceQuadProgramUniforms.isTextured, GL_FALSE);
+            Texture::bind2DTexture(m_screenSpaceQuadProgramUniforms.textureData, 0); // no texture
+            glUniform4fv(m_screenSpaceQuadProgramUniforms.solidColour, 1, glm::value_ptr(fogColourFarAtCurrentTime));
+
+            // POINT, LINE or FILL...
+            glPolygonMode(GL_FRONT_AND_BACK, PolygonMode::FILL);
+            glDrawArrays(PrimitiveMode::TRIANGLE_STRIP, 0, 4);
+
+            Texture::unbind2DTexture();
+            // unbind
+            glBindVertexArray(0);
+        }
+    }
+
+    void RenderEngine::assignBuffers(MeshObject &object)
+    {
+        if (nullptr != object.cachedStreams)
+        {
+            assignCachedBuffers(object);
+            return;
+        }
+
+        std::vector<glm::vec3> const &vertices = object.drawVerts;
+        std::vector<glm::vec3> const &normals = object.normals;
+        std::vector<glm::vec2> const &uvs = object.uvs;
+        std::vector<glm::vec3> const &colours = object.colours;
+        std::vector<GLuint> const &faces = object.drawFaces;
+
+        glGenVertexArrays(1, &object.vao);
+        glBindVertexArray(object.vao);
+
+        if (VertexFormat::PACKED_INTERLEAVED == object.vertexFormat && vertices.size() > 0)
+        {
+            // every stream interleaved into the vertex buffer
+            // NOTE: a stream that doesn't have one entry per vertex is left out (same as an empty stream)
+            createPackedVertexBuffer(object, vertices.size(), vertices.data(),
+                                     normals.size() == vertices.size() ? normals.data() : nullptr,
+                                     uvs.size() == vertices.size() ? uvs.data() : nullptr,
+                                     colours.size() == vertices.size() ? colours.data() : nullptr);
+        }
+        else
         {
-            std::vector<glm::vec3> const &newColours = object.colours;
-            unsigned int const newSize = sizeof(glm::vec3) * newColours.size();
+            // Vertex buffer
+            // location 0 in vao
+            if (vertices.size() > 0)
+                createVertexBuffer(object.vertexBuffer, object.vertexBufferSize, VertexLayout::floats(VertexLayout::POSITION, 3), sizeof(glm::vec3) * vertices.size(), vertices.data());
+
+            // Normal buffer
+            // location 1 in vao
+            if (normals.size() > 0)
+                createVertexBuffer(object.normalBuffer, object.normalBufferSize, VertexLayout::floats(VertexLayout::NORMAL, 3), sizeof(glm::vec3) * normals.size(), normals.data());
+
+            // UV buffer
+            // location 2 in vao
+            if (uvs.size() > 0)
+                createVertexBuffer(object.uvBuffer, object.uvBufferSize, VertexLayout::floats(VertexLayout::UV, 2), sizeof(glm::vec2) * uvs.size(), uvs.data());
+
+            // Colour buffer
+            // location 3 in vao
+            if (colours.size() > 0)
+                createVertexBuffer(object.colourBuffer, object.colourBufferSize, VertexLayout::floats(VertexLayout::COLOUR, 3), sizeof(glm::vec3) * colours.size(), colours.data());
+        }
 
-            GLint oldSize = 0;
-            glBindBuffer(GL_ARRAY_BUFFER, object.colourBuffer);
-            glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &oldSize); // get size of data in buffer
+        // Face buffer
+        // NOTE: assuming every object with faces is using an index buffer (thus glDrawElements is always used)
+        //  this is fully compatible since if an object has only verts and wanted to use glDrawArrays, then it could just initialize a trivial index buffer (0,1,2,...,verts.size()-1)
+        if (faces.size() > 0)
+            uploadIndexBuffer(object, faces.data(), faces.size());
+        object.indexCount = faces.size();
+
+        // unbind vao
+        glBindVertexArray(0);
+
+        // bounds for culling
+        object.computeBounds();
+    }
+
+    // same layout as assignBuffers, but every buffer is filled straight from the mapped .wtmesh file (no intermediate copies)
+    // NOTE: the bounds were already set from the cache's header by the loader
+    void RenderEngine::assignCachedBuffers(MeshObject &object)
+    {
+        MeshCache::Mapping const &cache = *object.cachedStreams;
+
+        glGenVertexArrays(1, &object.vao);
+        glBindVertexArray(object.vao);
 
-            // only update buffer data if new data is same size, otherwise buffer will be unchanged
-            if (newSize == oldSize)
+        if (VertexFormat::PACKED_INTERLEAVED == object.vertexFormat)
+        {
+            // the cache stores the vertices already interleaved (MeshCache::open checked that they match this layout)
+            object.vertexLayout = VertexLayout::packed(cache.hasStream(MeshCache::NORMALS), cache.hasStream(MeshCache::UVS), cache.hasStream(MeshCache::COLOURS));
+            createVertexBuffer(object.vertexBuffer, object.vertexBufferSize, object.vertexLayout, cache.getStreamSize(MeshCache::PACKED_VERTICES), cache.getStreamData(MeshCache::PACKED_VERTICES));
+        }
+        else
+        {
+            createVertexBuffer(object.vertexBuffer, object.vertexBufferSize, VertexLayout::floats(VertexLayout::POSITION, 3), cache.getStreamSize(MeshCache::POSITIONS), cache.getStreamData(MeshCache::POSITIONS));
+            if (cache.hasStream(MeshCache::NORMALS))
+                createVertexBuffer(object.normalBuffer, object.normalBufferSize, VertexLayout::floats(VertexLayout::NORMAL, 3), cache.getStreamSize(MeshCache::NORMALS), cache.getStreamData(MeshCache::NORMALS));
+            if (cache.hasStream(MeshCache::UVS))
+                createVertexBuffer(object.uvBuffer, object.uvBufferSize, VertexLayout::floats(VertexLayout::UV, 2), cache.getStreamSize(MeshCache::UVS), cache.getStreamData(MeshCache::UVS));
+            if (cache.hasStream(MeshCache::COLOURS))
+                createVertexBuffer(object.colourBuffer, object.colourBufferSize, VertexLayout::floats(VertexLayout::COLOUR, 3), cache.getStreamSize(MeshCache::COLOURS), cache.getStreamData(MeshCache::COLOURS));
+        }
+
+        uploadIndexBuffer(object, (GLuint const *)cache.getStreamData(MeshCache::INDICES), cache.getIndexCount());
+        object.indexCount = cache.getIndexCount();
+
+        glBindVertexArray(0);
+
+        // the data now lives in VRAM, so the file can be unmapped
+        object.cachedStreams = nullptr;
+    }
+
+    // creates an array buffer holding size bytes of vertices and points the attributes of the currently bound vao at it as described by layout
+    void RenderEngine::createVertexBuffer(GLuint &out_buffer, GLsizeiptr &out_bufferSize, VertexLayout const &layout, GLsizeiptr const size, void const *data)
+    {
+        out_bufferSize = size;
+        glGenBuffers(1, &out_buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, out_buffer);
+        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        layout.apply();
+    }
+
+    // interleaves the given streams (nullptr for absent ones) into object.vertexBuffer and remembers the layout for updateBuffers
+    void RenderEngine::createPackedVertexBuffer(MeshObject &object, std::size_t const vertexCount, glm::vec3 const *positions, glm::vec3 const *normals, glm::vec2 const *uvs, glm::vec3 const *colours)
+    {
+        object.vertexLayout = VertexLayout::packed(nullptr != normals, nullptr != uvs, nullptr != colours);
+        std::vector<std::uint8_t> vertices;
+        object.vertexLayout.pack(vertexCount, positions, normals, uvs, colours, vertices);
+        createVertexBuffer(object.vertexBuffer, object.vertexBufferSize, object.vertexLayout, vertices.size(), vertices.data());
+    }
+
+    // (re)creates the index buffer of the currently bound vao, with 16-bit indices whenever every index fits (halves the index fetch bandwidth)
+    void RenderEngine::uploadIndexBuffer(MeshObject &object, GLuint const *indices, std::size_t const count)
+    {
+        if (0 == object.indexBuffer)
+            glGenBuffers(1, &object.indexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object.indexBuffer);
+
+        bool const isShortEnough{std::all_of(indices, indices + count, [](GLuint const index) { return index <= std::numeric_limits<GLushort>::max(); })};
+        if (isShortEnough)
+        {
+            std::vector<GLushort> const shortIndices(indices, indices + count);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * count, shortIndices.data(), GL_STATIC_DRAW);
+            object.indexType = GL_UNSIGNED_SHORT;
+        }
+        else
+        {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * count, indices, GL_STATIC_DRAW);
+            object.indexType = GL_UNSIGNED_INT;
+        }
+    }
+
+    // NOTE: this method assumes that the buffers have already been created and bound to the vao (by assignBuffers)
+    // NOTE: the data goes through the streaming buffer and is copied on the GPU, so it never waits on frames still reading the old data
+    void RenderEngine::updateBuffers(MeshObject &object, bool const updateVerts, bool const updateUVs, bool const updateNormals, bool const updateColours)
+    {
+        // nothing bound
+        if (0 == object.vao)
+            return;
+
+        // the interleaved buffer can only be rewritten as a whole
+        if (VertexFormat::PACKED_INTERLEAVED == object.vertexFormat)
+        {
+            if ((updateVerts || updateUVs || updateNormals || updateColours) && 0 != object.vertexBuffer)
             {
-                glBufferSubData(GL_ARRAY_BUFFER, 0, newSize, newColours.data());
+                std::vector<std::uint8_t> vertices;
+                object.vertexLayout.pack(object.drawVerts.size(), object.drawVerts.data(),
+                                         object.vertexLayout.hasAttribute(VertexLayout::NORMAL) ? object.normals.data() : nullptr,
+                                         object.vertexLayout.hasAttribute(VertexLayout::UV) ? object.uvs.data() : nullptr,
+                                         object.vertexLayout.hasAttribute(VertexLayout::COLOUR) ? object.colours.data() : nullptr,
+                                         vertices);
+                updateVertexBuffer(object.vertexBuffer, object.vertexBufferSize, vertices.size(), vertices.data());
             }
+            if (updateVerts)
+                object.computeBounds();
+            return;
+        }
+
+        if (updateVerts && 0 != object.vertexBuffer)
+        {
+            updateVertexBuffer(object.vertexBuffer, object.vertexBufferSize, sizeof(glm::vec3) * object.drawVerts.size(), object.drawVerts.data());
+            object.computeBounds();
         }
+
+        if (updateUVs && 0 != object.uvBuffer)
+            updateVertexBuffer(object.uvBuffer, object.uvBufferSize, sizeof(glm::vec2) * object.uvs.size(), object.uvs.data());
+
+        if (updateNormals && 0 != object.normalBuffer)
+            updateVertexBuffer(object.normalBuffer, object.normalBufferSize, sizeof(glm::vec3) * object.normals.size(), object.normals.data());
+
+        if (updateColours && 0 != object.colourBuffer)
+            updateVertexBuffer(object.colourBuffer, object.colourBufferSize, sizeof(glm::vec3) * object.colours.size(), object.colours.data());
     }
 
-    // Creates a 1D texture
-    GLuint RenderEngine::load1DTexture(std::string const &filePath)
+    // a buffer whose size changed is reallocated (the vao keeps pointing at the same buffer name)
+    void RenderEngine::updateVertexBuffer(GLuint const buffer, GLsizeiptr &bufferSize, GLsizeiptr const size, void const *data)
     {
-        int width, height, nrChannels;
-        stbi_set_flip_vertically_on_load(true);
-        unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha); // force RGBA conversion, but original number of 8-bit channels will remain in nrChannels
-        if (nullptr == data)
+        StreamingBuffer::Allocation const allocation{m_streamingBuffer->upload(data, size, sizeof(float))};
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        if (size != bufferSize)
         {
-            std::cout << "ERROR: failed to read texture at path: " << filePath << std::endl;
-            return 0; // error code (no OpenGL object can have id 0)
+            glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+            bufferSize = size;
         }
+        if (allocation.isValid())
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, m_streamingBuffer->getBuffer());
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation.offset, 0, size);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        else if (size > 0)
+        {
+            // the streaming buffer only grows at the next frame, until then the driver has to take care of it
+            glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, data);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
 
-        GLuint const textureID = Texture::create1DTexture(data, width * height);
-        stbi_image_free(data);
-        if (0 == textureID)
-            std::cout << "ERROR: failed to create texture at path: " << filePath << std::endl;
-
+    // Creates a 1D texture
+    GLuint RenderEngine::load1DTexture(std::string const &filePath)
+    {
+        GLuint textureID{0};
+        m_threadPool->wait(load1DTextureAsync(filePath, textureID));
         return textureID;
     }
 
@@ -1159,81 +1411,236 @@ namespace wave_tool
     // reference: https://learnopengl.com/Getting-started/Textures
     GLuint RenderEngine::load2DTexture(std::string const &filePath)
     {
-        int width, height, nrChannels;
-        stbi_set_flip_vertically_on_load(true);
-        unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha); // force RGBA conversion, but original number of 8-bit channels will remain in nrChannels
-        if (nullptr == data)
-        {
-            std::cout << "ERROR: failed to read texture at path: " << filePath << std::endl;
-            return 0; // error code (no OpenGL object can have id 0)
-        }
+        GLuint textureID{0};
+        m_threadPool->wait(load2DTextureAsync(filePath, textureID));
+        return textureID;
+    }
 
-        GLuint const textureID = Texture::create2DTexture(data, width, height);
-        stbi_image_free(data);
-        if (0 == textureID)
-            std::cout << "ERROR: failed to create texture at path: " << filePath << std::endl;
+    GLuint RenderEngine::loadHeightmapTexture(std::string const &filePath)
+    {
+        GLuint textureID{0};
+        m_threadPool->wait(loadHeightmapTextureAsync(filePath, textureID));
+        return textureID;
+    }
 
+    GLuint RenderEngine::loadCubemap(std::vector<std::string> const &faces)
+    {
+        GLuint textureID{0};
+        m_threadPool->wait(loadCubemapAsync(faces, textureID));
         return textureID;
     }
 
+    ThreadPool::TaskHandle RenderEngine::load1DTextureAsync(std::string const &filePath, GLuint &out_textureID)
+    {
+        out_textureID = 0;
+        std::shared_ptr<DecodedImage> const image{std::make_shared<DecodedImage>()};
+        ThreadPool::TaskHandle const decode{m_threadPool->submit([filePath, image]() {
+            *image = decodeImage(filePath, true, STBI_rgb_alpha); // force RGBA conversion
+        })};
+
+        return m_threadPool->thenOnContextThread({decode}, [filePath, image, &out_textureID]() {
+            if (nullptr == image->pixels)
+            {
+                std::cout << "ERROR: failed to read texture at path: " << filePath << std::endl;
+                return; // error code (no OpenGL object can have id 0)
+            }
+
+            out_textureID = Texture::create1DTexture(image->pixels.get(), image->width * image->height);
+            if (0 == out_textureID)
+                std::cout << "ERROR: failed to create texture at path: " << filePath << std::endl;
+        });
+    }
+
+    ThreadPool::TaskHandle RenderEngine::load2DTextureAsync(std::string const &filePath, GLuint &out_textureID)
+    {
+        out_textureID = 0;
+        std::shared_ptr<DecodedImage> const image{std::make_shared<DecodedImage>()};
+        ThreadPool::TaskHandle const decode{m_threadPool->submit([filePath, image]() {
+            *image = decodeImageOrContainer(filePath, true);
+        })};
+
+        return m_threadPool->thenOnContextThread({decode}, [filePath, image, &out_textureID]() {
+            ensureUploadable(*image, filePath, true);
+            if (nullptr != image->compressed)
+            {
+                out_textureID = Texture::create2DTexture(*image->compressed);
+            }
+            else if (nullptr == image->pixels)
+            {
+                std::cout << "ERROR: failed to read texture at path: " << filePath << std::endl;
+                return; // error code (no OpenGL object can have id 0)
+            }
+            else
+            {
+                out_textureID = Texture::create2DTexture(image->pixels.get(), image->width, image->height);
+            }
+            if (0 == out_textureID)
+                std::cout << "ERROR: failed to create texture at path: " << filePath << std::endl;
+        });
+    }
+
+    ThreadPool::TaskHandle RenderEngine::loadHeightmapTextureAsync(std::string const &filePath, GLuint &out_textureID)
+    {
+        out_textureID = 0;
+        std::shared_ptr<HeightmapTexels> const heightmap{std::make_shared<HeightmapTexels>()};
+        ThreadPool::TaskHandle const decode{m_threadPool->submit([filePath, heightmap]() {
+            DecodedImage const image{decodeImage(filePath, true, STBI_grey)};
+            if (nullptr == image.pixels)
+                return;
+
+            // central differences in texture-space units (per unit s/t, not per texel)
+            // NOTE: the texture is sampled with mirrored-repeat wrapping, where the neighbour past an edge is the edge texel itself (same as clamping)
+            int const width{image.width};
+            int const height{image.height};
+            unsigned char const *const data{image.pixels.get()};
+            auto const intensityAt = [data, width, height](int col, int row) {
+                col = glm::clamp(col, 0, width - 1);
+                row = glm::clamp(row, 0, height - 1);
+                return data[(std::size_t)row * width + col] / 255.0f;
+            };
+            heightmap->width = width;
+            heightmap->height = height;
+            heightmap->texels.resize(4 * (std::size_t)width * height);
+            for (int row = 0; row < height; ++row)
+            {
+                for (int col = 0; col < width; ++col)
+                {
+                    float *texel{&heightmap->texels[4 * ((std::size_t)row * width + col)]};
+                    texel[0] = intensityAt(col, row);
+                    texel[1] = 0.5f * width * (intensityAt(col + 1, row) - intensityAt(col - 1, row));
+                    texel[2] = 0.5f * height * (intensityAt(col, row + 1) - intensityAt(col, row - 1));
+                    texel[3] = 1.0f;
+                }
+            }
+        })};
+
+        return m_threadPool->thenOnContextThread({decode}, [filePath, heightmap, &out_textureID]() {
+            if (heightmap->texels.empty())
+            {
+                std::cout << "ERROR: failed to read heightmap at path: " << filePath << std::endl;
+                return; // error code (no OpenGL object can have id 0)
+            }
+
+            GLuint textureID;
+            glGenTextures(1, &textureID);
+            glBindTexture(GL_TEXTURE_2D, textureID);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, heightmap->width, heightmap->height, 0, GL_RGBA, GL_FLOAT, heightmap->texels.data());
+            glBindTexture(GL_TEXTURE_2D, 0);
+            out_textureID = textureID;
+        });
+    }
+
     // reference: https://learnopengl.com/Advanced-OpenGL/Cubemaps
     // reference: https://www.html5gamedevs.com/topic/40806-where-can-you-find-skybox-textures/
     // modified a bit to not leak texture memory if an error happens
     // assumes 6 faces are given in order (px,nx,py,ny,pz,nz)
-    GLuint RenderEngine::loadCubemap(std::vector<std::string> const &faces)
+    // NOTE: the 6 faces are decoded in parallel (or not at all, if every face has a compressed .ktx2 next to it)
+    ThreadPool::TaskHandle RenderEngine::loadCubemapAsync(std::vector<std::string> const &faces, GLuint &out_textureID)
     {
+        out_textureID = 0;
         if (6 != faces.size())
-            return 0; // error code (no OpenGL object can have id 0)
+            return nullptr; // error code (no OpenGL object can have id 0)
 
-        int width, height, nrChannels;
-        stbi_set_flip_vertically_on_load(false); // cubemap textures shouldn't be flipped
-        unsigned char *dataArr[6] = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+        std::shared_ptr<std::array<DecodedImage, 6>> const images{std::make_shared<std::array<DecodedImage, 6>>()};
+        std::vector<ThreadPool::TaskHandle> decodes;
         for (unsigned int i = 0; i < 6; ++i)
         {
-            unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, STBI_rgb_alpha); // force RGBA conversion, but original number of 8-bit channels will remain in nrChannels
-            if (nullptr == data)
+            decodes.push_back(m_threadPool->submit([filePath = faces.at(i), images, i]() {
+                images->at(i) = decodeImageOrContainer(filePath, false); // cubemap textures shouldn't be flipped
+            }));
+        }
+
+        return m_threadPool->thenOnContextThread(decodes, [faces, images, &out_textureID]() {
+            // the faces are only uploaded compressed if all 6 of them can be (with the same format, size and mip count)
+            bool isCompressed{true};
+            for (unsigned int i = 0; i < 6; ++i)
+            {
+                ensureUploadable(images->at(i), faces.at(i), false);
+                std::shared_ptr<KTX2::Mapping const> const &face{images->at(i).compressed};
+                std::shared_ptr<KTX2::Mapping const> const &firstFace{images->at(0).compressed};
+                isCompressed = isCompressed && nullptr != face && face->getFormat() == firstFace->getFormat() && face->getWidth() == firstFace->getWidth() && face->getHeight() == firstFace->getHeight() && face->getLevelCount() == firstFace->getLevelCount();
+            }
+            if (!isCompressed)
             {
-                std::cout << "ERROR: failed to read cubemap texture at path: " << faces[i] << std::endl;
-                // cleanup previous read data...
-                for (unsigned int j = 0; j < i; ++j)
+                for (unsigned int i = 0; i < 6; ++i)
                 {
-                    stbi_image_free(dataArr[j]);
-                    dataArr[j] = nullptr;
+                    if (nullptr != images->at(i).compressed)
+                        images->at(i) = decodeImage(faces.at(i), false, STBI_rgb_alpha);
                 }
-                return 0; // error code (no OpenGL object can have id 0)
             }
-            // get here if this image file was read correctly
-            dataArr[i] = data;
-        }
-        // get here if all 6 image files were read correctly
-        GLuint textureID;
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-        // set options on currently bound texture object...
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        /*
-        enum order (incremented by 1)
-        GL_TEXTURE_CUBE_MAP_POSITIVE_X
-        GL_TEXTURE_CUBE_MAP_NEGATIVE_X
-        GL_TEXTURE_CUBE_MAP_POSITIVE_Y
-        GL_TEXTURE_CUBE_MAP_NEGATIVE_Y
-        GL_TEXTURE_CUBE_MAP_POSITIVE_Z
-        GL_TEXTURE_CUBE_MAP_NEGATIVE_Z
-        */
-        for (unsigned int i = 0; i < 6; i++)
-        {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, dataArr[i]); // save data in VRAM
-            // cleanup...
-            stbi_image_free(dataArr[i]);
-            dataArr[i] = nullptr;
-        }
+            bool isComplete{true};
+            for (unsigned int i = 0; i < 6; ++i)
+            {
+                if (!isCompressed && nullptr == images->at(i).pixels)
+                {
+                    std::cout << "ERROR: failed to read cubemap texture at path: " << faces.at(i) << std::endl;
+                    isComplete = false;
+                }
+            }
+            if (!isComplete)
+                return; // error code (no OpenGL object can have id 0)
+
+            // get here if all 6 image files were read correctly
+            GLuint textureID;
+            glGenTextures(1, &textureID);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+            // set options on currently bound texture object...
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            // pre-built mips are sampled (they cut the bandwidth of the minified sky), a decoded image has none
+            GLint const levelCount{isCompressed ? (GLint)images->at(0).compressed->getLevelCount() : 1};
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, 1 < levelCount ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+            /*
+            enum order (incremented by 1)
+            GL_TEXTURE_CUBE_MAP_POSITIVE_X
+            GL_TEXTURE_CUBE_MAP_NEGATIVE_X
+            GL_TEXTURE_CUBE_MAP_POSITIVE_Y
+            GL_TEXTURE_CUBE_MAP_NEGATIVE_Y
+            GL_TEXTURE_CUBE_MAP_POSITIVE_Z
+            GL_TEXTURE_CUBE_MAP_NEGATIVE_Z
+            */
+            for (unsigned int i = 0; i < 6; i++)
+            {
+                DecodedImage &image{images->at(i)};
+                if (isCompressed)
+                    Texture::uploadCompressedLevels(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, *image.compressed);
+                else
+                    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.get()); // save data in VRAM
+                // cleanup...
+                image = DecodedImage();
+            }
+            out_textureID = textureID;
+        });
+    }
 
-        return textureID;
+    void RenderEngine::updateFaceBuffer(MeshObject &object)
+    {
+        if (0 == object.vao || 0 == object.indexBuffer)
+            return;
+
+        glBindVertexArray(object.vao);
+        uploadIndexBuffer(object, object.drawFaces.data(), object.drawFaces.size());
+        object.indexCount = object.drawFaces.size();
+        glBindVertexArray(0);
+    }
+
+    // the projected grid squeezes its far rows towards the horizon and stretches its near rows, so the base grid only needs to be fine enough for the far rows
+    // (the near rows get refined by the tessellator up to MAX_TESSELLATION_LEVEL)
+    GLuint RenderEngine::computeWaterGridLength() const
+    {
+        float const targetEdgeLengthInPixels{glm::max(tessellationTargetEdgeLengthInPixels, 1.0f)};
+        float const viewportLengthInPixels{(float)glm::max(m_windowWidth, m_windowHeight)};
+        GLuint const cellCount{(GLuint)glm::ceil(viewportLengthInPixels / (targetEdgeLengthInPixels * WATER_GRID_BASE_CELL_SUBDIVISIONS))};
+        return glm::clamp(cellCount + 1, 2u, MAX_WATER_GRID_LENGTH);
     }
 
     // Sets projection and viewport for new width and height
@@ -1247,25 +1654,302 @@ namespace wave_tool
         // TODO: figure out if there are any driver bugs that require regenerating the FBO or rebinding the textures/buffers to it
         //  reference: https://stackoverflow.com/questions/44763449/updating-width-and-height-of-render-target-on-the-fly
         //  reallocate textures / buffers that must match new window dimensions...
-        glBindRenderbuffer(GL_RENDERBUFFER, m_depth24Stencil8RBO);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_windowWidth, m_windowHeight);
-        glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
         glBindTexture(GL_TEXTURE_2D, m_depthTexture2D);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, m_windowWidth, m_windowHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
         glBindTexture(GL_TEXTURE_2D, 0);
 
-        glBindTexture(GL_TEXTURE_2D, m_localReflectionsTexture2D);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_windowWidth, m_windowHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        resizeLocalReflectionsTarget();
+        resizeLocalRefractionsTarget();
 
-        glBindTexture(GL_TEXTURE_2D, m_localRefractionsTexture2D);
+        glBindTexture(GL_TEXTURE_2D, m_worldSpaceDepthTexture2D);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_windowWidth, m_windowHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
         glBindTexture(GL_TEXTURE_2D, 0);
+    }
 
-        glBindTexture(GL_TEXTURE_2D, m_worldSpaceDepthTexture2D);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_windowWidth, m_windowHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glm::ivec2 RenderEngine::computeLocalTargetSize(int const downsampleLevel) const
+    {
+        int const level{glm::clamp(downsampleLevel, 0, MAX_LOCAL_TARGET_DOWNSAMPLE_LEVEL)};
+        return glm::max(glm::ivec2{m_windowWidth >> level, m_windowHeight >> level}, glm::ivec2{1, 1});
+    }
+
+    void RenderEngine::resizeLocalReflectionsTarget()
+    {
+        m_localReflectionsSize = computeLocalTargetSize(localReflectionsDownsampleLevel);
+        allocateLocalTarget(m_localReflectionsTexture2D, m_localReflectionsDepth24Stencil8RBO, m_localReflectionsSize);
+    }
+
+    void RenderEngine::resizeLocalRefractionsTarget()
+    {
+        m_localRefractionsSize = computeLocalTargetSize(localRefractionsDownsampleLevel);
+        allocateLocalTarget(m_localRefractionsTexture2D, m_localRefractionsDepth24Stencil8RBO, m_localRefractionsSize);
+    }
+
+    void RenderEngine::allocateLocalTarget(GLuint const colourTexture2D, GLuint const depth24Stencil8RBO, glm::ivec2 const &size)
+    {
+        glBindTexture(GL_TEXTURE_2D, colourTexture2D);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
         glBindTexture(GL_TEXTURE_2D, 0);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, depth24Stencil8RBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.x, size.y);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    }
+
+    void RenderEngine::setOutputFramebuffer(GLuint fbo)
+    {
+        m_outputFBO = fbo;
+    }
+
+    bool RenderEngine::computeProjectedGridCorners(float const displaceableAmplitude, glm::mat4 const &projection, glm::mat4 const &inverseViewProjection, std::array<glm::vec4, 4> &out_cornerPoints)
+    {
+        static geometry::Plane upperPlane{0.0f, 1.0f, 0.0f, 0.0f};
+        static geometry::Plane basePlane{0.0f, 1.0f, 0.0f, 0.0f};
+        static geometry::Plane lowerPlane{0.0f, 1.0f, 0.0f, 0.0f};
+        static float cachedAmplitude = -1.0f;
+
+        if (cachedAmplitude != displaceableAmplitude)
+        {
+            cachedAmplitude = displaceableAmplitude;
+            upperPlane = {0.0f, 1.0f, 0.0f, displaceableAmplitude};
+            lowerPlane = {0.0f, 1.0f, 0.0f, -displaceableAmplitude};
+        }
+
+        auto frustumCornerPoints = transformFrustumCorners(inverseViewProjection, 1.2f);
+
+        // stores indices into frustumCornerPoints
+        // 12 edges between pairs of points
+        std::array<unsigned int, 24> const FRUSTUM_EDGES{0, 1,  // [0]  - lbn ---> lbf (across-edge)
+                                                         0, 2,  // [1]  - lbn ---> ltn (near-edge)
+                                                         0, 4,  // [2]  - lbn ---> rbn (near-edge)
+                                                         1, 3,  // [3]  - lbf ---> ltf (far-edge)
+                                                         1, 5,  // [4]  - lbf ---> rbf (far-edge)
+                                                         2, 3,  // [5]  - ltn ---> ltf (across-edge)
+                                                         2, 6,  // [6]  - ltn ---> rtn (near-edge)
+                                                         3, 7,  // [7]  - ltf ---> rtf (far-edge)
+                                                         4, 5,  // [8]  - rbn ---> rbf (across-edge)
+                                                         4, 6,  // [9]  - rbn ---> rtn (near-edge)
+                                                         5, 7,  // [10] - rbf ---> rtf (far-edge)
+                                                         6, 7}; // [11] - rtn ---> rtf (across-edge)
+
+        // stores intersection points of camera frustum with the displaceable volume (between upper and lower bounding planes)
+        std::vector<glm::vec4> intersectionPoints;
+
+        // intersection testing with upper/lower bound planes...
+        // for each frustum edge...
+        for (unsigned int i = 0; i < 12; ++i)
+        {
+            unsigned int const src{FRUSTUM_EDGES.at(i * 2)};
+            unsigned int const dest{FRUSTUM_EDGES.at(i * 2 + 1)};
+
+            geometry::Line const line{frustumCornerPoints.at(src), frustumCornerPoints.at(dest)};
+
+            if (glm::max(line.p0.y, line.p1.y) < -displaceableAmplitude || glm::min(line.p0.y, line.p1.y) > displaceableAmplitude)
+                continue; // Edge is completely outside the displaceable volume
+
+            // upper-bound plane
+            // first, we do a quick intersection check (plane in this case can be described by all points with y = d, since the normal is <0,1,0>)
+            if (glm::min(line.p0.y, line.p1.y) <= upperPlane.d && upperPlane.d <= glm::max(line.p0.y, line.p1.y))
+            {
+                glm::vec3 intersectionPoint;
+                bool const isIntersection{utils::linePlaneIntersection(intersectionPoint, line, upperPlane)};
+                // NOTE: we can't currently assert this is true, since there is the rare chance that the line lies in the plane (which is currently treated as no intersection for simplicity)
+                if (isIntersection)
+                    intersectionPoints.push_back(glm::vec4{intersectionPoint, 1.0f});
+            }
+
+            // lower-bound plane
+            // first, we do a quick intersection check (plane in this case can be described by all points with y = d, since the normal is <0,1,0>)
+            if (glm::min(line.p0.y, line.p1.y) <= lowerPlane.d && lowerPlane.d <= glm::max(line.p0.y, line.p1.y))
+            {
+                glm::vec3 intersectionPoint;
+                bool const isIntersection{utils::linePlaneIntersection(intersectionPoint, line, lowerPlane)};
+                // NOTE: we can't currently assert this is true, since there is the rare chance that the line lies in the plane (which is currently treated as no intersection for simplicity)
+                if (isIntersection)
+                    intersectionPoints.push_back(glm::vec4{intersectionPoint, 1.0f});
+            }
+        }
+
+        // include any frustum vertices that lie within (intersect) the displaceable volume (between upper and lower bounding planes)
+        // for each frustum vertex...
+        auto isWithinVolume = [&](const glm::vec4 &point)
+        {
+            return point.y >= -displaceableAmplitude && point.y <= displaceableAmplitude;
+        };
+        for (const auto &corner : frustumCornerPoints)
+        {
+            if (isWithinVolume(corner))
+            {
+                intersectionPoints.push_back(corner);
+            }
+        }
+
+        // only continue to render the water grid, if there were intersection points
+        if (intersectionPoints.empty())
+            return false;
+
+        Camera projector{*m_camera};
+
+        float const cameraDistanceFromBasePlane{m_camera->getPosition().y};
+        bool const isUnderwater{cameraDistanceFromBasePlane < 0.0f};
+        // TODO: make this a UI property
+        float const PROJECTOR_ELEVATION_FROM_CAMERA{1.0f};
+        float const MINIMUM_PROJECTOR_DISTANCE_FROM_BASE_PLANE{displaceableAmplitude + PROJECTOR_ELEVATION_FROM_CAMERA};
+
+        // translate the y-position of the projector, so that it lies outside the displaceable volume (with some extra elevation padding)
+        if (cameraDistanceFromBasePlane < MINIMUM_PROJECTOR_DISTANCE_FROM_BASE_PLANE)
+        {
+            if (isUnderwater)
+                projector.translate(glm::vec3{0.0f, MINIMUM_PROJECTOR_DISTANCE_FROM_BASE_PLANE - 2.0f * cameraDistanceFromBasePlane, 0.0f});
+            else
+                projector.translate(glm::vec3{0.0f, MINIMUM_PROJECTOR_DISTANCE_FROM_BASE_PLANE - cameraDistanceFromBasePlane, 0.0f});
+        }
+
+        // safely handle when the camera is looking too close to the horizon (shift the forward vector a bit to ensure the intersection test succeeds for aimpoint_1)
+        glm::vec3 cameraForwardIntersectionSafe{m_camera->getForward()};
+        float const SAFE_EPSILON{0.001f};
+        if (glm::abs(cameraForwardIntersectionSafe.y) < SAFE_EPSILON)
+        {
+            float const sign{cameraForwardIntersectionSafe.y >= 0.0f ? 1.0f : -1.0f};
+            cameraForwardIntersectionSafe.y = sign * SAFE_EPSILON;
+            // NOTE: there is no need to normalize this (and I don't want to cause the ypos will decrease)
+        }
+
+        // compute aimpoint for method 1 (bird's eye)...
+        glm::vec3 aimpoint_1;
+        bool const isLookingDown{cameraForwardIntersectionSafe.y < 0.0f};
+        bool const isLookingDown_XOR_isUnderwater{isLookingDown != isUnderwater};
+        if (isLookingDown_XOR_isUnderwater)
+        {
+            bool const isIntersection{utils::linePlaneIntersection(aimpoint_1, geometry::Line{m_camera->getPosition(), m_camera->getPosition() + cameraForwardIntersectionSafe}, basePlane)};
+            assert(isIntersection);
+        }
+        else
+        {
+            glm::vec3 const cameraForwardIntersectionSafeMirrored{glm::reflect(cameraForwardIntersectionSafe, basePlane.getNormalVec())};
+            bool const isIntersection{utils::linePlaneIntersection(aimpoint_1, geometry::Line{m_camera->getPosition(), m_camera->getPosition() + cameraForwardIntersectionSafeMirrored}, basePlane)};
+            assert(isIntersection);
+        }
+
+        // compute aimpoint for method 2 (horizon)...
+        // TODO: make this a UI property? auto-generate it?
+        float const FORWARD_FIXED_LENGTH{1.0f};
+        glm::vec3 aimpoint_2{m_camera->getPosition() + FORWARD_FIXED_LENGTH * m_camera->getForward()};
+        // project this point onto the base plane
+        aimpoint_2.y = 0.0f;
+
+        // NOTE: the grid changes abruptly when aimpoint_final == aimpoint2 (a == 0), but this will never occur since...
+        //       I made the camera's forward vector (for the math only) intersection safe (aimpoint_1 will be defined and a != 0.0)
+        //  compute the interpolation coefficient in range [SAFE_EPSILON, 1.0]...
+        float const a{glm::abs(cameraForwardIntersectionSafe.y)};
+
+        // compute the final aimpoint as an interpolation between the two aimpoints...
+        glm::vec3 const aimpoint_final{glm::mix(aimpoint_2, aimpoint_1, a)};
+
+        // compute the projector's pitch in order to aim at this aimpoint...
+        glm::vec3 const projectorNewForwardVec{glm::normalize(aimpoint_final - projector.getPosition())};
+        glm::vec3 const projectorNewForwardVecXZProjection{glm::normalize(glm::vec3{projectorNewForwardVec.x, 0.0f, projectorNewForwardVec.z})};
+        // NOTE: the projector's position will always be above water, thus the pitch will always be negative
+        float projectorNewPitchDegrees{-glm::degrees(glm::acos(glm::dot(projectorNewForwardVec, projectorNewForwardVecXZProjection)))};
+
+        // now, aim the projector...
+        projector.setRotation(projector.getYaw(), projectorNewPitchDegrees);
+        ///////////////////////////////////////////////////////////////////////////////////
+
+        // project all intersection points onto base plane...
+        for (auto &point : intersectionPoints)
+        {
+            point.y = 0.0f;
+        }
+
+        // transform all intersection points into NDC-space (for projector)
+        // reference: https://community.khronos.org/t/homogenous-normalized-device-coords-and-clipping/61965
+        // reference: https://stackoverflow.com/questions/21841598/when-does-the-transition-from-clip-space-to-screen-coordinates-happen
+        // NOTE: I was having a lot of issues before I divided by w, so hopefully everything works now
+        glm::mat4 const projector_viewProjectionMat{projector.getProjectionMat() * projector.getViewMat()};
+        for (unsigned int i = 0; i < intersectionPoints.size(); ++i)
+        {
+            glm::vec4 const temp{projector_viewProjectionMat * intersectionPoints.at(i)}; // now in clip-space
+            intersectionPoints.at(i) = temp / temp.w;                                     // now in NDC-space
+        }
+
+        // determine the xy-NDC bounds of the intersection points
+        // clang-format off
+        float x_min = std::min_element(intersectionPoints.begin(), intersectionPoints.end(),
+            [](const glm::vec4& a, const glm::vec4& b) { return a.x < b.x; })->x;
+
+        float x_max = std::max_element(intersectionPoints.begin(), intersectionPoints.end(),
+            [](const glm::vec4& a, const glm::vec4& b) { return a.x < b.x; })->x;
+
+        float y_min = std::min_element(intersectionPoints.begin(), intersectionPoints.end(),
+            [](const glm::vec4& a, const glm::vec4& b) { return a.y < b.y; })->y;
+
+        float y_max = std::max_element(intersectionPoints.begin(), intersectionPoints.end(),
+            [](const glm::vec4& a, const glm::vec4& b) { return a.y < b.y; })->y;
+        // clang-format on
+
+        glm::mat4 const rangeMat{x_max - x_min, 0.0f, 0.0f, 0.0f,
+                                 0.0f, y_max - y_min, 0.0f, 0.0f,
+                                 0.0f, 0.0f, 1.0f, 0.0f,
+                                 x_min, y_min, 0.0f, 1.0f};
+
+        // compute M_projector...
+        glm::mat4 const projectorMat{glm::inverse(projection * projector.getViewMat()) * rangeMat};
+
+        // compute the world-space coordinates of the four grid corners...
+        // init the corner positions in a special uv-space ("range-space") - (with z = -1 (near) for convenience for intersection test below)
+        std::array<glm::vec4, 4> waterGridCornerPoints{glm::vec4{0.0f, 0.0f, -1.0f, 1.0f},  // [0] - bottom-left
+                                                       glm::vec4{0.0f, 1.0f, -1.0f, 1.0f},  // [1] - top-left
+                                                       glm::vec4{1.0f, 0.0f, -1.0f, 1.0f},  // [2] - bottom-right
+                                                       glm::vec4{1.0f, 1.0f, -1.0f, 1.0f}}; // [3] - top-right
+
+        // transform the coordinates to world-space...
+        // intersect projected rays with XZ-plane (base plane) to get world-space bounds of grid...
+        for (unsigned int i = 0; i < waterGridCornerPoints.size(); ++i)
+        {
+            glm::vec4 p0{waterGridCornerPoints.at(i)};
+            glm::vec4 p1{p0};
+            p1.z = 1.0f; // far
+
+            // transform both points to world-space...
+            p0 = projectorMat * p0;
+            p0 /= p0.w;
+            p1 = projectorMat * p1;
+            p1 /= p1.w;
+
+            // intersection test...
+            geometry::Line const line{p0, p1};
+            glm::vec3 intersectionPoint;
+            bool const isIntersection{utils::linePlaneIntersection(intersectionPoint, line, basePlane)};
+            assert(isIntersection);
+            waterGridCornerPoints.at(i) = glm::vec4{intersectionPoint, 1.0f};
+        }
+
+        // reorder into the patch corner order of water-grid.vert
+        out_cornerPoints = {waterGridCornerPoints.at(0), waterGridCornerPoints.at(2), waterGridCornerPoints.at(1), waterGridCornerPoints.at(3)};
+        return true;
+    }
+
+    void RenderEngine::beginWaterPrimitiveQuery()
+    {
+        // harvest the query before reusing it (issued m_waterPrimitiveQueries.size() frames ago)
+        // NOTE: if the GPU is still behind, the previous count is kept rather than waiting on it
+        GLuint const query{m_waterPrimitiveQueries.at(m_waterPrimitiveQueryIndex)};
+        if (m_isWaterPrimitiveQueryIssued.at(m_waterPrimitiveQueryIndex))
+        {
+            GLint isAvailable{GL_FALSE};
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+            if (GL_TRUE == isAvailable)
+                glGetQueryObjectuiv(query, GL_QUERY_RESULT, &m_waterPrimitiveCount);
+        }
+
+        glBeginQuery(GL_PRIMITIVES_GENERATED, query);
+        m_isWaterPrimitiveQueryIssued.at(m_waterPrimitiveQueryIndex) = true;
+    }
+
+    void RenderEngine::endWaterPrimitiveQuery()
+    {
+        glEndQuery(GL_PRIMITIVES_GENERATED);
+        m_waterPrimitiveQueryIndex = (m_waterPrimitiveQueryIndex + 1) % m_waterPrimitiveQueries.size();
     }
 
     std::array<glm::vec4, 8> RenderEngine::transformFrustumCorners(const glm::mat4 &inverseViewProjection, float safetyPadding)
@@ -40,12 +40,24 @@
 
 #include <array>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "bounding-volume-hierarchy.h"
 #include "camera.h"
+#include "gerstner-wave.h"
 #include "mesh-object.h"
+#include "ocean-clipmap.h"
+#include "ocean-fft.h"
+#include "ocean-surface.h"
+#include "profiler.h"
+#include "render-queue.h"
+#include "shader-hot-reloader.h"
 #include "shader-tools.h"
+#include "streaming-buffer.h"
 #include "texture.h"
+#include "thread-pool.h"
 
 namespace wave_tool
 {
@@ -132,53 +144,6 @@ namespace wave_tool
         }
     }
 
-    namespace geometry
-    {
-        // reference: https://developer.nvidia.com/gpugems/gpugems/part-i-natural-effects/chapter-1-effective-water-simulation-physical-models
-        // TODO: the statics are very unsafe at the moment
-        struct GerstnerWave
-        {
-        public:
-            static unsigned int const MAX_COUNT = 4;
-            static_assert(MAX_COUNT > 0);
-
-            inline static unsigned int Count() { return count; }
-            inline static float TotalAmplitude() { return totalAmplitude; }
-
-            float amplitude_A;       // height of crest above equilibrium plane
-            float frequency_w;       // w = 2/L (roughly), where L =:= wavelength (crest-to-crest distance)
-            float phaseConstant_phi; // phi = S x w, where S =:= speed (distance crest moves forward per second)
-            float steepness_Q;       // controls "sharpness" of crest
-            glm::vec2 xzDirection_D; // horizontal unit vector perpendicular to the wave front along which the crest travels
-
-            GerstnerWave(float const amplitude_A, float const frequency_w, float const phaseConstant_phi, float const steepness_Q, glm::vec2 const &xzDirection_D)
-                : amplitude_A(amplitude_A), frequency_w(frequency_w), phaseConstant_phi(phaseConstant_phi), steepness_Q(steepness_Q), xzDirection_D(xzDirection_D)
-            {
-                assert(count < MAX_COUNT);
-                assert(amplitude_A >= 0.0f);
-                assert(frequency_w >= 0.0f);
-                assert(phaseConstant_phi >= 0.0f);
-                assert(0.0f <= steepness_Q && steepness_Q <= 1.0f);
-                float const EPSILON{0.001f};
-                float const xzDirection_D_length{glm::length(xzDirection_D)};
-                assert(1.0f - EPSILON <= xzDirection_D_length && xzDirection_D_length <= 1.0f + EPSILON);
-
-                ++count;
-                totalAmplitude += amplitude_A;
-            }
-
-            ~GerstnerWave()
-            {
-                --count;
-                totalAmplitude -= amplitude_A;
-            }
-
-        private:
-            inline static unsigned int count = 0;
-            inline static float totalAmplitude = 0.0f;
-        };
-    }
-
     enum RenderMode
     {
         DEFAULT = 0,
@@ -186,6 +151,13 @@ namespace wave_tool
         LOCAL_REFRACTIONS = 2
     };
 
+    // how the water surface is laid out before tessellation
+    enum WaterGeometryMode
+    {
+        PROJECTED_GRID = 0, // a single grid spanning the part of the base plane the camera sees (see RenderEngine::render)
+        CLIPMAP = 1         // camera-centred tiles of a fixed grid, coarser with distance (see OceanClipmap)
+    };
+
     class RenderEngine
     {
     public:
@@ -221,9 +193,23 @@ namespace wave_tool
                                                                                     CUBEMAP_PROJECTION_MAT *CUBEMAP_VIEW_NO_TRANSLATION_MATS.at(3),
                                                                                     CUBEMAP_PROJECTION_MAT *CUBEMAP_VIEW_NO_TRANSLATION_MATS.at(4),
                                                                                     CUBEMAP_PROJECTION_MAT *CUBEMAP_VIEW_NO_TRANSLATION_MATS.at(5)};
+        // the uniform buffer binding point of the per-frame globals block shared by every shader program (see FrameUniforms)
+        static GLuint const FRAME_UNIFORMS_BINDING{0};
+        // the uniform buffer binding point of the water-grid wave set (see GerstnerWaves)
+        static GLuint const GERSTNER_WAVES_BINDING{1};
         // use this "plane" when manual clipping is enabled and you want this clipping test to always succeed for all vertices
         // <A, B, C, D> where Ax + By + Cz = D
         inline static glm::vec4 const SYMBOLIC_CLIP_PLANE_SINGULARITY{0.0f, 0.0f, 0.0f, 1.0f};
+        // the largest tessellation level every GL 4.x implementation supports (GL_MAX_TESS_GEN_LEVEL >= 64)
+        inline static float const MAX_TESSELLATION_LEVEL{64.0f};
+        // on average, a base water-grid cell spans this many target-length edges on screen (tessellation refines the cells the projection stretches)
+        inline static float const WATER_GRID_BASE_CELL_SUBDIVISIONS{4.0f};
+        // the base water-grid length is kept in range [2, MAX_WATER_GRID_LENGTH] (vertices per side)
+        static GLuint const MAX_WATER_GRID_LENGTH{1025};
+        // clipmap tiles are tessellated uniformly at this (even) level, so their vertices stay on the lattice OceanClipmap morphs by
+        inline static float const CLIPMAP_TESSELLATION_LEVEL{2.0f};
+        // the local reflection/refraction targets can be rendered at full, half or quarter resolution (per axis)
+        static int const MAX_LOCAL_TARGET_DOWNSAMPLE_LEVEL{2};
         // NOTE: Z_FAR > Z_NEAR > 0.0f
         inline static float const Z_FAR{100.0f};
         inline static float const Z_NEAR{0.1f};
@@ -234,27 +220,52 @@ namespace wave_tool
         float cloudProportion = 0.15f;                                     // in range [0.0, 1.0]
         float heightmapDisplacementScale{1.0f};                            // in range [0.0, inf)
         float heightmapSampleScale{0.02f};                                 // in range [0.0, inf)
+        int skyboxCubemapFacesPerFrame{1};                                 // in range [1, 6] - cubemap faces refreshed per frame while time-of-day is animating
+        int localReflectionsDownsampleLevel{1};                            // in range [0, MAX_LOCAL_TARGET_DOWNSAMPLE_LEVEL] - local reflections are rendered at (window size >> level)
+        int localRefractionsDownsampleLevel{1};                            // in range [0, MAX_LOCAL_TARGET_DOWNSAMPLE_LEVEL] - local refractions are rendered at (window size >> level)
         bool isAnimatingTimeOfDay = false;
         bool isAnimatingWaves = true;
+        bool isUsingOceanFFT{false}; // replaces the static heightmap with the FFT ocean (see oceanFFTParameters)
         float softEdgesDeltaDepthThreshold{0.05f}; // in range [0.0, 1.0]
         float sunHorizonDarkness = 0.25f;          // in range [0.0, 1.0]
         float sunShininess = 50.0f;                // in range [0.0, inf)
         float sunStrength = 1.0f;                  // in range [0.0, 1.0]
-        float timeOfDayInHours = 9.0f;             // in range [0.0, 24.0]
+        float tessellationTargetEdgeLengthInPixels{8.0f}; // in range [1.0, inf) - desired on-screen length of a tessellated water-grid triangle edge
+        float timeOfDayInHours = 9.0f;             // in range [0.0, 24.0] - advanced by the SimulationClock
         float tintDeltaDepthThreshold{0.1f};       // in range [0.0, 1.0]
         float waterClarity{0.3f};                  // in range [0.0, 1.0]
-        float waveAnimationTimeInSeconds = 0.0f;   // in range [0.0, inf)
+        int waterGeometryMode{WaterGeometryMode::PROJECTED_GRID}; // a WaterGeometryMode (int for the UI)
+        float waveAnimationTimeInSeconds = 0.0f;   // in range [0.0, inf) - advanced by the SimulationClock
         float verticalBounceWaveAmplitude{0.1f};   // in range [0.0, inf)
-        float verticalBounceWavePhase = 0.0f;      // in range [0.0, 1.0]
+        float verticalBounceWavePhase = 0.0f;      // in range [0.0, 1.0] - advanced by the SimulationClock
 
         std::array<std::shared_ptr<geometry::GerstnerWave>, geometry::GerstnerWave::MAX_COUNT> gerstnerWaves;
+        GerstnerSpectrum::Parameters gerstnerSpectrumParameters; // used when the wave set is regenerated (see GerstnerSpectrum::generate)
+
+        OceanFFT::Parameters oceanFFTParameters;
+        OceanClipmap::Parameters oceanClipmapParameters;
 
         RenderMode renderMode{RenderMode::DEFAULT};
 
-        RenderEngine(GLFWwindow *window);
+        RenderEngine(int windowWidth, int windowHeight);
         ~RenderEngine();
 
         std::shared_ptr<Camera> getCamera() const;
+        inline std::shared_ptr<Profiler> getProfiler() const { return m_profiler; }
+        // shared worker threads for data-parallel CPU work (e.g. the FFT ocean, mesh loading)
+        inline std::shared_ptr<ThreadPool> getThreadPool() const { return m_threadPool; }
+        // number of objects that survived culling and were queued for each off-screen pass in the most recent frame
+        inline std::array<unsigned int, RenderQueue::PASS_COUNT> getVisibleObjectCounts() const { return m_visibleObjectCounts; }
+        inline std::size_t getCullableObjectCount() const { return m_objectBVH.getItemCount(); }
+        // CPU queries of the water surface, matching the waves as of the last updateOceanSurface()
+        inline std::shared_ptr<OceanSurface const> getOceanSurface() const { return m_oceanSurface; }
+        // snapshots the waves into the CPU queries (see OceanSurface::setWaves)
+        // NOTE: must be called whenever gerstnerWaves, verticalBounceWaveAmplitude or verticalBounceWavePhase change
+        inline void updateOceanSurface() { m_oceanSurface->setWaves(*this); }
+        // the clipmap tiles selected in the most recent frame (empty unless in WaterGeometryMode::CLIPMAP)
+        inline std::shared_ptr<OceanClipmap const> getOceanClipmap() const { return m_oceanClipmap; }
+        // primitives the water grid was tessellated into, from a recent frame (read back a couple of frames late, so it never stalls)
+        inline GLuint getWaterPrimitiveCount() const { return m_waterPrimitiveCount; }
         inline GLuint getDepthProgram() const { return depthProgram; }
         inline GLuint getMainProgram() const { return mainProgram; }
         inline GLuint getScreenSpaceQuadProgram() const { return screenSpaceQuadProgram; }
@@ -266,18 +277,180 @@ namespace wave_tool
         inline GLuint getWaterGridProgram() const { return waterGridProgram; }
         inline GLuint getWorldSpaceDepthProgram() const { return worldSpaceDepthProgram; }
 
+        // recompile programs in the background whenever a file in the shader directory changes (see ShaderHotReloader)
+        // NOTE: workerContext may be nullptr if ShaderTools::isParallelCompileSupported()
+        void enableShaderHotReload(GLFWwindow *workerContext);
+        // swaps in the programs that finished recompiling, returning the (old, new) program names so objects can follow along
+        // NOTE: never waits on the compiler
+        std::vector<std::pair<GLuint, GLuint>> updateShaderHotReload();
+        // empty unless the latest reload of some program failed (the last good program is still in use then)
+        std::string getShaderHotReloadErrorLog() const;
+
         void render(std::shared_ptr<const MeshObject> skyboxStars, std::shared_ptr<const MeshObject> skysphere, std::shared_ptr<const MeshObject> skyboxClouds, std::shared_ptr<const MeshObject> waterGrid, std::vector<std::shared_ptr<MeshObject>> const &objects);
         void assignBuffers(MeshObject &object);
         void updateBuffers(MeshObject &object, bool const updateVerts, bool const updateUVs, bool const updateNormals, bool const updateColours);
+        // re-uploads the index buffer (its size is allowed to change)
+        void updateFaceBuffer(MeshObject &object);
+
+        // the base water-grid length (vertices per side) suited to the current viewport and tessellation target
+        GLuint computeWaterGridLength() const;
 
         void setWindowSize(int width, int height);
+        // the framebuffer that the final image is rendered into (0 is the default window framebuffer)
+        // NOTE: must match the current window size
+        void setOutputFramebuffer(GLuint fbo);
+        inline GLuint getOutputFramebuffer() const { return m_outputFBO; }
 
         GLuint load1DTexture(std::string const &filePath);
         GLuint load2DTexture(std::string const &filePath);
+        // loads a greyscale heightmap as (intensity, d(intensity)/ds, d(intensity)/dt, 1) so the TES gets height and gradient in one lookup
+        GLuint loadHeightmapTexture(std::string const &filePath);
         GLuint loadCubemap(std::vector<std::string> const &faces);
+        // same as above, but the image is decoded on the thread pool and then uploaded on the context thread (this one) - out_textureID is set once the returned task is done (still 0 on failure)
+        // NOTE: out_textureID must outlive the task, use getThreadPool()->wait(...) to finish it
+        ThreadPool::TaskHandle load1DTextureAsync(std::string const &filePath, GLuint &out_textureID);
+        ThreadPool::TaskHandle load2DTextureAsync(std::string const &filePath, GLuint &out_textureID);
+        ThreadPool::TaskHandle loadHeightmapTextureAsync(std::string const &filePath, GLuint &out_textureID);
+        ThreadPool::TaskHandle loadCubemapAsync(std::vector<std::string> const &faces, GLuint &out_textureID);
 
     private:
+        // relative to the working directory (like every other asset path)
+        inline static std::string const SHADER_DIRECTORY{"../../assets/shaders/"};
+        // per frame, fits the uniform blocks and the default 256 * 256 ocean maps (the regions grow if a frame needs more)
+        inline static GLsizeiptr const STREAMING_BUFFER_REGION_SIZE{4 * 1024 * 1024};
+
+        // CPU-side mirror of the std140 "FrameUniforms" block declared in the shaders (uploaded once per frame)
+        // NOTE: each vec3 is packed with a trailing scalar to match std140 alignment (vec3 is 16-byte aligned)
+        struct FrameUniforms
+        {
+            glm::mat4 viewMat;
+            glm::mat4 projectionMat;
+            glm::mat4 viewProjectionMat;
+            glm::mat4 viewMatOnlyYaw;
+            glm::vec4 fogColourFarAtCurrentTime;
+            glm::vec3 cameraPosition;
+            float waveAnimationTimeInSeconds;
+            glm::vec3 sunPosition;
+            float zNear;
+            glm::vec2 viewportWidthHeight;
+            float zFar;
+            float padding0;
+        };
+        static_assert(sizeof(FrameUniforms) == 320, "FrameUniforms must match the std140 layout of the GLSL block");
+
+        // CPU-side mirror of the std140 "GerstnerWaves" block declared in water-grid.tes (uploaded once per frame, only the used prefix)
+        struct GerstnerWaves
+        {
+            struct Wave
+            {
+                float amplitude_A;
+                float frequency_w;
+                float phaseConstant_phi;
+                float steepness_Q_i;
+                glm::vec2 xzDirection_D;
+                float wavelength;
+                float phaseOffset;
+            };
+            static_assert(sizeof(Wave) == 32, "GerstnerWaves::Wave must match the std140 layout of the GLSL struct");
+
+            GLuint count;
+            GLuint padding0[3]; // the array starts at the next 16-byte boundary
+            std::array<Wave, geometry::GerstnerWave::MAX_COUNT> waves;
+        };
+        static_assert(sizeof(GerstnerWaves) == 16 + 32 * geometry::GerstnerWave::MAX_COUNT, "GerstnerWaves must match the std140 layout of the GLSL block");
+
+        // uniform locations of each shader program (resolved once after linking, see resolveUniformLocations)
+        struct DepthProgramUniforms
+        {
+            GLint mvpMat{-1};
+        };
+        struct MainProgramUniforms
+        {
+            GLint clipPlane0{-1};
+            GLint forceFlipNormals{-1};
+            GLint hasNormals{-1};
+            GLint isTextured{-1};
+            GLint modelMat{-1};
+            GLint modelViewMat{-1};
+            GLint mvpMat{-1};
+            GLint textureData{-1};
+        };
+        struct ScreenSpaceQuadProgramUniforms
+        {
+            GLint isTextured{-1};
+            GLint solidColour{-1};
+            GLint textureData{-1};
+        };
+        struct SkyboxCloudsProgramUniforms
+        {
+            GLint oneMinusCloudProportion{-1};
+            GLint skyboxClouds{-1};
+            GLint VPNoTranslation{-1};
+        };
+        struct SkyboxStarsProgramUniforms
+        {
+            GLint skyboxStars{-1};
+            GLint VPNoTranslation{-1};
+        };
+        struct SkyboxTrivialProgramUniforms
+        {
+            GLint skybox{-1};
+            GLint VPNoTranslation{-1};
+        };
+        struct SkysphereProgramUniforms
+        {
+            GLint skysphere{-1};
+            GLint sunHorizonDarkness{-1};
+            GLint sunShininess{-1};
+            GLint sunStrength{-1};
+            GLint VPNoTranslation{-1};
+        };
+        struct WaterGridProgramUniforms
+        {
+            GLint bottomLeftGridPointInWorld{-1};
+            GLint bottomRightGridPointInWorld{-1};
+            GLint clipmapMorph{-1};
+            GLint depthTexture2D{-1};
+            GLint fixedTessellationLevel{-1};
+            GLint gridLength{-1};
+            GLint heightmap{-1};
+            GLint heightmapDisplacementScale{-1};
+            GLint heightmapSampleScale{-1};
+            GLint isUsingOceanFFT{-1};
+            GLint localReflectionsTexture2D{-1};
+            GLint localRefractionsTexture2D{-1};
+            GLint oceanDisplacementMap{-1};
+            GLint oceanNormalFoldingMap{-1};
+            GLint oceanSampleScale{-1};
+            GLint skybox{-1};
+            GLint softEdgesDeltaDepthThreshold{-1};
+            GLint sunShininess{-1};
+            GLint sunStrength{-1};
+            GLint maxTessellationLevel{-1};
+            GLint tessellationTargetEdgeLengthInPixels{-1};
+            GLint tintDeltaDepthThreshold{-1};
+            GLint topLeftGridPointInWorld{-1};
+            GLint topRightGridPointInWorld{-1};
+            GLint verticalBounceWaveDisplacement{-1};
+            GLint waterClarity{-1};
+        };
+
         std::shared_ptr<Camera> m_camera = nullptr;
+        std::shared_ptr<Profiler> m_profiler = nullptr;
+        std::shared_ptr<ThreadPool> m_threadPool = nullptr;
+        std::shared_ptr<OceanFFT> m_oceanFFT = nullptr;
+        std::shared_ptr<OceanClipmap> m_oceanClipmap = nullptr;
+        std::shared_ptr<OceanSurface> m_oceanSurface = nullptr;
+        std::unique_ptr<ShaderHotReloader> m_shaderHotReloader = nullptr;
+
+        RenderQueue m_renderQueue;
+        RenderStateCache m_renderStateCache;
+        // culling of the off-screen passes (the BVH items are the visible objects of the last frame, in object-list order)
+        BoundingVolumeHierarchy m_objectBVH;
+        std::vector<MeshObject const *> m_objectBVHItems;
+        std::vector<geometry::AABB> m_objectBVHBounds;
+        std::vector<std::uint32_t> m_visibleObjectIndices;
+        std::array<unsigned int, RenderQueue::PASS_COUNT> m_visibleObjectCounts{0, 0, 0};
 
         GLuint depthProgram;
         GLuint screenSpaceQuadProgram;
@@ -290,14 +463,37 @@ namespace wave_tool
         GLuint waterGridProgram;
         GLuint worldSpaceDepthProgram;
 
-        GLuint m_depth24Stencil8RBO{0};
+        DepthProgramUniforms m_depthProgramUniforms;
+        MainProgramUniforms m_mainProgramUniforms;
+        ScreenSpaceQuadProgramUniforms m_screenSpaceQuadProgramUniforms;
+        SkyboxCloudsProgramUniforms m_skyboxCloudsProgramUniforms;
+        SkyboxStarsProgramUniforms m_skyboxStarsProgramUniforms;
+        SkyboxTrivialProgramUniforms m_skyboxTrivialProgramUniforms;
+        SkysphereProgramUniforms m_skysphereProgramUniforms;
+        WaterGridProgramUniforms m_waterGridProgramUniforms;
+
         GLuint m_depthFBO{0};
         GLuint m_depthTexture2D{0};
         GLuint m_emptyVAO{0};
+        std::unique_ptr<StreamingBuffer> m_streamingBuffer = nullptr;
+        GLint m_uniformBufferOffsetAlignment{256};
         GLuint m_localReflectionsFBO{0};
+        GLuint m_outputFBO{0};
         GLuint m_localReflectionsTexture2D{0};
         GLuint m_localRefractionsFBO{0};
         GLuint m_localRefractionsTexture2D{0};
+        GLuint m_localReflectionsDepth24Stencil8RBO{0};
+        GLuint m_localRefractionsDepth24Stencil8RBO{0};
+        glm::ivec2 m_localReflectionsSize{0, 0}; // resolution the local reflections target is currently allocated at
+        glm::ivec2 m_localRefractionsSize{0, 0}; // resolution the local refractions target is currently allocated at
+        GLuint m_oceanDisplacementTexture2D{0};
+        GLuint m_oceanNormalFoldingTexture2D{0};
+        unsigned int m_oceanTextureResolution{0}; // resolution the ocean textures are currently allocated at (0 if not allocated)
+        // GL_PRIMITIVES_GENERATED around the water draw, double-buffered (see beginWaterPrimitiveQuery())
+        std::array<GLuint, 2> m_waterPrimitiveQueries{0, 0};
+        std::array<bool, 2> m_isWaterPrimitiveQueryIssued{false, false};
+        unsigned int m_waterPrimitiveQueryIndex{0};
+        GLuint m_waterPrimitiveCount{0};
         GLuint m_worldSpaceDepthFBO{0};
         GLuint m_worldSpaceDepthTexture2D{0};
         GLuint m_skyboxCubemap{0};
@@ -305,6 +501,60 @@ namespace wave_tool
         int m_windowHeight{0};
         int m_windowWidth{0};
 
+        // everything the dynamic skybox cubemap depends on (if none of these change, the cubemap can be reused as-is)
+        struct SkyboxCubemapInputs
+        {
+            float timeOfDayInHours{-1.0f}; // symbolic invalid value, so that the first frame always renders the cubemap
+            float cloudProportion{0.0f};
+            float sunHorizonDarkness{0.0f};
+            float sunShininess{0.0f};
+            float sunStrength{0.0f};
+            bool isSkyboxStarsVisible{false};
+            bool isSkysphereVisible{false};
+            bool isSkyboxCloudsVisible{false};
+
+            bool operator==(SkyboxCubemapInputs const &other) const
+            {
+                return timeOfDayInHours == other.timeOfDayInHours && cloudProportion == other.cloudProportion && sunHorizonDarkness == other.sunHorizonDarkness && sunShininess == other.sunShininess && sunStrength == other.sunStrength && isSkyboxStarsVisible == other.isSkyboxStarsVisible && isSkysphereVisible == other.isSkysphereVisible && isSkyboxCloudsVisible == other.isSkyboxCloudsVisible;
+            }
+            bool operator!=(SkyboxCubemapInputs const &other) const { return !(*this == other); }
+        };
+        SkyboxCubemapInputs m_skyboxCubemapInputs;
+        bool m_isSkyboxCubemapComplete{false};         // has every face been rendered at least once?
+        unsigned int m_skyboxCubemapNextFace{0};       // in range [0, 5] - next face to refresh (round-robin)
+        unsigned int m_skyboxCubemapStaleFaceCount{6}; // in range [0, 6] - number of faces not yet refreshed since the inputs last changed
+
+        // every compiled program and its stage files
+        std::vector<std::pair<GLuint *, ShaderHotReloader::ProgramSources>> getProgramSources();
+        void bindUniformBlocks(GLuint const program);
+        void streamUniformBlock(GLuint const bindingPoint, void const *data, GLsizeiptr const size, GLsizeiptr const blockSize);
+        void updateVertexBuffer(GLuint const buffer, GLsizeiptr &bufferSize, GLsizeiptr const size, void const *data);
+        void resolveUniformLocations();
+        // assignBuffers for a mesh loaded from a .wtmesh file (see MeshObject::cachedStreams)
+        void assignCachedBuffers(MeshObject &object);
+        void createVertexBuffer(GLuint &out_buffer, GLsizeiptr &out_bufferSize, VertexLayout const &layout, GLsizeiptr const size, void const *data);
+        void createPackedVertexBuffer(MeshObject &object, std::size_t const vertexCount, glm::vec3 const *positions, glm::vec3 const *normals, glm::vec2 const *uvs, glm::vec3 const *colours);
+        void uploadIndexBuffer(MeshObject &object, GLuint const *indices, std::size_t const count);
+        // rebuilds the BVH if the set of visible objects changed, otherwise refits it to their current world bounds
+        void updateObjectBVH(std::vector<std::shared_ptr<MeshObject>> const &objects);
+        // draw the queued objects of a pass with the main program (passMat is applied on top of each model matrix)
+        void submitMainProgramPass(RenderQueue::Pass const pass, glm::mat4 const &passMat, glm::vec4 const &clipPlane, bool const forceFlipNormals, glm::mat4 const &view, glm::mat4 const &projection);
+        void submitDepthPass(glm::mat4 const &viewProjection);
+        // the window resolution shifted down by the (clamped) level, at least 1x1
+        glm::ivec2 computeLocalTargetSize(int const downsampleLevel) const;
+        // (re)allocates a local target (colour texture + depth/stencil RBO) at its downsampled window resolution
+        void resizeLocalReflectionsTarget();
+        void resizeLocalRefractionsTarget();
+        void allocateLocalTarget(GLuint const colourTexture2D, GLuint const depth24Stencil8RBO, glm::ivec2 const &size);
+        // steps the FFT ocean to the current wave time and uploads both of its maps
+        void updateOceanFFT();
+        void renderSkyboxCubemapFace(unsigned int const face, std::shared_ptr<const MeshObject> const &skyboxStars, std::shared_ptr<const MeshObject> const &skysphere, std::shared_ptr<const MeshObject> const &skyboxClouds, glm::vec4 const &fogColourFarAtCurrentTime, float const oneMinusCloudProportion);
+        // the world-space corners (bottom-left, bottom-right, top-left, top-right) of the base-plane grid covering the camera's view of the displaceable volume
+        // returns false if the camera can't see any of the displaceable volume
+        bool computeProjectedGridCorners(float const displaceableAmplitude, glm::mat4 const &projection, glm::mat4 const &inverseViewProjection, std::array<glm::vec4, 4> &out_cornerPoints);
+        // wraps the water draw(s) in the GL_PRIMITIVES_GENERATED query (see getWaterPrimitiveCount())
+        void beginWaterPrimitiveQuery();
+        void endWaterPrimitiveQuery();
         std::array<glm::vec4, 8> transformFrustumCorners(const glm::mat4 &inverseViewProjection, float safetyPadding);
     };
 }
@@ -0,0 +1,141 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "render-queue.h"
+
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+namespace wave_tool
+{
+    std::uint64_t RenderQueue::makeSortKey(Pass const pass, GLuint const program, GLuint const texture, GLuint const vao, float const depth)
+    {
+        std::uint64_t const quantizedDepth{(std::uint64_t)(glm::clamp(depth, 0.0f, 1.0f) * 0xFFFF)};
+        return ((std::uint64_t)(pass & 0xF) << 60) | ((std::uint64_t)(program & 0xFFF) << 48) | ((std::uint64_t)(texture & 0xFFFF) << 32) | ((std::uint64_t)(vao & 0xFFFF) << 16) | quantizedDepth;
+    }
+
+    void RenderQueue::clear()
+    {
+        m_items.clear();
+        m_passOffsets.clear();
+    }
+
+    void RenderQueue::push(Pass const pass, MeshObject const &object, GLuint const program, GLuint const texture, float const depth)
+    {
+        m_items.push_back(DrawItem{makeSortKey(pass, program, texture, object.vao, depth), &object});
+    }
+
+    void RenderQueue::sort()
+    {
+        std::sort(m_items.begin(), m_items.end(), [](DrawItem const &a, DrawItem const &b) { return a.sortKey < b.sortKey; });
+
+        // the pass is the top of the key, so each pass is now one contiguous run
+        m_passOffsets.assign(PASS_COUNT + 1, m_items.size());
+        for (std::size_t i = m_items.size(); i-- > 0;)
+            m_passOffsets.at(m_items.at(i).sortKey >> 60) = i;
+        for (std::size_t pass = PASS_COUNT; pass-- > 0;)
+            m_passOffsets.at(pass) = std::min(m_passOffsets.at(pass), m_passOffsets.at(pass + 1));
+    }
+
+    RenderQueue::DrawItem const *RenderQueue::begin(Pass const pass) const
+    {
+        return m_passOffsets.empty() ? nullptr : m_items.data() + m_passOffsets.at(pass);
+    }
+
+    RenderQueue::DrawItem const *RenderQueue::end(Pass const pass) const
+    {
+        return m_passOffsets.empty() ? nullptr : m_items.data() + m_passOffsets.at(pass + 1);
+    }
+
+    void RenderStateCache::reset()
+    {
+        m_program = s_UNKNOWN;
+        m_vao = s_UNKNOWN;
+        m_polygonMode = s_UNKNOWN;
+        m_activeTextureUnit = s_UNKNOWN;
+        m_boundTextures.clear();
+        m_uniformValues.clear();
+    }
+
+    void RenderStateCache::useProgram(GLuint const program)
+    {
+        if (program == m_program)
+            return;
+        m_program = program;
+        glUseProgram(program);
+    }
+
+    void RenderStateCache::bindVertexArray(GLuint const vao)
+    {
+        if (vao == m_vao)
+            return;
+        m_vao = vao;
+        glBindVertexArray(vao);
+    }
+
+    void RenderStateCache::polygonMode(GLenum const mode)
+    {
+        if (mode == m_polygonMode)
+            return;
+        m_polygonMode = mode;
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+    }
+
+    void RenderStateCache::bind2DTexture(GLint const samplerLocation, GLuint const texture)
+    {
+        if (0 == m_boundTextures.count(texture))
+        {
+            if (texture != m_activeTextureUnit)
+            {
+                m_activeTextureUnit = texture;
+                glActiveTexture(GL_TEXTURE0 + texture);
+            }
+            glBindTexture(GL_TEXTURE_2D, texture);
+            m_boundTextures.insert(texture);
+        }
+        uniform1i(samplerLocation, texture);
+    }
+
+    void RenderStateCache::uniform1i(GLint const location, GLint const value)
+    {
+        // NOTE: -1 is silently ignored by GL, so there is nothing to cache
+        if (-1 == location)
+            return;
+
+        std::uint64_t const key{((std::uint64_t)m_program << 32) | (std::uint32_t)location};
+        auto const uniformValue{m_uniformValues.find(key)};
+        if (m_uniformValues.end() != uniformValue && uniformValue->second == value)
+            return;
+        m_uniformValues[key] = value;
+        glUniform1i(location, value);
+    }
+}
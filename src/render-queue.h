@@ -0,0 +1,114 @@
+#ifndef WAVE_TOOL_RENDER_QUEUE_H_
+#define WAVE_TOOL_RENDER_QUEUE_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "mesh-object.h"
+
+namespace wave_tool
+{
+    // collects the MeshObject draws of a frame and orders them by a 64-bit key, so that draws sharing state end up next to each other
+    // key layout (most significant first): pass (4 bits) | program (12 bits) | texture (16 bits) | VAO (16 bits) | depth (16 bits)
+    // NOTE: GL names are truncated to their field, which can only cost a few extra state changes (RenderStateCache compares the real values)
+    class RenderQueue
+    {
+    public:
+        enum Pass
+        {
+            LOCAL_REFLECTIONS = 0,
+            LOCAL_REFRACTIONS,
+            DEPTH,
+            PASS_COUNT
+        };
+
+        struct DrawItem
+        {
+            std::uint64_t sortKey;
+            MeshObject const *object;
+        };
+
+        // depth is in range [0.0, 1.0] (0.0 at the camera), smaller depths are drawn first (front-to-back, so early-z rejects more)
+        static std::uint64_t makeSortKey(Pass const pass, GLuint const program, GLuint const texture, GLuint const vao, float const depth);
+
+        void clear();
+        // NOTE: program and texture are passed separately, since a pass may draw the object with different state (e.g. the depth pass)
+        void push(Pass const pass, MeshObject const &object, GLuint const program, GLuint const texture, float const depth);
+        // must be called after the last push and before the items are read
+        void sort();
+
+        // the sorted draws of a single pass, as [begin, end)
+        DrawItem const *begin(Pass const pass) const;
+        DrawItem const *end(Pass const pass) const;
+
+    private:
+        std::vector<DrawItem> m_items;
+        std::vector<std::size_t> m_passOffsets; // index of the first item of each pass (plus one past the end), valid after sort()
+    };
+
+    // remembers the GL state last issued through it, so that only the state that actually changes between draws reaches the driver
+    // NOTE: anything that changes this state behind its back must be followed by reset()
+    class RenderStateCache
+    {
+    public:
+        // forget everything (the next request of each kind is always issued)
+        void reset();
+
+        void useProgram(GLuint const program);
+        // the program last issued through the cache (or ~0 if unknown)
+        inline GLuint getProgram() const { return m_program; }
+        void bindVertexArray(GLuint const vao);
+        void polygonMode(GLenum const mode);
+        // same texture-unit convention as Texture::bind2DTexture (the unit is the texture name)
+        void bind2DTexture(GLint const samplerLocation, GLuint const texture);
+        // scalar int/bool uniforms of the program in use (cached per program and location)
+        void uniform1i(GLint const location, GLint const value);
+
+    private:
+        static GLuint const s_UNKNOWN{~0u};
+
+        GLuint m_program{s_UNKNOWN};
+        GLuint m_vao{s_UNKNOWN};
+        GLenum m_polygonMode{s_UNKNOWN};
+        GLuint m_activeTextureUnit{s_UNKNOWN};
+        std::unordered_set<GLuint> m_boundTextures;               // 2D textures known to be bound to their own unit
+        std::unordered_map<std::uint64_t, GLint> m_uniformValues; // (program << 32 | location) -> value
+    };
+}
+
+#endif // WAVE_TOOL_RENDER_QUEUE_H_
@@ -0,0 +1,269 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "shader-hot-reloader.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace wave_tool
+{
+    namespace
+    {
+        std::string getFileName(std::string const &path)
+        {
+            std::size_t const slashIndex{path.find_last_of("/\\")};
+            return std::string::npos == slashIndex ? path : path.substr(slashIndex + 1);
+        }
+    }
+
+    ShaderHotReloader::ShaderHotReloader(std::string const &shaderDirectory, std::vector<ProgramSources> const &programs, GLFWwindow *workerContext)
+        : m_watcher{shaderDirectory}, m_programs{programs}, m_generations(programs.size(), 0), m_errorLogs(programs.size())
+    {
+        if (!m_watcher.isWatching())
+            return;
+
+        m_isParallel = ShaderTools::isParallelCompileSupported();
+        if (!m_isParallel)
+        {
+            if (nullptr == workerContext)
+            {
+                std::cout << "ERROR: shader hot reload needs a worker context when parallel shader compilation isn't supported" << std::endl;
+                return;
+            }
+            m_workerContext = workerContext;
+            m_worker = std::thread{&ShaderHotReloader::runWorker, this};
+        }
+        m_isEnabled = true;
+    }
+
+    ShaderHotReloader::~ShaderHotReloader()
+    {
+        if (m_worker.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> const lock{m_workerMutex};
+                m_isWorkerStopping = true;
+            }
+            m_workerJobAdded.notify_one();
+            m_worker.join();
+        }
+
+        // nothing left is going to be swapped in...
+        for (WorkerResult const &result : m_workerResults)
+        {
+            glDeleteSync(result.fence);
+            glDeleteProgram(result.program);
+        }
+        for (PendingCompilation &pending : m_pendingCompilations)
+        {
+            for (GLuint const shader : pending.compilation.shaders)
+                glDeleteShader(shader);
+            glDeleteProgram(pending.compilation.program);
+        }
+    }
+
+    std::vector<ShaderHotReloader::Reload> ShaderHotReloader::update()
+    {
+        std::vector<Reload> reloads;
+        if (!m_isEnabled)
+            return reloads;
+
+        for (std::string const &fileName : m_watcher.pollChangedFiles())
+        {
+            for (std::size_t i = 0; i < m_programs.size(); ++i)
+            {
+                for (std::string const &path : m_programs.at(i))
+                {
+                    if (!path.empty() && getFileName(path) == fileName)
+                    {
+                        recompile(i);
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (m_isParallel)
+        {
+            // only programs the driver is done with are checked, since checking blocks otherwise
+            for (auto it = m_pendingCompilations.begin(); it != m_pendingCompilations.end();)
+            {
+                if (!ShaderTools::isCompilationComplete(it->compilation))
+                {
+                    ++it;
+                    continue;
+                }
+                std::string errorLog;
+                bool const isSuccessful{ShaderTools::finishCompileShaders(it->compilation, errorLog)};
+                finishReload(it->index, it->generation, it->compilation.program, isSuccessful, errorLog, reloads);
+                it = m_pendingCompilations.erase(it);
+            }
+        }
+        else
+        {
+            std::lock_guard<std::mutex> const lock{m_workerMutex};
+            for (auto it = m_workerResults.begin(); it != m_workerResults.end();)
+            {
+                // NOTE: a zero timeout just polls the fence
+                if (0 != it->fence && GL_TIMEOUT_EXPIRED == glClientWaitSync(it->fence, 0, 0))
+                {
+                    ++it;
+                    continue;
+                }
+                glDeleteSync(it->fence);
+                finishReload(it->index, it->generation, it->program, 0 != it->program, it->errorLog, reloads);
+                it = m_workerResults.erase(it);
+            }
+        }
+
+        return reloads;
+    }
+
+    std::string ShaderHotReloader::getErrorLog() const
+    {
+        std::string errorLog;
+        for (std::size_t i = 0; i < m_programs.size(); ++i)
+        {
+            if (!m_errorLogs.at(i).empty())
+                errorLog += m_programs.at(i).at(ProgramCompilation::VERTEX) + ":\n" + m_errorLogs.at(i);
+        }
+        return errorLog;
+    }
+
+    void ShaderHotReloader::recompile(std::size_t const index)
+    {
+        unsigned int const generation{++m_generations.at(index)};
+
+        // NOTE: the files are small enough to read here, and are read right away so every stage comes from the same save
+        std::array<std::string, ProgramCompilation::STAGE_COUNT> sources;
+        std::string errorLog;
+        for (int stage = 0; stage < ProgramCompilation::STAGE_COUNT; ++stage)
+        {
+            std::string const &path{m_programs.at(index).at(stage)};
+            if (!path.empty() && !ShaderTools::readShaderSource(path, sources.at(stage)))
+                errorLog += "Failed to read " + path + "\n";
+        }
+        if (!errorLog.empty())
+        {
+            std::vector<Reload> ignored;
+            finishReload(index, generation, 0, false, errorLog, ignored);
+            return;
+        }
+
+        if (m_isParallel)
+        {
+            std::array<GLchar const *, ProgramCompilation::STAGE_COUNT> sourcePointers;
+            for (int stage = 0; stage < ProgramCompilation::STAGE_COUNT; ++stage)
+                sourcePointers.at(stage) = m_programs.at(index).at(stage).empty() ? nullptr : sources.at(stage).c_str();
+            m_pendingCompilations.push_back(PendingCompilation{index, generation, ShaderTools::beginCompileShaders(sourcePointers)});
+        }
+        else
+        {
+            {
+                std::lock_guard<std::mutex> const lock{m_workerMutex};
+                m_workerJobs.push_back(WorkerJob{index, generation, std::move(sources)});
+            }
+            m_workerJobAdded.notify_one();
+        }
+    }
+
+    void ShaderHotReloader::finishReload(std::size_t const index, unsigned int const generation, GLuint const program, bool const isSuccessful, std::string const &errorLog, std::vector<Reload> &out_reloads)
+    {
+        // a newer compile of the same program is (or was) in flight
+        if (generation != m_generations.at(index))
+        {
+            glDeleteProgram(program);
+            return;
+        }
+
+        if (isSuccessful)
+        {
+            m_errorLogs.at(index).clear();
+            out_reloads.push_back(Reload{index, program});
+            std::cout << "reloaded shaders: " << m_programs.at(index).at(ProgramCompilation::VERTEX) << std::endl;
+        }
+        else
+        {
+            m_errorLogs.at(index) = errorLog;
+            glDeleteProgram(program);
+            std::cout << "ERROR: failed to reload shaders (keeping the last good program): " << m_programs.at(index).at(ProgramCompilation::VERTEX) << std::endl
+                      << errorLog;
+        }
+    }
+
+    void ShaderHotReloader::runWorker()
+    {
+        glfwMakeContextCurrent(m_workerContext);
+
+        for (;;)
+        {
+            WorkerJob job;
+            {
+                std::unique_lock<std::mutex> lock{m_workerMutex};
+                m_workerJobAdded.wait(lock, [this]() { return m_isWorkerStopping || !m_workerJobs.empty(); });
+                if (m_isWorkerStopping)
+                    break;
+                job = std::move(m_workerJobs.front());
+                m_workerJobs.pop_front();
+
+                // skip the compile entirely if the same program was saved again already (its result would be discarded anyway)
+                if (std::any_of(m_workerJobs.begin(), m_workerJobs.end(), [&job](WorkerJob const &other) { return other.index == job.index; }))
+                    continue;
+            }
+
+            // NOTE: m_programs never changes after construction, so it's safe to read here
+            std::array<GLchar const *, ProgramCompilation::STAGE_COUNT> sourcePointers;
+            for (int stage = 0; stage < ProgramCompilation::STAGE_COUNT; ++stage)
+                sourcePointers.at(stage) = m_programs.at(job.index).at(stage).empty() ? nullptr : job.sources.at(stage).c_str();
+
+            // blocking is fine here, this thread has nothing else to do
+            ProgramCompilation compilation{ShaderTools::beginCompileShaders(sourcePointers)};
+            WorkerResult result{job.index, job.generation, compilation.program, 0, std::string{}};
+            if (ShaderTools::finishCompileShaders(compilation, result.errorLog))
+            {
+                // the render context may only use the program once this context's commands have completed
+                result.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                glFlush();
+            }
+            else
+            {
+                glDeleteProgram(result.program);
+                result.program = 0;
+            }
+
+            std::lock_guard<std::mutex> const lock{m_workerMutex};
+            m_workerResults.push_back(std::move(result));
+        }
+
+        glfwMakeContextCurrent(nullptr);
+    }
+}
@@ -0,0 +1,132 @@
+#ifndef WAVE_TOOL_SHADER_HOT_RELOADER_H_
+#define WAVE_TOOL_SHADER_HOT_RELOADER_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "file-watcher.h"
+#include "shader-tools.h"
+
+namespace wave_tool
+{
+    // recompiles programs in the background when their shader files change, without ever stalling the render loop
+    // the driver compiles in the background where GL_KHR_parallel_shader_compile is supported, otherwise a worker thread compiles on a shared context
+    // NOTE: a program that fails to compile is dropped (see getErrorLog), so the last good one stays in use
+    class ShaderHotReloader
+    {
+    public:
+        // the stage files of one program, indexed by ProgramCompilation::Stage (empty for unused optional stages)
+        using ProgramSources = std::array<std::string, ProgramCompilation::STAGE_COUNT>;
+
+        // a program that finished recompiling, ready to replace the program at index (in construction order)
+        struct Reload
+        {
+            std::size_t index;
+            GLuint program;
+        };
+
+        // workerContext is a hidden window sharing objects with the current context, only required when the driver can't compile in parallel (see ShaderTools::isParallelCompileSupported)
+        // NOTE: the stage files must all be in shaderDirectory
+        ShaderHotReloader(std::string const &shaderDirectory, std::vector<ProgramSources> const &programs, GLFWwindow *workerContext);
+        ~ShaderHotReloader();
+
+        ShaderHotReloader(ShaderHotReloader const &) = delete;
+        ShaderHotReloader &operator=(ShaderHotReloader const &) = delete;
+
+        inline bool isEnabled() const { return m_isEnabled; }
+
+        // starts recompiling every program with a changed file, and returns the recompiled programs that are ready (the caller takes ownership of them)
+        // NOTE: must be called on the thread of the render context, once per frame
+        std::vector<Reload> update();
+        // the messages of the latest failed compile of every program that hasn't reloaded successfully since (empty if there are none)
+        std::string getErrorLog() const;
+
+    private:
+        struct PendingCompilation
+        {
+            std::size_t index;
+            unsigned int generation;
+            ProgramCompilation compilation;
+        };
+        struct WorkerJob
+        {
+            std::size_t index;
+            unsigned int generation;
+            std::array<std::string, ProgramCompilation::STAGE_COUNT> sources;
+        };
+        struct WorkerResult
+        {
+            std::size_t index;
+            unsigned int generation;
+            GLuint program; // 0 if it failed
+            GLsync fence;   // signaled once the worker's context is done with the program
+            std::string errorLog;
+        };
+
+        FileWatcher m_watcher;
+        std::vector<ProgramSources> m_programs;
+        std::vector<unsigned int> m_generations; // bumped per recompile, so an outdated compile never replaces a newer one
+        std::vector<std::string> m_errorLogs;
+        bool m_isEnabled{false};
+        bool m_isParallel{false};
+
+        // compiled by the driver in the background (parallel)...
+        std::vector<PendingCompilation> m_pendingCompilations;
+
+        // compiled by the worker on its own context (not parallel)...
+        GLFWwindow *m_workerContext{nullptr};
+        std::thread m_worker;
+        std::mutex m_workerMutex; // guards everything below
+        std::condition_variable m_workerJobAdded;
+        std::deque<WorkerJob> m_workerJobs;
+        std::vector<WorkerResult> m_workerResults;
+        bool m_isWorkerStopping{false};
+
+        void recompile(std::size_t const index);
+        // keeps the program if it is the latest compile of its index and succeeded, otherwise deletes it
+        void finishReload(std::size_t const index, unsigned int const generation, GLuint const program, bool const isSuccessful, std::string const &errorLog, std::vector<Reload> &out_reloads);
+        void runWorker();
+    };
+}
+
+#endif // WAVE_TOOL_SHADER_HOT_RELOADER_H_
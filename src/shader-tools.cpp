@@ -31,15 +31,35 @@
 
 #include "shader-tools.h"
 
+#include "gl-extensions.h"
+#include "hash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+// from KHR_parallel_shader_compile (not part of the core profile our glad loader was generated for, same value as the ARB version)
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 namespace wave_tool
 {
+    std::string ShaderTools::programCacheDirectory{"program-cache"};
+
+    GLint ProgramReflection::getUniformLocation(std::string const &name) const
+    {
+        auto const it{uniformLocations.find(name)};
+        return uniformLocations.end() != it ? it->second : -1;
+    }
+
     GLuint ShaderTools::compileShaders(char const *vertexFilename, char const *fragmentFilename,
                                        char const *tessControlFilename, char const *tessEvalFilename)
     {
-        GLuint vertex_shader;
-        GLuint fragment_shader;
-        GLuint tess_control_shader = 0; // Optional
-        GLuint tess_eval_shader = 0;    // Optional
         GLuint program;
 
         GLchar const *vertex_shader_source[] = {loadshader(vertexFilename)};
@@ -47,66 +67,322 @@ namespace wave_tool
         GLchar const *tess_control_shader_source[] = {tessControlFilename ? loadshader(tessControlFilename) : nullptr};
         GLchar const *tess_eval_shader_source[] = {tessEvalFilename ? loadshader(tessEvalFilename) : nullptr};
 
-        // Create and compile vertex shader
-        vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex_shader, 1, vertex_shader_source, nullptr);
-        glCompileShader(vertex_shader);
-        checkShaderCompilation(vertex_shader, "vertex_shader");
+        auto const unloadSources{[&]() {
+            unloadshader((GLchar **)vertex_shader_source);
+            unloadshader((GLchar **)fragment_shader_source);
+            if (tess_control_shader_source[0])
+                unloadshader((GLchar **)tess_control_shader_source);
+            if (tess_eval_shader_source[0])
+                unloadshader((GLchar **)tess_eval_shader_source);
+        }};
+
+        // try the driver binary from a previous launch first, which skips compilation entirely
+        bool const isCacheEnabled{isProgramBinaryCacheEnabled()};
+        std::string binaryPath;
+        std::uint64_t sourceKey{0};
+        if (isCacheEnabled)
+        {
+            char const *const filenames[] = {vertexFilename, fragmentFilename, tessControlFilename, tessEvalFilename};
+            GLchar const *const sources[] = {vertex_shader_source[0], fragment_shader_source[0], tess_control_shader_source[0], tess_eval_shader_source[0]};
+            binaryPath = getProgramBinaryPath(filenames, ProgramCompilation::STAGE_COUNT);
+            sourceKey = hashProgramSources(sources, ProgramCompilation::STAGE_COUNT);
+
+            program = loadProgramBinary(binaryPath, sourceKey);
+            if (0 != program)
+            {
+                unloadSources();
+                return program;
+            }
+        }
+
+        // Create and compile the shaders, attach them to a program, and link it
+        ProgramCompilation compilation{beginCompileShaders({vertex_shader_source[0], fragment_shader_source[0], tess_control_shader_source[0], tess_eval_shader_source[0]}, isCacheEnabled)};
+        unloadSources(); // the driver keeps its own copy of the sources
+
+        std::string errorLog;
+        bool const isLinked{finishCompileShaders(compilation, errorLog)};
+        if (!errorLog.empty())
+            fprintf(stderr, "%s", errorLog.c_str());
+        program = compilation.program;
 
-        // Create and compile fragment shader
-        fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment_shader, 1, fragment_shader_source, nullptr);
-        glCompileShader(fragment_shader);
-        checkShaderCompilation(fragment_shader, "fragment_shader");
+        if (isCacheEnabled && isLinked && !saveProgramBinary(program, binaryPath, sourceKey))
+            std::cout << "WARNING: failed to cache program binary: " << binaryPath << std::endl;
 
-        // Optional: Create and compile tessellation control shader
-        if (tess_control_shader_source[0])
+        return program;
+    }
+
+    ProgramCompilation ShaderTools::beginCompileShaders(std::array<GLchar const *, ProgramCompilation::STAGE_COUNT> const &sources, bool const isBinaryRetrievable)
+    {
+        static std::array<GLenum, ProgramCompilation::STAGE_COUNT> const STAGE_TYPES{GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER};
+
+        ProgramCompilation compilation;
+        compilation.program = glCreateProgram();
+        for (int stage = 0; stage < ProgramCompilation::STAGE_COUNT; ++stage)
         {
-            tess_control_shader = glCreateShader(GL_TESS_CONTROL_SHADER);
-            glShaderSource(tess_control_shader, 1, tess_control_shader_source, nullptr);
-            glCompileShader(tess_control_shader);
-            checkShaderCompilation(tess_control_shader, "tess_control_shader");
+            // NOTE: a missing required stage is left to fail at link time
+            if (nullptr == sources.at(stage))
+                continue;
+
+            GLuint const shader{glCreateShader(STAGE_TYPES.at(stage))};
+            glShaderSource(shader, 1, &sources.at(stage), nullptr);
+            glCompileShader(shader);
+            glAttachShader(compilation.program, shader);
+            compilation.shaders.at(stage) = shader;
         }
 
-        // Optional: Create and compile tessellation evaluation shader
-        if (tess_eval_shader_source[0])
+        // NOTE: the hint has to be given before linking, otherwise the driver may not keep a binary around
+        if (isBinaryRetrievable)
+            glProgramParameteri(compilation.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(compilation.program);
+
+        return compilation;
+    }
+
+    bool ShaderTools::isCompilationComplete(ProgramCompilation const &compilation)
+    {
+        if (!isParallelCompileSupported())
+            return true; // compiling and linking were already synchronous
+
+        // NOTE: a program only completes once all of its stages have
+        GLint isComplete{GL_FALSE};
+        glGetProgramiv(compilation.program, GL_COMPLETION_STATUS_KHR, &isComplete);
+        return GL_FALSE != isComplete;
+    }
+
+    bool ShaderTools::finishCompileShaders(ProgramCompilation &compilation, std::string &out_errorLog)
+    {
+        static std::array<char const *, ProgramCompilation::STAGE_COUNT> const STAGE_NAMES{"vertex_shader", "fragment_shader", "tess_control_shader", "tess_eval_shader"};
+
+        bool isSuccessful{true};
+        for (int stage = 0; stage < ProgramCompilation::STAGE_COUNT; ++stage)
+        {
+            GLuint &shader{compilation.shaders.at(stage)};
+            if (0 == shader)
+                continue;
+
+            isSuccessful = checkShaderCompilation(shader, STAGE_NAMES.at(stage), out_errorLog) && isSuccessful;
+            // Delete the shader as the program has it now
+            glDeleteShader(shader);
+            shader = 0;
+        }
+        return checkProgramLink(compilation.program, out_errorLog) && isSuccessful;
+    }
+
+    bool ShaderTools::isParallelCompileSupported()
+    {
+        // the extension list can't change for a context, so it's only searched once
+        // NOTE: glMaxShaderCompilerThreadsKHR isn't called (our glad loader doesn't have it), which leaves the driver's default thread count
+        static bool const isSupported{GLExtensions::isSupported("GL_KHR_parallel_shader_compile") || GLExtensions::isSupported("GL_ARB_parallel_shader_compile")};
+        return isSupported;
+    }
+
+    bool ShaderTools::readShaderSource(std::string const &filename, std::string &out_source)
+    {
+        std::ifstream file(filename, std::ios::in | std::ios::binary);
+        if (!file)
+            return false;
+
+        out_source.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        return !file.bad();
+    }
+
+    void ShaderTools::bindUniformBlock(GLuint program, char const *blockName, GLuint bindingPoint)
+    {
+        GLuint const blockIndex{glGetUniformBlockIndex(program, blockName)};
+        if (GL_INVALID_INDEX != blockIndex)
+            glUniformBlockBinding(program, blockIndex, bindingPoint);
+    }
+
+    // reference: https://www.khronos.org/opengl/wiki/Program_Introspection#Uniforms_and_blocks
+    ProgramReflection ShaderTools::reflectProgram(GLuint program)
+    {
+        ProgramReflection reflection;
+        reflection.program = program;
+        if (0 == program)
+            return reflection;
+
+        GLint activeUniformCount{0};
+        GLint maxNameLength{0};
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &activeUniformCount);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+        std::vector<GLchar> nameBuffer(maxNameLength > 0 ? maxNameLength : 1);
+        for (GLuint i = 0; i < (GLuint)activeUniformCount; ++i)
         {
-            tess_eval_shader = glCreateShader(GL_TESS_EVALUATION_SHADER);
-            glShaderSource(tess_eval_shader, 1, tess_eval_shader_source, nullptr);
-            glCompileShader(tess_eval_shader);
-            checkShaderCompilation(tess_eval_shader, "tess_eval_shader");
+            // uniforms inside a block don't have a location (they are set through the block's buffer instead)
+            GLint blockIndex{-1};
+            glGetActiveUniformsiv(program, 1, &i, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+            if (-1 != blockIndex)
+                continue;
+
+            GLint arraySize{0};
+            GLenum type{GL_NONE};
+            GLsizei nameLength{0};
+            glGetActiveUniform(program, i, (GLsizei)nameBuffer.size(), &nameLength, &arraySize, &type, nameBuffer.data());
+            std::string name{nameBuffer.data(), (std::size_t)nameLength};
+
+            // arrays are reported once as "name[0]" (with their size), so resolve every element individually
+            // NOTE: the locations of array elements aren't guaranteed to be consecutive by GL 4.1
+            std::string::size_type const arraySuffixIndex{name.rfind("[0]")};
+            if (arraySize > 1 && std::string::npos != arraySuffixIndex && arraySuffixIndex + 3 == name.length())
+            {
+                std::string const baseName{name.substr(0, arraySuffixIndex)};
+                reflection.uniformLocations[baseName] = glGetUniformLocation(program, name.c_str());
+                for (GLint e = 0; e < arraySize; ++e)
+                {
+                    std::string const elementName{baseName + "[" + std::to_string(e) + "]"};
+                    reflection.uniformLocations[elementName] = glGetUniformLocation(program, elementName.c_str());
+                }
+            }
+            else
+            {
+                reflection.uniformLocations[name] = glGetUniformLocation(program, name.c_str());
+            }
         }
 
-        // Create program, attach shaders to it, and link it
-        program = glCreateProgram();
-        glAttachShader(program, vertex_shader);
-        if (tess_control_shader)
-            glAttachShader(program, tess_control_shader);
-        if (tess_eval_shader)
-            glAttachShader(program, tess_eval_shader);
-        glAttachShader(program, fragment_shader);
-
-        glLinkProgram(program);
-        checkProgramLink(program);
-
-        // Delete the shaders as the program has them now
-        glDeleteShader(vertex_shader);
-        glDeleteShader(fragment_shader);
-        if (tess_control_shader)
-            glDeleteShader(tess_control_shader);
-        if (tess_eval_shader)
-            glDeleteShader(tess_eval_shader);
-
-        unloadshader((GLchar **)vertex_shader_source);
-        unloadshader((GLchar **)fragment_shader_source);
-        if (tess_control_shader_source[0])
-            unloadshader((GLchar **)tess_control_shader_source);
-        if (tess_eval_shader_source[0])
-            unloadshader((GLchar **)tess_eval_shader_source);
+        return reflection;
+    }
 
+    // NOTE: some drivers (e.g. Mesa without a disk cache) advertise no binary formats at all, which makes glGetProgramBinary useless
+    bool ShaderTools::isProgramBinaryCacheEnabled()
+    {
+        if (programCacheDirectory.empty())
+            return false;
+
+        GLint formatCount{0};
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        return formatCount > 0;
+    }
+
+    // one file per program (named after its stage files), so a stale binary gets replaced rather than piling up next to the new one
+    std::string ShaderTools::getProgramBinaryPath(char const *const filenames[], std::size_t const count)
+    {
+        std::string identity;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            identity += filenames[i] ? filenames[i] : "";
+            identity += '\n';
+        }
+
+        std::string const vertexFilename{filenames[0]};
+        std::size_t const slashIndex{vertexFilename.find_last_of("/\\")};
+        std::string stem{std::string::npos == slashIndex ? vertexFilename : vertexFilename.substr(slashIndex + 1)};
+        std::size_t const dotIndex{stem.find_last_of('.')};
+        if (std::string::npos != dotIndex)
+            stem.resize(dotIndex);
+
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hashContents(identity.data(), identity.size()));
+        return programCacheDirectory + "/" + stem + "-" + hex + ".glbin";
+    }
+
+    // NOTE: every string handed to glShaderSource is part of the key, so anything spliced into the sources (e.g. #defines) invalidates the binary too
+    std::uint64_t ShaderTools::hashProgramSources(GLchar const *const sources[], std::size_t const count)
+    {
+        std::string key;
+        for (GLenum const name : {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION})
+        {
+            GLubyte const *const value{glGetString(name)};
+            key += value ? reinterpret_cast<char const *>(value) : "";
+            key += '\0';
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            // the stage separator keeps e.g. a missing tessellation stage distinguishable from an empty one
+            key += char('0' + i);
+            key += sources[i] ? sources[i] : "";
+            key += '\0';
+        }
+        return hashContents(key.data(), key.size());
+    }
+
+    // returns 0 if there's no usable binary (missing, stale or rejected by the driver), in which case the caller compiles from source
+    GLuint ShaderTools::loadProgramBinary(std::string const &binaryPath, std::uint64_t const sourceKey)
+    {
+        std::ifstream file(binaryPath, std::ios::in | std::ios::binary);
+        if (!file)
+            return 0;
+
+        ProgramBinaryHeader header;
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (!file || 0 != std::memcmp(header.magic, "WTPROG\0\0", sizeof(header.magic)) || ProgramBinaryHeader::VERSION != header.version)
+            return 0;
+        if (sourceKey != header.sourceKey || 0 == header.binaryLength || header.binaryLength > (std::uint64_t)INT32_MAX)
+            return 0; // stale: the sources or the driver changed since this was written
+
+        std::vector<char> binary(header.binaryLength);
+        file.read(binary.data(), (std::streamsize)binary.size());
+        if (!file)
+            return 0;
+
+        GLuint const program{glCreateProgram()};
+        glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+
+        // NOTE: drivers are allowed to reject any binary (e.g. after an update that kept the version string), which isn't an error
+        GLint status;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        if (GL_TRUE != status)
+        {
+            glDeleteProgram(program);
+            file.close();
+            std::remove(binaryPath.c_str());
+            return 0;
+        }
         return program;
     }
 
+    bool ShaderTools::saveProgramBinary(GLuint program, std::string const &binaryPath, std::uint64_t const sourceKey)
+    {
+        GLint binaryLength{0};
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+        if (binaryLength <= 0)
+            return false;
+
+        std::vector<char> binary(binaryLength);
+        GLenum binaryFormat{GL_NONE};
+        GLsizei writtenLength{0};
+        glGetProgramBinary(program, binaryLength, &writtenLength, &binaryFormat, binary.data());
+        if (writtenLength <= 0)
+            return false;
+
+        ProgramBinaryHeader header{};
+        std::memcpy(header.magic, "WTPROG\0\0", sizeof(header.magic));
+        header.version = ProgramBinaryHeader::VERSION;
+        header.binaryFormat = binaryFormat;
+        header.sourceKey = sourceKey;
+        header.binaryLength = (std::uint64_t)writtenLength;
+
+        std::error_code error;
+        std::filesystem::create_directories(programCacheDirectory, error);
+        if (error)
+            return false;
+
+        // NOTE: written aside and renamed, so a crash mid-write never leaves a truncated binary behind
+        std::string const temporaryPath{binaryPath + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()))};
+        {
+            std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file)
+                return false;
+            file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+            file.write(binary.data(), writtenLength);
+            if (!file)
+            {
+                file.close();
+                std::remove(temporaryPath.c_str());
+                return false;
+            }
+        }
+
+        // NOTE: rename won't replace an existing file on every platform
+        std::remove(binaryPath.c_str());
+        if (0 != std::rename(temporaryPath.c_str(), binaryPath.c_str()))
+        {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
     unsigned long ShaderTools::getFileLength(std::ifstream &file)
     {
         if (!file.good())
@@ -164,7 +440,7 @@ namespace wave_tool
         *ShaderSource = nullptr;
     }
 
-    void ShaderTools::checkShaderCompilation(GLuint shader, const char *shaderName)
+    bool ShaderTools::checkShaderCompilation(GLuint shader, const char *shaderName, std::string &out_errorLog)
     {
         GLint status;
         glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
@@ -174,15 +450,16 @@ namespace wave_tool
             GLint infoLogLength;
             glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
 
-            GLchar *strInfoLog = new GLchar[infoLogLength + 1];
-            glGetShaderInfoLog(shader, infoLogLength, nullptr, strInfoLog);
+            std::vector<GLchar> strInfoLog(infoLogLength + 1, 0);
+            glGetShaderInfoLog(shader, infoLogLength, nullptr, strInfoLog.data());
 
-            fprintf(stderr, "Compilation error in %s: %s\n", shaderName, strInfoLog);
-            delete[] strInfoLog;
+            out_errorLog += std::string{"Compilation error in "} + shaderName + ": " + strInfoLog.data() + "\n";
+            return false;
         }
+        return true;
     }
 
-    void ShaderTools::checkProgramLink(GLuint program)
+    bool ShaderTools::checkProgramLink(GLuint program, std::string &out_errorLog)
     {
         GLint status;
         glGetProgramiv(program, GL_LINK_STATUS, &status);
@@ -192,12 +469,13 @@ namespace wave_tool
             GLint infoLogLength;
             glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLogLength);
 
-            GLchar *strInfoLog = new GLchar[infoLogLength + 1];
-            glGetProgramInfoLog(program, infoLogLength, nullptr, strInfoLog);
+            std::vector<GLchar> strInfoLog(infoLogLength + 1, 0);
+            glGetProgramInfoLog(program, infoLogLength, nullptr, strInfoLog.data());
 
-            fprintf(stderr, "Linking error in program: %s\n", strInfoLog);
-            delete[] strInfoLog;
+            out_errorLog += std::string{"Linking error in program: "} + strInfoLog.data() + "\n";
+            return false;
         }
+        return true;
     }
 
 }
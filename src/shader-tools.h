@@ -33,24 +33,96 @@
 //
 
 #include <glad/glad.h>
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <unordered_map>
 
 namespace wave_tool
 {
+    // the active (default-block) uniforms of a linked program, resolved once at link time
+    // NOTE: this avoids a string-based glGetUniformLocation round-trip to the driver for every uniform set per frame
+    // NOTE: array elements (e.g. "gerstnerWaves[2].amplitude_A" or "weights[3]") are each resolved under their own full name
+    struct ProgramReflection
+    {
+        GLuint program{0};
+        std::unordered_map<std::string, GLint> uniformLocations;
+
+        // returns -1 (same as OpenGL) if the uniform isn't active in the program, so setting it is a silent no-op
+        GLint getUniformLocation(std::string const &name) const;
+    };
+
+    // a program whose stages were handed to the driver, but whose compile/link result hasn't been checked yet (see ShaderTools::beginCompileShaders)
+    struct ProgramCompilation
+    {
+        enum Stage
+        {
+            VERTEX,
+            FRAGMENT,
+            TESS_CONTROL,
+            TESS_EVALUATION,
+            STAGE_COUNT
+        };
+
+        GLuint program{0};
+        std::array<GLuint, STAGE_COUNT> shaders{0, 0, 0, 0}; // 0 for unused (optional) stages
+    };
+
     // Class modified from code provided by Allan Rocha for CPSC 591
     class ShaderTools
     {
     public:
+        // where linked programs are kept as driver binaries between launches (relative to the working directory)
+        // NOTE: an empty path turns the cache off, so every program is compiled from source
+        static std::string programCacheDirectory;
+
+        // reloads the program from the binary cache when its sources and the driver are unchanged, otherwise compiles and links from source (and caches the result)
         static GLuint compileShaders(char const *vertexFilename, char const *fragmentFilename,
                                      char const *tessControlFilename = nullptr, char const *tessEvalFilename = nullptr);
 
+        // issues the compile and link of a program without checking the result, so with parallel compilation the driver can work on it in the background
+        // NOTE: sources are indexed by ProgramCompilation::Stage (nullptr for unused optional stages)
+        static ProgramCompilation beginCompileShaders(std::array<GLchar const *, ProgramCompilation::STAGE_COUNT> const &sources, bool const isBinaryRetrievable = false);
+        // only ever false while the driver is still compiling in the background (see isParallelCompileSupported)
+        static bool isCompilationComplete(ProgramCompilation const &compilation);
+        // releases the shaders and returns whether every stage compiled and the program linked (if not, the driver's messages are appended to out_errorLog)
+        // NOTE: blocks until the driver is done, unless isCompilationComplete was true
+        static bool finishCompileShaders(ProgramCompilation &compilation, std::string &out_errorLog);
+        // GL_KHR_parallel_shader_compile (or the ARB version) - compiling and linking return immediately and completion can be polled
+        static bool isParallelCompileSupported();
+        static bool readShaderSource(std::string const &filename, std::string &out_source);
+
+        // connects a named uniform block to a binding point (does nothing if the program doesn't use the block)
+        // NOTE: GLSL 4.1 has no layout(binding = ...) qualifier for blocks, so this has to be done after linking
+        static void bindUniformBlock(GLuint program, char const *blockName, GLuint bindingPoint);
+        static ProgramReflection reflectProgram(GLuint program);
+
     private:
         static unsigned long getFileLength(std::ifstream &file);
         static GLchar *loadshader(std::string filename);
         static void unloadshader(GLchar **ShaderSource);
-        static void checkShaderCompilation(GLuint shader, char const *shaderName);
-        static void checkProgramLink(GLuint program);
+        static bool checkShaderCompilation(GLuint shader, char const *shaderName, std::string &out_errorLog);
+        static bool checkProgramLink(GLuint program, std::string &out_errorLog);
+
+        // program binaries are only valid for the exact driver (and sources) that produced them
+        struct ProgramBinaryHeader
+        {
+            static constexpr std::uint32_t VERSION{1};
+
+            char magic[8];
+            std::uint32_t version;
+            GLenum binaryFormat;
+            std::uint64_t sourceKey; // hash of every stage's source and the driver's vendor/renderer/version strings
+            std::uint64_t binaryLength;
+        };
+
+        static bool isProgramBinaryCacheEnabled();
+        static std::string getProgramBinaryPath(char const *const filenames[], std::size_t const count);
+        static std::uint64_t hashProgramSources(GLchar const *const sources[], std::size_t const count);
+        static GLuint loadProgramBinary(std::string const &binaryPath, std::uint64_t const sourceKey);
+        static bool saveProgramBinary(GLuint program, std::string const &binaryPath, std::uint64_t const sourceKey);
     };
 }
 
@@ -0,0 +1,203 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "simulation-clock.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+namespace wave_tool
+{
+    SimulationClock::SimulationClock(State const &initialState, float const ticksPerSecond)
+        : m_ticksPerSecond{std::max(ticksPerSecond, 1.0f)},
+          m_tickDuration{std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{1.0 / m_ticksPerSecond})},
+          m_state{initialState}
+    {
+        // every slot starts out holding the initial state, so sampling before the first tick is well-defined
+        m_snapshots.fill(Snapshot{initialState, initialState, Clock::now()});
+        setRates(Rates{});
+    }
+
+    SimulationClock::~SimulationClock()
+    {
+        if (m_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> const lock{m_stopMutex};
+                m_isStopping = true;
+            }
+            m_stopRequested.notify_one();
+            m_thread.join();
+        }
+    }
+
+    void SimulationClock::start()
+    {
+        if (!m_thread.joinable())
+            m_thread = std::thread{&SimulationClock::run, this};
+    }
+
+    void SimulationClock::step(double const deltaTimeInSeconds)
+    {
+        if (m_thread.joinable())
+            return;
+        tick(deltaTimeInSeconds, Clock::now());
+    }
+
+    SimulationClock::State SimulationClock::sample()
+    {
+        // take the latest snapshot if the simulation published a new one since the last sample (otherwise keep interpolating the current one)
+        if (0 != (m_sharedSlot.load(std::memory_order_relaxed) & s_FRESH_SNAPSHOT_BIT))
+            m_readSlot = m_sharedSlot.exchange(m_readSlot, std::memory_order_acq_rel) & ~s_FRESH_SNAPSHOT_BIT;
+        Snapshot const &snapshot{m_snapshots.at(m_readSlot)};
+        if (!m_thread.joinable())
+            return snapshot.current;
+
+        // the current tick's state is reached a whole tick after it was simulated (if the next tick is late, the state holds rather than extrapolates)
+        std::chrono::duration<float> const timeSinceTick{Clock::now() - snapshot.currentTickTime};
+        float const alpha{glm::clamp(timeSinceTick.count() * m_ticksPerSecond, 0.0f, 1.0f)};
+        return interpolate(snapshot.previous, snapshot.current, alpha);
+    }
+
+    void SimulationClock::setRates(Rates const &rates)
+    {
+        m_isAnimatingWaves.store(rates.isAnimatingWaves, std::memory_order_relaxed);
+        m_isAnimatingTimeOfDay.store(rates.isAnimatingTimeOfDay, std::memory_order_relaxed);
+        m_verticalBounceWavePhasePeriodInSeconds.store(rates.verticalBounceWavePhasePeriodInSeconds, std::memory_order_relaxed);
+        m_timeOfDayInSecondsPerHour.store(rates.timeOfDayInSecondsPerHour, std::memory_order_relaxed);
+    }
+
+    void SimulationClock::setWaveAnimationTimeInSeconds(double const waveAnimationTimeInSeconds)
+    {
+        m_overrideWaveAnimationTimeInSeconds.store(waveAnimationTimeInSeconds, std::memory_order_relaxed);
+        m_pendingOverrides.fetch_or(WAVE_ANIMATION_TIME, std::memory_order_release);
+    }
+
+    void SimulationClock::setVerticalBounceWavePhase(float const verticalBounceWavePhase)
+    {
+        m_overrideVerticalBounceWavePhase.store(verticalBounceWavePhase, std::memory_order_relaxed);
+        m_pendingOverrides.fetch_or(VERTICAL_BOUNCE_WAVE_PHASE, std::memory_order_release);
+    }
+
+    void SimulationClock::setTimeOfDayInHours(float const timeOfDayInHours)
+    {
+        m_overrideTimeOfDayInHours.store(timeOfDayInHours, std::memory_order_relaxed);
+        m_pendingOverrides.fetch_or(TIME_OF_DAY, std::memory_order_release);
+    }
+
+    void SimulationClock::run()
+    {
+        double const tickDurationInSeconds{1.0 / m_ticksPerSecond};
+        Clock::time_point nextTickTime{Clock::now() + m_tickDuration};
+        std::unique_lock<std::mutex> lock{m_stopMutex};
+        while (!m_stopRequested.wait_until(lock, nextTickTime, [this] { return m_isStopping; }))
+        {
+            // every tick advances by exactly one tick duration, late ticks are caught up on (up to a point)
+            Clock::time_point const now{Clock::now()};
+            unsigned int tickCount{0};
+            for (; nextTickTime <= now && tickCount < MAX_CATCH_UP_TICKS; ++tickCount)
+            {
+                tick(tickDurationInSeconds, nextTickTime);
+                nextTickTime += m_tickDuration;
+            }
+            if (nextTickTime <= now)
+            {
+                auto const droppedTickCount{(now - nextTickTime) / m_tickDuration + 1};
+                m_droppedTickCount.fetch_add((unsigned long long)droppedTickCount, std::memory_order_relaxed);
+                nextTickTime += droppedTickCount * m_tickDuration;
+            }
+        }
+    }
+
+    void SimulationClock::tick(double const deltaTimeInSeconds, Clock::time_point const tickTime)
+    {
+        unsigned int const overrides{m_pendingOverrides.exchange(0, std::memory_order_acquire)};
+        if (0 != (overrides & WAVE_ANIMATION_TIME))
+            m_state.waveAnimationTimeInSeconds = m_overrideWaveAnimationTimeInSeconds.load(std::memory_order_relaxed);
+        if (0 != (overrides & VERTICAL_BOUNCE_WAVE_PHASE))
+            m_state.verticalBounceWavePhase = m_overrideVerticalBounceWavePhase.load(std::memory_order_relaxed);
+        if (0 != (overrides & TIME_OF_DAY))
+            m_state.timeOfDayInHours = m_overrideTimeOfDayInHours.load(std::memory_order_relaxed);
+
+        Rates const rates{m_isAnimatingWaves.load(std::memory_order_relaxed), m_isAnimatingTimeOfDay.load(std::memory_order_relaxed),
+                          m_verticalBounceWavePhasePeriodInSeconds.load(std::memory_order_relaxed), m_timeOfDayInSecondsPerHour.load(std::memory_order_relaxed)};
+        // NOTE: an override is a jump, so it starts the interpolation rather than being interpolated to
+        State const previous{m_state};
+        m_state = advance(m_state, rates, deltaTimeInSeconds);
+        m_tickCount.fetch_add(1, std::memory_order_relaxed);
+        publish(Snapshot{previous, m_state, tickTime});
+    }
+
+    void SimulationClock::publish(Snapshot const &snapshot)
+    {
+        m_snapshots.at(m_writeSlot) = snapshot;
+        m_writeSlot = m_sharedSlot.exchange(m_writeSlot | s_FRESH_SNAPSHOT_BIT, std::memory_order_acq_rel) & ~s_FRESH_SNAPSHOT_BIT;
+    }
+
+    SimulationClock::State SimulationClock::advance(State const &state, Rates const &rates, double const deltaTimeInSeconds)
+    {
+        State next{state};
+        if (rates.isAnimatingWaves)
+        {
+            next.waveAnimationTimeInSeconds += deltaTimeInSeconds;
+            if (rates.verticalBounceWavePhasePeriodInSeconds > 0.0f)
+                next.verticalBounceWavePhase = glm::mod(next.verticalBounceWavePhase + (float)(deltaTimeInSeconds / rates.verticalBounceWavePhasePeriodInSeconds), 1.0f);
+        }
+        if (rates.isAnimatingTimeOfDay && rates.timeOfDayInSecondsPerHour > 0.0f)
+        {
+            float const timeOfDayInHours{next.timeOfDayInHours + (float)(deltaTimeInSeconds / rates.timeOfDayInSecondsPerHour)};
+            next.timeOfDayInHours = MIN_TIME_OF_DAY_IN_HOURS + glm::mod(timeOfDayInHours - MIN_TIME_OF_DAY_IN_HOURS, MAX_TIME_OF_DAY_IN_HOURS - MIN_TIME_OF_DAY_IN_HOURS);
+        }
+        return next;
+    }
+
+    SimulationClock::State SimulationClock::interpolate(State const &from, State const &to, float const alpha)
+    {
+        // the phase and the time of day wrap around, so a step more than half a period long was a wrap (and is interpolated the short way round)
+        auto const interpolateWrapped{[alpha](float const value0, float const value1, float const min, float const max) {
+            float const period{max - min};
+            float const delta{value1 - value0};
+            if (std::abs(delta) <= 0.5f * period)
+                return value0 + alpha * delta;
+            float const wrappedDelta{delta - period * std::round(delta / period)};
+            return min + glm::mod(value0 + alpha * wrappedDelta - min, period);
+        }};
+
+        State result;
+        result.waveAnimationTimeInSeconds = from.waveAnimationTimeInSeconds + alpha * (to.waveAnimationTimeInSeconds - from.waveAnimationTimeInSeconds);
+        result.verticalBounceWavePhase = interpolateWrapped(from.verticalBounceWavePhase, to.verticalBounceWavePhase, 0.0f, 1.0f);
+        result.timeOfDayInHours = interpolateWrapped(from.timeOfDayInHours, to.timeOfDayInHours, MIN_TIME_OF_DAY_IN_HOURS, MAX_TIME_OF_DAY_IN_HOURS);
+        return result;
+    }
+}
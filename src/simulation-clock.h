@@ -0,0 +1,165 @@
+#ifndef WAVE_TOOL_SIMULATION_CLOCK_H_
+#define WAVE_TOOL_SIMULATION_CLOCK_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace wave_tool
+{
+    // advances everything that animates with time (the wave animation and the time of day) at a fixed rate, on its own thread
+    // the ticks follow a monotonic clock rather than the framerate, so render hitches don't change the speed of the simulation
+    // every tick publishes the previous and current state through a triple buffer (the slots are handed over by an atomic exchange, so neither thread ever waits on the other), and the renderer interpolates between the two
+    // NOTE: the sampled state lags the simulation by a tick, which is what makes the interpolation possible
+    // reference: Fiedler - Fix Your Timestep! (2004)
+    class SimulationClock
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // everything the simulation owns
+        struct State
+        {
+            double waveAnimationTimeInSeconds{0.0}; // in range [0.0, inf) - double, so the fixed ticks keep their precision over long runs
+            float verticalBounceWavePhase{0.0f};    // in range [0.0, 1.0]
+            float timeOfDayInHours{9.0f};           // in range [0.0, 24.0] - wraps within [MIN_TIME_OF_DAY_IN_HOURS, MAX_TIME_OF_DAY_IN_HOURS) while animating
+        };
+
+        // how fast the state advances (set from the UI thread, picked up at the next tick)
+        struct Rates
+        {
+            bool isAnimatingWaves{true};
+            bool isAnimatingTimeOfDay{false};
+            float verticalBounceWavePhasePeriodInSeconds{3.0f}; // in range [0.0, inf) - 0 stops the bounce
+            float timeOfDayInSecondsPerHour{1.0f};              // in range [0.0, inf) - 0 stops the time of day
+        };
+
+        inline static float const DEFAULT_TICKS_PER_SECOND{120.0f};
+        // if the thread falls further behind than this (e.g. the process was suspended), the rest is dropped instead of fast-forwarded
+        static unsigned int const MAX_CATCH_UP_TICKS{8};
+        inline static float const MIN_TIME_OF_DAY_IN_HOURS{7.0f};
+        inline static float const MAX_TIME_OF_DAY_IN_HOURS{17.0f};
+
+        explicit SimulationClock(State const &initialState, float const ticksPerSecond = DEFAULT_TICKS_PER_SECOND);
+        ~SimulationClock();
+
+        SimulationClock(SimulationClock const &) = delete;
+        SimulationClock &operator=(SimulationClock const &) = delete;
+
+        // starts ticking on the simulation thread (until destruction)
+        // NOTE: until then, the clock only advances through step() (e.g. headless mode, where frames use a fixed timestep for deterministic output)
+        void start();
+        inline bool isRunning() const { return m_thread.joinable(); }
+        // advances the state by exactly deltaTimeInSeconds on the calling thread, must not be called once started
+        void step(double const deltaTimeInSeconds);
+
+        // the state at the current time, interpolated between the two latest ticks (just the latest state if not running)
+        // NOTE: must only be called from a single thread (the render thread)
+        State sample();
+
+        void setRates(Rates const &rates);
+        // overrides part of the state (e.g. from a UI slider), the simulation continues from there at its next tick
+        void setWaveAnimationTimeInSeconds(double const waveAnimationTimeInSeconds);
+        void setVerticalBounceWavePhase(float const verticalBounceWavePhase);
+        void setTimeOfDayInHours(float const timeOfDayInHours);
+
+        inline float getTicksPerSecond() const { return m_ticksPerSecond; }
+        // ticks run so far (including step()s), and ticks dropped because the thread fell too far behind
+        inline unsigned long long getTickCount() const { return m_tickCount.load(std::memory_order_relaxed); }
+        inline unsigned long long getDroppedTickCount() const { return m_droppedTickCount.load(std::memory_order_relaxed); }
+
+    private:
+        struct Snapshot
+        {
+            State previous;
+            State current;
+            Clock::time_point currentTickTime; // the scheduled (not actual) time of the current tick
+        };
+
+        enum Override
+        {
+            WAVE_ANIMATION_TIME = 1u << 0,
+            VERTICAL_BOUNCE_WAVE_PHASE = 1u << 1,
+            TIME_OF_DAY = 1u << 2
+        };
+
+        // set in the shared slot index while it holds a snapshot the reader hasn't taken yet
+        static unsigned int const s_FRESH_SNAPSHOT_BIT{4};
+
+        float const m_ticksPerSecond;
+        Clock::duration const m_tickDuration;
+
+        // simulation side (the simulation thread once started, the caller of step() before)...
+        State m_state;
+        unsigned int m_writeSlot{0};
+
+        // triple buffer...
+        std::array<Snapshot, 3> m_snapshots;
+        std::atomic<unsigned int> m_sharedSlot{1};
+
+        // render side...
+        unsigned int m_readSlot{2};
+
+        // written by the UI thread, read at every tick...
+        std::atomic<bool> m_isAnimatingWaves;
+        std::atomic<bool> m_isAnimatingTimeOfDay;
+        std::atomic<float> m_verticalBounceWavePhasePeriodInSeconds;
+        std::atomic<float> m_timeOfDayInSecondsPerHour;
+        std::atomic<unsigned int> m_pendingOverrides{0}; // Override bits, set after the matching value below
+        std::atomic<double> m_overrideWaveAnimationTimeInSeconds{0.0};
+        std::atomic<float> m_overrideVerticalBounceWavePhase{0.0f};
+        std::atomic<float> m_overrideTimeOfDayInHours{0.0f};
+
+        std::atomic<unsigned long long> m_tickCount{0};
+        std::atomic<unsigned long long> m_droppedTickCount{0};
+
+        std::thread m_thread;
+        // only used to wake the thread up for stopping (never taken by the render thread)
+        std::mutex m_stopMutex;
+        std::condition_variable m_stopRequested;
+        bool m_isStopping{false};
+
+        void run();
+        // applies pending overrides, advances the state and publishes it
+        void tick(double const deltaTimeInSeconds, Clock::time_point const tickTime);
+        void publish(Snapshot const &snapshot);
+        static State advance(State const &state, Rates const &rates, double const deltaTimeInSeconds);
+        static State interpolate(State const &from, State const &to, float const alpha);
+    };
+}
+
+#endif // WAVE_TOOL_SIMULATION_CLOCK_H_
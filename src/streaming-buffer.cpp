@@ -0,0 +1,188 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "streaming-buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "gl-extensions.h"
+
+namespace wave_tool
+{
+    StreamingBuffer::StreamingBuffer(GLsizeiptr const regionSize) : m_regionSize{regionSize}, m_requestedRegionSize{regionSize}
+    {
+        create();
+    }
+
+    StreamingBuffer::~StreamingBuffer()
+    {
+        destroy();
+    }
+
+    void StreamingBuffer::nextFrame()
+    {
+        if (isPersistentlyMapped())
+        {
+            GLsync &fence{m_fences.at(m_region)};
+            glDeleteSync(fence);
+            fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        m_regionOffset = 0;
+
+        // NOTE: the old storage is kept alive by GL until the GPU is done with it
+        if (m_requestedRegionSize > m_regionSize)
+        {
+            destroy();
+            m_regionSize = m_requestedRegionSize;
+            create();
+            return;
+        }
+
+        if (isPersistentlyMapped())
+        {
+            m_region = (m_region + 1) % REGION_COUNT;
+            GLsync &fence{m_fences.at(m_region)};
+            if (0 != fence)
+            {
+                // a frame's worth of commands is normally long done by now
+                GLenum result{GL_TIMEOUT_EXPIRED};
+                while (GL_TIMEOUT_EXPIRED == result)
+                    result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1 second
+                glDeleteSync(fence);
+                fence = 0;
+            }
+        }
+        else
+        {
+            // orphan: the driver hands out fresh storage while the previous frames keep reading the old one
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, m_regionSize, nullptr, GL_STREAM_DRAW);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+    }
+
+    StreamingBuffer::Allocation StreamingBuffer::allocate(GLsizeiptr const size, GLsizeiptr const alignment)
+    {
+        GLsizeiptr const offset{(m_regionOffset + alignment - 1) / alignment * alignment};
+        if (offset + size > m_regionSize)
+        {
+            // grow geometrically, so a steadily growing demand doesn't recreate the buffer every frame
+            m_requestedRegionSize = std::max(m_requestedRegionSize, std::max(offset + size, m_regionSize * 2));
+            return Allocation{};
+        }
+        m_regionOffset = offset + size;
+
+        Allocation allocation;
+        allocation.size = size;
+        if (isPersistentlyMapped())
+        {
+            allocation.offset = m_region * m_regionSize + offset;
+            allocation.data = static_cast<char *>(m_persistentMapping) + allocation.offset;
+        }
+        else
+        {
+            // NOTE: the range is unused since the buffer was orphaned this frame, so there's nothing to synchronize with
+            allocation.offset = offset;
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+            allocation.data = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        return allocation;
+    }
+
+    void StreamingBuffer::commit(Allocation const &allocation)
+    {
+        // writes to a coherent mapping are visible to the GPU without any call
+        if (isPersistentlyMapped() || !allocation.isValid())
+            return;
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    StreamingBuffer::Allocation StreamingBuffer::upload(void const *data, GLsizeiptr const size, GLsizeiptr const alignment)
+    {
+        Allocation const allocation{allocate(size, alignment)};
+        if (allocation.isValid())
+        {
+            std::memcpy(allocation.data, data, size);
+            commit(allocation);
+        }
+        return allocation;
+    }
+
+    void StreamingBuffer::create()
+    {
+        m_region = 0;
+        m_regionOffset = 0;
+
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        if (nullptr != GLExtensions::bufferStorage)
+        {
+            GLbitfield const flags{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT};
+            GLExtensions::bufferStorage(GL_COPY_WRITE_BUFFER, REGION_COUNT * m_regionSize, nullptr, flags);
+            m_persistentMapping = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, REGION_COUNT * m_regionSize, flags);
+            if (nullptr == m_persistentMapping)
+            {
+                // immutable storage can't be respecified, so start over with a regular buffer
+                std::cout << "ERROR: failed to persistently map streaming buffer, falling back to orphaning" << std::endl;
+                glDeleteBuffers(1, &m_buffer);
+                glGenBuffers(1, &m_buffer);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+            }
+        }
+        if (!isPersistentlyMapped())
+            glBufferData(GL_COPY_WRITE_BUFFER, m_regionSize, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void StreamingBuffer::destroy()
+    {
+        for (GLsync &fence : m_fences)
+        {
+            glDeleteSync(fence);
+            fence = 0;
+        }
+        if (isPersistentlyMapped())
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            m_persistentMapping = nullptr;
+        }
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef WAVE_TOOL_STREAMING_BUFFER_H_
+#define WAVE_TOOL_STREAMING_BUFFER_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glad/glad.h>
+
+#include <array>
+
+namespace wave_tool
+{
+    // a ring of REGION_COUNT per-frame regions for data that is rewritten every frame (uniform blocks, dynamic vertex data, texture uploads)
+    // the CPU writes one region while the GPU may still read the previous frames' regions, and a fence per region guards its reuse
+    // NOTE: persistently (and coherently) mapped where buffer storage is available (see GLExtensions), otherwise the buffer is orphaned every frame
+    // NOTE: nothing is bound to the buffer's regular targets, consumers bind getBuffer() (e.g. as a uniform range, a copy source or a pixel unpack buffer) themselves
+    class StreamingBuffer
+    {
+    public:
+        static unsigned int const REGION_COUNT{3};
+
+        struct Allocation
+        {
+            GLintptr offset{0}; // into getBuffer()
+            GLsizeiptr size{0};
+            void *data{nullptr}; // where to write the size bytes (only valid until commit)
+
+            inline bool isValid() const { return nullptr != data; }
+        };
+
+        // regionSize is the most that can be allocated per frame (if a frame asks for more, the regions grow at the next nextFrame)
+        explicit StreamingBuffer(GLsizeiptr const regionSize);
+        ~StreamingBuffer();
+
+        StreamingBuffer(StreamingBuffer const &) = delete;
+        StreamingBuffer &operator=(StreamingBuffer const &) = delete;
+
+        inline GLuint getBuffer() const { return m_buffer; }
+        inline bool isPersistentlyMapped() const { return nullptr != m_persistentMapping; }
+
+        // fences the region written since the last call (everything reading it must have been issued), then moves on to the next one
+        // NOTE: must be called once per frame, and only waits if the GPU is still reading the region from REGION_COUNT frames ago
+        void nextFrame();
+
+        // reserves size bytes (with offset a multiple of alignment) in this frame's region, write them to data and commit before any command reads them
+        // NOTE: the allocation is invalid if the region is full, in which case the caller should upload some other way for this frame
+        // NOTE: without persistent mapping only one allocation can be outstanding (uncommitted) at a time
+        Allocation allocate(GLsizeiptr const size, GLsizeiptr const alignment);
+        void commit(Allocation const &allocation);
+        // allocate, copy and commit in one go
+        Allocation upload(void const *data, GLsizeiptr const size, GLsizeiptr const alignment);
+
+    private:
+        GLuint m_buffer{0};
+        void *m_persistentMapping{nullptr};
+        GLsizeiptr m_regionSize{0};
+        GLsizeiptr m_requestedRegionSize{0}; // the regions are recreated at this size by the next nextFrame
+        unsigned int m_region{0};
+        GLsizeiptr m_regionOffset{0}; // the next free byte of the current region
+        std::array<GLsync, REGION_COUNT> m_fences{};
+
+        void create();
+        void destroy();
+    };
+}
+
+#endif // WAVE_TOOL_STREAMING_BUFFER_H_
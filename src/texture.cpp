@@ -29,10 +29,20 @@
 //     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include "gl-extensions.h"
 #include "texture.h"
 
+// from EXT_texture_compression_s3tc (not part of the core profile our glad loader was generated for)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 namespace wave_tool {
     GLuint Texture::create1DTexture(unsigned char *data, unsigned int length) {
         if (nullptr == data) return 0; // error code
@@ -71,6 +81,58 @@ namespace wave_tool {
         return textureID;
     }
 
+    GLuint Texture::create2DTexture(KTX2::Mapping const& image) {
+        if (!isCompressedFormatSupported(image.getFormat())) return 0; // error code
+
+        GLuint textureID;
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        // set options on currently bound texture object (same as above, but the mips are actually sampled)...
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, 1 < image.getLevelCount() ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.getLevelCount() - 1);
+        uploadCompressedLevels(GL_TEXTURE_2D, image);
+
+        return textureID;
+    }
+
+    void Texture::uploadCompressedLevels(GLenum target, KTX2::Mapping const& image) {
+        GLenum const internalFormat = getCompressedInternalFormat(image.getFormat());
+        for (std::uint32_t level = 0; level < image.getLevelCount(); ++level) {
+            GLsizei const width = std::max(1u, image.getWidth() >> level);
+            GLsizei const height = std::max(1u, image.getHeight() >> level);
+            glCompressedTexImage2D(target, level, internalFormat, width, height, 0, image.getLevelSize(level), image.getLevelData(level));
+        }
+    }
+
+    bool Texture::isCompressedFormatSupported(KTX2::Format format) {
+        switch (format) {
+            case KTX2::BC4_R:
+            case KTX2::BC5_RG:
+                return true;
+            case KTX2::BC1_RGB:
+            case KTX2::BC3_RGBA: {
+                // the extension list can't change for a context, so it's only searched once
+                static bool const isS3TCSupported = GLExtensions::isSupported("GL_EXT_texture_compression_s3tc");
+                return isS3TCSupported;
+            }
+            default:
+                return false;
+        }
+    }
+
+    GLenum Texture::getCompressedInternalFormat(KTX2::Format format) {
+        switch (format) {
+            case KTX2::BC1_RGB: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case KTX2::BC3_RGBA: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case KTX2::BC4_R: return GL_COMPRESSED_RED_RGTC1;
+            case KTX2::BC5_RG: return GL_COMPRESSED_RG_RGTC2;
+            default: return GL_NONE;
+        }
+    }
+
     void Texture::bind1DTexture(GLuint _program, GLuint _textureID, std::string const& varName) {
         glActiveTexture(GL_TEXTURE0 + _textureID);
         glBindTexture(GL_TEXTURE_1D, _textureID);
@@ -83,6 +145,18 @@ namespace wave_tool {
         glUniform1i(glGetUniformLocation(_program, varName.c_str()), _textureID);
     }
 
+    void Texture::bind1DTexture(GLint _samplerLocation, GLuint _textureID) {
+        glActiveTexture(GL_TEXTURE0 + _textureID);
+        glBindTexture(GL_TEXTURE_1D, _textureID);
+        glUniform1i(_samplerLocation, _textureID);
+    }
+
+    void Texture::bind2DTexture(GLint _samplerLocation, GLuint _textureID) {
+        glActiveTexture(GL_TEXTURE0 + _textureID);
+        glBindTexture(GL_TEXTURE_2D, _textureID);
+        glUniform1i(_samplerLocation, _textureID);
+    }
+
     void Texture::unbind1DTexture() {
         glBindTexture(GL_TEXTURE_1D, 0);
     }
@@ -35,14 +35,27 @@
 #include <glad/glad.h>
 #include <string>
 
+#include "ktx2.h"
+
 namespace wave_tool {
     class Texture {
         public:
             static GLuint create1DTexture(unsigned char *data, unsigned int length);
             static GLuint create2DTexture(unsigned char *data, unsigned int width, unsigned int height);
+            // uploads the pre-built mip chain of a KTX 2.0 file as-is (no decoding, and no glGenerateMipmap)
+            static GLuint create2DTexture(KTX2::Mapping const& image);
+            // uploads every level of the image to target (e.g. one face of the currently bound cubemap)
+            static void uploadCompressedLevels(GLenum target, KTX2::Mapping const& image);
+
+            //NOTE: BC4 / BC5 (RGTC) are core in OpenGL 4.1, but BC1 / BC3 (S3TC) come from an extension that must be checked for first
+            static bool isCompressedFormatSupported(KTX2::Format format);
+            static GLenum getCompressedInternalFormat(KTX2::Format format);
 
             static void bind1DTexture(GLuint _program, GLuint _textureID, std::string const& varName);
             static void bind2DTexture(GLuint _program, GLuint _textureID, std::string const& varName);
+            // same as above, but with a sampler location that was already resolved (see ShaderTools::reflectProgram)
+            static void bind1DTexture(GLint _samplerLocation, GLuint _textureID);
+            static void bind2DTexture(GLint _samplerLocation, GLuint _textureID);
 
             static void unbind1DTexture();
             static void unbind2DTexture();
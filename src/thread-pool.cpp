@@ -0,0 +1,292 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "thread-pool.h"
+
+#include <algorithm>
+
+namespace wave_tool
+{
+    namespace
+    {
+        // the pool (and deque) of the calling thread, if it is a worker
+        thread_local ThreadPool const *t_workerPool{nullptr};
+        thread_local std::size_t t_workerQueueIndex{0};
+    }
+
+    ThreadPool::ThreadPool(unsigned int threadCount)
+        : m_contextThreadID{std::this_thread::get_id()}
+    {
+        if (0 == threadCount)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        // NOTE: the caller of parallelFor / wait also works, so one less worker is needed
+        for (unsigned int i = 0; i < threadCount; ++i)
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        for (unsigned int i = 1; i < threadCount; ++i)
+            m_workers.emplace_back(&ThreadPool::workerLoop, this, i - 1);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_sleepMutex};
+            m_isStopping = true;
+        }
+        m_stateChanged.notify_all();
+        for (auto &worker : m_workers)
+            worker.join();
+    }
+
+    ThreadPool::TaskHandle ThreadPool::submit(std::function<void()> func)
+    {
+        return createTask({}, std::move(func), false);
+    }
+
+    ThreadPool::TaskHandle ThreadPool::then(std::vector<TaskHandle> const &dependencies, std::function<void()> func)
+    {
+        return createTask(dependencies, std::move(func), false);
+    }
+
+    ThreadPool::TaskHandle ThreadPool::thenOnContextThread(std::vector<TaskHandle> const &dependencies, std::function<void()> func)
+    {
+        return createTask(dependencies, std::move(func), true);
+    }
+
+    void ThreadPool::wait(TaskHandle const &task)
+    {
+        if (nullptr == task)
+            return;
+
+        bool const isContextThread{std::this_thread::get_id() == m_contextThreadID};
+        while (!task->isDone())
+        {
+            if (isContextThread && runContextThreadTask())
+                continue;
+            if (runPendingTask())
+                continue;
+
+            std::unique_lock<std::mutex> lock{m_sleepMutex};
+            m_stateChanged.wait(lock, [this, &task, isContextThread]() {
+                return task->isDone() || 0 < m_queuedTaskCount.load() || (isContextThread && 0 < m_queuedContextThreadTaskCount.load());
+            });
+        }
+    }
+
+    void ThreadPool::wait(std::vector<TaskHandle> const &tasks)
+    {
+        for (TaskHandle const &task : tasks)
+            wait(task);
+    }
+
+    void ThreadPool::runContextThreadTasks()
+    {
+        while (runContextThreadTask())
+            ;
+    }
+
+    void ThreadPool::parallelFor(std::size_t const count, std::function<void(std::size_t, std::size_t)> const &func, std::size_t const minChunkSize)
+    {
+        if (0 == count)
+            return;
+
+        std::size_t const threadCount{m_workers.size() + 1};
+        std::size_t const chunkSize{std::max(std::max<std::size_t>(minChunkSize, 1), (count + threadCount - 1) / threadCount)};
+        std::size_t const chunkCount{(count + chunkSize - 1) / chunkSize};
+        if (1 == chunkCount)
+        {
+            func(0, count);
+            return;
+        }
+
+        std::vector<TaskHandle> chunks;
+        chunks.reserve(chunkCount - 1);
+        for (std::size_t chunk = 1; chunk < chunkCount; ++chunk)
+        {
+            std::size_t const begin{chunk * chunkSize};
+            std::size_t const end{std::min(count, begin + chunkSize)};
+            // NOTE: func is captured by reference, which is safe since this waits for every chunk before returning
+            chunks.push_back(submit([&func, begin, end]() { func(begin, end); }));
+        }
+
+        // the calling thread takes the first chunk, then helps with the rest
+        func(0, std::min(count, chunkSize));
+        wait(chunks);
+    }
+
+    ThreadPool::TaskHandle ThreadPool::createTask(std::vector<TaskHandle> const &dependencies, std::function<void()> func, bool const isContextThreadTask)
+    {
+        TaskHandle task{std::make_shared<Task>()};
+        task->m_func = std::move(func);
+        task->m_isContextThreadTask = isContextThreadTask;
+        // NOTE: the extra count keeps the task from being scheduled by a dependency that finishes while the rest are still being registered
+        task->m_pendingDependencyCount.store(dependencies.size() + 1);
+
+        std::size_t doneDependencyCount{1};
+        for (TaskHandle const &dependency : dependencies)
+        {
+            if (nullptr == dependency)
+            {
+                ++doneDependencyCount;
+                continue;
+            }
+            std::lock_guard<std::mutex> lock{dependency->m_mutex};
+            if (dependency->isDone())
+                ++doneDependencyCount;
+            else
+                dependency->m_continuations.push_back(task);
+        }
+
+        if (doneDependencyCount == task->m_pendingDependencyCount.fetch_sub(doneDependencyCount))
+            schedule(task);
+        return task;
+    }
+
+    void ThreadPool::schedule(TaskHandle task)
+    {
+        if (task->m_isContextThreadTask)
+        {
+            std::lock_guard<std::mutex> lock{m_contextThreadQueue.mutex};
+            m_contextThreadQueue.tasks.push_back(std::move(task));
+            ++m_queuedContextThreadTaskCount;
+        }
+        else
+        {
+            // workers keep their own tasks, everyone else shares the last deque
+            std::size_t const queueIndex{this == t_workerPool ? t_workerQueueIndex : m_queues.size() - 1};
+            WorkQueue &queue{*m_queues.at(queueIndex)};
+            std::lock_guard<std::mutex> lock{queue.mutex};
+            queue.tasks.push_back(std::move(task));
+            ++m_queuedTaskCount;
+        }
+        notifyStateChanged();
+    }
+
+    void ThreadPool::execute(TaskHandle const &task)
+    {
+        task->m_func();
+        task->m_func = nullptr; // release whatever it captured
+
+        std::vector<TaskHandle> continuations;
+        {
+            std::lock_guard<std::mutex> lock{task->m_mutex};
+            task->m_isDone.store(true, std::memory_order_release);
+            continuations.swap(task->m_continuations);
+        }
+        for (TaskHandle &continuation : continuations)
+        {
+            if (1 == continuation->m_pendingDependencyCount.fetch_sub(1))
+                schedule(std::move(continuation));
+        }
+        notifyStateChanged(); // wakes the threads waiting on this task
+    }
+
+    void ThreadPool::notifyStateChanged()
+    {
+        // NOTE: taking the lock orders this against a sleeper that has just checked its predicate, so the notify can't be lost
+        {
+            std::lock_guard<std::mutex> lock{m_sleepMutex};
+        }
+        m_stateChanged.notify_all();
+    }
+
+    ThreadPool::TaskHandle ThreadPool::popTask()
+    {
+        if (0 == m_queuedTaskCount.load())
+            return nullptr;
+
+        std::size_t const ownQueueIndex{this == t_workerPool ? t_workerQueueIndex : m_queues.size() - 1};
+        for (std::size_t i = 0; i < m_queues.size(); ++i)
+        {
+            std::size_t const queueIndex{(ownQueueIndex + i) % m_queues.size()};
+            WorkQueue &queue{*m_queues.at(queueIndex)};
+            std::lock_guard<std::mutex> lock{queue.mutex};
+            if (queue.tasks.empty())
+                continue;
+
+            TaskHandle task;
+            if (0 == i)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            --m_queuedTaskCount;
+            return task;
+        }
+        return nullptr;
+    }
+
+    bool ThreadPool::runPendingTask()
+    {
+        TaskHandle const task{popTask()};
+        if (nullptr == task)
+            return false;
+        execute(task);
+        return true;
+    }
+
+    bool ThreadPool::runContextThreadTask()
+    {
+        TaskHandle task;
+        {
+            std::lock_guard<std::mutex> lock{m_contextThreadQueue.mutex};
+            if (m_contextThreadQueue.tasks.empty())
+                return false;
+            task = std::move(m_contextThreadQueue.tasks.front());
+            m_contextThreadQueue.tasks.pop_front();
+            --m_queuedContextThreadTaskCount;
+        }
+        execute(task);
+        return true;
+    }
+
+    void ThreadPool::workerLoop(std::size_t const queueIndex)
+    {
+        t_workerPool = this;
+        t_workerQueueIndex = queueIndex;
+
+        while (true)
+        {
+            if (runPendingTask())
+                continue;
+
+            std::unique_lock<std::mutex> lock{m_sleepMutex};
+            m_stateChanged.wait(lock, [this]() { return m_isStopping || 0 < m_queuedTaskCount.load(); });
+            if (m_isStopping && 0 == m_queuedTaskCount.load())
+                return;
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef WAVE_TOOL_THREAD_POOL_H_
+#define WAVE_TOOL_THREAD_POOL_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wave_tool
+{
+    // a work-stealing job system for CPU work (e.g. the ocean FFT, asset decoding)
+    // every worker owns a deque of ready tasks: it pushes and pops its own tasks at the back (so nested work stays hot in its cache), and an idle worker steals from the front of the others
+    // tasks can depend on other tasks (see then), and can be marked to run on the context thread (the thread that constructed the pool, which owns the GL context)
+    // NOTE: the deques are guarded by a mutex each rather than being lock-free, which is plenty for the size of the tasks submitted here
+    class ThreadPool
+    {
+    public:
+        class Task
+        {
+        public:
+            inline bool isDone() const { return m_isDone.load(std::memory_order_acquire); }
+
+        private:
+            friend class ThreadPool;
+
+            std::function<void()> m_func;
+            std::atomic<bool> m_isDone{false};
+            std::atomic<std::size_t> m_pendingDependencyCount{0};
+            bool m_isContextThreadTask{false};
+            std::mutex m_mutex; // guards m_continuations and the transition to done
+            std::vector<std::shared_ptr<Task>> m_continuations;
+        };
+        using TaskHandle = std::shared_ptr<Task>;
+
+        // 0 uses one thread per hardware core
+        // NOTE: the constructing thread becomes the context thread
+        explicit ThreadPool(unsigned int threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(ThreadPool const &) = delete;
+        ThreadPool &operator=(ThreadPool const &) = delete;
+
+        inline unsigned int getThreadCount() const { return (unsigned int)m_workers.size(); }
+
+        // runs func on any worker
+        TaskHandle submit(std::function<void()> func);
+        // runs func on any worker once every dependency is done (a null dependency counts as done)
+        TaskHandle then(std::vector<TaskHandle> const &dependencies, std::function<void()> func);
+        // same as above, but func runs on the context thread (inside wait or runContextThreadTasks) - this is where GL calls belong
+        TaskHandle thenOnContextThread(std::vector<TaskHandle> const &dependencies, std::function<void()> func);
+
+        // blocks until the task(s) are done, running other ready tasks meanwhile (on the context thread, that includes context-thread tasks)
+        void wait(TaskHandle const &task);
+        void wait(std::vector<TaskHandle> const &tasks);
+        // runs every ready context-thread task, must be called on the context thread
+        void runContextThreadTasks();
+
+        // splits [0, count) into contiguous chunks (of at least minChunkSize) and blocks until func(begin, end) has run for all of them
+        // NOTE: the calling thread runs chunks too, so this never deadlocks even if every worker is busy (it's also safe to call from inside a task)
+        void parallelFor(std::size_t const count, std::function<void(std::size_t, std::size_t)> const &func, std::size_t const minChunkSize = 1);
+
+    private:
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<TaskHandle> tasks;
+        };
+
+        std::vector<std::thread> m_workers;
+        std::vector<std::unique_ptr<WorkQueue>> m_queues; // one per worker, plus a last one for tasks scheduled from any other thread
+        WorkQueue m_contextThreadQueue;
+        std::thread::id const m_contextThreadID;
+        std::atomic<std::size_t> m_queuedTaskCount{0};
+        std::atomic<std::size_t> m_queuedContextThreadTaskCount{0};
+        // sleeping threads (idle workers, and waiters with nothing to run) block on this, it is notified whenever a task is queued or finishes
+        std::mutex m_sleepMutex;
+        std::condition_variable m_stateChanged;
+        bool m_isStopping{false};
+
+        TaskHandle createTask(std::vector<TaskHandle> const &dependencies, std::function<void()> func, bool const isContextThreadTask);
+        void schedule(TaskHandle task);
+        void execute(TaskHandle const &task);
+        void notifyStateChanged();
+        // the calling thread's own deque is checked first (from the back), then every other deque is stolen from (from the front)
+        TaskHandle popTask();
+        // runs a single ready task on the calling thread, returns false if there was none
+        bool runPendingTask();
+        bool runContextThreadTask();
+        void workerLoop(std::size_t const queueIndex);
+    };
+}
+
+#endif // WAVE_TOOL_THREAD_POOL_H_
@@ -0,0 +1,122 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "vertex-layout.h"
+
+#include <glm/gtc/packing.hpp>
+#include <glm/packing.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace wave_tool
+{
+    VertexLayout VertexLayout::floats(Location const location, GLint const componentCount)
+    {
+        return VertexLayout{{Attribute{location, componentCount, GL_FLOAT, GL_FALSE, 0}}, 0};
+    }
+
+    VertexLayout VertexLayout::packed(bool const hasNormals, bool const hasUVs, bool const hasColours)
+    {
+        VertexLayout layout;
+        GLuint offset{0};
+        layout.attributes.push_back(Attribute{POSITION, 3, GL_FLOAT, GL_FALSE, offset});
+        offset += 3 * sizeof(float);
+        if (hasNormals)
+        {
+            // NOTE: the 2-bit w is unused, the shader only reads xyz
+            layout.attributes.push_back(Attribute{NORMAL, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offset});
+            offset += sizeof(std::uint32_t);
+        }
+        if (hasUVs)
+        {
+            layout.attributes.push_back(Attribute{UV, 2, GL_HALF_FLOAT, GL_FALSE, offset});
+            offset += sizeof(std::uint32_t);
+        }
+        if (hasColours)
+        {
+            layout.attributes.push_back(Attribute{COLOUR, 4, GL_UNSIGNED_BYTE, GL_TRUE, offset});
+            offset += sizeof(std::uint32_t);
+        }
+        layout.stride = offset;
+        return layout;
+    }
+
+    bool VertexLayout::hasAttribute(Location const location) const
+    {
+        return attributes.end() != std::find_if(attributes.begin(), attributes.end(), [location](Attribute const &attribute) { return location == attribute.location; });
+    }
+
+    void VertexLayout::apply() const
+    {
+        for (Attribute const &attribute : attributes)
+        {
+            glVertexAttribPointer(attribute.location, attribute.componentCount, attribute.type, attribute.isNormalized, stride, (void *)(std::uintptr_t)attribute.offset);
+            glEnableVertexAttribArray(attribute.location);
+        }
+    }
+
+    void VertexLayout::pack(std::size_t const vertexCount, glm::vec3 const *positions, glm::vec3 const *normals, glm::vec2 const *uvs, glm::vec3 const *colours, std::vector<std::uint8_t> &out_data) const
+    {
+        std::size_t const vertexSize{0 != stride ? (std::size_t)stride : attributes.size() * sizeof(glm::vec3)};
+        out_data.resize(vertexCount * vertexSize);
+
+        for (Attribute const &attribute : attributes)
+        {
+            std::uint8_t *destination{out_data.data() + attribute.offset};
+            for (std::size_t i = 0; i < vertexCount; ++i, destination += vertexSize)
+            {
+                std::uint32_t packedValue{0};
+                switch (attribute.location)
+                {
+                case POSITION:
+                    std::memcpy(destination, &positions[i], sizeof(glm::vec3));
+                    continue;
+                case NORMAL:
+                {
+                    // NOTE: a zero-length normal stays zero instead of becoming NaN
+                    float const length{glm::length(normals[i])};
+                    glm::vec3 const normal{length > 0.0f ? normals[i] / length : glm::vec3{0.0f}};
+                    packedValue = glm::packSnorm3x10_1x2(glm::vec4{normal, 0.0f});
+                    break;
+                }
+                case UV:
+                    packedValue = glm::packHalf2x16(uvs[i]);
+                    break;
+                case COLOUR:
+                    packedValue = glm::packUnorm4x8(glm::vec4{glm::clamp(colours[i], 0.0f, 1.0f), 1.0f});
+                    break;
+                }
+                std::memcpy(destination, &packedValue, sizeof(packedValue));
+            }
+        }
+    }
+}
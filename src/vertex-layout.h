@@ -0,0 +1,93 @@
+#ifndef WAVE_TOOL_VERTEX_LAYOUT_H_
+#define WAVE_TOOL_VERTEX_LAYOUT_H_
+
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wave_tool
+{
+    // how a MeshObject's vertices are stored on the GPU
+    enum class VertexFormat
+    {
+        SEPARATE_FLOAT,    // one buffer of 32-bit floats per stream
+        PACKED_INTERLEAVED // a single interleaved buffer with quantized normals, UVs and colours (see VertexLayout::packed)
+    };
+
+    // describes the vertex fetch from one buffer: where every attribute sits in a vertex and in what format
+    // NOTE: the locations are shared by every vertex shader (see the layout qualifiers in assets/shaders)
+    struct VertexLayout
+    {
+        enum Location : GLuint
+        {
+            POSITION = 0,
+            NORMAL = 1,
+            UV = 2,
+            COLOUR = 3
+        };
+
+        struct Attribute
+        {
+            GLuint location;
+            GLint componentCount;
+            GLenum type;
+            GLboolean isNormalized;
+            GLuint offset; // in bytes from the start of a vertex
+        };
+
+        std::vector<Attribute> attributes;
+        GLsizei stride{0}; // 0 for tightly packed (single attribute) streams
+
+        // a single stream of tightly packed floats
+        static VertexLayout floats(Location const location, GLint const componentCount);
+        // 24 bytes per vertex (instead of 44 as separate floats) with every stream present:
+        //  position as 3 floats, normal as snorm 10:10:10:2, UV as 2 half floats, colour as unorm RGBA8
+        // NOTE: the shaders still see vec3/vec2 inputs, the conversion happens in the vertex fetch
+        static VertexLayout packed(bool const hasNormals, bool const hasUVs, bool const hasColours);
+
+        bool hasAttribute(Location const location) const;
+        inline GLsizei getVertexSize() const { return stride; }
+
+        // points the attributes of the bound vao at the buffer bound to GL_ARRAY_BUFFER
+        void apply() const;
+        // interleaves vertexCount vertices into out_data according to this layout
+        // NOTE: the streams of attributes the layout doesn't have can be nullptr
+        void pack(std::size_t const vertexCount, glm::vec3 const *positions, glm::vec3 const *normals, glm::vec2 const *uvs, glm::vec3 const *colours, std::vector<std::uint8_t> &out_data) const;
+    };
+}
+
+#endif // WAVE_TOOL_VERTEX_LAYOUT_H_
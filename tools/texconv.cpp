@@ -0,0 +1,248 @@
+// BSD 3 - Clause License
+//
+// Copyright(c) 2020, Aaron Hornby
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//     OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// texconv - offline converter from a common image format (png, bmp, jpg, tga, ...) to a KTX 2.0 file of BCn blocks with a pre-built mip chain
+// usage: texconv [--format auto|bc1|bc3|bc4|bc5] [--flip-y] [--no-mips] <input image> [<output .ktx2>]
+// NOTE: the output defaults to the input path with a .ktx2 extension, which is where the render engine looks for it
+// NOTE: pass --flip-y for images loaded as 2D textures (they are flipped on load so the first row is the bottom), but not for cubemap faces
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+#define STB_DXT_IMPLEMENTATION
+#include <stb/stb_dxt.h>
+
+#include "ktx2.h"
+
+namespace
+{
+    using wave_tool::KTX2;
+
+    // an 8-bit RGBA image
+    struct Image
+    {
+        std::uint32_t width{0};
+        std::uint32_t height{0};
+        std::vector<unsigned char> rgba;
+
+        inline unsigned char const *texel(std::uint32_t const x, std::uint32_t const y) const { return &rgba[4 * ((std::size_t)y * width + x)]; }
+    };
+
+    // the next mip level (each dimension halved, down to 1) as a 2x2 box filter
+    // NOTE: the average is taken on the stored (non-linear) values, which matches what glGenerateMipmap does for a plain GL_RGBA texture
+    Image downsample(Image const &image)
+    {
+        Image next;
+        next.width = std::max(1u, image.width / 2);
+        next.height = std::max(1u, image.height / 2);
+        next.rgba.resize(4 * (std::size_t)next.width * next.height);
+        for (std::uint32_t y = 0; y < next.height; ++y)
+        {
+            for (std::uint32_t x = 0; x < next.width; ++x)
+            {
+                std::uint32_t const x0{std::min(2 * x, image.width - 1)}, x1{std::min(2 * x + 1, image.width - 1)};
+                std::uint32_t const y0{std::min(2 * y, image.height - 1)}, y1{std::min(2 * y + 1, image.height - 1)};
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    unsigned int const sum{(unsigned int)image.texel(x0, y0)[channel] + image.texel(x1, y0)[channel] + image.texel(x0, y1)[channel] + image.texel(x1, y1)[channel]};
+                    next.rgba[4 * ((std::size_t)y * next.width + x) + channel] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+        return next;
+    }
+
+    // encodes every 4x4 block of the image (edge blocks repeat the last row / column)
+    std::vector<unsigned char> compress(Image const &image, KTX2::Format const format)
+    {
+        std::size_t const blockSize{KTX2::getBlockSize(format)};
+        std::uint32_t const blocksWide{(image.width + 3) / 4};
+        std::uint32_t const blocksHigh{(image.height + 3) / 4};
+        std::vector<unsigned char> blocks(blockSize * blocksWide * blocksHigh);
+
+        unsigned char rgba[16 * 4];
+        unsigned char channels[16 * 2];
+        for (std::uint32_t blockY = 0; blockY < blocksHigh; ++blockY)
+        {
+            for (std::uint32_t blockX = 0; blockX < blocksWide; ++blockX)
+            {
+                for (std::uint32_t i = 0; i < 16; ++i)
+                {
+                    unsigned char const *const source{image.texel(std::min(4 * blockX + i % 4, image.width - 1), std::min(4 * blockY + i / 4, image.height - 1))};
+                    std::memcpy(&rgba[4 * i], source, 4);
+                    channels[2 * i] = source[0];
+                    channels[2 * i + 1] = source[1];
+                }
+
+                unsigned char *const destination{&blocks[blockSize * ((std::size_t)blockY * blocksWide + blockX)]};
+                switch (format)
+                {
+                case KTX2::BC1_RGB:
+                    stb_compress_dxt_block(destination, rgba, 0, STB_DXT_HIGHQUAL);
+                    break;
+                case KTX2::BC3_RGBA:
+                    stb_compress_dxt_block(destination, rgba, 1, STB_DXT_HIGHQUAL);
+                    break;
+                case KTX2::BC4_R:
+                {
+                    unsigned char red[16];
+                    for (int i = 0; i < 16; ++i)
+                        red[i] = channels[2 * i];
+                    stb_compress_bc4_block(destination, red);
+                    break;
+                }
+                case KTX2::BC5_RG:
+                    stb_compress_bc5_block(destination, channels);
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+        return blocks;
+    }
+
+    bool parseFormat(std::string const &name, KTX2::Format &out_format)
+    {
+        if ("auto" == name)
+            out_format = KTX2::UNDEFINED;
+        else if ("bc1" == name)
+            out_format = KTX2::BC1_RGB;
+        else if ("bc3" == name)
+            out_format = KTX2::BC3_RGBA;
+        else if ("bc4" == name)
+            out_format = KTX2::BC4_R;
+        else if ("bc5" == name)
+            out_format = KTX2::BC5_RG;
+        else
+            return false;
+        return true;
+    }
+
+    void printUsage()
+    {
+        std::cout << "usage: texconv [--format auto|bc1|bc3|bc4|bc5] [--flip-y] [--no-mips] <input image> [<output .ktx2>]" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    KTX2::Format format{KTX2::UNDEFINED}; // auto: BC1 for opaque images, otherwise BC3
+    bool isFlippingY{false};
+    bool isBuildingMips{true};
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg{argv[i]};
+        if ("--format" == arg)
+        {
+            if (i + 1 >= argc || !parseFormat(argv[i + 1], format))
+            {
+                printUsage();
+                return 1;
+            }
+            ++i;
+        }
+        else if ("--flip-y" == arg)
+        {
+            isFlippingY = true;
+        }
+        else if ("--no-mips" == arg)
+        {
+            isBuildingMips = false;
+        }
+        else if (0 == arg.compare(0, 2, "--"))
+        {
+            std::cout << "ERROR: unknown option " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty() || 2 < paths.size())
+    {
+        printUsage();
+        return 1;
+    }
+    std::string const inputPath{paths.at(0)};
+    std::string const outputPath{2 == paths.size() ? paths.at(1) : KTX2::getContainerPath(inputPath)};
+
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(isFlippingY);
+    unsigned char *const data{stbi_load(inputPath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha)};
+    if (nullptr == data)
+    {
+        std::cout << "ERROR: failed to read image at path: " << inputPath << std::endl;
+        return 1;
+    }
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.rgba.assign(data, data + 4 * (std::size_t)width * height);
+    stbi_image_free(data);
+
+    if (KTX2::UNDEFINED == format)
+    {
+        bool isOpaque{true};
+        for (std::size_t i = 3; i < image.rgba.size() && isOpaque; i += 4)
+            isOpaque = 255 == image.rgba[i];
+        format = isOpaque ? KTX2::BC1_RGB : KTX2::BC3_RGBA;
+    }
+
+    std::vector<std::vector<unsigned char>> levels;
+    levels.push_back(compress(image, format));
+    while (isBuildingMips && (1 < image.width || 1 < image.height))
+    {
+        image = downsample(image);
+        levels.push_back(compress(image, format));
+    }
+
+    if (!KTX2::write(outputPath, format, width, height, levels, isFlippingY))
+    {
+        std::cout << "ERROR: failed to write " << outputPath << std::endl;
+        return 1;
+    }
+
+    std::size_t compressedSize{0};
+    for (auto const &level : levels)
+        compressedSize += level.size();
+    std::cout << inputPath << " -> " << outputPath << " (" << width << "x" << height << ", " << levels.size() << " levels, " << compressedSize / 1024 << " KiB)" << std::endl;
+    return 0;
+}